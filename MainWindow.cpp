@@ -4,16 +4,22 @@
 #include <QFileDialog>
 #include <QStandardPaths>
 #include <QDebug>
-#include <QMimeType>
-#include <QMimeDatabase>
+#include <QDragEnterEvent>
+#include <QDropEvent>
+#include <QMimeData>
+#include <QShowEvent>
 #include <QSystemTrayIcon>
-#include "Tools/MediaMetadataExtractor.h"
+#include <QThread>
+#include "Tools/AudioFormatRegistry.h"
+#include "Tools/StartupProfiler.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
 
     , m_bInitPlayList(false)
+    , m_bStartupExtract(false)
+    , m_bShown(false)
 {
     ui->setupUi(this);
 
@@ -24,12 +30,16 @@ MainWindow::MainWindow(QWidget *parent)
     initHotKeys();
 
     initConfigs();
-
-    postInitialize();
+    StartupProfiler::instance().mark("Config");
 }
 
 MainWindow::~MainWindow()
 {
+    // 子对象按创建顺序析构，写入服务（属于 AlbumManager）先于缓存销毁，在此之前提交最后的快照
+    m_metadataCache->saveToFile();
+    m_loudnessCache->saveToFile();
+    m_equalizerPresets->saveToFile();
+
     delete ui;
 }
 
@@ -55,6 +65,9 @@ void MainWindow::initApplication()
     m_trayIcon->show();
 
     qApp->setQuitOnLastWindowClosed(false);
+
+    // 允许拖入音频文件或目录
+    setAcceptDrops(true);
 }
 
 void MainWindow::initWidgets()
@@ -64,8 +77,8 @@ void MainWindow::initWidgets()
     m_group->addButton(ui->radioBtn_loop, 1);  // ID 1
     m_group->addButton(ui->radioBtn_random, 2);   // ID 2
 
-    ui->slider_volume->setSliderPosition(m_audioOutput->volume()*100);
-    ui->label_volume->setText(QString::number(m_audioOutput->volume()*100));
+    ui->slider_volume->setSliderPosition(m_audioEngine->volume()*100);
+    ui->label_volume->setText(QString::number(m_audioEngine->volume()*100));
 
     // // 创建侧滑面板
     m_slidePanel = new QSlidePanel(this);
@@ -75,12 +88,23 @@ void MainWindow::initWidgets()
 
     // 添加侧边栏内容
     m_playListWidget = new PlayListWidget;
+    m_playListWidget->setMediaPlayList(m_mediaPlayList);
 
     // 设置到侧滑面板
     m_slidePanel->setContentWidget(m_playListWidget);
 
+    // 均衡器调节窗口（非模态，关闭时保存设置）
+    m_equalizerDialog = new EqualizerDialog(this);
+
     connect(ui->actionopenAudioFile, &QAction::triggered, this, &MainWindow::openAudioFile);
     connect(ui->slider_volume, &QSlider::valueChanged, this, &MainWindow::onVolumeChanged);
+    connect(ui->btn_equalizer, &QPushButton::clicked, this, [this]() {
+        m_equalizerDialog->show();
+        m_equalizerDialog->raise();
+        m_equalizerDialog->activateWindow();
+    });
+    connect(m_equalizerDialog, &EqualizerDialog::presetChanged, this, &MainWindow::onEqualizerChanged);
+    connect(m_equalizerDialog, &QDialog::finished, m_equalizerPresets, &EqualizerPresets::saveToFile);
     connect(ui->btn_playList, &QPushButton::clicked, this,&MainWindow::showPlayList);
     connect(m_playListWidget, &PlayListWidget::closeRequested, m_slidePanel, &QSlidePanel::hidePanel);
     connect(m_playListWidget, &PlayListWidget::entryClicked, this, &MainWindow::onMediaClicked);
@@ -95,23 +119,52 @@ void MainWindow::initWidgets()
 
 void MainWindow::initMedia()
 {
-    m_audioOutput = new QAudioOutput(this);
-    m_mediaPlayer = new QMediaPlayer(this);
+    m_audioEngine = new AudioEngine(this);
     m_mediaPlayList = new QMediaPlayList(this);
     m_albumManager = new AlbumManager(this);
-
-    m_mediaPlayer->setAudioOutput(m_audioOutput);
-    m_audioOutput->setVolume(1);
+    m_extractPool = new MetadataExtractPool(this);
+    m_metadataCache = new MetadataCache(this);
+
+    m_loudnessScanner = new LoudnessScanner(this);
+    m_loudnessCache = new LoudnessCache(this);
+    m_waveformGenerator = new WaveformGenerator(this);
+    m_spectrumAnalyzer = new SpectrumAnalyzer(this);
+    m_equalizerPresets = new EqualizerPresets(this);
+
+    // 缓存与历史记录共用同一个后台写入服务
+    m_metadataCache->setPersistence(m_albumManager->persistence());
+    m_mediaPlayList->setPersistence(m_albumManager->persistence());
+    m_equalizerPresets->setPersistence(m_albumManager->persistence());
+    m_loudnessCache->setPersistence(m_albumManager->persistence());
+    m_extractPool->setMetadataCache(m_metadataCache);
+    m_loudnessScanner->setLoudnessCache(m_loudnessCache);
+    m_spectrumAnalyzer->attach(m_audioEngine);
+
+    m_audioEngine->setVolume(1);
 
     m_mediaPlayList->setPlaybackMode(QMediaPlayList::Loops);
 
-    connect(m_mediaPlayer, &QMediaPlayer::playbackStateChanged, this, &MainWindow::onStateChanged);
-    connect(m_mediaPlayer, &QMediaPlayer::positionChanged, this, &MainWindow::onPositionChanged);
-    connect(m_mediaPlayer, &QMediaPlayer::durationChanged, this, &MainWindow::onDurationChanged);
-    connect(m_mediaPlayer, &QMediaPlayer::mediaStatusChanged, this, &MainWindow::onMediaStateChanged);
+    connect(m_audioEngine, &AudioEngine::playbackStateChanged, this, &MainWindow::onStateChanged);
+    connect(m_audioEngine, &AudioEngine::positionChanged, this, &MainWindow::onPositionChanged);
+    connect(m_audioEngine, &AudioEngine::durationChanged, this, &MainWindow::onDurationChanged);
+    connect(m_audioEngine, &AudioEngine::mediaStatusChanged, this, &MainWindow::onMediaStateChanged);
+    connect(m_audioEngine, &AudioEngine::nextSourceStarted, this, &MainWindow::onNextSourceStarted);
+    connect(m_audioEngine, &AudioEngine::sourceChanged, this, &MainWindow::onSourceChanged);
+    connect(m_waveformGenerator, &WaveformGenerator::peaksReady, this, &MainWindow::onWaveformReady);
     connect(m_albumManager, &AlbumManager::currentAlbumChanged, this, &MainWindow::onAlbumChanged);
-    connect(m_mediaPlayList, &QMediaPlayList::metadataListChanged, this, &MainWindow::onMetadataListChanged);
+    connect(m_albumManager, &AlbumManager::currentAlbumTracksChanged, this, &MainWindow::onAlbumTracksChanged);
+    connect(m_albumManager, &AlbumManager::albumLoadFailed, this, &MainWindow::onAlbumLoadFailed);
+    connect(m_extractPool, &MetadataExtractPool::batchReady, this, &MainWindow::onMetadataBatchReady);
+    connect(m_extractPool, &MetadataExtractPool::priorityTrackReady, this, &MainWindow::onPriorityTrackReady);
+    connect(m_extractPool, &MetadataExtractPool::finished, this, &MainWindow::onMetadataExtractFinished);
+    connect(m_loudnessScanner, &LoudnessScanner::finished, this, &MainWindow::onLoudnessScanFinished);
     connect(m_mediaPlayList, &QMediaPlayList::currentMediaChanged, this, &MainWindow::onCurrentMediaChanged);
+
+    // 列表变化后重新确定无缝接续的下一首
+    connect(m_mediaPlayList, &QMediaPlayList::metadataListChanged, this, &MainWindow::updateNextSource);
+    connect(m_mediaPlayList, &QMediaPlayList::mediaInserted, this, &MainWindow::updateNextSource);
+    connect(m_mediaPlayList, &QMediaPlayList::mediaRemoved, this, &MainWindow::updateNextSource);
+    connect(m_mediaPlayList, &QMediaPlayList::mediaMoved, this, &MainWindow::updateNextSource);
 }
 
 void MainWindow::initHotKeys()
@@ -135,55 +188,96 @@ void MainWindow::initConfigs()
         initSettings.setValue("AlbumUrl", "");
         initSettings.setValue("LastAudioUrl", "");
         initSettings.setValue("LastOpenDir", "");
+        initSettings.setValue("MetadataConcurrency", QThread::idealThreadCount());
+        initSettings.setValue("MetadataBatchSize", 32);
+        initSettings.setValue("VerifyAudioContent", false);
+        initSettings.setValue("AlbumPollInterval", 5000);
         initSettings.sync();
     }
 
-    m_settings = new QSettings(CONFIG_FILE_NAME, QSettings::IniFormat);
-}
+    // 配置读写都经过内存缓存，修改合并后批量写回文件
+    m_settings = new SettingsStore(CONFIG_FILE_NAME, QSettings::IniFormat, this);
+
+    // 扫描专辑时是否校验文件签名（默认只按扩展名判断）
+    m_albumManager->setVerifyAudioContent(m_settings->value("VerifyAudioContent", false));
+    // 无法使用 inotify 时（网络文件系统等）轮询专辑目录的间隔
+    m_albumManager->watcher()->setPollInterval(m_settings->value("AlbumPollInterval", 5000));
+
+    // 元数据提取池的并发上限与分批大小
+    m_extractPool->setMaxConcurrency(m_settings->value("MetadataConcurrency", QThread::idealThreadCount()));
+    m_extractPool->setBatchSize(m_settings->value("MetadataBatchSize", 32));
+
+    // 解码缓冲深度（毫秒），出现缓冲不足时可以调大
+    m_audioEngine->setBufferDuration(m_settings->value("AudioBufferMs", 250));
+    // 切换音轨时的淡入淡出时长（毫秒），0 表示无缝衔接
+    m_audioEngine->setCrossfadeDuration(m_settings->value("CrossfadeMs", 0));
+
+    // 回放增益：0 关闭，1 按音轨，2 按专辑（默认）；前置增益（dB）叠加在 -18 LUFS 的参考响度上
+    const int gainMode = qBound(0, m_settings->value("ReplayGainMode", 2), 2);
+    m_audioEngine->setReplayGain(m_loudnessCache, static_cast<LoudnessCache::GainMode>(gainMode),
+                                 m_settings->value("ReplayGainPreampDb", 0.0));
+    // 音轨采样率与输出设备不同时的转换质量：0 快速，1 标准，2 高（默认）
+    const int resampleQuality = qBound(0, m_settings->value("ResampleQuality", 2), 2);
+    m_audioEngine->setResampleQuality(static_cast<Resampler::Quality>(resampleQuality));
+    // 响度分析的并发上限，默认为核心数的一半
+    m_loudnessScanner->setMaxConcurrency(m_settings->value("LoudnessConcurrency", qMax(1, QThread::idealThreadCount() / 2)));
+    // 波形缓存的大小上限（MB）
+    m_waveformGenerator->setCacheLimit(qint64(m_settings->value("WaveformCacheMB", 64)) * 1024 * 1024);
+    // 频谱与电平显示，关闭后不在输出上接分析抽头
+    if (m_settings->value("SpectrumEnabled", true)) {
+        ui->widget_spectrum->setAnalyzer(m_spectrumAnalyzer);
+    }
 
-void MainWindow::postInitialize()
-{
     // 初始化音量大小
-    onVolumeChanged(m_settings->value("VolumnValue", 100).toInt());
+    onVolumeChanged(m_settings->value("VolumnValue", 100));
     // 初始化播放模式
     onRadioGroupClicked(
-        m_group->button(m_settings->value("PlayMode", static_cast<int>(QMediaPlayList::List)).toInt())
+        m_group->button(m_settings->value("PlayMode", static_cast<int>(QMediaPlayList::List)))
     );
-    // 初始化播放列表
-    m_albumManager->loadAlbum(m_settings->value("AlbumUrl", "").toString());
-
-    m_bInitPlayList = true;
-
-    // 载入音乐
-    QString lasturl = m_settings->value("LastAudioUrl", "").toString();
-    m_mediaPlayList->setMediaByUrl(lasturl);
 }
 
-void MainWindow::reloadPlayList(const QVector<QVariantMap>& entries)
+void MainWindow::postInitialize()
 {
-    m_playListWidget->clearEntries();
-    m_playListWidget->addMediaEntries(entries);
+    // 各类缓存在窗口显示后再读取，不拖慢第一帧；都在恢复专辑之前完成
+    m_equalizerPresets->loadFromFile();
+    m_metadataCache->loadFromFile();
+    m_loudnessCache->loadFromFile();
+    m_mediaPlayList->loadHistoryFromFile();
+    m_mediaPlayList->loadShuffleFromFile();
+    StartupProfiler::instance().mark("Caches");
+
+    // 载入专辑之前使用默认的均衡器设置
+    applyAlbumEqualizer();
+
+    // 载入音乐（上次播放的音频最先提取，提取完成后立即恢复）
+    m_pendingMediaUrl = m_settings->value("LastAudioUrl", QString());
+
+    // 初始化播放列表（目录扫描在后台进行，可被新的载入取消）
+    const QString albumUrl = m_settings->value("AlbumUrl", QString());
+    if (albumUrl.isEmpty()) {
+        // 没有要恢复的专辑，上次的随机顺序不会再用到，之后的顺序变化照常保存
+        m_mediaPlayList->finishShuffleRestore();
+        StartupProfiler::instance().finish();
+    } else {
+        m_bStartupExtract = true;
+        m_albumManager->loadAlbumAsync(albumUrl);
+    }
+
+    m_bInitPlayList = true;
 }
 
 void MainWindow::openAudioFile()
 {
     // 打开音频文件，置入播放列表和当前播放
-    QStringList audioMimeFilters;
-    const QList<QMimeType> mimes = QMimeDatabase().allMimeTypes();
-    foreach (const QMimeType &mime, mimes) {
-        if (mime.name().startsWith("audio/")) {
-            audioMimeFilters += mime.globPatterns();
-        }
-    }
 
-    // 生成过滤器字符串
+    // 生成过滤器字符串（扩展名表只在首次使用时构建）
     QString filter = tr("Supported Audio Files") + " (";
-    filter += audioMimeFilters.join(" ") + ");;" +
+    filter += AudioFormatRegistry::instance().nameFilters().join(" ") + ");;" +
               tr("All Files") + " (*)";
 
     QUrl fileUrl = QFileDialog::getOpenFileUrl(this,
         tr("Open Audio File"),
-        m_settings->value("LastOpenDir", QUrl::fromLocalFile(QStandardPaths::standardLocations(QStandardPaths::MusicLocation).value(0, QDir::homePath()))).toUrl(),
+        m_settings->value("LastOpenDir", QUrl::fromLocalFile(QStandardPaths::standardLocations(QStandardPaths::MusicLocation).value(0, QDir::homePath()))),
         filter);
 
     if (!fileUrl.isEmpty()) {
@@ -205,6 +299,84 @@ void MainWindow::openAudioFile()
     }
 }
 
+QList<QUrl> MainWindow::acceptedDropUrls(const QList<QUrl> &urls) const
+{
+    const AudioFormatRegistry &registry = AudioFormatRegistry::instance();
+
+    QList<QUrl> accepted;
+    for (const QUrl &url : urls)
+    {
+        if (!url.isLocalFile())
+        {
+            continue;
+        }
+        const QString path = url.toLocalFile();
+        if (QFileInfo(path).isDir() || registry.isAudioFile(path))
+        {
+            accepted.append(url);
+        }
+    }
+    return accepted;
+}
+
+void MainWindow::dragEnterEvent(QDragEnterEvent *event)
+{
+    if (event->mimeData()->hasUrls() && !acceptedDropUrls(event->mimeData()->urls()).isEmpty())
+    {
+        event->acceptProposedAction();
+    }
+}
+
+void MainWindow::dropEvent(QDropEvent *event)
+{
+    const QList<QUrl> urls = acceptedDropUrls(event->mimeData()->urls());
+    if (urls.isEmpty())
+    {
+        return;
+    }
+
+    const QUrl url = urls.first();
+    const bool audioFile = !QFileInfo(url.toLocalFile()).isDir();
+
+    // 拖入的是音频文件时切换到该音频：与恢复上次播放的音频相同，先记为等待的音频再载入专辑，
+    // 提取池最先提取它，进入播放列表后立即切换
+    cancelPendingRestore();
+    if (audioFile)
+    {
+        m_pendingMediaUrl = url.toString();
+    }
+
+    // 与打开文件相同，载入第一个条目所在的目录作为专辑
+    m_albumManager->loadAlbum(url);
+
+    // 重新载入的是当前专辑时音频已在播放列表中
+    if (audioFile && m_mediaPlayList->indexOfUrl(m_pendingMediaUrl) >= 0)
+    {
+        const QString pending = m_pendingMediaUrl;
+        m_pendingMediaUrl.clear();
+        m_mediaPlayList->setMediaByUrl(pending);
+    }
+
+    event->acceptProposedAction();
+}
+
+void MainWindow::showEvent(QShowEvent *event)
+{
+    QMainWindow::showEvent(event);
+    if (m_bShown)
+    {
+        return;
+    }
+    m_bShown = true;
+
+    // 显示时第一帧的绘制请求已经排入事件队列，排在其后执行的调用即在第一帧之后；
+    // 此时再读取缓存、在后台恢复上次的专辑，不阻塞第一帧
+    QMetaObject::invokeMethod(this, [this]() {
+        StartupProfiler::instance().mark("First frame");
+        postInitialize();
+    }, Qt::QueuedConnection);
+}
+
 void MainWindow::onQuit()
 {
     m_trayIcon->hide(); // 移除托盘图标
@@ -269,17 +441,24 @@ void MainWindow::onDurationChanged(qint64 dur)
 
 void MainWindow::onMediaStateChanged(QMediaPlayer::MediaStatus state)
 {
+    // 跳转要从头解码到目标位置，较远的位置需要等待一会
+    if (state == QMediaPlayer::BufferingMedia) {
+        ui->slider_playProgress->setCursor(Qt::BusyCursor);
+    } else {
+        ui->slider_playProgress->unsetCursor();
+    }
+
     if (state == QMediaPlayer::EndOfMedia) {
         switch (m_mediaPlayList->getPlaybackMode()) {
         case QMediaPlayList::Loops:
         {
             m_mediaPlayList->setCurrentMedia(m_mediaPlayList->getCurrentMediaIterator());
-            m_mediaPlayer->play();
+            m_audioEngine->play();
         }
         break;
         default:
             m_mediaPlayList->setNextMedia();
-            m_mediaPlayer->play();
+            m_audioEngine->play();
             break;
         }
     }
@@ -288,93 +467,340 @@ void MainWindow::onMediaStateChanged(QMediaPlayer::MediaStatus state)
 void MainWindow::onVolumeChanged(int pos)
 {
     ui->slider_volume->setValue(pos);
-    m_audioOutput->setVolume((float)pos/100.f);
+    m_audioEngine->setVolume((float)pos/100.f);
 
     ui->label_volume->setText(QString::number(pos));
 
     m_settings->setValue("VolumnValue", pos);
 }
 
+void MainWindow::onEqualizerChanged(const EqPreset &preset, bool albumPreset)
+{
+    m_audioEngine->setEqualizer(preset);
+
+    // 临时专辑等没有 uid，设置只作用于本次播放，不保存
+    if (m_albumUid.isEmpty()) {
+        return;
+    }
+
+    if (albumPreset) {
+        m_equalizerPresets->setAlbumPreset(m_albumUid, preset);
+    } else {
+        m_equalizerPresets->removeAlbumPreset(m_albumUid);
+        m_equalizerPresets->setDefaultPreset(preset);
+    }
+}
+
+void MainWindow::applyAlbumEqualizer()
+{
+    const EqPreset preset = m_equalizerPresets->preset(m_albumUid);
+    m_audioEngine->setEqualizer(preset);
+    m_equalizerDialog->setPreset(preset, m_equalizerPresets->hasAlbumPreset(m_albumUid));
+}
+
 void MainWindow::onAlbumChanged(const QVariantMap &album)
 {
+    StartupProfiler::instance().mark("Album scan");
+
     ui->label_albumName->setText(album["name"].toString());
 
-    // 将专辑中的音频 url 载入到播放列表中
-    auto tracks = album["tracks"].toStringList();
-    QVector<QVariantMap> metadataList;
-    foreach (QString track, tracks) {
-        QVariantMap metadata = MediaMetadataExtractor::extractMetadata(track);
-        metadataList.append(metadata);
+    // 切换到该专辑的均衡器设置
+    m_albumUid = album["uid"].toString();
+    applyAlbumEqualizer();
+
+    // 切换到了其他专辑，上次的随机顺序不会再恢复（启动时恢复的专辑在提取完成后结束恢复）
+    if (!m_bStartupExtract)
+    {
+        m_mediaPlayList->finishShuffleRestore();
     }
 
-    m_mediaPlayList->setPlayList(metadataList);
+    // 将专辑中的音频 url 交给提取池并行提取元数据，结果分批载入到播放列表中，等待恢复的音频优先提取
+    m_updatingUrls.clear();
+    m_queuedTracks.clear();
+    m_changedTracks.clear();
+    m_preloadedUrl.clear();
+    m_mediaPlayList->setPlayList({});
+    m_extractPool->start(album["tracks"].toStringList(), m_pendingMediaUrl);
 
     // 保存配置值
     m_settings->setValue("AlbumUrl", album["url"].toString());  // 修改当前专辑值
 }
 
-void MainWindow::onMetadataListChanged()
+void MainWindow::onAlbumTracksChanged(const AlbumScanDiff &diff)
+{
+    // 只处理变化的音轨：移除已删除的，重新提取新增与修改的
+    m_mediaPlayList->removeMedia(diff.removed);
+
+    for (const auto &url : diff.modified)
+    {
+        m_updatingUrls.insert(url);
+    }
+
+    const QStringList tracks = diff.added + diff.modified;
+    if (tracks.isEmpty())
+    {
+        // 只删除了音轨：提取池空闲时直接重新计算专辑响度，忙碌时由提取完成后的分析一并处理
+        if (!diff.removed.isEmpty() && !m_extractPool->isRunning())
+        {
+            const QStringList albumTracks = m_albumManager->getCurrentAlbum()["tracks"].toStringList();
+            if (m_loudnessScanner->isRunning())
+            {
+                m_loudnessScanner->scanAlbum(albumTracks, m_mediaPlayList->getCurrentMediaValue().url);
+            }
+            else
+            {
+                m_loudnessScanner->scanChanged({}, albumTracks);
+            }
+        }
+        return;
+    }
+
+    if (m_extractPool->isRunning())
+    {
+        m_queuedTracks += tracks;
+        return;
+    }
+    m_changedTracks = tracks;
+    m_extractPool->start(tracks);
+}
+
+void MainWindow::onAlbumLoadFailed()
 {
-    auto metadataList = m_mediaPlayList->getMetadataList();
+    if (!m_bStartupExtract)
+    {
+        return;
+    }
+
+    // 启动时恢复的专辑未能载入，结束恢复，否则随机顺序在整个会话中都不会保存
+    m_bStartupExtract = false;
+    m_pendingMediaUrl.clear();
+    m_mediaPlayList->finishShuffleRestore();
+    StartupProfiler::instance().finish();
+}
+
+void MainWindow::onMetadataBatchReady(const QVector<TrackRecord> &batch)
+{
+    // 已在列表中的音频原地更新，其余追加到末尾
+    QVector<TrackRecord> appended;
+    appended.reserve(batch.size());
+    for (const auto &track : batch)
+    {
+        if (m_updatingUrls.remove(track.url))
+        {
+            m_mediaPlayList->updateMedia(track);
+        }
+        else
+        {
+            appended.append(track);
+        }
+    }
+
+    if (!appended.isEmpty())
+    {
+        m_mediaPlayList->append(appended);
+    }
+
+    if (m_pendingMediaUrl.isEmpty())
+    {
+        return;
+    }
+
+    // 上次播放的音频已经载入，立即恢复
+    for (const auto &track : batch)
+    {
+        if (track.url == m_pendingMediaUrl)
+        {
+            QString url = m_pendingMediaUrl;
+            m_pendingMediaUrl.clear();
+            m_mediaPlayList->setMediaByUrl(url);
+            break;
+        }
+    }
+}
 
-    m_playListWidget->addMediaEntries(metadataList);
+void MainWindow::onPriorityTrackReady(const TrackRecord &track)
+{
+    if (track.url != m_pendingMediaUrl || m_mediaPlayList->getCurrentMediaValue().url == track.url)
+    {
+        return;
+    }
+
+    // 上次播放的音频先交给播放器，进入播放列表后再设为当前音频时不重复设置
+    StartupProfiler::instance().mark("Last track ready");
+    m_preloadedUrl = track.url;
+    m_audioEngine->setSource(track.url);
+    ui->label_mediaName->setText(track.title);
+}
+
+void MainWindow::onMetadataExtractFinished()
+{
+    if (m_bStartupExtract)
+    {
+        // 启动时恢复的专辑提取完成，之后的增量提取不再重复这些收尾
+        m_bStartupExtract = false;
+        StartupProfiler::instance().mark("Metadata");
+        StartupProfiler::instance().finish();
+
+        // 专辑中已经没有上次播放的音频
+        m_pendingMediaUrl.clear();
+        // 上次的音轨已全部进入列表，之后的顺序变化开始保存
+        m_mediaPlayList->finishShuffleRestore();
+
+        // 持久化启动时新提取的元数据（之后的提取在退出时保存）
+        m_metadataCache->saveToFile();
+    }
+
+    // 元数据就绪后再在后台分析专辑响度：整张专辑提取完成（或上一次分析尚未结束）时分析整张专辑，当前音轨最先分析；
+    // 增量提取完成时只分析新增与修改的音轨
+    const QStringList albumTracks = m_albumManager->getCurrentAlbum()["tracks"].toStringList();
+    if (m_changedTracks.isEmpty() || m_loudnessScanner->isRunning())
+    {
+        m_loudnessScanner->scanAlbum(albumTracks, m_mediaPlayList->getCurrentMediaValue().url);
+    }
+    else
+    {
+        m_loudnessScanner->scanChanged(m_changedTracks, albumTracks);
+    }
+    m_changedTracks.clear();
+
+    // 提取期间到达的增量变化
+    if (!m_queuedTracks.isEmpty())
+    {
+        m_changedTracks = m_queuedTracks;
+        m_queuedTracks.clear();
+        m_extractPool->start(m_changedTracks);
+    }
+}
+
+void MainWindow::onLoudnessScanFinished()
+{
+    // 持久化本次的分析结果
+    m_loudnessCache->saveToFile();
 }
 
 void MainWindow::onCurrentMediaChanged()
 {
-    QVariantMap metadata = m_mediaPlayList->getCurrentMediaValue();
+    const TrackRecord track = m_mediaPlayList->getCurrentMediaValue();
 
-    if (!metadata.isEmpty())
+    if (!m_preloadedUrl.isEmpty() && !m_pendingMediaUrl.isEmpty() && track.url != m_preloadedUrl)
     {
-        if (m_mediaPlayer->playbackState() == QMediaPlayer::PlaybackState::PlayingState)
+        // 预先设置的音频尚未进入播放列表，自动选中的第一首不替换播放器中的音频
+        return;
+    }
+
+    if (!track.isNull() && track.url == m_preloadedUrl)
+    {
+        // 已经预先设置给播放器
+        m_preloadedUrl.clear();
+        ui->label_mediaName->setText(track.title);
+    }
+    else if (!track.isNull())
+    {
+        m_preloadedUrl.clear();
+        if (m_audioEngine->source() == QUrl(track.url))
+        {
+            // 播放器已经无缝接上了这首（或单曲循环回到开头），不重新设置
+        }
+        else if (m_audioEngine->playbackState() == QMediaPlayer::PlaybackState::PlayingState)
         {
-            // 如果在切换之前已经播放了媒体，那么依旧保持播放
-            m_mediaPlayer->setSource(metadata["Url"].toString());
-            m_mediaPlayer->play();
+            // 如果在切换之前已经播放了媒体，那么依旧保持播放（启用淡入淡出时交叉淡化）
+            m_audioEngine->switchTo(track.url);
         }
         else
         {
-            m_mediaPlayer->setSource(metadata["Url"].toString());
+            m_audioEngine->setSource(track.url);
         }
 
-        ui->label_mediaName->setText(metadata["Title"].toString());
+        ui->label_mediaName->setText(track.title);
     }
 
-    if (m_bInitPlayList)
+    if (m_bInitPlayList && m_pendingMediaUrl.isEmpty())
     {
-        m_settings->setValue("LastAudioUrl", metadata["Url"].toString());
+        m_settings->setValue("LastAudioUrl", track.url);
+    }
+
+    updateNextSource();
+}
+
+void MainWindow::onNextSourceStarted(const QUrl &url)
+{
+    if (m_mediaPlayList->getCurrentMediaValue().url == url.toString())
+    {
+        // 单曲循环，重新设置当前音频以记录播放历史
+        m_mediaPlayList->setCurrentMedia(m_mediaPlayList->getCurrentMediaIterator());
+    }
+    else
+    {
+        m_mediaPlayList->setMediaByUrl(url.toString());
     }
 }
 
-void MainWindow::onMediaClicked(const QVariantMap &metadata)
+void MainWindow::onSourceChanged(const QUrl &url)
 {
-    // m_mediaPlayer->setSource(metadata["Url"].toString());
-    m_mediaPlayList->setMediaByUrl(metadata["Url"].toString());
-    m_mediaPlayer->play();
+    // 进度条先恢复为普通样式，波形就绪后再显示
+    ui->slider_playProgress->clearPeaks();
+    if (!url.isEmpty())
+    {
+        m_waveformGenerator->request(url.toString());
+    }
+}
+
+void MainWindow::onWaveformReady(const QString &url, const WaveformPeaks &peaks)
+{
+    if (m_audioEngine->source().toString() == url)
+    {
+        ui->slider_playProgress->setPeaks(peaks);
+    }
+}
+
+void MainWindow::updateNextSource()
+{
+    if (!m_preloadedUrl.isEmpty())
+    {
+        // 上次播放的音频尚未进入播放列表
+        return;
+    }
+
+    const TrackRecord next = m_mediaPlayList->peekNextMedia();
+    m_audioEngine->setNextSource(next.isNull() ? QUrl() : QUrl(next.url));
+}
+
+void MainWindow::cancelPendingRestore()
+{
+    // 用户已经选择了音频，不再恢复上次播放的音频
+    m_pendingMediaUrl.clear();
+    m_preloadedUrl.clear();
+}
+
+void MainWindow::onMediaClicked(const TrackRecord &track)
+{
+    cancelPendingRestore();
+    m_mediaPlayList->setMediaByUrl(track.url);
+    m_audioEngine->play();
 }
 
 void MainWindow::onPlayStateClicked()
 {
-    QMediaPlayer::PlaybackState state = m_mediaPlayer->playbackState();
+    QMediaPlayer::PlaybackState state = m_audioEngine->playbackState();
     switch (state) {
     case QMediaPlayer::PlaybackState::PausedState:
     {
-        if(m_mediaPlayer->source().isValid())
+        if(m_audioEngine->source().isValid())
         {
-            m_mediaPlayer->play();
+            m_audioEngine->play();
         }
     }
     break;
     case QMediaPlayer::PlaybackState::PlayingState:
     {
-        m_mediaPlayer->pause();
+        m_audioEngine->pause();
     }
     break;
     case QMediaPlayer::PlaybackState::StoppedState:
     {
-        if(m_mediaPlayer->source().isValid())
+        if(m_audioEngine->source().isValid())
         {
-            m_mediaPlayer->play();
+            m_audioEngine->play();
         }
     }
     break;
@@ -385,11 +811,13 @@ void MainWindow::onPlayStateClicked()
 
 void MainWindow::onPreviousMediaClicked()
 {
+    cancelPendingRestore();
     m_mediaPlayList->setPreviousMedia();
 }
 
 void MainWindow::onNextMediaClicked()
 {
+    cancelPendingRestore();
     m_mediaPlayList->setNextMedia();
 }
 
@@ -400,12 +828,13 @@ void MainWindow::onRadioGroupClicked(QAbstractButton *btn)
     m_mediaPlayList->setPlaybackMode(static_cast<QMediaPlayList::EPlayMode>(id));
 
     m_settings->setValue("PlayMode", id);
+
+    updateNextSource();
 }
 
 void MainWindow::onPlayProgressChanged(int value)
 {
-    m_mediaPlayer->setPosition(value);
-
+    // 拖动时只更新时间，松开后再跳转（每次跳转都要重新解码）
     qint64 currentSeconds = value / 1000;
     QTime time = QTime(0, 0, 0).addSecs(currentSeconds);
     ui->label_currentDuration->setText((time.hour() > 0) ? time.toString("HH:mm:ss") : time.toString("mm:ss"));
@@ -413,18 +842,20 @@ void MainWindow::onPlayProgressChanged(int value)
 
 void MainWindow::onPlayProgressPressed()
 {
-    m_bPlayState = m_mediaPlayer->isPlaying();
+    m_bPlayState = m_audioEngine->isPlaying();
     if (m_bPlayState)
     {
-        m_mediaPlayer->pause();
+        m_audioEngine->pause();
     }
 }
 
 void MainWindow::onPlayProgressReleased()
 {
+    m_audioEngine->setPosition(ui->slider_playProgress->value());
+
     if (m_bPlayState)
     {
-        m_mediaPlayer->play();
+        m_audioEngine->play();
     }
 }
 
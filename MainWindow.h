@@ -2,15 +2,23 @@
 #define MAINWINDOW_H
 
 #include "Tools/AlbumManager.h"
+#include "Tools/AudioEngine.h"
+#include "Tools/EqualizerPresets.h"
+#include "Tools/LoudnessCache.h"
+#include "Tools/LoudnessScanner.h"
+#include "Tools/MetadataCache.h"
+#include "Tools/MetadataExtractPool.h"
 #include "Tools/QMediaPlayList.h"
+#include "Tools/SettingsStore.h"
+#include "Tools/SpectrumAnalyzer.h"
+#include "Tools/WaveformGenerator.h"
+#include "Widgets/EqualizerDialog.h"
 #include "Widgets/QSlidePanel.h"
 #include "Widgets/PlayListWidget.h"
 #include <QMainWindow>
-#include <QMediaPlayer>
-#include <QAudioOutput>
 #include <QButtonGroup>
 #include <QHotkey>
-#include <QSettings>
+#include <QSet>
 #include <QSystemTrayIcon>
 
 #define CONFIG_FILE_NAME "config.ini"
@@ -29,6 +37,11 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    void showEvent(QShowEvent *event) override;
+    void dragEnterEvent(QDragEnterEvent *event) override;
+    void dropEvent(QDropEvent *event) override;
+
 public:
     void initApplication();
 
@@ -46,14 +59,21 @@ private:
     QMenu *m_trayMenu;
     QAction *m_quitAction;
 
-    QAudioOutput* m_audioOutput;
-    QMediaPlayer* m_mediaPlayer;
+    AudioEngine* m_audioEngine;
 
     QMediaPlayList* m_mediaPlayList;
     AlbumManager* m_albumManager;
+    MetadataExtractPool* m_extractPool;
+    MetadataCache* m_metadataCache;
+    LoudnessScanner* m_loudnessScanner;
+    LoudnessCache* m_loudnessCache;
+    WaveformGenerator* m_waveformGenerator;
+    SpectrumAnalyzer* m_spectrumAnalyzer;
+    EqualizerPresets* m_equalizerPresets;
 
     QSlidePanel *m_slidePanel;
     PlayListWidget *m_playListWidget;
+    EqualizerDialog *m_equalizerDialog;
 
     QButtonGroup *m_group;
 
@@ -65,15 +85,28 @@ private:
 private:
     bool m_bPlayState;
 
-    QSettings* m_settings;
+    SettingsStore* m_settings;
 
 private:
 
     uint8_t m_bInitPlayList : 1; // 初始化播放列表
+    uint8_t m_bStartupExtract : 1; // 启动时恢复的专辑尚未提取完成
+    uint8_t m_bShown : 1; // 窗口已显示过，首次显示后执行 postInitialize
+
+    QString m_pendingMediaUrl;   // 等待元数据提取完成后恢复的音频
+    QString m_preloadedUrl;      // 进入播放列表之前已经交给播放器的音频
+
+    QSet<QString> m_updatingUrls;    // 正在重新提取元数据的已有音频
+    QStringList m_queuedTracks;      // 提取池忙碌时排队等待提取的音频
+    QStringList m_changedTracks;     // 正在提取的增量变化（新增与修改的音频），提取整张专辑时为空
+
+    QString m_albumUid;              // 当前专辑的 uid，用于查找专辑的均衡器设置
 
 private:
-    // 重载播放列表数据
-    void reloadPlayList(const QVector<QVariantMap>& entries);
+    // 从拖放的 url 中取出可载入的本地音频或目录
+    QList<QUrl> acceptedDropUrls(const QList<QUrl>& urls) const;
+    // 放弃恢复上次播放的音频
+    void cancelPendingRestore();
 
 private slots:
     void openAudioFile();
@@ -87,11 +120,24 @@ private slots:
     void onMediaStateChanged(QMediaPlayer::MediaStatus state);
 
     void onVolumeChanged(int pos);
+    void onEqualizerChanged(const EqPreset &preset, bool albumPreset);
+    // 把当前专辑的均衡器设置交给播放器与调节窗口
+    void applyAlbumEqualizer();
 
     void onAlbumChanged(const QVariantMap &album);
-    void onMetadataListChanged();
+    void onAlbumTracksChanged(const AlbumScanDiff &diff);
+    void onAlbumLoadFailed();
+    void onMetadataBatchReady(const QVector<TrackRecord> &batch);
+    void onPriorityTrackReady(const TrackRecord &track);
+    void onMetadataExtractFinished();
+    void onLoudnessScanFinished();
     void onCurrentMediaChanged();
-    void onMediaClicked(const QVariantMap& metadata);
+    void onNextSourceStarted(const QUrl &url);
+    void onSourceChanged(const QUrl &url);
+    void onWaveformReady(const QString &url, const WaveformPeaks &peaks);
+    // 把播放列表中的下一首交给播放器预解码
+    void updateNextSource();
+    void onMediaClicked(const TrackRecord& track);
     void onPlayStateClicked();
     void onPreviousMediaClicked();
     void onNextMediaClicked();
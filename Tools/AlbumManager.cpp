@@ -1,17 +1,30 @@
 #include "AlbumManager.h"
 
-#include <QDirIterator>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QMimeDatabase>
 #include <QStandardPaths>
 #include <QUrl>
 #include <QVariantList>
 
+#include <utility>
+
 AlbumManager::AlbumManager(QObject *parent)
     : QObject{parent}
+    , m_scanner(new AlbumScanner(this))
+    , m_watcher(new AlbumWatcher(this))
+    , m_persistence(new PersistenceService(this))
+    , m_loadGeneration(0)
+    , m_loadCanceled(std::make_shared<std::atomic_bool>(false))
+    , m_rescanRunning(false)
+    , m_rescanQueued(false)
 {
+    m_loadPool.setMaxThreadCount(1);
+    m_scanner->setPersistence(m_persistence);
+
+    connect(m_watcher, &AlbumWatcher::directoriesChanged,
+            this, &AlbumManager::rescanCurrentAlbum);
+
     // 初始化历史记录存储路径
     QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
     QDir dir(appDataPath);
@@ -21,6 +34,17 @@ AlbumManager::AlbumManager(QObject *parent)
     m_historySavePath = dir.filePath("album_history.json");
 
     loadHistoryFromFile();
+
+    // 扫描快照在扫描线程中读取，之后排队的扫描总在它之后进行
+    m_loadPool.start([this]() {
+        m_scanner->loadFromFile();
+    });
+}
+
+AlbumManager::~AlbumManager()
+{
+    cancelPendingLoad();
+    m_loadPool.waitForDone();
 }
 
 void AlbumManager::loadAlbum(const QUrl &url)
@@ -44,13 +68,66 @@ void AlbumManager::loadAlbum(const QUrl &url)
             << url.scheme()
             << "] for: "
             << url.toString();
+        emit albumLoadFailed(url);
     }
 }
 
+void AlbumManager::loadAlbumAsync(const QUrl &url)
+{
+    const QString scheme = url.scheme().toLower();
+    if (scheme != "file" && !(scheme.isEmpty() && QFile::exists(url.toLocalFile()))) {
+        // 网络专辑只读取一个描述文件，直接同步载入
+        loadAlbum(url);
+        return;
+    }
+
+    cancelPendingLoad();
+
+    const QString dirPath = localAlbumPath(url);
+    if (dirPath.isEmpty()) {
+        emit albumLoadFailed(url);
+        return;
+    }
+
+    const quint64 generation = m_loadGeneration;
+    const auto canceled = m_loadCanceled;
+
+    m_loadPool.start([this, generation, canceled, dirPath]() {
+        AlbumScanDiff diff;
+        const QStringList audioFiles = m_scanner->scan(dirPath, &diff, QStringList(), canceled.get());
+        if (canceled->load()) {
+            return;
+        }
+
+        // 回到所属线程更新专辑
+        QMetaObject::invokeMethod(this, [this, generation, dirPath, audioFiles, diff]() {
+            if (generation != m_loadGeneration) {
+                return;
+            }
+            applyLocalAlbum(dirPath, audioFiles, diff);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AlbumManager::cancelPendingLoad()
+{
+    m_loadCanceled->store(true);
+    m_loadCanceled = std::make_shared<std::atomic_bool>(false);
+    ++m_loadGeneration;
+
+    // 进行中的增量扫描随之取消，其结果会因代号不符被丢弃
+    m_rescanRunning = false;
+    m_rescanQueued = false;
+    m_rescanDirtyDirs.clear();
+}
+
 void AlbumManager::loadNetworkAlbum(const QUrl &url)
 {
+    cancelPendingLoad();
+
     if (!url.isLocalFile()) {
         qWarning() << "URL is not a local file";
+        emit albumLoadFailed(url);
         return;
     }
 
@@ -58,6 +135,7 @@ void AlbumManager::loadNetworkAlbum(const QUrl &url)
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
         qWarning() << "Failed to open file:" << filePath;
+        emit albumLoadFailed(url);
         return;
     }
 
@@ -65,6 +143,7 @@ void AlbumManager::loadNetworkAlbum(const QUrl &url)
     QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
     if (doc.isNull()) {
         qWarning() << "Invalid JSON format in file:" << filePath;
+        emit albumLoadFailed(url);
         return;
     }
 
@@ -72,6 +151,7 @@ void AlbumManager::loadNetworkAlbum(const QUrl &url)
     QString uid = albumData.value("uid").toString();
     if (uid.isEmpty()) {
         qWarning() << "Missing UID in album file";
+        emit albumLoadFailed(url);
         return;
     }
 
@@ -84,14 +164,32 @@ void AlbumManager::loadNetworkAlbum(const QUrl &url)
 
     // 更新当前专辑并触发信号
     m_currentAlbum = albumData;
+    updateWatcher();
     emit currentAlbumChanged(m_currentAlbum);
 }
 
 void AlbumManager::loadLocalAlbum(const QUrl &url)
+{
+    cancelPendingLoad();
+
+    const QString dirPath = localAlbumPath(url);
+    if (dirPath.isEmpty()) {
+        emit albumLoadFailed(url);
+        return;
+    }
+
+    // 获取音频文件列表（只重新列举发生变化的目录）
+    AlbumScanDiff diff;
+    const QStringList audioFiles = m_scanner->scan(dirPath, &diff);
+
+    applyLocalAlbum(dirPath, audioFiles, diff);
+}
+
+QString AlbumManager::localAlbumPath(const QUrl &url) const
 {
     if (!url.isLocalFile()) {
         qWarning() << "URL is not a local directory";
-        return;
+        return QString();
     }
 
     QString originalPath = url.toLocalFile();
@@ -99,33 +197,24 @@ void AlbumManager::loadLocalAlbum(const QUrl &url)
 
     // 如果是文件路径，自动修正为所在目录
     QString dirPath = fileInfo.isDir() ? originalPath : fileInfo.dir().absolutePath();
-    QDir dir(dirPath);
-    if (!dir.exists()) {
+    if (!QDir(dirPath).exists()) {
         qWarning() << "Directory does not exist:" << dirPath;
-        return;
+        return QString();
     }
 
-    QString dirName = dir.dirName();
-
-    // 获取音频文件列表（示例扩展名）
-    QStringList audioFiles;
-    QMimeDatabase mimeDatabase; // MIME 类型检测器
+    return dirPath;
+}
 
-    QDirIterator it(dirPath, QDir::Files, QDirIterator::Subdirectories);
-    while (it.hasNext()) {
-        QString filePath = it.next();
-        QMimeType mimeType = mimeDatabase.mimeTypeForFile(filePath);
+void AlbumManager::applyLocalAlbum(const QString &dirPath, const QStringList &audioFiles, const AlbumScanDiff &diff)
+{
+    m_scanner->saveToFile();
 
-        // 检测是否是音频类型（根据 MIME 类型前缀）
-        if (mimeType.name().startsWith("audio/")) {
-            QUrl fileUrl = QUrl::fromLocalFile(filePath);
-            audioFiles.append(fileUrl.toString());
-        }
-    }
+    // 是否是重新载入当前专辑
+    const bool reload = (m_currentAlbum.value("uid").toString() == dirPath);
 
     // 构建临时专辑数据
     QVariantMap localAlbum;
-    localAlbum["name"] = dirName;
+    localAlbum["name"] = QDir(dirPath).dirName();
     localAlbum["desc"] = "";
     localAlbum["tracks"] = audioFiles;
     localAlbum["uid"] = dirPath; // 以文件夹路径做标识
@@ -140,7 +229,88 @@ void AlbumManager::loadLocalAlbum(const QUrl &url)
 
     // 更新当前专辑并触发信号
     m_currentAlbum = localAlbum;
-    emit currentAlbumChanged(m_currentAlbum);
+    updateWatcher();
+    if (reload) {
+        // 当前专辑只通知差异，未变化的音轨保持不动
+        if (!diff.isEmpty()) {
+            emit currentAlbumTracksChanged(diff);
+        }
+    } else {
+        emit currentAlbumChanged(m_currentAlbum);
+    }
+}
+
+void AlbumManager::rescanCurrentAlbum(const QStringList &dirtyDirs)
+{
+    const QString uid = m_currentAlbum.value("uid").toString();
+    if (uid.isEmpty() || !QFileInfo(uid).isDir()) {
+        return;     // 网络专辑或尚未载入专辑
+    }
+
+    for (const QString &dir : dirtyDirs) {
+        if (!m_rescanDirtyDirs.contains(dir)) {
+            m_rescanDirtyDirs.append(dir);
+        }
+    }
+    if (m_rescanRunning) {
+        // 上一次扫描完成后再扫描一次
+        m_rescanQueued = true;
+        return;
+    }
+    m_rescanRunning = true;
+
+    const quint64 generation = m_loadGeneration;
+    const auto canceled = m_loadCanceled;
+    const QStringList dirs = std::exchange(m_rescanDirtyDirs, QStringList());
+
+    m_loadPool.start([this, generation, canceled, uid, dirs]() {
+        AlbumScanDiff diff;
+        const QStringList audioFiles = m_scanner->scan(uid, &diff, dirs, canceled.get());
+        if (canceled->load()) {
+            return;
+        }
+
+        QMetaObject::invokeMethod(this, [this, generation, uid, audioFiles, diff]() {
+            if (generation != m_loadGeneration) {
+                return;     // 期间载入了其他专辑
+            }
+            applyRescan(uid, audioFiles, diff);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AlbumManager::applyRescan(const QString &uid, const QStringList &audioFiles, const AlbumScanDiff &diff)
+{
+    m_rescanRunning = false;
+
+    // 新建或删除的子目录需要同步监视项
+    updateWatcher();
+
+    if (!diff.isEmpty()) {
+        m_scanner->saveToFile();
+
+        m_currentAlbum["tracks"] = audioFiles;
+        m_historyAlbums[uid] = m_currentAlbum;
+        saveHistoryToFile();
+
+        emit currentAlbumTracksChanged(diff);
+    }
+
+    if (m_rescanQueued) {
+        m_rescanQueued = false;
+        rescanCurrentAlbum();
+    }
+}
+
+void AlbumManager::updateWatcher()
+{
+    const QString uid = m_currentAlbum.value("uid").toString();
+    if (uid.isEmpty() || !QFileInfo(uid).isDir()) {
+        m_watcher->unwatch();
+        return;
+    }
+
+    m_watcher->watch(uid, m_scanner->directories(uid));
 }
 
 QMap<QString, QVariantMap> AlbumManager::getSortedHistoryAlbums()
@@ -192,21 +362,22 @@ void AlbumManager::loadHistoryFromFile()
 
 void AlbumManager::saveHistoryToFile()
 {
-    QJsonArray historyArray;
-    for (auto it = m_historyAlbums.begin(); it != m_historyAlbums.end(); ++it) {
-        QJsonObject obj;
-        obj["uid"] = it.key();
-        obj["data"] = QJsonObject::fromVariantMap(it.value());
-        obj["timestamp"] = m_albumsUpdate.value(it.key());
-        historyArray.append(obj);
-    }
-
-    QJsonObject root;
-    root["history"] = historyArray;
-    QJsonDocument doc(root);
+    // 隐式共享的快照，序列化在工作线程中进行
+    const QMap<QString, QVariantMap> historyAlbums = m_historyAlbums;
+    const QMap<QString, int> albumsUpdate = m_albumsUpdate;
+
+    m_persistence->schedule(m_historySavePath, [historyAlbums, albumsUpdate]() {
+        QJsonArray historyArray;
+        for (auto it = historyAlbums.constBegin(); it != historyAlbums.constEnd(); ++it) {
+            QJsonObject obj;
+            obj["uid"] = it.key();
+            obj["data"] = QJsonObject::fromVariantMap(it.value());
+            obj["timestamp"] = albumsUpdate.value(it.key());
+            historyArray.append(obj);
+        }
 
-    QFile file(m_historySavePath);
-    if (file.open(QIODevice::WriteOnly)) {    
-        file.write(doc.toJson());
-    }
+        QJsonObject root;
+        root["history"] = historyArray;
+        return QJsonDocument(root).toJson();
+    });
 }
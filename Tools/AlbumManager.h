@@ -7,6 +7,14 @@
 #include <QVariantMap>
 #include <QFile>
 #include <QDir>
+#include <QThreadPool>
+
+#include <atomic>
+#include <memory>
+
+#include "AlbumScanner.h"
+#include "AlbumWatcher.h"
+#include "PersistenceService.h"
 /**
  * @brief The AlbumManager class
  * 这个类用于管理当前载入的专辑
@@ -20,6 +28,7 @@ class AlbumManager : public QObject
     Q_OBJECT
 public:
     explicit AlbumManager(QObject *parent = nullptr);
+    ~AlbumManager();
 
     void loadAlbum(const QUrl& url);
 
@@ -27,8 +36,27 @@ public:
     void loadNetworkAlbum(const QUrl& url);
 
     // 设置当前专辑为本地专辑（即全是本地音频），本地专辑即是包含音频文件的目录，该函数将会读取此目录内的所有音频文件。
+    // 再次载入当前专辑时只进行增量扫描，并通过 currentAlbumTracksChanged 通知差异。
     void loadLocalAlbum(const QUrl& url);
 
+    // 与 loadAlbum 相同，但本地专辑的目录扫描在工作线程中进行，完成后回到所属线程发出信号
+    // 新的载入或 cancelPendingLoad 会取消尚未完成的扫描
+    void loadAlbumAsync(const QUrl& url);
+    void cancelPendingLoad();
+
+    // 增量扫描当前的本地专辑，dirtyDirs 中的目录强制重新列举
+    // 扫描在工作线程中进行，差异回到所属线程后再应用；扫描期间的请求合并为完成后的下一次扫描
+    void rescanCurrentAlbum(const QStringList &dirtyDirs = QStringList());
+
+    // 当前本地专辑的目录监视（载入本地专辑后自动开始，内容变化时增量扫描）
+    AlbumWatcher *watcher() const { return m_watcher; }
+
+    // 历史记录与扫描快照的后台写入服务（可查询写入字节数与耗时）
+    PersistenceService *persistence() const { return m_persistence; }
+
+    // 扫描时是否读取文件签名校验音频类型
+    void setVerifyAudioContent(bool verify) { m_scanner->setVerifyContent(verify); }
+
     // 获取当前专辑信息
     QVariantMap getCurrentAlbum() const { return m_currentAlbum; };
 
@@ -38,6 +66,10 @@ public:
 signals:
     // 当前专辑变化信号
     void currentAlbumChanged(const QVariantMap &album);
+    // 当前专辑内的音轨变化（新增、删除、修改）
+    void currentAlbumTracksChanged(const AlbumScanDiff &diff);
+    // 专辑未能载入（协议不支持、目录不存在、专辑文件无效），当前专辑保持不变
+    void albumLoadFailed(const QUrl &url);
 
 private:
     QVariantMap m_currentAlbum;                  // 当前专辑数据
@@ -45,8 +77,31 @@ private:
     QMap<QString, int> m_albumsUpdate;           // 更新历史 (UID -> 最后一次载入时间戳)
     QString m_historySavePath;                   // 历史记录保存路径
 
+    AlbumScanner *m_scanner;                     // 本地专辑的增量扫描器
+    AlbumWatcher *m_watcher;                     // 当前本地专辑的目录监视
+    PersistenceService *m_persistence;           // 历史记录与扫描快照在工作线程中合并写入
+
+    QThreadPool m_loadPool;                      // 异步载入专辑的扫描线程
+    quint64 m_loadGeneration;                    // 当前异步载入的代号，用于丢弃过期结果
+    std::shared_ptr<std::atomic_bool> m_loadCanceled;
+
+    bool m_rescanRunning;                        // 是否有增量扫描在工作线程中进行
+    bool m_rescanQueued;                         // 扫描期间又收到了请求
+    QStringList m_rescanDirtyDirs;               // 下一次扫描需要强制列举的目录
+
+    // 监视当前专辑（非本地专辑时停止监视）
+    void updateWatcher();
+
+    // 本地专辑 url 对应的目录（url 为文件时取所在目录），无效时返回空字符串
+    QString localAlbumPath(const QUrl& url) const;
+    // 以扫描结果更新当前专辑与历史记录并发出信号
+    void applyLocalAlbum(const QString& dirPath, const QStringList& audioFiles, const AlbumScanDiff& diff);
+    // 应用增量扫描的结果（所属线程）
+    void applyRescan(const QString& uid, const QStringList& audioFiles, const AlbumScanDiff& diff);
+
 public:
     void loadHistoryFromFile();
+    // 提交历史记录的快照，由 PersistenceService 在后台合并写入
     void saveHistoryToFile();
 };
 
@@ -0,0 +1,267 @@
+#include "AlbumScanner.h"
+#include "AudioFormatRegistry.h"
+#include "PersistenceService.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QUrl>
+
+namespace {
+
+constexpr quint32 kSnapshotMagic = 0x414C5343;     // "ALSC"
+constexpr quint32 kSnapshotVersion = 1;
+
+QString fileUrl(const QString &dirPath, const QString &fileName)
+{
+    return QUrl::fromLocalFile(dirPath + '/' + fileName).toString();
+}
+
+} // namespace
+
+AlbumScanner::AlbumScanner(QObject *parent)
+    : QObject{parent}
+    , m_verifyContent(false)
+{
+    // 初始化快照存储路径
+    QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir dir(appDataPath);
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+    m_snapshotSavePath = dir.filePath("album_scan_cache.dat");
+}
+
+QStringList AlbumScanner::scan(const QString &rootPath, AlbumScanDiff *diff, const QStringList &dirtyDirs,
+                               const std::atomic_bool *canceled)
+{
+    QMutexLocker scanLocker(&m_scanMutex);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    AlbumScanDiff found;    // 扫描完成后才写入 diff，取消时保持不变
+
+    AlbumSnapshot previous;
+    {
+        QMutexLocker locker(&m_mutex);
+        previous = m_snapshots.value(rootPath);
+    }
+    AlbumSnapshot current;
+    int listedDirs = 0;
+
+    QStringList pending{rootPath};
+    while (!pending.isEmpty()) {
+        if (canceled && canceled->load()) {
+            qDebug() << "Album scan canceled:" << rootPath;
+            return QStringList();
+        }
+
+        const QString dirPath = pending.takeLast();
+        if (current.contains(dirPath)) {
+            continue;   // 已访问过的目录
+        }
+
+        const QFileInfo dirInfo(dirPath);
+        if (!dirInfo.isDir()) {
+            continue;
+        }
+        const qint64 mtime = dirInfo.lastModified().toMSecsSinceEpoch();
+
+        auto old = previous.constFind(dirPath);
+        DirSnapshot snapshot;
+        if (old != previous.constEnd() && old->mtime == mtime && !dirtyDirs.contains(dirPath)) {
+            // 目录条目未变化，复用上次的列表
+            snapshot = *old;
+        } else {
+            snapshot = listDirectory(dirPath, mtime);
+            ++listedDirs;
+
+            if (diff) {
+                const QHash<QString, FileStamp> oldFiles =
+                    (old != previous.constEnd()) ? old->files : QHash<QString, FileStamp>();
+
+                for (auto it = snapshot.files.constBegin(); it != snapshot.files.constEnd(); ++it) {
+                    auto before = oldFiles.constFind(it.key());
+                    if (before == oldFiles.constEnd()) {
+                        found.added.append(fileUrl(dirPath, it.key()));
+                    } else if (before->size != it->size || before->mtime != it->mtime) {
+                        found.modified.append(fileUrl(dirPath, it.key()));
+                    }
+                }
+                for (auto it = oldFiles.constBegin(); it != oldFiles.constEnd(); ++it) {
+                    if (!snapshot.files.contains(it.key())) {
+                        found.removed.append(fileUrl(dirPath, it.key()));
+                    }
+                }
+            }
+        }
+
+        pending.append(snapshot.subdirs);
+        current.insert(dirPath, snapshot);
+    }
+
+    // 已经不存在的目录，其中的文件全部视为删除
+    if (diff) {
+        for (auto it = previous.constBegin(); it != previous.constEnd(); ++it) {
+            if (current.contains(it.key())) {
+                continue;
+            }
+            for (auto file = it->files.constBegin(); file != it->files.constEnd(); ++file) {
+                found.removed.append(fileUrl(it.key(), file.key()));
+            }
+        }
+    }
+
+    QStringList tracks;
+    for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+        for (auto file = it->files.constBegin(); file != it->files.constEnd(); ++file) {
+            tracks.append(fileUrl(it.key(), file.key()));
+        }
+    }
+    tracks.sort();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_snapshots.insert(rootPath, current);
+    }
+    if (diff) {
+        *diff = found;
+    }
+
+    qDebug().nospace() << "Album scanned: " << rootPath << ", " << tracks.size() << " tracks, "
+                       << listedDirs << "/" << current.size() << " directories listed, "
+                       << timer.elapsed() << " ms";
+
+    return tracks;
+}
+
+bool AlbumScanner::hasSnapshot(const QString &rootPath) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_snapshots.contains(rootPath);
+}
+
+QStringList AlbumScanner::directories(const QString &rootPath) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_snapshots.value(rootPath).keys();
+}
+
+AlbumScanner::DirSnapshot AlbumScanner::listDirectory(const QString &dirPath, qint64 mtime)
+{
+    DirSnapshot snapshot;
+    snapshot.mtime = mtime;
+
+    const AudioFormatRegistry &registry = AudioFormatRegistry::instance();
+    const QFileInfoList entries = QDir(dirPath).entryInfoList(
+        QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+
+    for (const QFileInfo &entry : entries) {
+        if (entry.isDir()) {
+            // 与 QDirIterator 默认行为一致，不进入符号链接目录
+            if (!entry.isSymLink()) {
+                snapshot.subdirs.append(entry.absoluteFilePath());
+            }
+        } else if (registry.isAudioFile(entry.absoluteFilePath(), m_verifyContent)) {
+            FileStamp stamp;
+            stamp.size = entry.size();
+            stamp.mtime = entry.lastModified().toMSecsSinceEpoch();
+            snapshot.files.insert(entry.fileName(), stamp);
+        }
+    }
+
+    return snapshot;
+}
+
+void AlbumScanner::loadFromFile()
+{
+    QFile file(m_snapshotSavePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0, version = 0, albumCount = 0;
+    in >> magic >> version >> albumCount;
+    if (magic != kSnapshotMagic || version != kSnapshotVersion) {
+        qWarning() << "Ignoring incompatible album scan cache:" << m_snapshotSavePath;
+        return;
+    }
+
+    QHash<QString, AlbumSnapshot> snapshots;
+    for (quint32 a = 0; a < albumCount && in.status() == QDataStream::Ok; ++a) {
+        QString rootPath;
+        quint32 dirCount = 0;
+        in >> rootPath >> dirCount;
+
+        AlbumSnapshot album;
+        for (quint32 d = 0; d < dirCount && in.status() == QDataStream::Ok; ++d) {
+            QString dirPath;
+            DirSnapshot snapshot;
+            quint32 fileCount = 0;
+            in >> dirPath >> snapshot.mtime >> snapshot.subdirs >> fileCount;
+
+            for (quint32 f = 0; f < fileCount && in.status() == QDataStream::Ok; ++f) {
+                QString name;
+                FileStamp stamp;
+                in >> name >> stamp.size >> stamp.mtime;
+                snapshot.files.insert(name, stamp);
+            }
+            album.insert(dirPath, snapshot);
+        }
+        snapshots.insert(rootPath, album);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "Album scan cache is truncated, discarding:" << m_snapshotSavePath;
+        return;
+    }
+
+    // 载入完成之前已经扫描过的目录保留新的快照
+    QMutexLocker locker(&m_mutex);
+    for (auto it = snapshots.constBegin(); it != snapshots.constEnd(); ++it) {
+        if (!m_snapshots.contains(it.key())) {
+            m_snapshots.insert(it.key(), it.value());
+        }
+    }
+}
+
+void AlbumScanner::saveToFile()
+{
+    QHash<QString, AlbumSnapshot> snapshots;
+    {
+        QMutexLocker locker(&m_mutex);
+        snapshots = m_snapshots;    // 隐式共享，序列化在锁外进行
+    }
+
+    auto serialize = [snapshots]() {
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << kSnapshotMagic << kSnapshotVersion << quint32(snapshots.size());
+        for (auto album = snapshots.constBegin(); album != snapshots.constEnd(); ++album) {
+            out << album.key() << quint32(album->size());
+            for (auto dir = album->constBegin(); dir != album->constEnd(); ++dir) {
+                out << dir.key() << dir->mtime << dir->subdirs << quint32(dir->files.size());
+                for (auto file = dir->files.constBegin(); file != dir->files.constEnd(); ++file) {
+                    out << file.key() << file->size << file->mtime;
+                }
+            }
+        }
+        return data;
+    };
+
+    if (m_persistence) {
+        m_persistence->schedule(m_snapshotSavePath, serialize);
+    } else {
+        PersistenceService::writeFile(m_snapshotSavePath, serialize());
+    }
+}
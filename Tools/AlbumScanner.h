@@ -0,0 +1,91 @@
+#ifndef ALBUMSCANNER_H
+#define ALBUMSCANNER_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QPointer>
+#include <QStringList>
+
+#include <atomic>
+
+class PersistenceService;
+
+// 两次扫描之间的差异（元素为音频文件的 url 字符串）
+struct AlbumScanDiff
+{
+    QStringList added;
+    QStringList removed;
+    QStringList modified;
+
+    bool isEmpty() const { return added.isEmpty() && removed.isEmpty() && modified.isEmpty(); }
+};
+
+/**
+ * @brief The AlbumScanner class
+ * 专辑目录的增量扫描器
+ *
+ * 为每个专辑根目录记录各子目录的修改时间与上次的文件列表。再次扫描时，修改时间未变化的目录直接复用上次的列表，
+ * 只有发生变化的目录才会重新列举，并与上次的文件列表比较得到新增、删除、修改的音轨。
+ * 目录修改时间只反映条目的增删，未变化目录中文件内容的修改由元数据缓存在读取时惰性校验。
+ * 扫描可以在工作线程中进行，同一时间只有一次扫描。遍历目录时不持有快照的锁，只在开始与结束时短暂加锁读写快照，
+ * 扫描期间其他线程仍可查询（hasSnapshot、directories）。
+ */
+class AlbumScanner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AlbumScanner(QObject *parent = nullptr);
+
+    // 扫描专辑目录，返回当前所有音频文件（url 字符串，已排序），diff 为与上次扫描的差异
+    // dirtyDirs 中的目录无论修改时间是否变化都会重新列举（用于检测目录内文件内容的修改）
+    // canceled 被置位时中止扫描，返回空列表且不更新快照
+    QStringList scan(const QString &rootPath, AlbumScanDiff *diff = nullptr,
+                     const QStringList &dirtyDirs = QStringList(),
+                     const std::atomic_bool *canceled = nullptr);
+
+    // 是否已有该目录的扫描记录
+    bool hasSnapshot(const QString &rootPath) const;
+
+    // 上次扫描时专辑内的全部目录（包括根目录）
+    QStringList directories(const QString &rootPath) const;
+
+    // 是否额外读取文件签名校验音频类型（默认只按扩展名判断）
+    void setVerifyContent(bool verify) { m_verifyContent = verify; }
+
+    // 快照经由 persistence 在后台写入；未设置时在调用线程中同步写入
+    void setPersistence(PersistenceService *persistence) { m_persistence = persistence; }
+
+private:
+    struct FileStamp
+    {
+        qint64 size = 0;
+        qint64 mtime = 0;
+    };
+
+    struct DirSnapshot
+    {
+        qint64 mtime = 0;
+        QStringList subdirs;                 // 子目录绝对路径
+        QHash<QString, FileStamp> files;     // 文件名 -> 大小与修改时间（仅音频文件）
+    };
+
+    using AlbumSnapshot = QHash<QString, DirSnapshot>;  // 目录绝对路径 -> 目录记录
+
+    DirSnapshot listDirectory(const QString &dirPath, qint64 mtime);
+
+private:
+    QHash<QString, AlbumSnapshot> m_snapshots;  // 专辑根目录 -> 快照
+    mutable QMutex m_mutex;                     // 保护 m_snapshots
+    QMutex m_scanMutex;                         // 串行化扫描
+    std::atomic_bool m_verifyContent;           // 是否校验文件签名
+    QString m_snapshotSavePath;                 // 快照保存路径
+    QPointer<PersistenceService> m_persistence;
+
+public:
+    // 可在工作线程中调用；已有快照的目录不会被文件中的旧记录覆盖
+    void loadFromFile();
+    void saveToFile();
+};
+
+#endif // ALBUMSCANNER_H
@@ -0,0 +1,237 @@
+#include "AlbumWatcher.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QSocketNotifier>
+#include <QStorageInfo>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef Q_OS_LINUX
+// 目录条目增删、文件写入完成以及目录自身被删除或移走
+constexpr uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                                | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+#endif
+
+} // namespace
+
+AlbumWatcher::AlbumWatcher(QObject *parent)
+    : QObject{parent}
+    , m_polling(false)
+    , m_inotifyFd(-1)
+    , m_notifier(nullptr)
+    , m_pendingFull(false)
+    , m_coalesceDelay(300)
+    , m_maxCoalesceDelay(2000)
+{
+    m_coalesceTimer.setSingleShot(true);
+    connect(&m_coalesceTimer, &QTimer::timeout, this, &AlbumWatcher::onCoalesceTimeout);
+
+    m_pollTimer.setInterval(5000);
+    connect(&m_pollTimer, &QTimer::timeout, this, [this]() {
+        emit directoriesChanged({});
+    });
+}
+
+AlbumWatcher::~AlbumWatcher()
+{
+    stopInotify();
+}
+
+void AlbumWatcher::setCoalesceDelay(int delayMs, int maxDelayMs)
+{
+    m_coalesceDelay = qMax(0, delayMs);
+    m_maxCoalesceDelay = qMax(m_coalesceDelay, maxDelayMs);
+}
+
+void AlbumWatcher::setPollInterval(int ms)
+{
+    m_pollTimer.setInterval(qMax(500, ms));
+}
+
+void AlbumWatcher::watch(const QString &rootPath, const QStringList &dirs)
+{
+    if (rootPath != m_rootPath) {
+        unwatch();
+        m_rootPath = rootPath;
+
+        m_polling = isNetworkFileSystem(rootPath) || !startInotify();
+        if (m_polling) {
+            qDebug() << "Album watcher polling:" << rootPath;
+            m_pollTimer.start();
+        }
+    }
+
+    if (m_polling) {
+        return;
+    }
+
+#ifdef Q_OS_LINUX
+    // 只为新出现的目录添加监视，已消失的目录移除监视
+    const QSet<QString> wanted(dirs.cbegin(), dirs.cend());
+    for (auto it = m_dirWatches.begin(); it != m_dirWatches.end();) {
+        if (!wanted.contains(it.key())) {
+            inotify_rm_watch(m_inotifyFd, it.value());
+            m_watchDirs.remove(it.value());
+            it = m_dirWatches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const QString &dir : dirs) {
+        if (m_dirWatches.contains(dir)) {
+            continue;
+        }
+        const int wd = inotify_add_watch(m_inotifyFd, QFile::encodeName(dir).constData(), kWatchMask);
+        if (wd < 0) {
+            if (errno == ENOSPC) {
+                // 超出系统的监视数量上限，整个专辑改为轮询
+                qWarning() << "inotify watch limit reached, falling back to polling:" << m_rootPath;
+                stopInotify();
+                m_polling = true;
+                m_pollTimer.start();
+                return;
+            }
+            qWarning() << "Failed to watch directory:" << dir;
+            continue;
+        }
+        m_watchDirs.insert(wd, dir);
+        m_dirWatches.insert(dir, wd);
+    }
+#else
+    Q_UNUSED(dirs);
+#endif
+}
+
+void AlbumWatcher::unwatch()
+{
+    stopInotify();
+    m_pollTimer.stop();
+    m_coalesceTimer.stop();
+    m_dirtyDirs.clear();
+    m_pendingFull = false;
+    m_polling = false;
+    m_rootPath.clear();
+}
+
+bool AlbumWatcher::isNetworkFileSystem(const QString &path)
+{
+    static const QSet<QByteArray> networkTypes{
+        "nfs", "nfs4", "cifs", "smb", "smb2", "smb3", "smbfs", "9p", "afs",
+        "ncpfs", "davfs", "fuse.sshfs", "fuse.rclone", "fuse.davfs2"
+    };
+    return networkTypes.contains(QStorageInfo(path).fileSystemType().toLower());
+}
+
+bool AlbumWatcher::startInotify()
+{
+#ifdef Q_OS_LINUX
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0) {
+        qWarning() << "inotify unavailable, falling back to polling";
+        return false;
+    }
+
+    m_notifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &AlbumWatcher::onInotifyReadable);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AlbumWatcher::stopInotify()
+{
+    delete m_notifier;
+    m_notifier = nullptr;
+
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd >= 0) {
+        ::close(m_inotifyFd);     // 关闭时内核会移除全部监视
+        m_inotifyFd = -1;
+    }
+#endif
+    m_watchDirs.clear();
+    m_dirWatches.clear();
+}
+
+void AlbumWatcher::onInotifyReadable()
+{
+#ifdef Q_OS_LINUX
+    alignas(struct inotify_event) char buffer[16 * 1024];
+
+    for (;;) {
+        const ssize_t length = ::read(m_inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;      // EAGAIN：已读完
+        }
+
+        for (ssize_t offset = 0; offset < length;) {
+            const auto *event = reinterpret_cast<const struct inotify_event *>(buffer + offset);
+            offset += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                m_pendingFull = true;
+                markDirty(QString());
+                continue;
+            }
+
+            const QString dir = m_watchDirs.value(event->wd);
+            if (dir.isEmpty()) {
+                continue;
+            }
+
+            if (event->mask & IN_IGNORED) {
+                // 目录已被删除，内核自动移除了监视
+                m_watchDirs.remove(event->wd);
+                m_dirWatches.remove(dir);
+                continue;
+            }
+
+            // 新建文件会在写入完成时再收到 IN_CLOSE_WRITE，这里只关心新建目录
+            if ((event->mask & IN_CREATE) && !(event->mask & IN_ISDIR)) {
+                continue;
+            }
+
+            markDirty(dir);
+        }
+    }
+#endif
+}
+
+void AlbumWatcher::markDirty(const QString &dir)
+{
+    if (!dir.isEmpty()) {
+        m_dirtyDirs.insert(dir);
+    }
+
+    if (!m_coalesceTimer.isActive()) {
+        m_firstPending.start();
+    }
+
+    // 持续有事件时推迟通知，但不超过上限
+    const qint64 remaining = m_maxCoalesceDelay - m_firstPending.elapsed();
+    m_coalesceTimer.start(int(qBound<qint64>(0, remaining, m_coalesceDelay)));
+}
+
+void AlbumWatcher::onCoalesceTimeout()
+{
+    QStringList dirs;
+    if (m_pendingFull) {
+        // 丢失了部分事件，所有目录都重新列举
+        dirs = m_dirWatches.keys();
+    } else {
+        dirs = QStringList(m_dirtyDirs.cbegin(), m_dirtyDirs.cend());
+    }
+    m_dirtyDirs.clear();
+    m_pendingFull = false;
+
+    emit directoriesChanged(dirs);
+}
@@ -0,0 +1,72 @@
+#ifndef ALBUMWATCHER_H
+#define ALBUMWATCHER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+class QSocketNotifier;
+
+/**
+ * @brief The AlbumWatcher class
+ * 监视当前本地专辑的目录变化
+ *
+ * Linux 下使用 inotify 监视专辑内的每个目录；网络文件系统、inotify 不可用或其他平台上退化为定时轮询。
+ * 短时间内的大量事件（如复制整个目录）会被合并，静默一段时间（或等待超过上限）后才发出一次 directoriesChanged。
+ */
+class AlbumWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AlbumWatcher(QObject *parent = nullptr);
+    ~AlbumWatcher();
+
+    // 监视专辑根目录及 dirs 中的目录；对同一根目录重复调用只增删有变化的监视项
+    void watch(const QString &rootPath, const QStringList &dirs);
+    void unwatch();
+
+    // 事件合并：静默 delayMs 后发出通知，持续有事件时最多等待 maxDelayMs
+    void setCoalesceDelay(int delayMs, int maxDelayMs);
+    // 轮询模式的间隔
+    void setPollInterval(int ms);
+
+    bool isPolling() const { return m_polling; }
+
+signals:
+    // 目录内容发生变化；dirs 为需要强制重新列举的目录，为空时只按目录修改时间判断
+    void directoriesChanged(const QStringList &dirs);
+
+private slots:
+    void onInotifyReadable();
+    void onCoalesceTimeout();
+
+private:
+    static bool isNetworkFileSystem(const QString &path);
+
+    bool startInotify();
+    void stopInotify();
+    void markDirty(const QString &dir);
+
+private:
+    QString m_rootPath;
+    bool m_polling;
+
+    int m_inotifyFd;
+    QSocketNotifier *m_notifier;
+    QHash<int, QString> m_watchDirs;         // inotify 监视描述符 -> 目录
+    QHash<QString, int> m_dirWatches;        // 目录 -> inotify 监视描述符
+
+    QSet<QString> m_dirtyDirs;               // 等待通知的目录
+    bool m_pendingFull;                      // 事件队列溢出，需要完整扫描
+    QTimer m_coalesceTimer;
+    QElapsedTimer m_firstPending;            // 第一个未通知事件的时间
+    int m_coalesceDelay;
+    int m_maxCoalesceDelay;
+
+    QTimer m_pollTimer;
+};
+
+#endif // ALBUMWATCHER_H
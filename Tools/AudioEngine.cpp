@@ -0,0 +1,903 @@
+#include "AudioEngine.h"
+#include "DspKernels.h"
+
+#include <QAudioDevice>
+#include <QAudioSink>
+#include <QDebug>
+#include <QMediaDevices>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr double HalfPi = 1.57079632679489661923;
+
+// 自然结束时提前多久载入下一首，留出解码器启动的时间
+constexpr qint64 CrossfadePrerollMs = 1000;
+
+// 混音缓冲区的最小帧数，设备缓冲区更大时按设备缓冲区分配
+constexpr qint64 MixBlockFrames = 4096;
+
+} // namespace
+
+AudioEngine::Stream::Stream(AudioEngine *engine, QObject *parent)
+    : QIODevice(parent)
+    , m_engine(engine)
+{
+}
+
+qint64 AudioEngine::Stream::readData(char *data, qint64 maxSize)
+{
+    return m_engine->render(data, maxSize);
+}
+
+qint64 AudioEngine::Stream::writeData(const char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+qint64 AudioEngine::Stream::bytesAvailable() const
+{
+    // 数据源没有尽头（没有音频时输出静音），部分后端按可读字节数决定拉取的长度
+    return QIODevice::bytesAvailable() + (1 << 24);
+}
+
+AudioEngine::AudioEngine(QObject *parent)
+    : QObject{parent}
+    , m_audioThread(new QThread(this))
+    , m_output(new QObject)
+    , m_sink(nullptr)
+    , m_stream(nullptr)
+    , m_outputState(QAudio::StoppedState)
+    , m_deviceFrames(0)
+    , m_deviceTimeNs(0)
+    , m_decodeThread(new QThread(this))
+    , m_lane(0)
+    , m_preparedLane(-1)
+    , m_requestLane(-1)
+    , m_requestFadeFrames(0)
+    , m_renderInLane(0)
+    , m_renderOutLane(-1)
+    , m_inLane(0)
+    , m_outLane(-1)
+    , m_fadeLength(0)
+    , m_fadeInPos(0)
+    , m_fadeOutPos(0)
+    , m_primed(false)
+    , m_starved(false)
+    , m_underrunCount(0)
+    , m_underrunFrames(0)
+    , m_tap(nullptr)
+    , m_tapBusy(false)
+    , m_tapDropped(0)
+    , m_bufferMs(250)
+    , m_crossfadeMs(0)
+    , m_lastPosition(0)
+    , m_reportedUnderruns(0)
+    , m_state(QMediaPlayer::StoppedState)
+    , m_status(QMediaPlayer::NoMedia)
+    , m_volume(1.0f)
+    , m_gain(1.0f)
+    , m_dsp(&DspKernels::instance())
+{
+    // 输出格式使用设备的首选采样率与声道数，采样优先使用 float
+    const QAudioDevice device = QMediaDevices::defaultAudioOutput();
+    m_format = device.preferredFormat();
+    if (m_format.sampleRate() <= 0 || m_format.channelCount() <= 0) {
+        m_format.setSampleRate(44100);
+        m_format.setChannelCount(2);
+    }
+    m_format.setSampleFormat(QAudioFormat::Float);
+    if (!device.isNull() && !device.isFormatSupported(m_format)) {
+        m_format.setSampleFormat(QAudioFormat::Int16);
+    }
+
+    m_equalizer = std::make_unique<Equalizer>(m_format.sampleRate(), m_format.channelCount());
+
+    // 输出设备与数据源在音频线程中创建，输出回调也在音频线程中执行
+    m_audioClock.start();
+    m_output->moveToThread(m_audioThread);
+    connect(m_audioThread, &QThread::finished, m_output, &QObject::deleteLater);
+    m_audioThread->start(QThread::TimeCriticalPriority);
+    QMetaObject::invokeMethod(m_output, [this, device]() {
+        m_sink = new QAudioSink(device, m_format, m_output);
+        m_stream = new Stream(this, m_output);
+        m_stream->open(QIODevice::ReadOnly);
+    });
+
+    for (int i = 0; i < LaneCount; ++i) {
+        Lane &lane = m_lanes[i];
+        lane.worker = new DecodeWorker(&lane);
+        lane.worker->moveToThread(m_decodeThread);
+        connect(m_decodeThread, &QThread::finished, lane.worker, &QObject::deleteLater);
+
+        connect(lane.worker, &DecodeWorker::trackStarted, this,
+                [this, i](quint64 generation, int serial, const QUrl &url, qint64 streamFrame, qint64 baseFrame) {
+            onTrackStarted(i, generation, serial, url, streamFrame, baseFrame);
+        });
+        connect(lane.worker, &DecodeWorker::durationChanged, this, [this, i](quint64 generation, int serial, qint64 frames) {
+            onTrackDurationChanged(i, generation, serial, frames);
+        });
+        connect(lane.worker, &DecodeWorker::streamEndChanged, this, [this, i](quint64 generation, qint64 streamFrame) {
+            onStreamEndChanged(i, generation, streamFrame);
+        });
+        connect(lane.worker, &DecodeWorker::errorOccurred, this, [this, i](quint64 generation, int serial, const QString &message) {
+            onTrackError(i, generation, serial, message);
+        });
+    }
+    m_decodeThread->start(QThread::HighPriority);
+
+    m_clock.setInterval(30);
+    connect(&m_clock, &QTimer::timeout, this, &AudioEngine::updateClock);
+}
+
+AudioEngine::~AudioEngine()
+{
+    QMetaObject::invokeMethod(m_output, [this]() {
+        m_sink->stop();
+    }, Qt::BlockingQueuedConnection);
+    m_audioThread->quit();
+    m_audioThread->wait();
+    m_decodeThread->quit();
+    m_decodeThread->wait();
+}
+
+void AudioEngine::setSource(const QUrl &source)
+{
+    m_clock.stop();
+    m_nextUrl.clear();
+    resetStream(source, 0);
+
+    setState(QMediaPlayer::StoppedState);
+    setStatus(source.isEmpty() ? QMediaPlayer::NoMedia : QMediaPlayer::LoadedMedia);
+
+    m_lastPosition = 0;
+    emit sourceChanged(source);
+    emit durationChanged(duration());
+    emit positionChanged(0);
+}
+
+QUrl AudioEngine::source() const
+{
+    const Lane &lane = m_lanes[m_lane];
+    return lane.segments.isEmpty() ? QUrl() : lane.segments.first().url;
+}
+
+void AudioEngine::switchTo(const QUrl &source)
+{
+    if (m_crossfadeMs <= 0 || m_state != QMediaPlayer::PlayingState || this->source().isEmpty() || source.isEmpty()) {
+        setSource(source);
+        play();
+        return;
+    }
+
+    // 预先载入的下一首不再需要
+    if (m_preparedLane >= 0) {
+        loadLane(m_preparedLane, QUrl(), 0);
+        m_preparedLane = -1;
+    }
+
+    const int lane = freeLane();
+    if (lane < 0) {
+        // 连续快速切换，所有通道都在使用中
+        setSource(source);
+        play();
+        return;
+    }
+
+    loadLane(lane, source, 0);
+    requestCrossfade(lane, m_crossfadeMs);
+    m_lane = lane;
+    m_nextUrl.clear();
+
+    setStatus(QMediaPlayer::LoadedMedia);
+    m_lastPosition = 0;
+    emit sourceChanged(source);
+    emit durationChanged(duration());
+    emit positionChanged(0);
+}
+
+void AudioEngine::setNextSource(const QUrl &source)
+{
+    if (source == m_nextUrl) {
+        return;
+    }
+    m_nextUrl = source;
+
+    if (m_crossfadeMs > 0) {
+        // 淡化由通道切换完成，下一首变化后重新预载
+        if (m_preparedLane >= 0) {
+            loadLane(m_preparedLane, QUrl(), 0);
+            m_preparedLane = -1;
+        }
+        return;
+    }
+
+    QMetaObject::invokeMethod(m_lanes[m_lane].worker, [worker = m_lanes[m_lane].worker, source]() {
+        worker->setNext(source);
+    });
+}
+
+void AudioEngine::play()
+{
+    if (source().isEmpty()) {
+        return;
+    }
+
+    if (m_status == QMediaPlayer::EndOfMedia) {
+        // 播放结束后再次播放，从头开始
+        resetStream(source(), 0);
+        setStatus(QMediaPlayer::LoadedMedia);
+    }
+
+    if (m_outputState == QAudio::SuspendedState) {
+        resumeOutput();
+    } else if (m_outputState == QAudio::StoppedState) {
+        startOutput();
+    }
+
+    m_clock.start();
+    setState(QMediaPlayer::PlayingState);
+}
+
+void AudioEngine::pause()
+{
+    if (m_state != QMediaPlayer::PlayingState) {
+        return;
+    }
+
+    suspendOutput();
+    updateClock();
+    m_clock.stop();
+    setState(QMediaPlayer::PausedState);
+}
+
+void AudioEngine::stop()
+{
+    if (m_state == QMediaPlayer::StoppedState) {
+        return;
+    }
+
+    // 停止后回到音轨开头
+    m_clock.stop();
+    resetStream(source(), 0);
+
+    setState(QMediaPlayer::StoppedState);
+    m_lastPosition = 0;
+    emit positionChanged(0);
+}
+
+qint64 AudioEngine::position() const
+{
+    const Lane &lane = m_lanes[m_lane];
+    if (lane.segments.isEmpty()) {
+        return 0;
+    }
+
+    const Segment &segment = lane.segments.first();
+    qint64 frames = segment.baseFrame;
+    if (segment.streamFrame >= 0) {
+        frames += qMax<qint64>(0, playedFrames(m_lane) - segment.streamFrame);
+    }
+
+    const qint64 ms = frames * 1000 / m_format.sampleRate();
+    const qint64 total = duration();
+    return total > 0 ? qMin(ms, total) : ms;
+}
+
+void AudioEngine::setPosition(qint64 position)
+{
+    if (source().isEmpty()) {
+        return;
+    }
+
+    // 以正在播放的音轨为准重新解码，已经写入的下一首在解码完成后重新预解码
+    const qint64 frame = qMax<qint64>(0, position) * m_format.sampleRate() / 1000;
+    resetStream(source(), frame);
+
+    // 解码器不支持跳转，要从头解码到目标位置，耗时随位置增长；第一帧写入之前处于缓冲状态
+    setStatus(QMediaPlayer::BufferingMedia);
+
+    if (m_state == QMediaPlayer::PlayingState) {
+        startOutput();
+    } else if (m_state == QMediaPlayer::PausedState) {
+        startOutput();
+        suspendOutput();
+    }
+
+    m_lastPosition = qMax<qint64>(0, position);
+    emit positionChanged(m_lastPosition);
+}
+
+qint64 AudioEngine::duration() const
+{
+    const Lane &lane = m_lanes[m_lane];
+    if (lane.segments.isEmpty()) {
+        return 0;
+    }
+    const qint64 frames = lane.durations.value(lane.segments.first().serial, -1);
+    return frames > 0 ? frames * 1000 / m_format.sampleRate() : 0;
+}
+
+void AudioEngine::setVolume(float volume)
+{
+    // 在输出回调中按增益缩放，不使用输出设备的音量（部分后端调节音量时会重新打开设备）
+    m_volume = qBound(0.0f, volume, 1.0f);
+    m_gain.store(m_volume, std::memory_order_relaxed);
+}
+
+void AudioEngine::setEqualizer(const EqPreset &preset)
+{
+    m_equalizer->setPreset(preset);
+}
+
+void AudioEngine::setReplayGain(LoudnessCache *cache, LoudnessCache::GainMode mode, double preampDb)
+{
+    for (Lane &lane : m_lanes) {
+        QMetaObject::invokeMethod(lane.worker, [worker = lane.worker, cache, mode, preampDb]() {
+            worker->setReplayGain(cache, mode, preampDb);
+        });
+    }
+}
+
+void AudioEngine::setResampleQuality(Resampler::Quality quality)
+{
+    for (Lane &lane : m_lanes) {
+        QMetaObject::invokeMethod(lane.worker, [worker = lane.worker, quality]() {
+            worker->setResampleQuality(quality);
+        });
+    }
+}
+
+void AudioEngine::setAnalysisTap(SpscRingBuffer<float> *tap)
+{
+    m_tap.store(tap);
+
+    // 输出回调对 tap 只做一次无锁写入，等待的时间很短
+    while (m_tapBusy.load()) {
+        QThread::yield();
+    }
+}
+
+void AudioEngine::setBufferDuration(int ms)
+{
+    m_bufferMs = qBound(20, ms, 5000);
+}
+
+void AudioEngine::setCrossfadeDuration(int ms)
+{
+    ms = qBound(0, ms, 12000);
+    if (ms == m_crossfadeMs) {
+        return;
+    }
+
+    const bool wasGapless = m_crossfadeMs <= 0;
+    m_crossfadeMs = ms;
+
+    if (m_preparedLane >= 0 && ms <= 0) {
+        loadLane(m_preparedLane, QUrl(), 0);
+        m_preparedLane = -1;
+    }
+
+    if (wasGapless != (ms <= 0)) {
+        // 无缝衔接时下一首交给当前通道的解码器接续，淡化时由通道切换完成
+        const QUrl next = ms > 0 ? QUrl() : m_nextUrl;
+        QMetaObject::invokeMethod(m_lanes[m_lane].worker, [worker = m_lanes[m_lane].worker, next]() {
+            worker->setNext(next);
+        });
+    }
+}
+
+qint64 AudioEngine::render(char *data, qint64 maxSize)
+{
+    const int bytesPerFrame = m_format.bytesPerFrame();
+    const qint64 frames = maxSize / bytesPerFrame;
+    const qint64 block = m_mixBuffer.size() / m_format.channelCount();
+    if (frames <= 0 || block <= 0) {
+        return 0;
+    }
+
+    acceptSwitchRequest();
+
+    // 混音缓冲区在开始输出时分配，设备一次要得更多时分块处理
+    for (qint64 done = 0; done < frames;) {
+        const qint64 n = qMin(block, frames - done);
+        renderBlock(data + done * bytesPerFrame, n);
+        done += n;
+    }
+
+    // 发布设备缓冲中尚未播放的帧数（本次写入的数据紧接在已缓冲的数据之后），界面线程据此推算播放位置
+    const qint64 queued = qMax<qint64>(0, m_sink->bufferSize() - m_sink->bytesFree()) / bytesPerFrame + frames;
+    m_deviceTimeNs.store(m_audioClock.nsecsElapsed(), std::memory_order_relaxed);
+    m_deviceFrames.store(queued, std::memory_order_release);
+
+    return frames * bytesPerFrame;
+}
+
+void AudioEngine::renderBlock(char *data, qint64 frames)
+{
+    const int channels = m_format.channelCount();
+    const qint64 samples = frames * channels;
+
+    // 环形缓冲区中总是整帧
+    Lane &lane = m_lanes[m_inLane];
+    float *mix = m_mixBuffer.data();
+    const qint64 got = readLane(lane, mix, frames);
+    std::fill(mix + got * channels, mix + samples, 0.0f);
+
+    if (got > 0) {
+        m_primed = true;
+    }
+
+    if (got < frames && m_primed && !lane.streamDone.load(std::memory_order_acquire)) {
+        // 解码跟不上，补静音；连续的不足只计一次
+        if (!m_starved) {
+            m_starved = true;
+            m_underrunCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_underrunFrames.fetch_add(frames - got, std::memory_order_relaxed);
+    } else if (got == frames) {
+        m_starved = false;
+    }
+
+    if (m_outLane >= 0 || m_fadeInPos < m_fadeLength) {
+        mixCrossfade(mix, frames, got);
+    }
+
+    m_equalizer->process(mix, frames);
+
+    const float gain = m_gain.load(std::memory_order_relaxed);
+    if (gain != 1.0f) {
+        m_dsp->applyGain(mix, samples, gain);
+    }
+
+    // 先标记再读取 tap（都是顺序一致的），setAnalysisTap 换下旧的 tap 后只需等待标记清除
+    m_tapBusy.store(true);
+    if (SpscRingBuffer<float> *tap = m_tap.load()) {
+        const qint64 written = qMin<qint64>(frames, tap->writeAvailable() / channels);
+        tap->write(mix, written * channels);
+        if (written < frames) {
+            m_tapDropped.fetch_add(frames - written, std::memory_order_relaxed);
+        }
+    }
+    m_tapBusy.store(false, std::memory_order_release);
+
+    if (m_format.sampleFormat() == QAudioFormat::Float) {
+        std::memcpy(data, mix, size_t(samples) * sizeof(float));
+    } else {
+        m_dsp->floatToInt16(mix, reinterpret_cast<qint16 *>(data), samples);
+    }
+}
+
+qint64 AudioEngine::readLane(Lane &lane, float *data, qint64 frames)
+{
+    const int channels = m_format.channelCount();
+    qint64 got = 0;
+
+    // 与 m_tapBusy 相同：先标记再比较代号（都是顺序一致的），解码线程看到标记清除后才重置环形缓冲区
+    lane.reading.store(true);
+    if (lane.ready.load() == lane.requested.load()) {
+        got = lane.ring.read(data, frames * channels) / channels;
+        lane.readFrames.fetch_add(got, std::memory_order_relaxed);
+    }
+    lane.reading.store(false, std::memory_order_release);
+    return got;
+}
+
+void AudioEngine::acceptSwitchRequest()
+{
+    const int lane = m_requestLane.exchange(-1, std::memory_order_acq_rel);
+    if (lane < 0) {
+        return;
+    }
+
+    const qint64 length = qMax<qint64>(1, m_requestFadeFrames.load(std::memory_order_relaxed));
+
+    // 正在淡入的通道从当前增益开始淡出（cos 与 sin 互补，总功率不变），更早的淡出通道直接丢弃
+    qint64 outPos = 0;
+    if (m_fadeInPos < m_fadeLength) {
+        outPos = length - m_fadeInPos * length / m_fadeLength;
+    }
+
+    m_outLane = m_inLane;
+    m_fadeOutPos = outPos;
+    m_inLane = lane;
+    m_fadeInPos = 0;
+    m_fadeLength = length;
+    m_primed = false;
+    m_starved = false;
+
+    m_renderOutLane.store(m_outLane, std::memory_order_release);
+    m_renderInLane.store(m_inLane, std::memory_order_release);
+}
+
+void AudioEngine::mixCrossfade(float *mix, qint64 frames, qint64 inFrames)
+{
+    const int channels = m_format.channelCount();
+    const qint64 samples = frames * channels;
+    float *other = m_fadeBuffer.data();
+    float *gainIn = m_gainIn.data();
+    float *gainOut = m_gainOut.data();
+
+    qint64 outFrames = 0;
+    if (m_outLane >= 0) {
+        outFrames = readLane(m_lanes[m_outLane], other, frames);
+    }
+    std::fill(other + outFrames * channels, other + samples, 0.0f);
+
+    // 等功率曲线：淡入 sin，淡出 cos；淡入从新音轨的第一帧算起，淡出从切换请求算起
+    const double step = HalfPi / double(m_fadeLength);
+    for (qint64 f = 0; f < frames; ++f) {
+        const qint64 inPos = m_fadeInPos + f;
+        const qint64 outPos = m_fadeOutPos + f;
+        const float in = inPos < m_fadeLength ? float(std::sin(step * inPos)) : 1.0f;
+        const float out = (m_outLane >= 0 && outPos < m_fadeLength) ? float(std::cos(step * outPos)) : 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            gainIn[f * channels + c] = in;
+            gainOut[f * channels + c] = out;
+        }
+    }
+    m_dsp->mixWeighted(mix, mix, other, gainIn, gainOut, samples);
+
+    m_fadeInPos = qMin(m_fadeLength, m_fadeInPos + inFrames);
+    if (m_outLane >= 0) {
+        m_fadeOutPos += frames;
+        if (m_fadeOutPos >= m_fadeLength) {
+            m_outLane = -1;
+            m_renderOutLane.store(-1, std::memory_order_release);
+        }
+    }
+}
+
+void AudioEngine::resetStream(const QUrl &url, qint64 startFrame)
+{
+    stopOutput();
+
+    for (int i = 0; i < LaneCount; ++i) {
+        if (i != m_lane && !m_lanes[i].segments.isEmpty()) {
+            loadLane(i, QUrl(), 0);
+        }
+    }
+    loadLane(m_lane, url, startFrame);
+    m_preparedLane = -1;
+
+    m_requestLane.store(-1, std::memory_order_relaxed);
+    QMetaObject::invokeMethod(m_output, [this, lane = m_lane]() {
+        resetRender(lane);
+    });
+}
+
+void AudioEngine::resetRender(int lane)
+{
+    // 排在 stopOutput 之后执行，输出回调不会同时运行
+    m_requestLane.store(-1, std::memory_order_relaxed);
+    m_inLane = lane;
+    m_outLane = -1;
+    m_fadeLength = 0;
+    m_fadeInPos = 0;
+    m_fadeOutPos = 0;
+    m_primed = false;
+    m_starved = false;
+    m_renderInLane.store(m_inLane, std::memory_order_release);
+    m_renderOutLane.store(-1, std::memory_order_release);
+}
+
+void AudioEngine::openOutput()
+{
+    // 回调中不再分配内存：按设备缓冲区（尚未确定时按最小块）分配，设备一次要得更多时分块处理
+    const qint64 frames = qMax<qint64>(MixBlockFrames, m_sink->bufferSize() / m_format.bytesPerFrame());
+    const qsizetype samples = qsizetype(frames * m_format.channelCount());
+    if (m_mixBuffer.size() < samples) {
+        m_mixBuffer.resize(samples);
+        m_fadeBuffer.resize(samples);
+        m_gainIn.resize(samples);
+        m_gainOut.resize(samples);
+    }
+
+    m_deviceFrames.store(0, std::memory_order_relaxed);
+    m_deviceTimeNs.store(m_audioClock.nsecsElapsed(), std::memory_order_relaxed);
+
+    m_sink->start(m_stream);
+    if (m_sink->error() != QAudio::NoError) {
+        qWarning() << "Failed to start audio output:" << m_sink->error();
+        QMetaObject::invokeMethod(this, &AudioEngine::onOutputError, Qt::QueuedConnection);
+    }
+}
+
+void AudioEngine::startOutput()
+{
+    m_outputState = QAudio::ActiveState;
+    QMetaObject::invokeMethod(m_output, [this]() {
+        openOutput();
+    });
+}
+
+void AudioEngine::suspendOutput()
+{
+    m_outputState = QAudio::SuspendedState;
+    QMetaObject::invokeMethod(m_output, [this]() {
+        m_sink->suspend();
+        // 暂停期间不再按时间推算已播放的帧数
+        m_deviceFrames.store(qMax<qint64>(0, m_sink->bufferSize() - m_sink->bytesFree()) / m_format.bytesPerFrame(),
+                             std::memory_order_release);
+    });
+}
+
+void AudioEngine::resumeOutput()
+{
+    m_outputState = QAudio::ActiveState;
+    QMetaObject::invokeMethod(m_output, [this]() {
+        m_deviceTimeNs.store(m_audioClock.nsecsElapsed(), std::memory_order_relaxed);
+        m_sink->resume();
+    });
+}
+
+void AudioEngine::stopOutput()
+{
+    m_outputState = QAudio::StoppedState;
+    QMetaObject::invokeMethod(m_output, [this]() {
+        m_sink->stop();
+    });
+}
+
+void AudioEngine::onOutputError()
+{
+    m_outputState = QAudio::StoppedState;
+    m_clock.stop();
+    setState(QMediaPlayer::StoppedState);
+    emit errorOccurred(tr("Failed to start audio output"));
+}
+
+void AudioEngine::loadLane(int lane, const QUrl &url, qint64 startFrame)
+{
+    Lane &target = m_lanes[lane];
+
+    // 先更新 requested，输出回调在解码线程完成重置之前不再读取该通道，这里不必等待解码线程
+    const quint64 generation = ++target.generation;
+    target.requested.store(generation);
+    target.segments.clear();
+    target.durations.clear();
+    if (!url.isEmpty()) {
+        Segment segment;
+        segment.serial = 0;
+        segment.url = url;
+        segment.baseFrame = startFrame;
+        target.segments.append(segment);
+    }
+    target.streamEnd = -1;
+
+    // 淡化时下一首由通道切换完成，不交给解码器接续
+    const QUrl next = (m_crossfadeMs > 0 || url.isEmpty()) ? QUrl() : m_nextUrl;
+    const QAudioFormat format = m_format;
+    const qsizetype capacity = qsizetype(m_bufferMs) * m_format.sampleRate() / 1000 * m_format.channelCount();
+    QMetaObject::invokeMethod(target.worker, [worker = target.worker, generation, format, capacity, url, startFrame, next]() {
+        worker->reset(generation, format, capacity, url, startFrame, next);
+    });
+}
+
+int AudioEngine::freeLane() const
+{
+    const int pending = m_requestLane.load(std::memory_order_acquire);
+    const int in = m_renderInLane.load(std::memory_order_acquire);
+    const int out = m_renderOutLane.load(std::memory_order_acquire);
+
+    for (int i = 0; i < LaneCount; ++i) {
+        if (i != m_lane && i != m_preparedLane && i != pending && i != in && i != out) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void AudioEngine::releaseIdleLanes()
+{
+    // 淡出完成的通道不再被读取，停止其解码
+    const int pending = m_requestLane.load(std::memory_order_acquire);
+    const int in = m_renderInLane.load(std::memory_order_acquire);
+    const int out = m_renderOutLane.load(std::memory_order_acquire);
+
+    for (int i = 0; i < LaneCount; ++i) {
+        if (i != m_lane && i != m_preparedLane && i != pending && i != in && i != out
+            && !m_lanes[i].segments.isEmpty()) {
+            loadLane(i, QUrl(), 0);
+        }
+    }
+}
+
+void AudioEngine::requestCrossfade(int lane, qint64 ms)
+{
+    m_requestFadeFrames.store(qMax<qint64>(1, ms * m_format.sampleRate() / 1000), std::memory_order_relaxed);
+    m_requestLane.store(lane, std::memory_order_release);
+}
+
+void AudioEngine::updateCrossfade()
+{
+    if (m_crossfadeMs <= 0 || m_nextUrl.isEmpty() || m_state != QMediaPlayer::PlayingState) {
+        return;
+    }
+
+    const qint64 total = duration();
+    if (total <= 0) {
+        return;
+    }
+
+    // 很短的音轨淡化时长不超过其一半
+    const qint64 fadeMs = qMin<qint64>(m_crossfadeMs, total / 2);
+    const qint64 remaining = total - position();
+
+    if (m_preparedLane < 0 && remaining <= fadeMs + CrossfadePrerollMs) {
+        const int lane = freeLane();
+        if (lane < 0) {
+            return;
+        }
+        loadLane(lane, m_nextUrl, 0);
+        m_preparedLane = lane;
+    }
+
+    if (m_preparedLane >= 0 && remaining <= fadeMs) {
+        const QUrl url = m_nextUrl;
+        requestCrossfade(m_preparedLane, fadeMs);
+        m_lane = m_preparedLane;
+        m_preparedLane = -1;
+        m_nextUrl.clear();
+
+        m_lastPosition = 0;
+        emit nextSourceStarted(url);
+        emit sourceChanged(url);
+        emit durationChanged(duration());
+    }
+}
+
+void AudioEngine::onTrackStarted(int lane, quint64 generation, int serial, const QUrl &url, qint64 streamFrame, qint64 baseFrame)
+{
+    Lane &target = m_lanes[lane];
+    if (generation != target.generation) {
+        return;
+    }
+
+    for (auto &segment : target.segments) {
+        if (segment.serial == serial) {
+            segment.streamFrame = streamFrame;
+            if (lane == m_lane && m_status == QMediaPlayer::BufferingMedia) {
+                setStatus(QMediaPlayer::BufferedMedia);
+            }
+            return;
+        }
+    }
+
+    // 解码线程已经接上了下一首
+    Segment segment;
+    segment.serial = serial;
+    segment.url = url;
+    segment.streamFrame = streamFrame;
+    segment.baseFrame = baseFrame;
+    target.segments.append(segment);
+
+    if (lane == m_lane && url == m_nextUrl) {
+        m_nextUrl.clear();
+    }
+}
+
+void AudioEngine::onTrackDurationChanged(int lane, quint64 generation, int serial, qint64 frames)
+{
+    Lane &target = m_lanes[lane];
+    if (generation != target.generation) {
+        return;
+    }
+
+    target.durations.insert(serial, frames);
+    if (lane == m_lane && !target.segments.isEmpty() && target.segments.first().serial == serial) {
+        emit durationChanged(duration());
+    }
+}
+
+void AudioEngine::onStreamEndChanged(int lane, quint64 generation, qint64 streamFrame)
+{
+    Lane &target = m_lanes[lane];
+    if (generation == target.generation) {
+        target.streamEnd = streamFrame;
+    }
+}
+
+void AudioEngine::onTrackError(int lane, quint64 generation, int serial, const QString &message)
+{
+    const Lane &target = m_lanes[lane];
+    if (lane != m_lane || generation != target.generation || target.segments.isEmpty()
+        || target.segments.first().serial != serial) {
+        return;
+    }
+
+    setStatus(QMediaPlayer::InvalidMedia);
+    emit errorOccurred(message);
+}
+
+qint64 AudioEngine::playedFrames(int lane) const
+{
+    // 解码线程尚未完成重置的通道还没有读出任何帧
+    const Lane &target = m_lanes[lane];
+    if (target.ready.load() != target.requested.load()) {
+        return 0;
+    }
+
+    // 已读出的帧数减去设备缓冲中尚未播放的部分；输出回调之间按经过的时间扣除设备已播放的帧数
+    qint64 buffered = 0;
+    if (m_outputState != QAudio::StoppedState) {
+        buffered = m_deviceFrames.load(std::memory_order_acquire);
+        if (m_outputState == QAudio::ActiveState) {
+            const qint64 elapsedNs = m_audioClock.nsecsElapsed() - m_deviceTimeNs.load(std::memory_order_relaxed);
+            buffered -= elapsedNs * m_format.sampleRate() / 1000000000;
+        }
+        buffered = qMax<qint64>(0, buffered);
+    }
+    return qMax<qint64>(0, target.readFrames.load(std::memory_order_relaxed) - buffered);
+}
+
+void AudioEngine::updateClock()
+{
+    const qint64 underruns = underrunCount();
+    if (underruns != m_reportedUnderruns) {
+        m_reportedUnderruns = underruns;
+        qWarning() << "Audio buffer underrun:" << underruns << "times," << underrunFrames() << "frames";
+        emit underrunOccurred(underruns);
+    }
+
+    Lane &lane = m_lanes[m_lane];
+    const qint64 played = playedFrames(m_lane);
+
+    // 已经写入的下一首开始发声
+    while (lane.segments.size() > 1 && lane.segments.at(1).streamFrame >= 0
+           && played >= lane.segments.at(1).streamFrame) {
+        lane.durations.remove(lane.segments.takeFirst().serial);
+
+        emit nextSourceStarted(lane.segments.first().url);
+        emit sourceChanged(lane.segments.first().url);
+        emit durationChanged(duration());
+    }
+
+    // 最后一首播放完
+    if (lane.streamEnd >= 0 && lane.segments.size() <= 1 && played >= lane.streamEnd) {
+        stopOutput();
+        m_clock.stop();
+
+        m_lastPosition = duration();
+        emit positionChanged(m_lastPosition);
+        setState(QMediaPlayer::StoppedState);
+        // 无法解码的音频只停止，不当作播放结束自动切换
+        if (m_status != QMediaPlayer::InvalidMedia) {
+            setStatus(QMediaPlayer::EndOfMedia);
+        }
+        return;
+    }
+
+    updateCrossfade();
+    releaseIdleLanes();
+
+    const qint64 pos = position();
+    if (pos != m_lastPosition) {
+        m_lastPosition = pos;
+        emit positionChanged(pos);
+    }
+}
+
+void AudioEngine::setState(QMediaPlayer::PlaybackState state)
+{
+    if (m_state == state) {
+        return;
+    }
+    m_state = state;
+    emit playbackStateChanged(state);
+}
+
+void AudioEngine::setStatus(QMediaPlayer::MediaStatus status)
+{
+    if (m_status == status) {
+        return;
+    }
+    m_status = status;
+    emit mediaStatusChanged(status);
+}
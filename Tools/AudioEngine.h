@@ -0,0 +1,267 @@
+#ifndef AUDIOENGINE_H
+#define AUDIOENGINE_H
+
+#include <QAudio>
+#include <QAudioFormat>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QIODevice>
+#include <QList>
+#include <QMediaPlayer>
+#include <QObject>
+#include <QTimer>
+#include <QUrl>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+
+#include "DecodeWorker.h"
+#include "Equalizer.h"
+#include "LoudnessCache.h"
+#include "Resampler.h"
+#include "SpscRingBuffer.h"
+
+class QAudioSink;
+class QThread;
+struct DspKernels;
+
+/**
+ * @brief The AudioEngine class
+ * 无缝播放引擎
+ *
+ * 解码 → 环形缓冲区 → 输出设备：解码线程（DecodeWorker）把音轨解码为 float 采样写入无锁的单生产者单消费者环形缓冲区，
+ * QAudioSink 以拉取模式从中读取，读取时不加锁也不等待解码，数据不足时补静音并计为一次缓冲不足。
+ * 输出设备与输出回调在独立的音频线程中，界面线程繁忙时不会造成缓冲不足；界面线程对设备的操作（开始、暂停、停止）
+ * 排队交给音频线程执行，播放位置由输出回调发布的设备缓冲量推算。
+ * 通道的重置也不等待解码线程，以代号区分（见 DecodeLane），重置完成之前输出回调不读取该通道。
+ * 接口与状态沿用 QMediaPlayer，以便直接替换。
+ *
+ * 未启用淡入淡出时，当前音轨解码完成后立即开始预解码下一首（setNextSource），当前音轨写完后紧接着写入下一首，
+ * 音轨之间没有空隙，也不需要重新初始化输出设备；音轨首尾的编码器延迟与填充由 TrackDecoder 裁掉。
+ * 接上的下一首真正被播放出来（输出设备中缓冲的上一首播放完）时发出 nextSourceStarted 与 sourceChanged。
+ *
+ * 启用淡入淡出时，每首音轨在独立的通道（各自的解码器与环形缓冲区）中解码，输出回调同时读取两个通道并按等功率曲线混合。
+ * 自然结束时在剩余时长等于淡化时长时切换到下一首；手动切换（switchTo）在下一次输出回调中就开始淡出当前音轨。
+ */
+class AudioEngine : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AudioEngine(QObject *parent = nullptr);
+    ~AudioEngine();
+
+    // 设置当前音频，会停止播放并清除预解码的下一首
+    void setSource(const QUrl &source);
+    QUrl source() const;
+
+    // 切换到 source 并播放，正在播放且启用了淡入淡出时与当前音频交叉淡化，否则等同于 setSource + play
+    void switchTo(const QUrl &source);
+
+    // 当前音频结束后无缝接续的音频，为空表示播放到当前音频结束为止
+    void setNextSource(const QUrl &source);
+    QUrl nextSource() const { return m_nextUrl; }
+
+    void play();
+    void pause();
+    void stop();
+
+    bool isPlaying() const { return m_state == QMediaPlayer::PlayingState; }
+    QMediaPlayer::PlaybackState playbackState() const { return m_state; }
+    QMediaPlayer::MediaStatus mediaStatus() const { return m_status; }
+
+    // 毫秒
+    qint64 position() const;
+    void setPosition(qint64 position);
+    qint64 duration() const;
+
+    // 线性音量 [0, 1]
+    void setVolume(float volume);
+    float volume() const { return m_volume; }
+
+    // 均衡器设置（界面线程调用），在输出回调中与音量一起施加，变化时平滑过渡
+    void setEqualizer(const EqPreset &preset);
+    EqPreset equalizer() const { return m_equalizer->preset(); }
+
+    // 回放增益：按 cache 中的响度分析结果把音轨调整到参考响度，cache 为空或 mode 为 GainOff 时不调整
+    // 增益在解码时施加，对之后开始解码的音轨生效
+    void setReplayGain(LoudnessCache *cache, LoudnessCache::GainMode mode, double preampDb = 0.0);
+
+    // 音轨采样率与输出设备不同时由解码线程转换采样率，相同时不转换；对之后开始解码的音轨生效
+    void setResampleQuality(Resampler::Quality quality);
+
+    // 环形缓冲区的深度（毫秒），在下一次设置音频或跳转时生效
+    void setBufferDuration(int ms);
+    int bufferDuration() const { return m_bufferMs; }
+
+    // 淡入淡出时长（毫秒），0 表示无缝衔接
+    void setCrossfadeDuration(int ms);
+    int crossfadeDuration() const { return m_crossfadeMs; }
+
+    // 缓冲不足（输出设备读取时数据不够）的次数与补入的静音帧数
+    qint64 underrunCount() const { return m_underrunCount.load(std::memory_order_relaxed); }
+    qint64 underrunFrames() const { return m_underrunFrames.load(std::memory_order_relaxed); }
+
+    QAudioFormat format() const { return m_format; }
+
+    // 分析抽头：输出回调把最终送往设备的采样（交错的 float，采样率与声道数同 format()）写入 tap，
+    // 写不下的整帧直接丢弃，不会等待读端。设置新的 tap（包括 nullptr）后返回时，输出回调已不再访问旧的 tap
+    void setAnalysisTap(SpscRingBuffer<float> *tap);
+    // 因 tap 已满而丢弃的帧数
+    qint64 tapDroppedFrames() const { return m_tapDropped.load(std::memory_order_relaxed); }
+
+signals:
+    void sourceChanged(const QUrl &source);
+    // 预解码的下一首开始播放（随后也会发出 sourceChanged）
+    void nextSourceStarted(const QUrl &source);
+    void playbackStateChanged(QMediaPlayer::PlaybackState state);
+    void mediaStatusChanged(QMediaPlayer::MediaStatus status);
+    void positionChanged(qint64 position);
+    void durationChanged(qint64 duration);
+    void errorOccurred(const QString &message);
+    void underrunOccurred(qint64 count);
+
+private:
+    // 输出设备从中拉取采样
+    class Stream : public QIODevice
+    {
+    public:
+        Stream(AudioEngine *engine, QObject *parent);
+
+        bool isSequential() const override { return true; }
+        qint64 bytesAvailable() const override;
+
+    protected:
+        qint64 readData(char *data, qint64 maxSize) override;
+        qint64 writeData(const char *data, qint64 maxSize) override;
+
+    private:
+        AudioEngine *m_engine;
+    };
+
+    // 输出流中的一段音轨，第一个是正在播放的，其余是已经写入但还在缓冲之后的
+    struct Segment
+    {
+        int serial = 0;                 // 对应 DecodeWorker 中的 serial
+        QUrl url;
+        qint64 streamFrame = -1;        // 首帧在输出流中的位置，-1 表示尚未写入
+        qint64 baseFrame = 0;           // 首帧在音轨中的位置（跳转后不为 0）
+    };
+
+    // 解码通道：一个解码器（解码线程中）加一个环形缓冲区（与解码线程、输出回调共享的部分在 DecodeLane 中）
+    struct Lane : DecodeLane
+    {
+        DecodeWorker *worker = nullptr;         // 属于解码线程
+        quint64 generation = 0;                 // 每次重新载入递增，丢弃之前的解码线程信号
+
+        QList<Segment> segments;
+        QHash<int, qint64> durations;           // serial -> 音轨总帧数
+        qint64 streamEnd = -1;                  // 输出流结束的位置，-1 表示尚未结束
+    };
+
+    static constexpr int LaneCount = 3;         // 淡化中的两个通道之外再留一个，淡化过程中可以再次切换
+
+    // 输出设备回调中调用（音频线程），只访问环形缓冲区、原子变量与仅输出回调使用的成员
+    qint64 render(char *data, qint64 maxSize);
+    void renderBlock(char *data, qint64 frames);
+    // 通道完成最近一次重置后才读取，返回读到的帧数
+    qint64 readLane(Lane &lane, float *data, qint64 frames);
+    void acceptSwitchRequest();
+    void mixCrossfade(float *mix, qint64 frames, qint64 inFrames);
+
+    // 音频线程中执行：按设备缓冲区分配混音缓冲区后开始输出
+    void openOutput();
+    // 音频线程中执行：输出停止后重置输出回调的状态，从 lane 开始播放
+    void resetRender(int lane);
+
+    // 界面线程调用，排队交给音频线程
+    void startOutput();
+    void suspendOutput();
+    void resumeOutput();
+    void stopOutput();
+    void onOutputError();
+
+    // 停止输出，清空所有通道并在当前通道中从 startFrame 开始解码 url
+    void resetStream(const QUrl &url, qint64 startFrame);
+
+    // 让通道从 startFrame 开始解码 url（url 为空时清空），不等待解码线程，重置完成前输出回调不读取该通道
+    void loadLane(int lane, const QUrl &url, qint64 startFrame);
+    int freeLane() const;
+    void releaseIdleLanes();
+    void requestCrossfade(int lane, qint64 ms);
+    void updateCrossfade();
+
+    void onTrackStarted(int lane, quint64 generation, int serial, const QUrl &url, qint64 streamFrame, qint64 baseFrame);
+    void onTrackDurationChanged(int lane, quint64 generation, int serial, qint64 frames);
+    void onStreamEndChanged(int lane, quint64 generation, qint64 streamFrame);
+    void onTrackError(int lane, quint64 generation, int serial, const QString &message);
+
+    qint64 playedFrames(int lane) const;
+    void updateClock();
+
+    void setState(QMediaPlayer::PlaybackState state);
+    void setStatus(QMediaPlayer::MediaStatus status);
+
+private:
+    QAudioFormat m_format;
+
+    QThread *m_audioThread;
+    QObject *m_output;                  // 音频线程中的上下文对象，输出设备与数据源都属于它
+    QAudioSink *m_sink;                 // 仅在音频线程中访问
+    Stream *m_stream;
+    QAudio::State m_outputState;        // 界面线程记录的输出状态
+
+    // 输出回调发布：回调结束时设备缓冲中尚未播放的帧数与当时的时刻（m_audioClock）
+    QElapsedTimer m_audioClock;
+    std::atomic<qint64> m_deviceFrames;
+    std::atomic<qint64> m_deviceTimeNs;
+
+    QThread *m_decodeThread;
+    Lane m_lanes[LaneCount];
+    int m_lane;                         // 当前音轨所在的通道
+    int m_preparedLane;                 // 为自然结束的淡化预先载入下一首的通道，-1 表示无
+
+    // 界面线程发出的切换请求，输出回调在下一次读取时接受
+    std::atomic_int m_requestLane;
+    std::atomic<qint64> m_requestFadeFrames;
+    // 输出回调正在读取的通道，供界面线程判断哪些通道空闲
+    std::atomic_int m_renderInLane;
+    std::atomic_int m_renderOutLane;
+
+    // 仅音频线程使用（输出回调与 resetRender）
+    int m_inLane;                       // 正在播放（或淡入）的通道
+    int m_outLane;                      // 正在淡出的通道，-1 表示无
+    qint64 m_fadeLength;
+    qint64 m_fadeInPos;
+    qint64 m_fadeOutPos;
+    bool m_primed;                      // 本次输出开始后是否读到过数据
+    bool m_starved;                     // 上一次读取时数据不足
+    QVector<float> m_mixBuffer;         // 开始输出时分配，回调中不改变大小
+    QVector<float> m_fadeBuffer;
+    QVector<float> m_gainIn;
+    QVector<float> m_gainOut;
+
+    std::atomic<qint64> m_underrunCount;
+    std::atomic<qint64> m_underrunFrames;
+
+    std::atomic<SpscRingBuffer<float> *> m_tap;
+    std::atomic_bool m_tapBusy;         // 输出回调正在访问 tap
+    std::atomic<qint64> m_tapDropped;
+
+    int m_bufferMs;
+    int m_crossfadeMs;
+    QUrl m_nextUrl;
+
+    QTimer m_clock;                     // 更新播放位置、检测音轨切换与播放结束
+    qint64 m_lastPosition;
+    qint64 m_reportedUnderruns;
+
+    QMediaPlayer::PlaybackState m_state;
+    QMediaPlayer::MediaStatus m_status;
+    float m_volume;
+    std::atomic<float> m_gain;          // 输出回调使用的音量
+    std::unique_ptr<Equalizer> m_equalizer;
+    const DspKernels *m_dsp;
+};
+
+#endif // AUDIOENGINE_H
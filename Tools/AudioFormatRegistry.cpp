@@ -0,0 +1,93 @@
+#include "AudioFormatRegistry.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMimeDatabase>
+
+const AudioFormatRegistry &AudioFormatRegistry::instance()
+{
+    static const AudioFormatRegistry registry;
+    return registry;
+}
+
+AudioFormatRegistry::AudioFormatRegistry()
+{
+    // 常见格式，MIME 数据库不完整的平台上也能识别
+    static const char *const kBuiltinSuffixes[] = {
+        "mp3", "mp2", "flac", "ogg", "oga", "opus", "wav", "m4a", "m4b", "aac",
+        "wma", "aif", "aiff", "ape", "wv", "mka", "alac", "amr", "au", "dsf",
+    };
+    for (const char *suffix : kBuiltinSuffixes) {
+        m_suffixes.insert(QString::fromLatin1(suffix));
+    }
+
+    const QList<QMimeType> mimes = QMimeDatabase().allMimeTypes();
+    for (const QMimeType &mime : mimes) {
+        if (!mime.name().startsWith("audio/")) {
+            continue;
+        }
+        for (const QString &suffix : mime.suffixes()) {
+            m_suffixes.insert(suffix.toLower());
+        }
+    }
+
+    for (const QString &suffix : std::as_const(m_suffixes)) {
+        m_nameFilters.append("*." + suffix);
+    }
+    m_nameFilters.sort();
+}
+
+bool AudioFormatRegistry::isAudioFile(const QString &filePath, bool verifyContent) const
+{
+    if (!isAudioSuffix(QFileInfo(filePath).suffix())) {
+        // 未知扩展名只在要求校验内容时通过签名识别
+        return verifyContent && hasAudioSignature(filePath);
+    }
+    return !verifyContent || hasAudioSignature(filePath);
+}
+
+bool AudioFormatRegistry::isAudioSuffix(const QString &suffix) const
+{
+    return !suffix.isEmpty() && m_suffixes.contains(suffix.toLower());
+}
+
+bool AudioFormatRegistry::hasAudioSignature(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QByteArray head = file.read(12);
+    if (head.size() < 4) {
+        return false;
+    }
+
+    const uchar b0 = uchar(head[0]);
+    const uchar b1 = uchar(head[1]);
+
+    if (head.startsWith("ID3") || head.startsWith("fLaC") || head.startsWith("OggS")
+        || head.startsWith("MAC ") || head.startsWith("wvpk") || head.startsWith("#!AMR")
+        || head.startsWith(".snd") || head.startsWith("DSD ")) {
+        return true;
+    }
+    // MPEG 音频帧同步字，或 ADTS 封装的 AAC
+    if (b0 == 0xFF && (b1 & 0xE0) == 0xE0) {
+        return true;
+    }
+    if (head.size() >= 12) {
+        const QByteArray form = head.mid(8, 4);
+        if (head.startsWith("RIFF") && form == "WAVE") return true;
+        if (head.startsWith("FORM") && (form == "AIFF" || form == "AIFC")) return true;
+        if (head.mid(4, 4) == "ftyp") return true;
+    }
+    // ASF (WMA) 头对象 GUID 的前 4 字节
+    if (head.startsWith(QByteArray("\x30\x26\xB2\x75", 4))) {
+        return true;
+    }
+    // Matroska (MKA) 的 EBML 头
+    if (head.startsWith(QByteArray("\x1A\x45\xDF\xA3", 4))) {
+        return true;
+    }
+    return false;
+}
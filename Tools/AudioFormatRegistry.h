@@ -0,0 +1,37 @@
+#ifndef AUDIOFORMATREGISTRY_H
+#define AUDIOFORMATREGISTRY_H
+
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief The AudioFormatRegistry class
+ * 预先计算的音频格式表
+ *
+ * 启动后只从 MIME 数据库中收集一次音频类型的扩展名，之后按扩展名快速判断，不再逐个文件嗅探内容。
+ * 需要时可以额外读取文件开头的少量字节校验文件签名。扫描器、文件对话框与拖放共用同一份数据。
+ */
+class AudioFormatRegistry
+{
+public:
+    static const AudioFormatRegistry &instance();
+
+    // 先按扩展名判断；verifyContent 为 true 时再校验文件签名（无扩展名的文件也通过签名识别）
+    bool isAudioFile(const QString &filePath, bool verifyContent = false) const;
+    bool isAudioSuffix(const QString &suffix) const;
+
+    // 读取文件开头 12 字节判断是否为已知的音频容器
+    static bool hasAudioSignature(const QString &filePath);
+
+    // 文件对话框使用的通配符（*.mp3 *.flac ...）
+    const QStringList &nameFilters() const { return m_nameFilters; }
+
+private:
+    AudioFormatRegistry();
+
+    QSet<QString> m_suffixes;       // 小写扩展名
+    QStringList m_nameFilters;
+};
+
+#endif // AUDIOFORMATREGISTRY_H
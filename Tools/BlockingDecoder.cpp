@@ -0,0 +1,87 @@
+#include "BlockingDecoder.h"
+#include "DspKernels.h"
+
+#include <QAudioBuffer>
+#include <QAudioDecoder>
+#include <QDebug>
+#include <QEventLoop>
+#include <QUrl>
+#include <QVector>
+
+bool BlockingDecoder::decode(const QString &filePath, const std::atomic_bool &canceled, const Sink &sink)
+{
+    QAudioDecoder decoder;
+    QEventLoop loop;
+    QVector<float> samples;
+    bool done = false;
+    bool failed = false;
+
+    auto quit = [&]() {
+        done = true;
+        loop.quit();
+    };
+
+    QObject::connect(&decoder, &QAudioDecoder::bufferReady, &loop, [&]() {
+        const QAudioBuffer buffer = decoder.read();
+        if (canceled.load()) {
+            decoder.stop();
+            quit();
+            return;
+        }
+        if (!buffer.isValid()) {
+            return;
+        }
+
+        QAudioFormat format = buffer.format();
+        const qint64 frames = buffer.frameCount();
+        const qint64 count = frames * format.channelCount();
+        const DspKernels &dsp = DspKernels::instance();
+        const float *data = nullptr;
+
+        switch (format.sampleFormat()) {
+        case QAudioFormat::Float:
+            data = buffer.constData<float>();
+            break;
+        case QAudioFormat::Int16:
+            samples.resize(count);
+            dsp.int16ToFloat(buffer.constData<qint16>(), samples.data(), count);
+            data = samples.constData();
+            break;
+        case QAudioFormat::Int32:
+            samples.resize(count);
+            dsp.int32ToFloat(buffer.constData<qint32>(), samples.data(), count);
+            data = samples.constData();
+            break;
+        case QAudioFormat::UInt8: {
+            samples.resize(count);
+            const quint8 *src = buffer.constData<quint8>();
+            for (qint64 i = 0; i < count; ++i) {
+                samples[i] = (int(src[i]) - 128) * (1.0f / 128.0f);
+            }
+            data = samples.constData();
+            break;
+        }
+        default:
+            return;
+        }
+
+        format.setSampleFormat(QAudioFormat::Float);
+        sink(format, data, frames);
+    });
+    QObject::connect(&decoder, &QAudioDecoder::finished, &loop, quit);
+    QObject::connect(&decoder, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), &loop, [&]() {
+        qWarning() << "Failed to decode" << filePath << ":" << decoder.errorString();
+        failed = true;
+        quit();
+    });
+
+    decoder.setSource(QUrl::fromLocalFile(filePath));
+    decoder.start();
+    // 启动失败时可能已经同步发出了错误
+    if (!done) {
+        loop.exec();
+    }
+    decoder.stop();
+
+    return !failed && !canceled.load();
+}
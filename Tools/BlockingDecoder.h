@@ -0,0 +1,27 @@
+#ifndef BLOCKINGDECODER_H
+#define BLOCKINGDECODER_H
+
+#include <QAudioFormat>
+#include <QString>
+
+#include <atomic>
+#include <functional>
+
+/**
+ * @brief The BlockingDecoder class
+ * 在调用线程中完整解码一个本地文件（用于后台分析，不用于播放）
+ *
+ * QAudioDecoder 的信号在局部事件循环中处理，因此可以在线程池的工作线程中使用。
+ * 不设置输出格式，采样率与声道数保持文件本身的值，采样统一转换为交错的 float 后交给回调。
+ */
+class BlockingDecoder
+{
+public:
+    // format 中的采样格式总是 Float
+    using Sink = std::function<void(const QAudioFormat &format, const float *data, qint64 frames)>;
+
+    // 解码完成返回 true；出错或 canceled 被置位时提前返回 false
+    static bool decode(const QString &filePath, const std::atomic_bool &canceled, const Sink &sink);
+};
+
+#endif // BLOCKINGDECODER_H
@@ -0,0 +1,239 @@
+#include "DecodeWorker.h"
+#include "TrackDecoder.h"
+
+#include <QThread>
+#include <QTimer>
+
+namespace {
+
+// 每个解码器在环形缓冲区之外最多缓冲几个环形缓冲区容量的解码结果
+constexpr qint64 DecodeAheadRings = 4;
+
+// 当前音轨剩余不到这么多秒时开始预解码下一首（缓冲有上限，当前音轨可能很晚才解码完）
+constexpr qint64 PrerollSeconds = 5;
+
+} // namespace
+
+DecodeWorker::DecodeWorker(DecodeLane *lane, QObject *parent)
+    : QObject{parent}
+    , m_lane(lane)
+    , m_pumpTimer(new QTimer(this))
+    , m_generation(0)
+    , m_channels(2)
+    , m_current(nullptr)
+    , m_currentSerial(0)
+    , m_currentBase(0)
+    , m_currentStarted(false)
+    , m_next(nullptr)
+    , m_nextSerial(0)
+    , m_serialCounter(0)
+    , m_loudness(nullptr)
+    , m_gainMode(LoudnessCache::GainOff)
+    , m_preampDb(0.0)
+    , m_resampleQuality(Resampler::High)
+    , m_writtenFrames(0)
+    , m_streamEnd(-1)
+{
+    // 解码器没有新数据的通知，环形缓冲区满或解码跟不上时定期检查
+    m_pumpTimer->setInterval(10);
+    connect(m_pumpTimer, &QTimer::timeout, this, &DecodeWorker::pump);
+}
+
+DecodeWorker::~DecodeWorker()
+{
+    deleteDecoders();
+}
+
+void DecodeWorker::reset(quint64 generation, const QAudioFormat &format, qsizetype ringCapacity,
+                         const QUrl &url, qint64 startFrame, const QUrl &nextUrl)
+{
+    deleteDecoders();
+
+    m_generation = generation;
+    m_format = format;
+    m_channels = qMax(1, format.channelCount());
+
+    // 请求方已更新 requested，输出回调不会再开始读取，只需等待正在进行的一次读取结束
+    while (m_lane->reading.load()) {
+        QThread::yield();
+    }
+
+    // 容量按整帧取整，保证读写都以整帧为单位
+    m_lane->ring.reset(qMax<qsizetype>(m_channels, ringCapacity));
+    m_lane->readFrames.store(0, std::memory_order_relaxed);
+    m_writtenFrames = 0;
+    m_streamEnd = -1;
+    m_lane->streamDone.store(false, std::memory_order_release);
+    m_lane->ready.store(generation);
+
+    m_serialCounter = 0;
+    m_nextUrl = nextUrl;
+
+    if (url.isEmpty()) {
+        m_pumpTimer->stop();
+        return;
+    }
+
+    m_currentSerial = m_serialCounter++;
+    m_currentBase = qMax<qint64>(0, startFrame);
+    m_currentStarted = false;
+    m_current = createDecoder(url, startFrame, m_currentSerial);
+    m_pumpTimer->start();
+}
+
+void DecodeWorker::setNext(const QUrl &url)
+{
+    if (url == m_nextUrl && (m_next || url.isEmpty())) {
+        return;
+    }
+
+    if (m_next) {
+        m_next->disconnect(this);
+        m_next->stop();
+        m_next->deleteLater();
+        m_next = nullptr;
+    }
+    m_nextUrl = url;
+
+    // 最后一首已经写完但还没播放完时，仍然可以接上
+    if (!url.isEmpty() && m_streamEnd >= 0) {
+        setStreamEnd(-1);
+    }
+
+    startPreroll();
+    pump();
+}
+
+void DecodeWorker::setReplayGain(LoudnessCache *cache, LoudnessCache::GainMode mode, double preampDb)
+{
+    m_loudness = cache;
+    m_gainMode = mode;
+    m_preampDb = preampDb;
+}
+
+void DecodeWorker::setResampleQuality(Resampler::Quality quality)
+{
+    m_resampleQuality = quality;
+}
+
+TrackDecoder *DecodeWorker::createDecoder(const QUrl &url, qint64 startFrame, int serial)
+{
+    TrackDecoder *decoder = new TrackDecoder(this);
+    const quint64 generation = m_generation;
+
+    connect(decoder, &TrackDecoder::durationChanged, this, [this, generation, serial](qint64 frames) {
+        emit durationChanged(generation, serial, frames);
+    });
+    connect(decoder, &TrackDecoder::errorOccurred, this, [this, generation, serial](const QString &message) {
+        emit errorOccurred(generation, serial, message);
+    });
+    connect(decoder, &TrackDecoder::decodingFinished, this, [this, decoder]() {
+        // 正在写入的音轨解码完成后开始预解码下一首
+        if (decoder == m_current) {
+            startPreroll();
+        }
+        pump();
+    });
+
+    if (m_loudness && url.isLocalFile()) {
+        decoder->setGain(m_loudness->gain(url.toLocalFile(), m_gainMode, m_preampDb));
+    }
+    decoder->setResampleQuality(m_resampleQuality);
+    decoder->setBufferLimit(DecodeAheadRings * m_lane->ring.capacity() / m_channels);
+    decoder->start(url, m_format, startFrame);
+    return decoder;
+}
+
+void DecodeWorker::deleteDecoders()
+{
+    for (TrackDecoder *decoder : {m_current, m_next}) {
+        if (decoder) {
+            decoder->disconnect(this);
+            decoder->stop();
+            decoder->deleteLater();
+        }
+    }
+    m_current = nullptr;
+    m_next = nullptr;
+}
+
+void DecodeWorker::startPreroll()
+{
+    if (m_next || m_nextUrl.isEmpty() || !m_current) {
+        return;
+    }
+    // 当前音轨解码完成（输入结束）或只剩最后几秒时开始，两个解码器同时工作的时间很短
+    const qint64 remaining = m_current->remainingFrames();
+    if (!m_current->isDecodingFinished()
+        && (remaining < 0 || remaining > PrerollSeconds * m_format.sampleRate())) {
+        return;
+    }
+
+    m_nextSerial = m_serialCounter++;
+    m_next = createDecoder(m_nextUrl, 0, m_nextSerial);
+}
+
+void DecodeWorker::pump()
+{
+    startPreroll();
+
+    while (m_current) {
+        const qint64 space = m_lane->ring.writeAvailable() / m_channels;
+        if (space <= 0) {
+            return;
+        }
+
+        const qint64 frames = qMin<qint64>(space, 4096);
+        if (m_scratch.size() < frames * m_channels) {
+            m_scratch.resize(frames * m_channels);
+        }
+
+        const qint64 n = m_current->read(m_scratch.data(), frames);
+        if (n > 0) {
+            if (!m_currentStarted) {
+                m_currentStarted = true;
+                emit trackStarted(m_generation, m_currentSerial, m_current->source(), m_writtenFrames, m_currentBase);
+            }
+            m_lane->ring.write(m_scratch.constData(), n * m_channels);
+            m_writtenFrames += n;
+            continue;
+        }
+
+        if (!m_current->atEnd()) {
+            return;     // 等待解码
+        }
+
+        if (!m_next) {
+            // 没有下一首，流到此结束
+            setStreamEnd(m_writtenFrames);
+            return;
+        }
+
+        // 当前音轨已全部写入，紧接着写下一首
+        m_current->disconnect(this);
+        m_current->deleteLater();
+
+        m_current = m_next;
+        m_currentSerial = m_nextSerial;
+        m_currentBase = 0;
+        m_currentStarted = false;
+        m_next = nullptr;
+        m_nextUrl.clear();
+    }
+}
+
+void DecodeWorker::setStreamEnd(qint64 streamFrame)
+{
+    if (m_streamEnd == streamFrame) {
+        return;
+    }
+
+    m_streamEnd = streamFrame;
+    m_lane->streamDone.store(streamFrame >= 0, std::memory_order_release);
+    if (streamFrame >= 0) {
+        m_pumpTimer->stop();
+    } else {
+        m_pumpTimer->start();
+    }
+    emit streamEndChanged(m_generation, streamFrame);
+}
@@ -0,0 +1,103 @@
+#ifndef DECODEWORKER_H
+#define DECODEWORKER_H
+
+#include <QAudioFormat>
+#include <QObject>
+#include <QUrl>
+#include <QVector>
+
+#include <atomic>
+
+#include "LoudnessCache.h"
+#include "Resampler.h"
+#include "SpscRingBuffer.h"
+
+class QTimer;
+class TrackDecoder;
+
+// 解码线程与输出回调共享的通道状态
+struct DecodeLane
+{
+    SpscRingBuffer<float> ring;
+    std::atomic_bool streamDone{false};     // 最后一帧已写入环形缓冲区
+    std::atomic<qint64> readFrames{0};      // 已从环形缓冲区读出的帧数（不含补入的静音）
+
+    // 重置不等待解码线程：请求方先更新 requested，解码线程重置完成后把 ready 设为相同的代号，
+    // 两者不同时输出回调不读取该通道；reading 为输出回调正在读取的标记，解码线程等待它清除后才重置环形缓冲区
+    std::atomic<quint64> requested{0};
+    std::atomic<quint64> ready{0};
+    std::atomic_bool reading{false};
+};
+
+/**
+ * @brief The DecodeWorker class
+ * 解码线程中的工作对象（由 AudioEngine 创建并移入解码线程）
+ *
+ * 持有当前与预解码的下一首 TrackDecoder，把解码结果写入环形缓冲区（环形缓冲区的唯一写端）。
+ * 当前音轨写完后直接接着写下一首，并发出 trackStarted 告知下一首在输出流中的起始帧；没有下一首时发出 streamEndChanged。
+ * 所有信号都带有 generation，AudioEngine 据此丢弃 reset 之前发出、尚未处理的信号。
+ * reset 是异步的，通道的 ready 代号表示最近一次完成的重置（见 DecodeLane）。
+ */
+class DecodeWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DecodeWorker(DecodeLane *lane, QObject *parent = nullptr);
+    ~DecodeWorker();
+
+    // 以下函数只在解码线程中调用
+
+    // 等待读端离开通道后清空环形缓冲区，并从 startFrame 开始解码 url（url 为空时只清空）
+    // 调用前请求方应已把通道的 requested 设为 generation
+    void reset(quint64 generation, const QAudioFormat &format, qsizetype ringCapacity,
+               const QUrl &url, qint64 startFrame, const QUrl &nextUrl);
+    void setNext(const QUrl &url);
+    // 之后创建的解码器按 cache 中的分析结果施加回放增益（cache 为空时不施加）
+    void setReplayGain(LoudnessCache *cache, LoudnessCache::GainMode mode, double preampDb);
+    // 之后创建的解码器在音轨采样率与输出不同时使用的转换质量
+    void setResampleQuality(Resampler::Quality quality);
+
+signals:
+    // 音轨的第一帧已写入环形缓冲区，streamFrame 为其在输出流中的位置，serial 为 reset 之后第几首（从 0 开始）
+    void trackStarted(quint64 generation, int serial, const QUrl &url, qint64 streamFrame, qint64 baseFrame);
+    void durationChanged(quint64 generation, int serial, qint64 frames);
+    // 最后一首已全部写入，streamFrame 为流的总帧数；之后又设置了下一首时以 -1 撤销
+    void streamEndChanged(quint64 generation, qint64 streamFrame);
+    void errorOccurred(quint64 generation, int serial, const QString &message);
+
+private:
+    TrackDecoder *createDecoder(const QUrl &url, qint64 startFrame, int serial);
+    void deleteDecoders();
+    void startPreroll();
+    void pump();
+    void setStreamEnd(qint64 streamFrame);
+
+private:
+    DecodeLane *m_lane;                 // streamDone 与 streamEndChanged 同步，供读端区分播放结束与缓冲不足
+    QTimer *m_pumpTimer;                // 环形缓冲区满时定期继续写入
+
+    quint64 m_generation;
+    QAudioFormat m_format;
+    int m_channels;
+
+    TrackDecoder *m_current;
+    int m_currentSerial;
+    qint64 m_currentBase;
+    bool m_currentStarted;              // 当前音轨是否已写入过数据
+
+    TrackDecoder *m_next;
+    QUrl m_nextUrl;
+    int m_nextSerial;
+    int m_serialCounter;                // 下一个创建的解码器的 serial
+
+    LoudnessCache *m_loudness;
+    LoudnessCache::GainMode m_gainMode;
+    double m_preampDb;
+    Resampler::Quality m_resampleQuality;
+
+    qint64 m_writtenFrames;             // 已写入环形缓冲区的帧数
+    qint64 m_streamEnd;
+    QVector<float> m_scratch;
+};
+
+#endif // DECODEWORKER_H
@@ -0,0 +1,777 @@
+#include "DspKernels.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DSP_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#else
+#define DSP_X86 0
+#endif
+
+#if DSP_X86 && (defined(__GNUC__) || defined(__clang__))
+#define DSP_TARGET_SSE2 __attribute__((target("sse2")))
+#define DSP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DSP_TARGET_SSE2
+#define DSP_TARGET_AVX2
+#endif
+
+namespace {
+
+constexpr float Int16Scale = 1.0f / 32768.0f;
+constexpr float Int24Scale = 1.0f / 8388608.0f;
+constexpr float Int32Scale = 1.0f / 2147483648.0f;
+
+inline qint32 load24(const uchar *p)
+{
+    // 放到高 24 位再算术右移，完成符号扩展
+    return qint32(quint32(p[0]) << 8 | quint32(p[1]) << 16 | quint32(p[2]) << 24) >> 8;
+}
+
+// 标量实现，也是向量实现处理尾部与测试比对时的基准
+namespace scalar {
+
+void applyGain(float *data, qint64 count, float gain)
+{
+    for (qint64 i = 0; i < count; ++i) {
+        data[i] *= gain;
+    }
+}
+
+void mixWeighted(float *dst, const float *a, const float *b, const float *gainA, const float *gainB, qint64 count)
+{
+    for (qint64 i = 0; i < count; ++i) {
+        // 与向量实现一样分别相乘再相加（本文件以 -ffp-contract=off 编译，不会被合并为 FMA）
+        dst[i] = a[i] * gainA[i] + b[i] * gainB[i];
+    }
+}
+
+void multiply(float *dst, const float *a, const float *b, qint64 count)
+{
+    for (qint64 i = 0; i < count; ++i) {
+        dst[i] = a[i] * b[i];
+    }
+}
+
+void fftButterfly(float *re0, float *im0, float *re1, float *im1, const float *wr, const float *wi, qint64 count)
+{
+    for (qint64 i = 0; i < count; ++i) {
+        const float tr = re1[i] * wr[i] - im1[i] * wi[i];
+        const float ti = re1[i] * wi[i] + im1[i] * wr[i];
+        re1[i] = re0[i] - tr;
+        im1[i] = im0[i] - ti;
+        re0[i] = re0[i] + tr;
+        im0[i] = im0[i] + ti;
+    }
+}
+
+void magnitude(const float *re, const float *im, float *dst, qint64 count)
+{
+    for (qint64 i = 0; i < count; ++i) {
+        // sqrtss 与 sqrtps 都是正确舍入的，结果一致
+        dst[i] = std::sqrt(re[i] * re[i] + im[i] * im[i]);
+    }
+}
+
+// 8 个部分和按固定顺序合并：先 i 与 i + 4，再 0 与 2、1 与 3，最后两者相加（与向量实现的水平相加相同）
+float reduce8(const float *acc)
+{
+    const float s0 = acc[0] + acc[4];
+    const float s1 = acc[1] + acc[5];
+    const float s2 = acc[2] + acc[6];
+    const float s3 = acc[3] + acc[7];
+    return (s0 + s2) + (s1 + s3);
+}
+
+// 从第 i 个开始把剩余的乘积依次加到 sum 上
+float dotTail(float sum, const float *a, const float *b, qint64 i, qint64 count)
+{
+    for (; i < count; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+float dotProduct(const float *a, const float *b, qint64 count)
+{
+    // 每 8 个一组分别累加到 8 个部分和，对应向量实现的 8 个通道
+    float acc[8] = {};
+    qint64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        for (int k = 0; k < 8; ++k) {
+            acc[k] += a[i + k] * b[i + k];
+        }
+    }
+    return dotTail(reduce8(acc), a, b, i, count);
+}
+
+void biquadCascade(float *data, int channels, qint64 frames, const float *coeffs, float *state, int sections)
+{
+    for (int s = 0; s < sections; ++s) {
+        const float *c = coeffs + s * 5;
+        const float b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+        float *s1 = state + s * 2 * channels;
+        float *s2 = s1 + channels;
+        for (int ch = 0; ch < channels; ++ch) {
+            float z1 = s1[ch];
+            float z2 = s2[ch];
+            for (qint64 i = 0; i < frames; ++i) {
+                float &v = data[i * channels + ch];
+                const float x = v;
+                const float y = b0 * x + z1;
+                z1 = (b1 * x - a1 * y) + z2;
+                z2 = b2 * x - a2 * y;
+                v = y;
+            }
+            s1[ch] = z1;
+            s2[ch] = z2;
+        }
+    }
+}
+
+void floatToInt16(const float *src, qint16 *dst, qint64 count)
+{
+    for (qint64 i = 0; i < count; ++i) {
+        // 与 maxps/minps 的语义一致：比较不成立（包括 NaN）时取第二个操作数
+        float v = src[i] * 32768.0f;
+        v = v > -32768.0f ? v : -32768.0f;
+        v = v < 32767.0f ? v : 32767.0f;
+        dst[i] = qint16(std::lrintf(v));
+    }
+}
+
+void int16ToFloat(const qint16 *src, float *dst, qint64 count)
+{
+    for (qint64 i = 0; i < count; ++i) {
+        dst[i] = float(src[i]) * Int16Scale;
+    }
+}
+
+void int24ToFloat(const uchar *src, float *dst, qint64 count)
+{
+    for (qint64 i = 0; i < count; ++i) {
+        dst[i] = float(load24(src + i * 3)) * Int24Scale;
+    }
+}
+
+void int32ToFloat(const qint32 *src, float *dst, qint64 count)
+{
+    for (qint64 i = 0; i < count; ++i) {
+        dst[i] = float(src[i]) * Int32Scale;
+    }
+}
+
+void deinterleaveStereo(const float *src, float *left, float *right, qint64 frames)
+{
+    for (qint64 i = 0; i < frames; ++i) {
+        left[i] = src[2 * i];
+        right[i] = src[2 * i + 1];
+    }
+}
+
+void interleaveStereo(const float *left, const float *right, float *dst, qint64 frames)
+{
+    for (qint64 i = 0; i < frames; ++i) {
+        dst[2 * i] = left[i];
+        dst[2 * i + 1] = right[i];
+    }
+}
+
+} // namespace scalar
+
+#if DSP_X86
+
+namespace sse2 {
+
+DSP_TARGET_SSE2 void applyGain(float *data, qint64 count, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    qint64 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), g));
+    }
+    scalar::applyGain(data + i, count - i, gain);
+}
+
+DSP_TARGET_SSE2 void mixWeighted(float *dst, const float *a, const float *b, const float *gainA, const float *gainB, qint64 count)
+{
+    qint64 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 x = _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(gainA + i));
+        const __m128 y = _mm_mul_ps(_mm_loadu_ps(b + i), _mm_loadu_ps(gainB + i));
+        _mm_storeu_ps(dst + i, _mm_add_ps(x, y));
+    }
+    scalar::mixWeighted(dst + i, a + i, b + i, gainA + i, gainB + i, count - i);
+}
+
+DSP_TARGET_SSE2 void multiply(float *dst, const float *a, const float *b, qint64 count)
+{
+    qint64 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    scalar::multiply(dst + i, a + i, b + i, count - i);
+}
+
+DSP_TARGET_SSE2 void fftButterfly(float *re0, float *im0, float *re1, float *im1, const float *wr, const float *wi, qint64 count)
+{
+    qint64 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 xr = _mm_loadu_ps(re1 + i);
+        const __m128 xi = _mm_loadu_ps(im1 + i);
+        const __m128 c = _mm_loadu_ps(wr + i);
+        const __m128 s = _mm_loadu_ps(wi + i);
+        const __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, c), _mm_mul_ps(xi, s));
+        const __m128 ti = _mm_add_ps(_mm_mul_ps(xr, s), _mm_mul_ps(xi, c));
+        const __m128 yr = _mm_loadu_ps(re0 + i);
+        const __m128 yi = _mm_loadu_ps(im0 + i);
+        _mm_storeu_ps(re1 + i, _mm_sub_ps(yr, tr));
+        _mm_storeu_ps(im1 + i, _mm_sub_ps(yi, ti));
+        _mm_storeu_ps(re0 + i, _mm_add_ps(yr, tr));
+        _mm_storeu_ps(im0 + i, _mm_add_ps(yi, ti));
+    }
+    scalar::fftButterfly(re0 + i, im0 + i, re1 + i, im1 + i, wr + i, wi + i, count - i);
+}
+
+DSP_TARGET_SSE2 void magnitude(const float *re, const float *im, float *dst, qint64 count)
+{
+    qint64 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 r = _mm_loadu_ps(re + i);
+        const __m128 m = _mm_loadu_ps(im + i);
+        _mm_storeu_ps(dst + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(m, m))));
+    }
+    scalar::magnitude(re + i, im + i, dst + i, count - i);
+}
+
+DSP_TARGET_SSE2 float dotProduct(const float *a, const float *b, qint64 count)
+{
+    // 两个向量分别对应标量实现的部分和 0..3 与 4..7
+    __m128 lo = _mm_setzero_ps();
+    __m128 hi = _mm_setzero_ps();
+    qint64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        lo = _mm_add_ps(lo, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        hi = _mm_add_ps(hi, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    const __m128 s = _mm_add_ps(lo, hi);
+    const __m128 t = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    const float sum = _mm_cvtss_f32(_mm_add_ss(t, _mm_shuffle_ps(t, t, 1)));
+    return scalar::dotTail(sum, a, b, i, count);
+}
+
+// 读写一帧中连续的 Lanes 个声道，其余通道为 0 且不写回
+template <int Lanes>
+DSP_TARGET_SSE2 inline __m128 loadLanes(const float *p)
+{
+    if constexpr (Lanes == 4) {
+        return _mm_loadu_ps(p);
+    } else if constexpr (Lanes == 3) {
+        return _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(p))), _mm_load_ss(p + 2));
+    } else if constexpr (Lanes == 2) {
+        return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(p)));
+    } else {
+        return _mm_load_ss(p);
+    }
+}
+
+template <int Lanes>
+DSP_TARGET_SSE2 inline void storeLanes(float *p, __m128 v)
+{
+    if constexpr (Lanes == 4) {
+        _mm_storeu_ps(p, v);
+    } else if constexpr (Lanes == 3) {
+        _mm_store_sd(reinterpret_cast<double *>(p), _mm_castps_pd(v));
+        _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+    } else if constexpr (Lanes == 2) {
+        _mm_store_sd(reinterpret_cast<double *>(p), _mm_castps_pd(v));
+    } else {
+        _mm_store_ss(p, v);
+    }
+}
+
+// 一节滤波作用于从 data 开始的 Lanes 个声道，stride 为一帧的采样数
+template <int Lanes>
+DSP_TARGET_SSE2 void biquadLanes(float *data, int stride, qint64 frames, const float *c, float *s1, float *s2)
+{
+    const __m128 b0 = _mm_set1_ps(c[0]);
+    const __m128 b1 = _mm_set1_ps(c[1]);
+    const __m128 b2 = _mm_set1_ps(c[2]);
+    const __m128 a1 = _mm_set1_ps(c[3]);
+    const __m128 a2 = _mm_set1_ps(c[4]);
+    __m128 z1 = loadLanes<Lanes>(s1);
+    __m128 z2 = loadLanes<Lanes>(s2);
+    for (qint64 i = 0; i < frames; ++i) {
+        float *p = data + i * stride;
+        const __m128 x = loadLanes<Lanes>(p);
+        const __m128 y = _mm_add_ps(_mm_mul_ps(b0, x), z1);
+        z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), z2);
+        z2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+        storeLanes<Lanes>(p, y);
+    }
+    storeLanes<Lanes>(s1, z1);
+    storeLanes<Lanes>(s2, z2);
+}
+
+DSP_TARGET_SSE2 void biquadCascade(float *data, int channels, qint64 frames, const float *coeffs, float *state, int sections)
+{
+    for (int s = 0; s < sections; ++s) {
+        const float *c = coeffs + s * 5;
+        float *s1 = state + s * 2 * channels;
+        float *s2 = s1 + channels;
+        // 每 4 个声道一组
+        for (int ch = 0; ch < channels; ch += 4) {
+            switch (qMin(4, channels - ch)) {
+            case 4:
+                biquadLanes<4>(data + ch, channels, frames, c, s1 + ch, s2 + ch);
+                break;
+            case 3:
+                biquadLanes<3>(data + ch, channels, frames, c, s1 + ch, s2 + ch);
+                break;
+            case 2:
+                biquadLanes<2>(data + ch, channels, frames, c, s1 + ch, s2 + ch);
+                break;
+            default:
+                biquadLanes<1>(data + ch, channels, frames, c, s1 + ch, s2 + ch);
+                break;
+            }
+        }
+    }
+}
+
+DSP_TARGET_SSE2 void floatToInt16(const float *src, qint16 *dst, qint64 count)
+{
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    qint64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), lo), hi);
+        const __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale), lo), hi);
+        const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+    }
+    scalar::floatToInt16(src + i, dst + i, count - i);
+}
+
+DSP_TARGET_SSE2 void int16ToFloat(const qint16 *src, float *dst, qint64 count)
+{
+    const __m128 scale = _mm_set1_ps(Int16Scale);
+    qint64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    scalar::int16ToFloat(src + i, dst + i, count - i);
+}
+
+DSP_TARGET_SSE2 void int24ToFloat(const uchar *src, float *dst, qint64 count)
+{
+    // SSE2 没有字节重排指令，逐个取出后一起转换
+    const __m128 scale = _mm_set1_ps(Int24Scale);
+    qint64 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const uchar *p = src + i * 3;
+        const __m128i v = _mm_setr_epi32(load24(p), load24(p + 3), load24(p + 6), load24(p + 9));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+    scalar::int24ToFloat(src + i * 3, dst + i, count - i);
+}
+
+DSP_TARGET_SSE2 void int32ToFloat(const qint32 *src, float *dst, qint64 count)
+{
+    const __m128 scale = _mm_set1_ps(Int32Scale);
+    qint64 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+    scalar::int32ToFloat(src + i, dst + i, count - i);
+}
+
+DSP_TARGET_SSE2 void deinterleaveStereo(const float *src, float *left, float *right, qint64 frames)
+{
+    qint64 i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 a = _mm_loadu_ps(src + 2 * i);
+        const __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+        _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    scalar::deinterleaveStereo(src + 2 * i, left + i, right + i, frames - i);
+}
+
+DSP_TARGET_SSE2 void interleaveStereo(const float *left, const float *right, float *dst, qint64 frames)
+{
+    qint64 i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 l = _mm_loadu_ps(left + i);
+        const __m128 r = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(l, r));
+    }
+    scalar::interleaveStereo(left + i, right + i, dst + 2 * i, frames - i);
+}
+
+} // namespace sse2
+
+namespace avx2 {
+
+DSP_TARGET_AVX2 void applyGain(float *data, qint64 count, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    qint64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), g));
+    }
+    scalar::applyGain(data + i, count - i, gain);
+}
+
+DSP_TARGET_AVX2 void mixWeighted(float *dst, const float *a, const float *b, const float *gainA, const float *gainB, qint64 count)
+{
+    qint64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 x = _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(gainA + i));
+        const __m256 y = _mm256_mul_ps(_mm256_loadu_ps(b + i), _mm256_loadu_ps(gainB + i));
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(x, y));
+    }
+    scalar::mixWeighted(dst + i, a + i, b + i, gainA + i, gainB + i, count - i);
+}
+
+DSP_TARGET_AVX2 void multiply(float *dst, const float *a, const float *b, qint64 count)
+{
+    qint64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    scalar::multiply(dst + i, a + i, b + i, count - i);
+}
+
+DSP_TARGET_AVX2 void fftButterfly(float *re0, float *im0, float *re1, float *im1, const float *wr, const float *wi, qint64 count)
+{
+    qint64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 xr = _mm256_loadu_ps(re1 + i);
+        const __m256 xi = _mm256_loadu_ps(im1 + i);
+        const __m256 c = _mm256_loadu_ps(wr + i);
+        const __m256 s = _mm256_loadu_ps(wi + i);
+        const __m256 tr = _mm256_sub_ps(_mm256_mul_ps(xr, c), _mm256_mul_ps(xi, s));
+        const __m256 ti = _mm256_add_ps(_mm256_mul_ps(xr, s), _mm256_mul_ps(xi, c));
+        const __m256 yr = _mm256_loadu_ps(re0 + i);
+        const __m256 yi = _mm256_loadu_ps(im0 + i);
+        _mm256_storeu_ps(re1 + i, _mm256_sub_ps(yr, tr));
+        _mm256_storeu_ps(im1 + i, _mm256_sub_ps(yi, ti));
+        _mm256_storeu_ps(re0 + i, _mm256_add_ps(yr, tr));
+        _mm256_storeu_ps(im0 + i, _mm256_add_ps(yi, ti));
+    }
+    scalar::fftButterfly(re0 + i, im0 + i, re1 + i, im1 + i, wr + i, wi + i, count - i);
+}
+
+DSP_TARGET_AVX2 void magnitude(const float *re, const float *im, float *dst, qint64 count)
+{
+    qint64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 r = _mm256_loadu_ps(re + i);
+        const __m256 m = _mm256_loadu_ps(im + i);
+        _mm256_storeu_ps(dst + i, _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(r, r), _mm256_mul_ps(m, m))));
+    }
+    scalar::magnitude(re + i, im + i, dst + i, count - i);
+}
+
+DSP_TARGET_AVX2 float dotProduct(const float *a, const float *b, qint64 count)
+{
+    __m256 acc = _mm256_setzero_ps();
+    qint64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    const __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    const __m128 t = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    const float sum = _mm_cvtss_f32(_mm_add_ss(t, _mm_shuffle_ps(t, t, 1)));
+    return scalar::dotTail(sum, a, b, i, count);
+}
+
+DSP_TARGET_AVX2 void biquadCascade(float *data, int channels, qint64 frames, const float *coeffs, float *state, int sections)
+{
+    // 不超过 4 个声道时 8 通道的向量用不满，与 SSE2 实现相同
+    if (channels <= 4) {
+        sse2::biquadCascade(data, channels, frames, coeffs, state, sections);
+        return;
+    }
+
+    for (int s = 0; s < sections; ++s) {
+        const float *c = coeffs + s * 5;
+        float *s1 = state + s * 2 * channels;
+        float *s2 = s1 + channels;
+        const __m256 b0 = _mm256_set1_ps(c[0]);
+        const __m256 b1 = _mm256_set1_ps(c[1]);
+        const __m256 b2 = _mm256_set1_ps(c[2]);
+        const __m256 a1 = _mm256_set1_ps(c[3]);
+        const __m256 a2 = _mm256_set1_ps(c[4]);
+        // 每 8 个声道一组，不满 8 个的按掩码读写
+        for (int ch = 0; ch < channels; ch += 8) {
+            const int lanes = qMin(8, channels - ch);
+            const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(lanes), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            __m256 z1 = _mm256_maskload_ps(s1 + ch, mask);
+            __m256 z2 = _mm256_maskload_ps(s2 + ch, mask);
+            for (qint64 i = 0; i < frames; ++i) {
+                float *p = data + i * channels + ch;
+                const __m256 x = _mm256_maskload_ps(p, mask);
+                const __m256 y = _mm256_add_ps(_mm256_mul_ps(b0, x), z1);
+                z1 = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(b1, x), _mm256_mul_ps(a1, y)), z2);
+                z2 = _mm256_sub_ps(_mm256_mul_ps(b2, x), _mm256_mul_ps(a2, y));
+                _mm256_maskstore_ps(p, mask, y);
+            }
+            _mm256_maskstore_ps(s1 + ch, mask, z1);
+            _mm256_maskstore_ps(s2 + ch, mask, z2);
+        }
+    }
+}
+
+DSP_TARGET_AVX2 void floatToInt16(const float *src, qint16 *dst, qint64 count)
+{
+    const __m256 scale = _mm256_set1_ps(32768.0f);
+    const __m256 lo = _mm256_set1_ps(-32768.0f);
+    const __m256 hi = _mm256_set1_ps(32767.0f);
+    qint64 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale), lo), hi);
+        const __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale), lo), hi);
+        // packs 在每个 128 位通道内交错两个输入，再按 64 位重排回顺序
+        const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    scalar::floatToInt16(src + i, dst + i, count - i);
+}
+
+DSP_TARGET_AVX2 void int16ToFloat(const qint16 *src, float *dst, qint64 count)
+{
+    const __m256 scale = _mm256_set1_ps(Int16Scale);
+    qint64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    scalar::int16ToFloat(src + i, dst + i, count - i);
+}
+
+DSP_TARGET_AVX2 void int24ToFloat(const uchar *src, float *dst, qint64 count)
+{
+    const __m256 scale = _mm256_set1_ps(Int24Scale);
+    // 第二个 128 位通道从第 12 字节开始，每个采样的 3 字节放到 32 位整数的高 24 位
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    const __m256i shuffle = _mm256_setr_epi8(
+        -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+        -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    qint64 i = 0;
+    // 每次读取 32 字节而只使用 24 字节，保证不读越界
+    for (; i + 11 <= count; i += 8) {
+        const __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 3));
+        const __m256i v = _mm256_srai_epi32(_mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(raw, lanes), shuffle), 8);
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    scalar::int24ToFloat(src + i * 3, dst + i, count - i);
+}
+
+DSP_TARGET_AVX2 void int32ToFloat(const qint32 *src, float *dst, qint64 count)
+{
+    const __m256 scale = _mm256_set1_ps(Int32Scale);
+    qint64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    scalar::int32ToFloat(src + i, dst + i, count - i);
+}
+
+DSP_TARGET_AVX2 void deinterleaveStereo(const float *src, float *left, float *right, qint64 frames)
+{
+    qint64 i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        const __m256 a = _mm256_loadu_ps(src + 2 * i);
+        const __m256 b = _mm256_loadu_ps(src + 2 * i + 8);
+        // 每个 128 位通道内取出左右声道，再按 64 位重排回顺序
+        const __m256 l = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm256_storeu_ps(left + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(l), _MM_SHUFFLE(3, 1, 2, 0))));
+        _mm256_storeu_ps(right + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0))));
+    }
+    scalar::deinterleaveStereo(src + 2 * i, left + i, right + i, frames - i);
+}
+
+DSP_TARGET_AVX2 void interleaveStereo(const float *left, const float *right, float *dst, qint64 frames)
+{
+    qint64 i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        const __m256 l = _mm256_loadu_ps(left + i);
+        const __m256 r = _mm256_loadu_ps(right + i);
+        const __m256 lo = _mm256_unpacklo_ps(l, r);
+        const __m256 hi = _mm256_unpackhi_ps(l, r);
+        _mm256_storeu_ps(dst + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(dst + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    scalar::interleaveStereo(left + i, right + i, dst + 2 * i, frames - i);
+}
+
+} // namespace avx2
+
+bool cpuHasAvx2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // 需要操作系统保存 YMM 寄存器（OSXSAVE 且 XCR0 的第 1、2 位）
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+bool cpuHasSse2()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#elif defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    return false;
+#endif
+}
+
+#endif // DSP_X86
+
+} // namespace
+
+void DspKernels::deinterleave(const float *src, float *const *planes, int channels, qint64 frames) const
+{
+    if (channels == 2) {
+        deinterleaveStereo(src, planes[0], planes[1], frames);
+        return;
+    }
+    for (qint64 i = 0; i < frames; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            planes[c][i] = src[i * channels + c];
+        }
+    }
+}
+
+void DspKernels::interleave(const float *const *planes, float *dst, int channels, qint64 frames) const
+{
+    if (channels == 2) {
+        interleaveStereo(planes[0], planes[1], dst, frames);
+        return;
+    }
+    for (qint64 i = 0; i < frames; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            dst[i * channels + c] = planes[c][i];
+        }
+    }
+}
+
+const DspKernels &DspKernels::instance()
+{
+    static const DspKernels kernels = forLevel(supportedLevel());
+    return kernels;
+}
+
+DspKernels DspKernels::forLevel(Level level)
+{
+    level = qMin(level, supportedLevel());
+
+    DspKernels kernels;
+    kernels.level = Scalar;
+    kernels.applyGain = scalar::applyGain;
+    kernels.mixWeighted = scalar::mixWeighted;
+    kernels.multiply = scalar::multiply;
+    kernels.fftButterfly = scalar::fftButterfly;
+    kernels.magnitude = scalar::magnitude;
+    kernels.dotProduct = scalar::dotProduct;
+    kernels.biquadCascade = scalar::biquadCascade;
+    kernels.floatToInt16 = scalar::floatToInt16;
+    kernels.int16ToFloat = scalar::int16ToFloat;
+    kernels.int24ToFloat = scalar::int24ToFloat;
+    kernels.int32ToFloat = scalar::int32ToFloat;
+    kernels.deinterleaveStereo = scalar::deinterleaveStereo;
+    kernels.interleaveStereo = scalar::interleaveStereo;
+
+#if DSP_X86
+    if (level == Sse2) {
+        kernels.level = Sse2;
+        kernels.applyGain = sse2::applyGain;
+        kernels.mixWeighted = sse2::mixWeighted;
+        kernels.multiply = sse2::multiply;
+        kernels.fftButterfly = sse2::fftButterfly;
+        kernels.magnitude = sse2::magnitude;
+        kernels.dotProduct = sse2::dotProduct;
+        kernels.biquadCascade = sse2::biquadCascade;
+        kernels.floatToInt16 = sse2::floatToInt16;
+        kernels.int16ToFloat = sse2::int16ToFloat;
+        kernels.int24ToFloat = sse2::int24ToFloat;
+        kernels.int32ToFloat = sse2::int32ToFloat;
+        kernels.deinterleaveStereo = sse2::deinterleaveStereo;
+        kernels.interleaveStereo = sse2::interleaveStereo;
+    } else if (level == Avx2) {
+        kernels.level = Avx2;
+        kernels.applyGain = avx2::applyGain;
+        kernels.mixWeighted = avx2::mixWeighted;
+        kernels.multiply = avx2::multiply;
+        kernels.fftButterfly = avx2::fftButterfly;
+        kernels.magnitude = avx2::magnitude;
+        kernels.dotProduct = avx2::dotProduct;
+        kernels.biquadCascade = avx2::biquadCascade;
+        kernels.floatToInt16 = avx2::floatToInt16;
+        kernels.int16ToFloat = avx2::int16ToFloat;
+        kernels.int24ToFloat = avx2::int24ToFloat;
+        kernels.int32ToFloat = avx2::int32ToFloat;
+        kernels.deinterleaveStereo = avx2::deinterleaveStereo;
+        kernels.interleaveStereo = avx2::interleaveStereo;
+    }
+#endif
+
+    return kernels;
+}
+
+DspKernels::Level DspKernels::supportedLevel()
+{
+#if DSP_X86
+    static const Level level = cpuHasAvx2() ? Avx2 : (cpuHasSse2() ? Sse2 : Scalar);
+    return level;
+#else
+    return Scalar;
+#endif
+}
+
+const char *DspKernels::levelName(Level level)
+{
+    switch (level) {
+    case Sse2:
+        return "SSE2";
+    case Avx2:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef DSPKERNELS_H
+#define DSPKERNELS_H
+
+#include <QtGlobal>
+
+/**
+ * @brief The DspKernels struct
+ * 音频处理的基础运算（增益、混合、采样格式转换、交错与解交错、FFT 蝶形与幅度、内积、双二阶滤波）
+ *
+ * 每个运算有标量、SSE2 与 AVX2 三种实现，instance() 在首次调用时按 CPU 特性选择一组。
+ * 向量实现与标量实现逐位一致（不使用 FMA，舍入与饱和的方式相同），处理不满一个向量的尾部时直接调用标量实现。
+ * 为此实现文件以 -ffp-contract=off 编译，标量实现中的乘加不会被编译器合并；一致性与吞吐量由 tests/tst_dspkernels 检查。
+ */
+struct DspKernels
+{
+    enum Level {
+        Scalar,
+        Sse2,
+        Avx2,
+    };
+
+    Level level = Scalar;
+
+    // data[i] *= gain
+    void (*applyGain)(float *data, qint64 count, float gain) = nullptr;
+    // dst[i] = a[i] * gainA[i] + b[i] * gainB[i]，dst 可以与 a 或 b 相同
+    void (*mixWeighted)(float *dst, const float *a, const float *b, const float *gainA, const float *gainB, qint64 count) = nullptr;
+    // dst[i] = a[i] * b[i]，dst 可以与 a 或 b 相同
+    void (*multiply)(float *dst, const float *a, const float *b, qint64 count) = nullptr;
+
+    // 基 2 FFT 的一组蝶形（实部与虚部分开存放）：t = x1 * w，x1 = x0 - t，x0 = x0 + t
+    void (*fftButterfly)(float *re0, float *im0, float *re1, float *im1, const float *wr, const float *wi, qint64 count) = nullptr;
+    // dst[i] = sqrt(re[i]^2 + im[i]^2)
+    void (*magnitude)(const float *re, const float *im, float *dst, qint64 count) = nullptr;
+    // a 与 b 的内积（FIR 滤波），按 8 个部分和累加
+    float (*dotProduct)(const float *a, const float *b, qint64 count) = nullptr;
+
+    // 对交错的 channels 声道采样原位串联 sections 节双二阶滤波（转置直接 II 型），各声道占向量的一个通道并行计算
+    // coeffs 每节 5 个：b0 b1 b2 a1 a2（已按 a0 归一化），state 每节 2 * channels 个：先各声道的 s1，再各声道的 s2
+    void (*biquadCascade)(float *data, int channels, qint64 frames, const float *coeffs, float *state, int sections) = nullptr;
+
+    // [-1, 1) 的 float 转换为 16 位整数，超出范围的饱和，NaN 转换为最小值
+    void (*floatToInt16)(const float *src, qint16 *dst, qint64 count) = nullptr;
+    void (*int16ToFloat)(const qint16 *src, float *dst, qint64 count) = nullptr;
+    // 紧凑排列的 24 位小端整数（每个采样 3 字节）
+    void (*int24ToFloat)(const uchar *src, float *dst, qint64 count) = nullptr;
+    void (*int32ToFloat)(const qint32 *src, float *dst, qint64 count) = nullptr;
+
+    void (*deinterleaveStereo)(const float *src, float *left, float *right, qint64 frames) = nullptr;
+    void (*interleaveStereo)(const float *left, const float *right, float *dst, qint64 frames) = nullptr;
+
+    // 任意声道数的交错与解交错，双声道使用向量实现
+    void deinterleave(const float *src, float *const *planes, int channels, qint64 frames) const;
+    void interleave(const float *const *planes, float *dst, int channels, qint64 frames) const;
+
+    // 按 CPU 特性选择的实现
+    static const DspKernels &instance();
+    // 指定级别的实现，CPU 不支持时降到支持的最高级别
+    static DspKernels forLevel(Level level);
+    static Level supportedLevel();
+    static const char *levelName(Level level);
+};
+
+#endif // DSPKERNELS_H
@@ -0,0 +1,266 @@
+#include "Equalizer.h"
+
+#include <QVariantList>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+
+// 低于该值的滤波器状态直接清零，避免静音后衰减到非规格化数，使运算变慢
+constexpr float DenormalThreshold = 1e-20f;
+
+const char *typeName(EqBand::Type type)
+{
+    switch (type) {
+    case EqBand::LowShelf:
+        return "lowshelf";
+    case EqBand::HighShelf:
+        return "highshelf";
+    default:
+        return "peaking";
+    }
+}
+
+EqBand::Type typeFromName(const QString &name)
+{
+    if (name == QLatin1String("lowshelf")) {
+        return EqBand::LowShelf;
+    }
+    if (name == QLatin1String("highshelf")) {
+        return EqBand::HighShelf;
+    }
+    return EqBand::Peaking;
+}
+
+} // namespace
+
+bool EqPreset::isFlat() const
+{
+    if (std::fabs(preampDb) >= 0.01) {
+        return false;
+    }
+    return std::all_of(bands.begin(), bands.end(), [](const EqBand &band) {
+        return std::fabs(band.gainDb) < 0.01;
+    });
+}
+
+QVariantMap EqPreset::toVariant() const
+{
+    QVariantList list;
+    for (const EqBand &band : bands) {
+        QVariantMap item;
+        item["type"] = QString::fromLatin1(typeName(band.type));
+        item["frequency"] = band.frequency;
+        item["gain"] = band.gainDb;
+        item["q"] = band.q;
+        list.append(item);
+    }
+
+    QVariantMap map;
+    map["preamp"] = preampDb;
+    map["bands"] = list;
+    return map;
+}
+
+EqPreset EqPreset::fromVariant(const QVariantMap &map)
+{
+    EqPreset preset;
+    preset.preampDb = map.value("preamp").toDouble();
+    const QVariantList list = map.value("bands").toList();
+    for (const QVariant &value : list) {
+        const QVariantMap item = value.toMap();
+        EqBand band;
+        band.type = typeFromName(item.value("type").toString());
+        band.frequency = item.value("frequency", band.frequency).toDouble();
+        band.gainDb = item.value("gain").toDouble();
+        band.q = item.value("q", band.q).toDouble();
+        preset.bands.append(band);
+        if (preset.bands.size() == Equalizer::MaxBands) {
+            break;
+        }
+    }
+    return preset;
+}
+
+EqPreset EqPreset::graphic10()
+{
+    EqPreset preset;
+    for (double frequency = 31.25; frequency < 20000.0; frequency *= 2.0) {
+        EqBand band;
+        band.frequency = frequency;
+        preset.bands.append(band);
+    }
+    return preset;
+}
+
+Equalizer::Equalizer(int sampleRate, int channels, const DspKernels &kernels)
+    : m_sampleRate(qMax(1, sampleRate))
+    , m_channels(qMax(1, channels))
+    , m_dsp(kernels)
+    , m_rampLength(qMax<qint64>(1, qint64(m_sampleRate) * RampMs / 1000))
+    , m_rampPos(m_rampLength)
+    , m_bypass(true)
+    , m_state(MaxBands * 2 * m_channels, 0.0f)
+{
+    std::fill(std::begin(m_current.coeffs), std::end(m_current.coeffs), 0.0f);
+    for (int b = 0; b < MaxBands; ++b) {
+        m_current.coeffs[b * 5] = 1.0f;
+    }
+    m_from = m_current;
+    m_target = m_current;
+}
+
+void Equalizer::setPreset(const EqPreset &preset)
+{
+    m_preset = preset;
+
+    Coefficients &next = m_pending.back();
+    next.preamp = float(std::pow(10.0, preset.preampDb / 20.0));
+    for (int b = 0; b < MaxBands; ++b) {
+        float *c = next.coeffs + b * 5;
+        if (b < preset.bands.size()) {
+            computeBand(preset.bands[b], m_sampleRate, c);
+        } else {
+            c[0] = 1.0f;
+            c[1] = c[2] = c[3] = c[4] = 0.0f;
+        }
+    }
+    m_pending.publish();
+}
+
+void Equalizer::computeBand(const EqBand &band, double sampleRate, float *coeffs)
+{
+    // 增益为 0 时三种滤波都等于直通，直接使用单位系数（不参与计算）
+    if (std::fabs(band.gainDb) < 0.01) {
+        coeffs[0] = 1.0f;
+        coeffs[1] = coeffs[2] = coeffs[3] = coeffs[4] = 0.0f;
+        return;
+    }
+
+    const double frequency = qBound(10.0, band.frequency, sampleRate * 0.49);
+    const double q = qMax(0.1, band.q);
+    const double a = std::pow(10.0, band.gainDb / 40.0);
+    const double w0 = 2.0 * Pi * frequency / sampleRate;
+    const double cosw = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * q);
+    const double sqrtA2Alpha = 2.0 * std::sqrt(a) * alpha;
+
+    double b0, b1, b2, a0, a1, a2;
+    switch (band.type) {
+    case EqBand::LowShelf:
+        b0 = a * ((a + 1) - (a - 1) * cosw + sqrtA2Alpha);
+        b1 = 2 * a * ((a - 1) - (a + 1) * cosw);
+        b2 = a * ((a + 1) - (a - 1) * cosw - sqrtA2Alpha);
+        a0 = (a + 1) + (a - 1) * cosw + sqrtA2Alpha;
+        a1 = -2 * ((a - 1) + (a + 1) * cosw);
+        a2 = (a + 1) + (a - 1) * cosw - sqrtA2Alpha;
+        break;
+    case EqBand::HighShelf:
+        b0 = a * ((a + 1) + (a - 1) * cosw + sqrtA2Alpha);
+        b1 = -2 * a * ((a - 1) + (a + 1) * cosw);
+        b2 = a * ((a + 1) + (a - 1) * cosw - sqrtA2Alpha);
+        a0 = (a + 1) - (a - 1) * cosw + sqrtA2Alpha;
+        a1 = 2 * ((a - 1) - (a + 1) * cosw);
+        a2 = (a + 1) - (a - 1) * cosw - sqrtA2Alpha;
+        break;
+    default:
+        b0 = 1 + alpha * a;
+        b1 = -2 * cosw;
+        b2 = 1 - alpha * a;
+        a0 = 1 + alpha / a;
+        a1 = -2 * cosw;
+        a2 = 1 - alpha / a;
+        break;
+    }
+
+    coeffs[0] = float(b0 / a0);
+    coeffs[1] = float(b1 / a0);
+    coeffs[2] = float(b2 / a0);
+    coeffs[3] = float(a1 / a0);
+    coeffs[4] = float(a2 / a0);
+}
+
+bool Equalizer::isIdentity(const float *coeffs)
+{
+    return coeffs[0] == 1.0f && coeffs[1] == 0.0f && coeffs[2] == 0.0f && coeffs[3] == 0.0f && coeffs[4] == 0.0f;
+}
+
+bool Equalizer::isBypass(const Coefficients &coefficients)
+{
+    if (coefficients.preamp != 1.0f) {
+        return false;
+    }
+    for (int b = 0; b < MaxBands; ++b) {
+        if (!isIdentity(coefficients.coeffs + b * 5)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Equalizer::process(float *data, qint64 frames)
+{
+    if (m_pending.update()) {
+        // 从当前（可能正在过渡中的）系数开始过渡
+        m_from = m_current;
+        m_target = m_pending.front();
+        m_rampPos = 0;
+        m_bypass = false;
+    }
+
+    // 过渡结束时的最后一次 run 已经清空了各频段的状态，直通时不必再逐段检查
+    if (m_bypass) {
+        return;
+    }
+
+    // 过渡中每 RampStep 帧插值一次系数
+    while (m_rampPos < m_rampLength && frames > 0) {
+        const qint64 n = qMin<qint64>(frames, RampStep);
+        m_rampPos = qMin(m_rampLength, m_rampPos + n);
+        if (m_rampPos == m_rampLength) {
+            m_current = m_target;
+            m_bypass = isBypass(m_current);
+        } else {
+            const float t = float(m_rampPos) / float(m_rampLength);
+            m_current.preamp = m_from.preamp + (m_target.preamp - m_from.preamp) * t;
+            for (int i = 0; i < MaxBands * 5; ++i) {
+                m_current.coeffs[i] = m_from.coeffs[i] + (m_target.coeffs[i] - m_from.coeffs[i]) * t;
+            }
+        }
+        run(data, n);
+        data += n * m_channels;
+        frames -= n;
+    }
+
+    if (frames > 0 && !m_bypass) {
+        run(data, frames);
+    }
+}
+
+void Equalizer::run(float *data, qint64 frames)
+{
+    const int stride = 2 * m_channels;
+    for (int b = 0; b < MaxBands; ++b) {
+        const float *c = m_current.coeffs + b * 5;
+        float *state = m_state.data() + b * stride;
+        if (isIdentity(c)) {
+            // 不起作用的频段清空状态，之后重新启用时从静止开始
+            std::fill(state, state + stride, 0.0f);
+            continue;
+        }
+
+        m_dsp.biquadCascade(data, m_channels, frames, c, state, 1);
+        for (int i = 0; i < stride; ++i) {
+            if (std::fabs(state[i]) < DenormalThreshold) {
+                state[i] = 0.0f;
+            }
+        }
+    }
+
+    if (m_current.preamp != 1.0f) {
+        m_dsp.applyGain(data, frames * m_channels, m_current.preamp);
+    }
+}
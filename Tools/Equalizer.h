@@ -0,0 +1,99 @@
+#ifndef EQUALIZER_H
+#define EQUALIZER_H
+
+#include <QVariantMap>
+#include <QVector>
+
+#include "DspKernels.h"
+#include "TripleBuffer.h"
+
+// 均衡器的一个频段
+struct EqBand
+{
+    enum Type {
+        Peaking,
+        LowShelf,
+        HighShelf,
+    };
+
+    Type type = Peaking;
+    double frequency = 1000.0;      // Hz，峰值滤波的中心频率或搁架滤波的转折频率
+    double gainDb = 0.0;
+    double q = 1.41;                // 约一个倍频程
+};
+
+// 一组均衡设置
+struct EqPreset
+{
+    double preampDb = 0.0;
+    QVector<EqBand> bands;
+
+    // 所有频段与前置增益都为 0 dB（均衡器不改变信号）
+    bool isFlat() const;
+
+    QVariantMap toVariant() const;
+    static EqPreset fromVariant(const QVariantMap &map);
+
+    // 31 Hz ~ 16 kHz 的十段倍频程均衡，增益均为 0
+    static EqPreset graphic10();
+};
+
+/**
+ * @brief The Equalizer class
+ * 参数均衡器（串联的双二阶滤波，RBJ 公式）
+ *
+ * setPreset 在界面线程中计算各频段的系数，通过无锁三缓冲交给输出回调中的 process，两端都不会等待。
+ * 收到新系数后在 RampMs 内从当前系数线性过渡到新系数（每 RampStep 帧更新一次），拖动滑块时不会产生咔嗒声；
+ * 二阶滤波的稳定区域是凸的，两组稳定系数之间的线性插值也是稳定的。
+ * 增益为 0 的频段不参与计算，所有频段都为 0 且不在过渡中时 process 直接返回。
+ * 滤波由 DspKernels::biquadCascade 完成，各声道在向量的不同通道中并行计算。
+ */
+class Equalizer
+{
+public:
+    static constexpr int MaxBands = 16;
+    static constexpr int RampMs = 20;
+    static constexpr int RampStep = 32;
+
+    Equalizer(int sampleRate, int channels, const DspKernels &kernels = DspKernels::instance());
+
+    // 界面线程调用
+    void setPreset(const EqPreset &preset);
+    const EqPreset &preset() const { return m_preset; }
+
+    // 输出回调调用：对交错的 float 采样原位处理
+    void process(float *data, qint64 frames);
+
+private:
+    // 输出回调使用的一组系数
+    struct Coefficients
+    {
+        float preamp = 1.0f;
+        float coeffs[MaxBands * 5];         // 每段 b0 b1 b2 a1 a2，不起作用的频段为 1 0 0 0 0
+    };
+
+    static void computeBand(const EqBand &band, double sampleRate, float *coeffs);
+    static bool isIdentity(const float *coeffs);
+    static bool isBypass(const Coefficients &coefficients);
+
+    void run(float *data, qint64 frames);
+
+private:
+    int m_sampleRate;
+    int m_channels;
+    DspKernels m_dsp;
+
+    EqPreset m_preset;                      // 界面线程
+    TripleBuffer<Coefficients> m_pending;   // 界面线程写入，输出回调读取
+
+    // 仅输出回调使用
+    Coefficients m_current;
+    Coefficients m_from;
+    Coefficients m_target;
+    qint64 m_rampLength;
+    qint64 m_rampPos;                       // >= m_rampLength 表示不在过渡中
+    bool m_bypass;                          // m_current 为直通（所有频段不起作用且前置增益为 1）
+    QVector<float> m_state;                 // 每段 2 * channels 个
+};
+
+#endif // EQUALIZER_H
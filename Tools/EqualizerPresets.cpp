@@ -0,0 +1,106 @@
+#include "EqualizerPresets.h"
+#include "PersistenceService.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+
+EqualizerPresets::EqualizerPresets(QObject *parent)
+    : QObject{parent}
+    , m_default(EqPreset::graphic10())
+    , m_dirty(false)
+{
+    QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir dir(appDataPath);
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+    m_savePath = dir.filePath("equalizer_presets.json");
+}
+
+EqualizerPresets::~EqualizerPresets()
+{
+    saveToFile();
+}
+
+void EqualizerPresets::setDefaultPreset(const EqPreset &preset)
+{
+    m_default = preset;
+    m_dirty = true;
+}
+
+void EqualizerPresets::setAlbumPreset(const QString &uid, const EqPreset &preset)
+{
+    if (uid.isEmpty()) {
+        return;
+    }
+    m_albums.insert(uid, preset);
+    m_dirty = true;
+}
+
+void EqualizerPresets::removeAlbumPreset(const QString &uid)
+{
+    if (m_albums.remove(uid) > 0) {
+        m_dirty = true;
+    }
+}
+
+EqPreset EqualizerPresets::preset(const QString &uid) const
+{
+    return m_albums.value(uid, m_default);
+}
+
+void EqualizerPresets::loadFromFile()
+{
+    QFile file(m_savePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isObject()) {
+        qWarning() << "Invalid equalizer presets:" << m_savePath;
+        return;
+    }
+
+    const QJsonObject root = doc.object();
+    if (root.contains("default")) {
+        m_default = EqPreset::fromVariant(root["default"].toObject().toVariantMap());
+    }
+
+    const QJsonObject albums = root["albums"].toObject();
+    for (auto it = albums.constBegin(); it != albums.constEnd(); ++it) {
+        m_albums.insert(it.key(), EqPreset::fromVariant(it.value().toObject().toVariantMap()));
+    }
+}
+
+void EqualizerPresets::saveToFile()
+{
+    if (!m_dirty) {
+        return;
+    }
+
+    QJsonObject albums;
+    for (auto it = m_albums.constBegin(); it != m_albums.constEnd(); ++it) {
+        albums[it.key()] = QJsonObject::fromVariantMap(it.value().toVariant());
+    }
+
+    QJsonObject root;
+    root["default"] = QJsonObject::fromVariantMap(m_default.toVariant());
+    root["albums"] = albums;
+    m_dirty = false;
+
+    // QJsonObject 隐式共享，按值捕获即为快照
+    auto serialize = [root]() {
+        return QJsonDocument(root).toJson();
+    };
+
+    if (m_persistence) {
+        m_persistence->schedule(m_savePath, serialize);
+    } else {
+        PersistenceService::writeFile(m_savePath, serialize());
+    }
+}
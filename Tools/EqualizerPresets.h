@@ -0,0 +1,52 @@
+#ifndef EQUALIZERPRESETS_H
+#define EQUALIZERPRESETS_H
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+
+#include "Equalizer.h"
+
+class PersistenceService;
+
+/**
+ * @brief The EqualizerPresets class
+ * 均衡器设置的持久化：一个默认设置，加上按专辑 uid 记录的专辑设置
+ *
+ * 载入专辑时有专辑设置的使用专辑设置，否则使用默认设置。
+ * 保存在应用数据目录的 equalizer_presets.json 中，便于手动编辑（可以改动频段的类型、频率与 Q 值）。
+ * 设置 PersistenceService 后由其在工作线程中写入，否则以 QSaveFile 同步写入。
+ */
+class EqualizerPresets : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EqualizerPresets(QObject *parent = nullptr);
+    ~EqualizerPresets();
+
+    EqPreset defaultPreset() const { return m_default; }
+    void setDefaultPreset(const EqPreset &preset);
+
+    bool hasAlbumPreset(const QString &uid) const { return m_albums.contains(uid); }
+    void setAlbumPreset(const QString &uid, const EqPreset &preset);
+    void removeAlbumPreset(const QString &uid);
+
+    // uid 对应专辑的设置，没有时返回默认设置
+    EqPreset preset(const QString &uid) const;
+
+    void setPersistence(PersistenceService *persistence) { m_persistence = persistence; }
+
+    // 由所属窗口在显示后调用，不在构造时读取
+    void loadFromFile();
+    void saveToFile();
+
+private:
+    QPointer<PersistenceService> m_persistence;
+    EqPreset m_default;
+    QHash<QString, EqPreset> m_albums;  // 专辑 uid -> 设置
+    QString m_savePath;
+    bool m_dirty;
+};
+
+#endif // EQUALIZERPRESETS_H
@@ -0,0 +1,90 @@
+#include "Fft.h"
+#include "DspKernels.h"
+
+#include <cmath>
+#include <utility>
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+
+} // namespace
+
+Fft::Fft(int size)
+    : m_size(size)
+    , m_dsp(&DspKernels::instance())
+{
+    Q_ASSERT(size >= 4 && (size & (size - 1)) == 0);
+
+    int bits = 0;
+    while ((1 << bits) < size) {
+        ++bits;
+    }
+
+    for (int i = 0; i < size; ++i) {
+        int j = 0;
+        for (int b = 0; b < bits; ++b) {
+            j |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        if (i < j) {
+            m_swaps.append(i);
+            m_swaps.append(j);
+        }
+    }
+
+    // 以双精度计算后取整，避免递推累积误差
+    for (int half = 4; half < size; half <<= 1) {
+        for (int k = 0; k < half; ++k) {
+            const double angle = -Pi * k / half;
+            m_cos.append(float(std::cos(angle)));
+            m_sin.append(float(std::sin(angle)));
+        }
+    }
+}
+
+void Fft::transform(float *re, float *im) const
+{
+    for (qsizetype i = 0; i < m_swaps.size(); i += 2) {
+        const int a = m_swaps[i];
+        const int b = m_swaps[i + 1];
+        std::swap(re[a], re[b]);
+        std::swap(im[a], im[b]);
+    }
+
+    // 第一级：旋转因子为 1
+    for (int k = 0; k < m_size; k += 2) {
+        const float tr = re[k + 1];
+        const float ti = im[k + 1];
+        re[k + 1] = re[k] - tr;
+        im[k + 1] = im[k] - ti;
+        re[k] += tr;
+        im[k] += ti;
+    }
+
+    // 第二级：旋转因子为 1 与 -i，x * -i = (x.im, -x.re)
+    for (int k = 0; k < m_size; k += 4) {
+        float tr = re[k + 2];
+        float ti = im[k + 2];
+        re[k + 2] = re[k] - tr;
+        im[k + 2] = im[k] - ti;
+        re[k] += tr;
+        im[k] += ti;
+
+        tr = im[k + 3];
+        ti = -re[k + 3];
+        re[k + 3] = re[k + 1] - tr;
+        im[k + 3] = im[k + 1] - ti;
+        re[k + 1] += tr;
+        im[k + 1] += ti;
+    }
+
+    const float *wr = m_cos.constData();
+    const float *wi = m_sin.constData();
+    for (int half = 4; half < m_size; half <<= 1) {
+        for (int k = 0; k < m_size; k += half * 2) {
+            m_dsp->fftButterfly(re + k, im + k, re + k + half, im + k + half, wr, wi, half);
+        }
+        wr += half;
+        wi += half;
+    }
+}
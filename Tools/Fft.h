@@ -0,0 +1,34 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <QVector>
+
+struct DspKernels;
+
+/**
+ * @brief The Fft class
+ * 固定长度的复数 FFT（基 2，按时间抽取，原位）
+ *
+ * 位反转表与各级的旋转因子在构造时算好，实部与虚部分开存放。
+ * 前两级的旋转因子只有 1 与 -i，直接做加减；之后每一组蝶形长度不小于 4，交给 DspKernels::fftButterfly 向量化处理。
+ */
+class Fft
+{
+public:
+    // size 为 2 的幂且不小于 4
+    explicit Fft(int size = 1024);
+
+    int size() const { return m_size; }
+
+    // 正变换：X[k] = sum x[n] * exp(-2 pi i n k / size)，re 与 im 各 size 个，结果不做归一化
+    void transform(float *re, float *im) const;
+
+private:
+    int m_size;
+    QVector<int> m_swaps;           // 位反转需要交换的下标对
+    QVector<float> m_cos;           // 第三级起各级的旋转因子依次排列（每级 half 个）
+    QVector<float> m_sin;
+    const DspKernels *m_dsp;
+};
+
+#endif // FFT_H
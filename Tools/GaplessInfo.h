@@ -0,0 +1,24 @@
+#ifndef GAPLESSINFO_H
+#define GAPLESSINFO_H
+
+#include <QtGlobal>
+
+/**
+ * @brief The GaplessInfo struct
+ * 编码器延迟与填充信息
+ *
+ * 有损编码会在音频前插入编码器延迟、在末尾补齐最后一帧，解码结果比原始音频长。
+ * 由 NativeTagReader::readGapless 从 MP3 的 LAME/Xing 头或 MP4 的 iTunSMPB 标签中读取，播放时裁掉，使相邻音轨无缝衔接。
+ * 所有长度以文件本身的采样率计。
+ */
+struct GaplessInfo
+{
+    qint64 encoderDelay = 0;    // 开头需要丢弃的帧数（已包含解码器延迟）
+    qint64 padding = 0;         // 末尾需要丢弃的帧数
+    qint64 validFrames = -1;    // 原始音频的帧数，未知时为 -1
+    int sampleRate = 0;
+
+    bool isValid() const { return sampleRate > 0 && (encoderDelay > 0 || padding > 0 || validFrames >= 0); }
+};
+
+#endif // GAPLESSINFO_H
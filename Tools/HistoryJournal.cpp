@@ -0,0 +1,413 @@
+#include "HistoryJournal.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <array>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr quint32 kJournalMagic = 0x50484A4C;      // "PHJL"
+constexpr quint32 kJournalVersion = 1;
+constexpr int kHeaderSize = 8;
+constexpr int kRecordHeaderSize = 8;               // 长度 + CRC32
+constexpr quint32 kMaxRecordSize = 16 * 1024 * 1024;
+constexpr qint64 kMinCompactSize = 256 * 1024;
+
+enum RecordType : quint8 {
+    Define = 1,     // 编号、url、时间戳与元数据
+    Touch = 2,      // 编号与时间戳
+};
+
+quint32 crc32(const char *data, qsizetype size)
+{
+    static const auto table = []() {
+        std::array<quint32, 256> t{};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : (c >> 1);
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (qsizetype i = 0; i < size; ++i) {
+        crc = table[(crc ^ uchar(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+quint32 readBe32(const char *p)
+{
+    return (quint32(uchar(p[0])) << 24) | (quint32(uchar(p[1])) << 16)
+           | (quint32(uchar(p[2])) << 8) | quint32(uchar(p[3]));
+}
+
+void appendBe32(QByteArray &out, quint32 value)
+{
+    out.append(char(value >> 24));
+    out.append(char(value >> 16));
+    out.append(char(value >> 8));
+    out.append(char(value));
+}
+
+// 把已写入的内容同步到磁盘，之后的重命名不会留下内容不完整的文件
+bool syncToDisk(QFile &file)
+{
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return ::_commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+QByteArray fileHeader()
+{
+    QByteArray header;
+    appendBe32(header, kJournalMagic);
+    appendBe32(header, kJournalVersion);
+    return header;
+}
+
+} // namespace
+
+HistoryJournal::HistoryJournal(const QString &filePath, QObject *parent)
+    : QObject{parent}
+    , m_filePath(filePath)
+    , m_nextId(1)
+    , m_fileSize(0)
+    , m_compactedSize(0)
+    , m_bytesWritten(0)
+    , m_compacting(false)
+{
+    m_compactPool.setMaxThreadCount(1);
+}
+
+HistoryJournal::~HistoryJournal()
+{
+    // 等待后台压缩结束；压缩期间的记录也已写入旧文件，放弃压缩结果不会丢失数据
+    m_compactPool.waitForDone();
+    QFile::remove(m_filePath + ".compact");
+}
+
+void HistoryJournal::load(const QString &legacyJsonPath)
+{
+    const QString compactPath = m_filePath + ".compact";
+    if (QFile::exists(compactPath)) {
+        // 压缩完成后替换文件的过程中断：旧文件已删除时使用压缩结果
+        if (!QFile::exists(m_filePath)) {
+            QFile::rename(compactPath, m_filePath);
+        } else {
+            QFile::remove(compactPath);
+        }
+    }
+    if (!QFile::exists(m_filePath) && QFile::exists(m_filePath + ".old")) {
+        QFile::rename(m_filePath + ".old", m_filePath);
+    }
+
+    m_entries.clear();
+    m_nextId = 1;
+
+    QFile file(m_filePath);
+    if (!file.exists()) {
+        if (!legacyJsonPath.isEmpty()) {
+            importLegacyJson(legacyJsonPath);
+        }
+        if (!writeSnapshot(m_filePath, m_entries)) {
+            qWarning() << "Failed to create play history journal:" << m_filePath;
+        }
+        openForAppend();
+        m_compactedSize = m_fileSize;
+        return;
+    }
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open play history journal:" << m_filePath;
+        return;
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+
+    if (data.size() < kHeaderSize || readBe32(data.constData()) != kJournalMagic
+        || readBe32(data.constData() + 4) != kJournalVersion) {
+        qWarning() << "Ignoring invalid play history journal:" << m_filePath;
+        writeSnapshot(m_filePath, m_entries);
+        openForAppend();
+        m_compactedSize = m_fileSize;
+        return;
+    }
+
+    QHash<quint32, QString> urlOfId;
+    QHash<QString, qint64> liveSize;    // 每个音轨最新定义记录的大小，用于估算压缩后的文件大小
+    qsizetype offset = kHeaderSize;
+    while (offset + kRecordHeaderSize <= data.size()) {
+        const quint32 length = readBe32(data.constData() + offset);
+        const quint32 checksum = readBe32(data.constData() + offset + 4);
+        if (length > kMaxRecordSize || offset + kRecordHeaderSize + length > data.size()) {
+            break;  // 写了一半的记录
+        }
+
+        const char *payload = data.constData() + offset + kRecordHeaderSize;
+        if (crc32(payload, length) != checksum) {
+            break;  // 损坏的记录，其后的内容不再可信
+        }
+
+        QDataStream in(QByteArray::fromRawData(payload, length));
+        in.setVersion(QDataStream::Qt_6_0);
+
+        quint8 type = 0;
+        quint32 id = 0;
+        in >> type >> id;
+        if (type == Define) {
+            QString url;
+            qint64 timestamp = 0;
+            QVariantMap metadata;
+            in >> url >> timestamp >> metadata;
+
+            Entry &entry = m_entries[url];
+            entry.id = id;
+            entry.track = TrackRecord::fromMetadata(metadata);
+            entry.timestamp = timestamp;
+            urlOfId.insert(id, url);
+            liveSize.insert(url, kRecordHeaderSize + length);
+            m_nextId = qMax(m_nextId, id + 1);
+        } else if (type == Touch) {
+            qint64 timestamp = 0;
+            in >> timestamp;
+
+            auto it = m_entries.find(urlOfId.value(id));
+            if (it != m_entries.end()) {
+                it->timestamp = timestamp;
+            }
+        }
+
+        offset += kRecordHeaderSize + length;
+    }
+
+    if (offset < data.size()) {
+        // 截掉无效的尾部，之后的记录接在最后一条有效记录之后
+        qWarning() << "Play history journal has a damaged tail, truncating"
+                   << data.size() - offset << "bytes:" << m_filePath;
+        QFile::resize(m_filePath, offset);
+    }
+
+    openForAppend();
+
+    m_compactedSize = kHeaderSize;
+    for (qint64 size : std::as_const(liveSize)) {
+        m_compactedSize += size;
+    }
+}
+
+void HistoryJournal::recordPlayed(const TrackRecord &track, qint64 timestamp)
+{
+    if (track.isNull()) {
+        return;
+    }
+
+    auto it = m_entries.find(track.url);
+    if (it == m_entries.end()) {
+        Entry entry;
+        entry.id = m_nextId++;
+        entry.track = track;
+        entry.timestamp = timestamp;
+        it = m_entries.insert(track.url, entry);
+        appendRecord(definePayload(*it));
+    } else if (it->track.toMetadata() != track.toMetadata()) {
+        // 元数据变化时重新定义，沿用原来的编号
+        it->track = track;
+        it->timestamp = timestamp;
+        appendRecord(definePayload(*it));
+    } else {
+        it->timestamp = timestamp;
+        appendRecord(touchPayload(it->id, timestamp));
+    }
+
+    maybeCompact();
+}
+
+bool HistoryJournal::openForAppend()
+{
+    m_file.close();
+    m_file.setFileName(m_filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Failed to open play history journal for writing:" << m_filePath;
+        m_fileSize = 0;
+        return false;
+    }
+    m_fileSize = m_file.size();
+    return true;
+}
+
+void HistoryJournal::appendRecord(const QByteArray &payload)
+{
+    const QByteArray record = frame(payload);
+
+    if (m_file.isOpen()) {
+        m_file.write(record);
+        m_file.flush();
+    }
+    m_fileSize += record.size();
+    m_bytesWritten += record.size();
+
+    if (m_compacting) {
+        m_pendingTail += record;
+    }
+}
+
+void HistoryJournal::maybeCompact()
+{
+    if (m_compacting || m_fileSize < kMinCompactSize || m_fileSize < 2 * m_compactedSize) {
+        return;
+    }
+
+    m_compacting = true;
+    m_pendingTail.clear();
+
+    // 条目是隐式共享的，复制快照只增加引用计数
+    const QHash<QString, Entry> snapshot = m_entries;
+    const QString compactPath = m_filePath + ".compact";
+
+    m_compactPool.start([this, snapshot, compactPath]() {
+        const bool ok = writeSnapshot(compactPath, snapshot);
+        QMetaObject::invokeMethod(this, [this, ok]() {
+            finishCompaction(ok);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void HistoryJournal::finishCompaction(bool ok)
+{
+    const QString compactPath = m_filePath + ".compact";
+
+    if (ok) {
+        // 补写压缩期间追加的记录并同步到磁盘后再替换旧文件
+        QFile compact(compactPath);
+        ok = compact.open(QIODevice::WriteOnly | QIODevice::Append)
+             && compact.write(m_pendingTail) == m_pendingTail.size()
+             && syncToDisk(compact);
+        compact.close();
+    }
+
+    if (ok) {
+        // 旧文件先改名保留，替换失败时还原
+        const QString oldPath = m_filePath + ".old";
+        m_file.close();
+        QFile::remove(oldPath);
+        ok = QFile::rename(m_filePath, oldPath);
+        if (ok && !QFile::rename(compactPath, m_filePath)) {
+            QFile::rename(oldPath, m_filePath);
+            ok = false;
+        }
+        if (ok) {
+            QFile::remove(oldPath);
+        }
+        openForAppend();
+    }
+
+    if (ok) {
+        m_compactedSize = m_fileSize;
+        qDebug() << "Play history journal compacted:" << m_entries.size() << "entries," << m_fileSize << "bytes";
+    } else {
+        qWarning() << "Failed to compact play history journal:" << m_filePath;
+        QFile::remove(compactPath);
+        // 避免每次追加都重试
+        m_compactedSize = m_fileSize;
+    }
+
+    m_pendingTail.clear();
+    m_compacting = false;
+}
+
+void HistoryJournal::importLegacyJson(const QString &jsonPath)
+{
+    QFile file(jsonPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isObject()) {
+        return;
+    }
+
+    const QJsonArray historyArray = doc.object()["history"].toArray();
+    for (const QJsonValue &val : historyArray) {
+        QJsonObject obj = val.toObject();
+        const QString url = obj["url"].toString();
+        if (url.isEmpty()) {
+            continue;
+        }
+
+        Entry entry;
+        entry.id = m_nextId++;
+        entry.track = TrackRecord::fromMetadata(obj["data"].toObject().toVariantMap());
+        entry.timestamp = obj["timestamp"].toInteger();
+        m_entries.insert(url, entry);
+    }
+
+    qDebug() << "Imported" << m_entries.size() << "entries from" << jsonPath;
+}
+
+QByteArray HistoryJournal::definePayload(const Entry &entry)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint8(Define) << entry.id << entry.track.url << entry.timestamp << entry.track.toMetadata();
+    return payload;
+}
+
+QByteArray HistoryJournal::touchPayload(quint32 id, qint64 timestamp)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint8(Touch) << id << timestamp;
+    return payload;
+}
+
+QByteArray HistoryJournal::frame(const QByteArray &payload)
+{
+    QByteArray record;
+    record.reserve(kRecordHeaderSize + payload.size());
+    appendBe32(record, quint32(payload.size()));
+    appendBe32(record, crc32(payload.constData(), payload.size()));
+    record.append(payload);
+    return record;
+}
+
+bool HistoryJournal::writeSnapshot(const QString &path, const QHash<QString, Entry> &entries)
+{
+    // QSaveFile 在 commit 时同步到磁盘再重命名，path 上不会出现写了一半的文件
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QByteArray data = fileHeader();
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        data += frame(definePayload(it.value()));
+    }
+    if (file.write(data) != data.size()) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
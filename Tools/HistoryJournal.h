@@ -0,0 +1,76 @@
+#ifndef HISTORYJOURNAL_H
+#define HISTORYJOURNAL_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+#include "TrackRecord.h"
+
+/**
+ * @brief The HistoryJournal class
+ * 播放历史的追加式日志
+ *
+ * 每次播放只在文件末尾追加一条很小的记录：首次出现（或元数据变化）的音频写入完整的定义记录，
+ * 之后只写入 “编号 + 时间戳” 的访问记录（约 21 字节）。每条记录带有长度与 CRC32 校验，
+ * 载入时遇到损坏或写了一半的尾部记录会截断文件，保证崩溃后仍能恢复之前的全部记录。
+ * 日志增长到一定程度后在自有的后台线程中压缩为每个音频一条定义记录，压缩期间追加的记录会补写到新文件中，
+ * 新文件同步到磁盘后才替换旧文件。
+ */
+class HistoryJournal : public QObject
+{
+    Q_OBJECT
+public:
+    struct Entry
+    {
+        quint32 id = 0;
+        TrackRecord track;
+        qint64 timestamp = 0;   // 最后一次播放（秒）
+    };
+
+    explicit HistoryJournal(const QString &filePath, QObject *parent = nullptr);
+    ~HistoryJournal();
+
+    // 读取日志，恢复截断的尾部；日志不存在时从旧版 JSON 历史记录导入
+    void load(const QString &legacyJsonPath = QString());
+
+    // 记录一次播放
+    void recordPlayed(const TrackRecord &track, qint64 timestamp);
+
+    const QHash<QString, Entry> &entries() const { return m_entries; }
+
+    // 累计写入的字节数（不含压缩）
+    qint64 bytesWritten() const { return m_bytesWritten; }
+
+private:
+    bool openForAppend();
+    void appendRecord(const QByteArray &payload);
+    void maybeCompact();
+    void finishCompaction(bool ok);
+
+    void importLegacyJson(const QString &jsonPath);
+
+    static QByteArray definePayload(const Entry &entry);
+    static QByteArray touchPayload(quint32 id, qint64 timestamp);
+    static QByteArray frame(const QByteArray &payload);
+    static bool writeSnapshot(const QString &path, const QHash<QString, Entry> &entries);
+
+private:
+    QString m_filePath;
+    QFile m_file;
+    QHash<QString, Entry> m_entries;     // url -> 历史记录
+    quint32 m_nextId;
+
+    qint64 m_fileSize;
+    qint64 m_compactedSize;              // 上次压缩（或载入）后的文件大小
+    qint64 m_bytesWritten;
+
+    bool m_compacting;
+    QByteArray m_pendingTail;            // 压缩期间追加的记录，完成后补写到新文件
+    QThreadPool m_compactPool;           // 压缩线程（不占用全局线程池）
+};
+
+#endif // HISTORYJOURNAL_H
@@ -0,0 +1,230 @@
+#ifndef KEYEDFILECACHE_H
+#define KEYEDFILECACHE_H
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPointer>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+
+#include "PersistenceService.h"
+
+/**
+ * @brief The KeyedFileCache class
+ * 以音频文件为键的持久化缓存（元数据缓存与响度缓存共用）
+ *
+ * 以（规范路径、文件大小、修改时间）为键保存 Value，缓存项只在查询时校验（惰性校验），
+ * 文件大小或修改时间不一致即视为过期并移除。保存在应用数据目录的 fileName 中：magic、version、项数，
+ * 之后逐项为路径、大小、修改时间与 Value（QDataStream 的 << 与 >>），magic 或 version 不符时整个文件被忽略。
+ * 可在多个线程中同时查询和写入。设置 PersistenceService 后，保存只提交快照，序列化与写入在其工作线程中进行；
+ * 未设置（或已销毁）时在调用线程中以 QSaveFile 同步写入。
+ */
+template <typename Value>
+class KeyedFileCache
+{
+public:
+    // name 只用于日志
+    KeyedFileCache(const QString &fileName, quint32 magic, quint32 version, const char *name)
+        : m_magic(magic)
+        , m_version(version)
+        , m_name(name)
+        , m_dirty(false)
+        , m_hits(0)
+        , m_misses(0)
+    {
+        QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+        if (!dir.exists()) {
+            dir.mkpath(".");
+        }
+        m_savePath = dir.filePath(fileName);
+    }
+
+    KeyedFileCache(const KeyedFileCache &) = delete;
+    KeyedFileCache &operator=(const KeyedFileCache &) = delete;
+
+    // 命中时写入 value 并返回 true
+    bool lookup(const QString &filePath, Value &value)
+    {
+        const QFileInfo fileInfo(filePath);
+        const QString key = fileInfo.canonicalFilePath();
+        if (key.isEmpty()) {
+            ++m_misses;
+            return false;
+        }
+
+        const qint64 size = fileInfo.size();
+        const qint64 mtime = fileInfo.lastModified().toMSecsSinceEpoch();
+
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.find(key);
+        if (it == m_entries.end()) {
+            ++m_misses;
+            return false;
+        }
+
+        // 文件已被修改，缓存项过期
+        if (it->size != size || it->mtime != mtime) {
+            m_entries.erase(it);
+            m_dirty = true;
+            ++m_misses;
+            return false;
+        }
+
+        value = it->value;
+        ++m_hits;
+        return true;
+    }
+
+    void insert(const QString &filePath, const Value &value)
+    {
+        const QFileInfo fileInfo(filePath);
+        const QString key = fileInfo.canonicalFilePath();
+        if (key.isEmpty()) {
+            return;
+        }
+
+        Entry entry;
+        entry.size = fileInfo.size();
+        entry.mtime = fileInfo.lastModified().toMSecsSinceEpoch();
+        entry.value = value;
+
+        QMutexLocker locker(&m_mutex);
+        m_entries.insert(key, entry);
+        m_dirty = true;
+    }
+
+    // 对 filePaths 中已缓存的项调用 update(Value &)，update 返回是否做了修改（不校验文件是否变化）
+    template <typename Update>
+    void update(const QStringList &filePaths, Update &&update)
+    {
+        QStringList keys;
+        keys.reserve(filePaths.size());
+        for (const QString &filePath : filePaths) {
+            keys.append(QFileInfo(filePath).canonicalFilePath());
+        }
+
+        QMutexLocker locker(&m_mutex);
+        for (const QString &key : std::as_const(keys)) {
+            auto it = m_entries.find(key);
+            if (it != m_entries.end() && update(it->value)) {
+                m_dirty = true;
+            }
+        }
+    }
+
+    quint64 hitCount() const { return m_hits.load(); }
+    quint64 missCount() const { return m_misses.load(); }
+    void resetCounters()
+    {
+        m_hits = 0;
+        m_misses = 0;
+    }
+
+    int size() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_entries.size();
+    }
+
+    void setPersistence(PersistenceService *persistence) { m_persistence = persistence; }
+
+    void loadFromFile()
+    {
+        QFile file(m_savePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return;
+        }
+
+        QDataStream in(&file);
+        in.setVersion(QDataStream::Qt_6_0);
+
+        quint32 magic = 0, version = 0, count = 0;
+        in >> magic >> version >> count;
+        if (magic != m_magic || version != m_version) {
+            qWarning() << "Ignoring incompatible" << m_name << "cache:" << m_savePath;
+            return;
+        }
+
+        QHash<QString, Entry> entries;
+        entries.reserve(count);
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            QString key;
+            Entry entry;
+            in >> key >> entry.size >> entry.mtime >> entry.value;
+            entries.insert(key, entry);
+        }
+
+        if (in.status() != QDataStream::Ok) {
+            qWarning() << "The" << m_name << "cache is truncated, discarding:" << m_savePath;
+            return;
+        }
+
+        QMutexLocker locker(&m_mutex);
+        m_entries = entries;
+        m_dirty = false;
+    }
+
+    void saveToFile()
+    {
+        QHash<QString, Entry> entries;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_dirty) {
+                return;
+            }
+            entries = m_entries;    // 隐式共享，只复制引用
+            m_dirty = false;
+        }
+
+        auto serialize = [entries, magic = m_magic, version = m_version]() {
+            QByteArray data;
+            QDataStream out(&data, QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_6_0);
+            out << magic << version << quint32(entries.size());
+            for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+                out << it.key() << it->size << it->mtime << it->value;
+            }
+            return data;
+        };
+
+        if (m_persistence) {
+            m_persistence->schedule(m_savePath, serialize);
+        } else {
+            PersistenceService::writeFile(m_savePath, serialize());
+        }
+    }
+
+private:
+    struct Entry
+    {
+        qint64 size = 0;
+        qint64 mtime = 0;       // 修改时间（毫秒时间戳）
+        Value value;
+    };
+
+    const quint32 m_magic;
+    const quint32 m_version;
+    const char *m_name;
+    QString m_savePath;
+
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;    // 规范路径 -> 缓存项
+    bool m_dirty;
+
+    std::atomic<quint64> m_hits;
+    std::atomic<quint64> m_misses;
+
+    QPointer<PersistenceService> m_persistence;
+};
+
+#endif // KEYEDFILECACHE_H
@@ -0,0 +1,55 @@
+#include "LoudnessCache.h"
+
+namespace {
+
+constexpr quint32 kCacheMagic = 0x4C444E43;     // "LDNC"
+constexpr quint32 kCacheVersion = 1;
+
+} // namespace
+
+LoudnessCache::LoudnessCache(QObject *parent)
+    : QObject{parent}
+    , m_cache("loudness_cache.dat", kCacheMagic, kCacheVersion, "loudness")
+{
+}
+
+LoudnessCache::~LoudnessCache()
+{
+    saveToFile();
+}
+
+bool LoudnessCache::lookup(const QString &filePath, LoudnessInfo &info)
+{
+    return m_cache.lookup(filePath, info);
+}
+
+void LoudnessCache::insert(const QString &filePath, const LoudnessInfo &info)
+{
+    m_cache.insert(filePath, info);
+}
+
+void LoudnessCache::setAlbumLoudness(const QStringList &filePaths, double integrated, double peak)
+{
+    m_cache.update(filePaths, [integrated, peak](LoudnessInfo &info) {
+        if (info.hasAlbum && info.albumIntegrated == integrated && info.albumPeak == peak) {
+            return false;
+        }
+        info.hasAlbum = true;
+        info.albumIntegrated = integrated;
+        info.albumPeak = peak;
+        return true;
+    });
+}
+
+float LoudnessCache::gain(const QString &filePath, GainMode mode, double preampDb)
+{
+    if (mode == GainOff) {
+        return 1.0f;
+    }
+
+    LoudnessInfo info;
+    if (!lookup(filePath, info) || !info.isValid()) {
+        return 1.0f;
+    }
+    return info.gain(mode == GainAlbum, ReferenceLufs + preampDb);
+}
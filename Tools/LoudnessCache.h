@@ -0,0 +1,62 @@
+#ifndef LOUDNESSCACHE_H
+#define LOUDNESSCACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "KeyedFileCache.h"
+#include "LoudnessMeter.h"
+
+class PersistenceService;
+
+/**
+ * @brief The LoudnessCache class
+ * 持久化的响度分析结果
+ *
+ * 与 MetadataCache 一样由 KeyedFileCache 以（规范路径、文件大小、修改时间）为键保存，文件未变化时直接复用。
+ * 保存在元数据缓存旁边（loudness_cache.dat），播放时由解码线程按音轨查询增益，可在多个线程中同时访问。
+ */
+class LoudnessCache : public QObject
+{
+    Q_OBJECT
+public:
+    // 回放增益的模式
+    enum GainMode {
+        GainOff,
+        GainTrack,
+        GainAlbum,      // 没有专辑响度时使用音轨响度
+    };
+
+    // ReplayGain 2.0 的参考响度
+    static constexpr double ReferenceLufs = -18.0;
+
+    explicit LoudnessCache(QObject *parent = nullptr);
+    ~LoudnessCache();
+
+    // 命中时写入 info 并返回 true
+    bool lookup(const QString &filePath, LoudnessInfo &info);
+    void insert(const QString &filePath, const LoudnessInfo &info);
+
+    // 为专辑中的每首音轨记录专辑响度与峰值
+    void setAlbumLoudness(const QStringList &filePaths, double integrated, double peak);
+
+    // 音轨的线性增益，没有分析结果或 mode 为 GainOff 时返回 1
+    float gain(const QString &filePath, GainMode mode, double preampDb = 0.0);
+
+    quint64 hitCount() const { return m_cache.hitCount(); }
+    quint64 missCount() const { return m_cache.missCount(); }
+
+    int size() const { return m_cache.size(); }
+
+    // 保存经由 persistence 在后台写入；未设置（或已销毁）时在调用线程中同步写入
+    void setPersistence(PersistenceService *persistence) { m_cache.setPersistence(persistence); }
+
+    void loadFromFile() { m_cache.loadFromFile(); }
+    void saveToFile() { m_cache.saveToFile(); }
+
+private:
+    KeyedFileCache<LoudnessInfo> m_cache;
+};
+
+#endif // LOUDNESSCACHE_H
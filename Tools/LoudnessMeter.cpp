@@ -0,0 +1,296 @@
+#include "LoudnessMeter.h"
+#include "DspKernels.h"
+
+#include <QDataStream>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+
+// 绝对门限（LUFS）与相对门限（LU）
+constexpr double AbsoluteGate = -70.0;
+constexpr double RelativeGate = -10.0;
+
+// BS.1770 附录 2：4 倍过采样的 48 阶多相滤波器，每相 12 个系数
+constexpr float OversampleTaps[4][12] = {
+    {  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f,
+      -0.0594482421875f,  0.1373291015625f,  0.9721679687500f, -0.1022949218750f,
+       0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f },
+    { -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f,
+      -0.1665039062500f,  0.4650878906250f,  0.7797851562500f, -0.2003173828125f,
+       0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f },
+    { -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f,
+      -0.2003173828125f,  0.7797851562500f,  0.4650878906250f, -0.1665039062500f,
+       0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f },
+    { -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f,
+      -0.1022949218750f,  0.9721679687500f,  0.1373291015625f, -0.0594482421875f,
+       0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f },
+};
+
+inline double energyToLufs(double energy)
+{
+    return -0.691 + 10.0 * std::log10(energy);
+}
+
+inline double lufsToEnergy(double lufs)
+{
+    return std::pow(10.0, (lufs + 0.691) / 10.0);
+}
+
+} // namespace
+
+float LoudnessInfo::gain(bool album, double referenceLufs) const
+{
+    if (!isValid()) {
+        return 1.0f;
+    }
+
+    const bool useAlbum = album && hasAlbum;
+    const double loudness = useAlbum ? albumIntegrated : integrated;
+    const double peak = useAlbum ? albumPeak : truePeak;
+
+    double linear = std::pow(10.0, (referenceLufs - loudness) / 20.0);
+    if (peak > 0.0) {
+        linear = std::min(linear, 1.0 / peak);
+    }
+    return float(linear);
+}
+
+QDataStream &operator<<(QDataStream &out, const LoudnessInfo &info)
+{
+    return out << info.integrated << info.truePeak << info.durationMs << info.histogram
+               << info.hasAlbum << info.albumIntegrated << info.albumPeak;
+}
+
+QDataStream &operator>>(QDataStream &in, LoudnessInfo &info)
+{
+    return in >> info.integrated >> info.truePeak >> info.durationMs >> info.histogram
+              >> info.hasAlbum >> info.albumIntegrated >> info.albumPeak;
+}
+
+bool LoudnessInfo::combinedLoudness(const QVector<const LoudnessInfo *> &tracks, double &lufs)
+{
+    // 合并直方图，每格以中心的响度计
+    QMap<quint16, quint64> merged;
+    for (const LoudnessInfo *track : tracks) {
+        for (auto it = track->histogram.constBegin(); it != track->histogram.constEnd(); ++it) {
+            merged[it.key()] += it.value();
+        }
+    }
+
+    auto binEnergy = [](quint16 bin) {
+        return lufsToEnergy(HistogramFloor + (bin + 0.5) * HistogramStep);
+    };
+
+    // 直方图中只有超过绝对门限的块
+    double sum = 0.0;
+    quint64 count = 0;
+    for (auto it = merged.constBegin(); it != merged.constEnd(); ++it) {
+        sum += binEnergy(it.key()) * it.value();
+        count += it.value();
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    const double threshold = lufsToEnergy(energyToLufs(sum / count) + RelativeGate);
+    sum = 0.0;
+    count = 0;
+    for (auto it = merged.constBegin(); it != merged.constEnd(); ++it) {
+        const double energy = binEnergy(it.key());
+        if (energy > threshold) {
+            sum += energy * it.value();
+            count += it.value();
+        }
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    lufs = energyToLufs(sum / count);
+    return true;
+}
+
+LoudnessMeter::LoudnessMeter(int sampleRate, int channels)
+    : m_sampleRate(qMax(1, sampleRate))
+    , m_channels(qMax(1, channels))
+    , m_oversample(m_sampleRate < 96000)
+    , m_subBlockFrames(qMax<qint64>(1, std::llround(m_sampleRate / 10.0)))
+    , m_subBlockFill(0)
+    , m_subBlockEnergy(0.0)
+    , m_subBlockCount(0)
+    , m_frames(0)
+{
+    // K 计权的两级滤波器，按采样率以双线性变换计算（48 kHz 时与 BS.1770 给出的系数一致）
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan(Pi * f0 / m_sampleRate);
+        const double vh = std::pow(10.0, gainDb / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        m_shelf.b0 = (vh + vb * k / q + k * k) / a0;
+        m_shelf.b1 = 2.0 * (k * k - vh) / a0;
+        m_shelf.b2 = (vh - vb * k / q + k * k) / a0;
+        m_shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+        m_shelf.a2 = (1.0 - k / q + k * k) / a0;
+    }
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan(Pi * f0 / m_sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+        m_highPass.b0 = 1.0;
+        m_highPass.b1 = -2.0;
+        m_highPass.b2 = 1.0;
+        m_highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+        m_highPass.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    m_channelState.resize(m_channels);
+    if (m_channels == 6) {
+        // L R C LFE Ls Rs
+        m_channelState[3].weight = 0.0;
+        m_channelState[4].weight = 1.41;
+        m_channelState[5].weight = 1.41;
+    }
+    m_planes.resize(m_channels);
+}
+
+void LoudnessMeter::process(const float *data, qint64 frames)
+{
+    const DspKernels &dsp = DspKernels::instance();
+    QVector<float *> planes(m_channels);
+
+    while (frames > 0) {
+        // 每次最多处理到当前子块结束
+        const qint64 n = qMin(frames, m_subBlockFrames - m_subBlockFill);
+        for (int c = 0; c < m_channels; ++c) {
+            if (m_planes[c].size() < n) {
+                m_planes[c].resize(n);
+            }
+            planes[c] = m_planes[c].data();
+        }
+        dsp.deinterleave(data, planes.constData(), m_channels, n);
+
+        for (int c = 0; c < m_channels; ++c) {
+            processChannel(m_channelState[c], planes[c], n, m_subBlockEnergy);
+        }
+
+        data += n * m_channels;
+        frames -= n;
+        m_frames += n;
+        m_subBlockFill += n;
+        if (m_subBlockFill == m_subBlockFrames) {
+            finishSubBlock();
+        }
+    }
+}
+
+void LoudnessMeter::processChannel(Channel &channel, const float *samples, qint64 count, double &energy)
+{
+    const Biquad s = m_shelf;
+    const Biquad h = m_highPass;
+    double z0 = channel.z[0], z1 = channel.z[1], z2 = channel.z[2], z3 = channel.z[3];
+    double sum = 0.0;
+    float peak = channel.peak;
+
+    for (qint64 i = 0; i < count; ++i) {
+        const double x = samples[i];
+        const double y1 = s.b0 * x + z0;
+        z0 = s.b1 * x - s.a1 * y1 + z1;
+        z1 = s.b2 * x - s.a2 * y1;
+        const double y2 = h.b0 * y1 + z2;
+        z2 = h.b1 * y1 - h.a1 * y2 + z3;
+        z3 = h.b2 * y1 - h.a2 * y2;
+        sum += y2 * y2;
+    }
+
+    if (m_oversample) {
+        // 历史缓冲区存两份，history[pos, pos + 12) 总是按时间顺序排列的最近 12 个采样
+        float *history = channel.history;
+        int pos = channel.historyPos;
+        for (qint64 i = 0; i < count; ++i) {
+            history[pos] = history[pos + 12] = samples[i];
+            pos = pos == 11 ? 0 : pos + 1;
+
+            const float *window = history + pos;
+            for (const auto &taps : OversampleTaps) {
+                float y = 0.0f;
+                for (int k = 0; k < 12; ++k) {
+                    y += taps[k] * window[11 - k];
+                }
+                peak = std::max(peak, std::fabs(y));
+            }
+        }
+        channel.historyPos = pos;
+    } else {
+        for (qint64 i = 0; i < count; ++i) {
+            peak = std::max(peak, std::fabs(samples[i]));
+        }
+    }
+
+    // 静音时滤波器状态会衰减为非规格化数，直接归零
+    auto flush = [](double v) { return std::fabs(v) < 1e-30 ? 0.0 : v; };
+    channel.z[0] = flush(z0);
+    channel.z[1] = flush(z1);
+    channel.z[2] = flush(z2);
+    channel.z[3] = flush(z3);
+    channel.peak = peak;
+    energy += channel.weight * sum;
+}
+
+void LoudnessMeter::finishSubBlock()
+{
+    m_subBlocks[m_subBlockCount % 4] = m_subBlockEnergy / m_subBlockFrames;
+    ++m_subBlockCount;
+    m_subBlockEnergy = 0.0;
+    m_subBlockFill = 0;
+
+    if (m_subBlockCount >= 4) {
+        m_blocks.append((m_subBlocks[0] + m_subBlocks[1] + m_subBlocks[2] + m_subBlocks[3]) / 4.0);
+    }
+}
+
+LoudnessInfo LoudnessMeter::result() const
+{
+    LoudnessInfo info;
+    info.durationMs = m_frames * 1000 / m_sampleRate;
+    for (const Channel &channel : m_channelState) {
+        info.truePeak = std::max(info.truePeak, double(channel.peak));
+    }
+
+    // 绝对门限
+    const double absolute = lufsToEnergy(AbsoluteGate);
+    double sum = 0.0;
+    qint64 count = 0;
+    for (const double energy : m_blocks) {
+        if (energy > absolute) {
+            sum += energy;
+            ++count;
+
+            const double bin = std::floor((energyToLufs(energy) - LoudnessInfo::HistogramFloor) / LoudnessInfo::HistogramStep);
+            ++info.histogram[quint16(std::clamp(bin, 0.0, 65535.0))];
+        }
+    }
+    if (count == 0) {
+        return info;
+    }
+
+    // 相对门限
+    const double relative = lufsToEnergy(energyToLufs(sum / count) + RelativeGate);
+    sum = 0.0;
+    count = 0;
+    for (const double energy : m_blocks) {
+        if (energy > absolute && energy > relative) {
+            sum += energy;
+            ++count;
+        }
+    }
+    info.integrated = energyToLufs(sum / count);
+    return info;
+}
@@ -0,0 +1,106 @@
+#ifndef LOUDNESSMETER_H
+#define LOUDNESSMETER_H
+
+#include <QMap>
+#include <QMetaType>
+#include <QVector>
+
+class QDataStream;
+
+/**
+ * @brief The LoudnessInfo struct
+ * 一首音轨的响度分析结果（EBU R128 / ITU-R BS.1770）
+ *
+ * 除音轨本身的积分响度与真峰值外，还保存门限块响度的直方图，
+ * 同一专辑的直方图合并后即可计算专辑响度，不需要重新解码。专辑响度与峰值在整张专辑分析完成后填入。
+ */
+struct LoudnessInfo
+{
+    // 直方图的下限（绝对门限）与分辨率
+    static constexpr double HistogramFloor = -70.0;
+    static constexpr double HistogramStep = 0.05;
+
+    double integrated = 0.0;        // 积分响度（LUFS）
+    double truePeak = 0.0;          // 真峰值（线性，1.0 为满幅）
+    qint64 durationMs = 0;
+    QMap<quint16, quint32> histogram;   // 超过绝对门限的门限块：响度所在的格 -> 块数
+
+    bool hasAlbum = false;
+    double albumIntegrated = 0.0;
+    double albumPeak = 0.0;
+
+    bool isValid() const { return !histogram.isEmpty(); }
+
+    // 把响度调整到 referenceLufs 所需的线性增益，album 为真且有专辑响度时使用专辑响度；
+    // 增益不会让峰值超过满幅。无效的结果返回 1
+    float gain(bool album, double referenceLufs) const;
+
+    // 多首音轨合并后的积分响度，没有有效的门限块时返回 false
+    static bool combinedLoudness(const QVector<const LoudnessInfo *> &tracks, double &lufs);
+};
+
+Q_DECLARE_METATYPE(LoudnessInfo)
+
+// 响度缓存文件中的格式
+QDataStream &operator<<(QDataStream &out, const LoudnessInfo &info);
+QDataStream &operator>>(QDataStream &in, LoudnessInfo &info);
+
+/**
+ * @brief The LoudnessMeter class
+ * BS.1770 响度计
+ *
+ * 逐块送入交错的 float 采样：K 计权（高架滤波加高通滤波）后按 100 ms 子块累计均方值，
+ * 每 400 ms（重叠 75%）形成一个门限块；结束时经绝对门限（-70 LUFS）与相对门限（-10 LU）得到积分响度。
+ * 滤波系数按实际采样率计算。真峰值在 96 kHz 以下按 BS.1770 附录 2 的 4 倍过采样滤波器估计，更高的采样率直接取采样峰值。
+ * 声道按 BS.1770 计权：5.1 的低音声道不计入，环绕声道乘以 1.41，其余为 1。
+ */
+class LoudnessMeter
+{
+public:
+    LoudnessMeter(int sampleRate, int channels);
+
+    int sampleRate() const { return m_sampleRate; }
+    int channelCount() const { return m_channels; }
+
+    void process(const float *data, qint64 frames);
+    LoudnessInfo result() const;
+
+private:
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    };
+
+    struct Channel
+    {
+        double weight = 1.0;
+        double z[4] = {};           // 两级滤波器的状态（直接 II 型转置）
+        float history[24] = {};     // 过采样滤波器最近的输入（存两份，免去取模）
+        int historyPos = 0;
+        float peak = 0.0f;
+    };
+
+    void processChannel(Channel &channel, const float *samples, qint64 count, double &energy);
+    void finishSubBlock();
+
+private:
+    int m_sampleRate;
+    int m_channels;
+    bool m_oversample;
+
+    Biquad m_shelf;
+    Biquad m_highPass;
+    QVector<Channel> m_channelState;
+
+    qint64 m_subBlockFrames;        // 100 ms
+    qint64 m_subBlockFill;          // 当前子块已累计的帧数
+    double m_subBlockEnergy;        // 当前子块的计权平方和
+    double m_subBlocks[4] = {};     // 最近 4 个子块的均方值
+    qint64 m_subBlockCount;
+
+    QVector<double> m_blocks;       // 各门限块的计权均方值
+    QVector<QVector<float>> m_planes;
+    qint64 m_frames;
+};
+
+#endif // LOUDNESSMETER_H
@@ -0,0 +1,281 @@
+#include "LoudnessScanner.h"
+#include "BlockingDecoder.h"
+#include "LoudnessCache.h"
+
+#include <QThread>
+#include <QUrl>
+
+#include <algorithm>
+
+namespace {
+
+// 在工作线程中解码整首音轨并测量响度（按文件本身的采样率与声道数）
+bool analyzeTrack(const QString &filePath, const std::atomic_bool &canceled, LoudnessInfo &info)
+{
+    std::unique_ptr<LoudnessMeter> meter;
+    const bool ok = BlockingDecoder::decode(filePath, canceled,
+                                            [&meter](const QAudioFormat &format, const float *data, qint64 frames) {
+        if (!meter) {
+            meter = std::make_unique<LoudnessMeter>(format.sampleRate(), format.channelCount());
+        } else if (format.sampleRate() != meter->sampleRate() || format.channelCount() != meter->channelCount()) {
+            return;     // 中途改变格式的流只测量第一段
+        }
+        meter->process(data, frames);
+    });
+
+    if (!ok || !meter) {
+        return false;
+    }
+
+    info = meter->result();
+    return true;
+}
+
+// 合并各音轨的门限块得到专辑响度，写入 cache（任意线程）
+void storeAlbumLoudness(LoudnessCache *cache, const QStringList &filePaths, const QVector<LoudnessInfo> &results)
+{
+    QVector<const LoudnessInfo *> valid;
+    QStringList validPaths;
+    double albumPeak = 0.0;
+    for (int i = 0; i < results.size(); ++i) {
+        if (results[i].isValid()) {
+            valid.append(&results[i]);
+            validPaths.append(filePaths.at(i));
+            albumPeak = std::max(albumPeak, results[i].truePeak);
+        }
+    }
+
+    double albumLufs = 0.0;
+    if (LoudnessInfo::combinedLoudness(valid, albumLufs)) {
+        cache->setAlbumLoudness(validPaths, albumLufs, albumPeak);
+    }
+}
+
+} // namespace
+
+LoudnessScanner::LoudnessScanner(QObject *parent)
+    : QObject{parent}
+    , m_cache(nullptr)
+    , m_generation(0)
+    , m_canceled(std::make_shared<std::atomic_bool>(false))
+    , m_doneCount(0)
+    , m_analyzedCount(0)
+    , m_analyzedMs(0)
+    , m_running(false)
+    , m_realtimeFactor(0.0)
+{
+    // 后台任务，默认只占用一半的核心，且不与播放、界面争抢
+    m_threadPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+    m_threadPool.setThreadPriority(QThread::LowPriority);
+}
+
+LoudnessScanner::~LoudnessScanner()
+{
+    cancel();
+    m_threadPool.waitForDone();
+}
+
+void LoudnessScanner::setMaxConcurrency(int count)
+{
+    m_threadPool.setMaxThreadCount(qMax(1, count));
+}
+
+int LoudnessScanner::maxConcurrency() const
+{
+    return m_threadPool.maxThreadCount();
+}
+
+void LoudnessScanner::setLoudnessCache(LoudnessCache *cache)
+{
+    m_cache = cache;
+}
+
+void LoudnessScanner::scanAlbum(const QStringList &tracks, const QString &priorityTrack)
+{
+    start(tracks, priorityTrack, QStringList());
+}
+
+void LoudnessScanner::scanChanged(const QStringList &tracks, const QStringList &albumTracks)
+{
+    QStringList filePaths;
+    for (const QString &track : albumTracks) {
+        const QUrl url(track);
+        if (url.isLocalFile()) {
+            filePaths.append(url.toLocalFile());
+        }
+    }
+    start(tracks, QString(), filePaths);
+}
+
+void LoudnessScanner::start(const QStringList &tracks, const QString &priorityTrack, const QStringList &albumTracks)
+{
+    cancel();
+
+    // 新一轮任务使用新的代号与取消标记，旧任务的结果回送时会被丢弃
+    ++m_generation;
+    m_canceled = std::make_shared<std::atomic_bool>(false);
+
+    // 只分析本地文件
+    m_tracks.clear();
+    int priorityIndex = -1;
+    for (const QString &track : tracks) {
+        const QUrl url(track);
+        if (url.isLocalFile()) {
+            if (track == priorityTrack) {
+                priorityIndex = m_tracks.size();
+            }
+            m_tracks.append(track);
+        }
+    }
+
+    m_results = QVector<LoudnessInfo>(m_tracks.size());
+    m_albumTracks = albumTracks;
+    m_doneCount = 0;
+    m_analyzedCount = 0;
+    m_analyzedMs = 0;
+    m_running = true;
+    m_timer.start();
+
+    if (m_tracks.isEmpty()) {
+        if (m_albumTracks.isEmpty()) {
+            m_running = false;
+            m_realtimeFactor = 0.0;
+            emit finished(0, 0, 0.0);
+        } else {
+            // 只删除了音轨，仍需重新计算专辑响度
+            finishAlbum();
+        }
+        return;
+    }
+
+    const quint64 generation = m_generation;
+    const auto canceled = m_canceled;
+    LoudnessCache *cache = m_cache;
+
+    // 线程池按提交顺序执行，优先的音轨最先提交
+    QVector<int> order;
+    order.reserve(m_tracks.size());
+    if (priorityIndex >= 0) {
+        order.append(priorityIndex);
+    }
+    for (int i = 0; i < m_tracks.size(); ++i) {
+        if (i != priorityIndex) {
+            order.append(i);
+        }
+    }
+
+    for (const int i : std::as_const(order)) {
+        const QString filePath = QUrl(m_tracks.at(i)).toLocalFile();
+        m_threadPool.start([this, generation, canceled, cache, i, filePath]() {
+            if (canceled->load()) {
+                return;
+            }
+
+            // 文件未变化时直接使用缓存
+            LoudnessInfo info;
+            bool analyzed = false;
+            if (!cache || !cache->lookup(filePath, info)) {
+                if (!analyzeTrack(filePath, *canceled, info)) {
+                    info = LoudnessInfo();
+                } else {
+                    analyzed = true;
+                    if (cache) {
+                        cache->insert(filePath, info);
+                    }
+                }
+            }
+
+            if (canceled->load()) {
+                return;
+            }
+
+            // 回到所属线程汇总结果
+            QMetaObject::invokeMethod(this, [this, generation, i, info, analyzed]() {
+                onTaskFinished(generation, i, info, analyzed);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void LoudnessScanner::cancel()
+{
+    m_canceled->store(true);
+    m_threadPool.clear();   // 移除尚未开始的任务
+    m_running = false;
+}
+
+void LoudnessScanner::onTaskFinished(quint64 generation, int index, const LoudnessInfo &info, bool analyzed)
+{
+    if (generation != m_generation || !m_running) {
+        return;
+    }
+
+    m_results[index] = info;
+    ++m_doneCount;
+    if (analyzed) {
+        ++m_analyzedCount;
+        m_analyzedMs += info.durationMs;
+    }
+
+    if (info.isValid()) {
+        emit trackScanned(m_tracks.at(index), info);
+    }
+
+    const int total = m_results.size();
+    emit progress(m_doneCount, total);
+
+    if (m_doneCount == total) {
+        finishAlbum();
+    }
+}
+
+void LoudnessScanner::finishAlbum()
+{
+    m_running = false;
+
+    const int total = m_results.size();
+    const qint64 elapsed = m_timer.elapsed();
+    m_realtimeFactor = elapsed > 0 ? double(m_analyzedMs) / elapsed : 0.0;
+
+    if (m_albumTracks.isEmpty()) {
+        QStringList filePaths;
+        filePaths.reserve(total);
+        for (const QString &track : std::as_const(m_tracks)) {
+            filePaths.append(QUrl(track).toLocalFile());
+        }
+        if (m_cache) {
+            storeAlbumLoudness(m_cache, filePaths, m_results);
+        }
+        m_results.clear();
+        emit finished(total, elapsed, m_realtimeFactor);
+        return;
+    }
+
+    // 增量分析：未变化的音轨的结果都在缓存中，在线程池中查询后与本次的结果一起合并，之后再报告完成
+    const quint64 generation = m_generation;
+    const auto canceled = m_canceled;
+    LoudnessCache *cache = m_cache;
+    const QStringList albumTracks = m_albumTracks;
+    const double realtimeFactor = m_realtimeFactor;
+    m_results.clear();
+    m_albumTracks.clear();
+
+    m_threadPool.start([this, generation, canceled, cache, albumTracks, total, elapsed, realtimeFactor]() {
+        if (cache) {
+            QVector<LoudnessInfo> results(albumTracks.size());
+            for (int i = 0; i < albumTracks.size() && !canceled->load(); ++i) {
+                cache->lookup(albumTracks.at(i), results[i]);   // 未命中的保持无效，不参与合并
+            }
+            if (canceled->load()) {
+                return;
+            }
+            storeAlbumLoudness(cache, albumTracks, results);
+        }
+
+        QMetaObject::invokeMethod(this, [this, generation, total, elapsed, realtimeFactor]() {
+            if (generation == m_generation) {
+                emit finished(total, elapsed, realtimeFactor);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
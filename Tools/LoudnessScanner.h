@@ -0,0 +1,79 @@
+#ifndef LOUDNESSSCANNER_H
+#define LOUDNESSSCANNER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+#include "LoudnessMeter.h"
+
+#include <atomic>
+#include <memory>
+
+class LoudnessCache;
+
+/**
+ * @brief The LoudnessScanner class
+ * 专辑响度分析
+ *
+ * 将专辑内的本地音轨分发到低优先级的线程池中并行解码并测量响度（LoudnessMeter），结果写入 LoudnessCache，
+ * 文件未变化的音轨直接使用缓存。全部完成后合并各音轨的门限块直方图得到专辑响度与峰值；
+ * 专辑只有部分音轨变化时（scanChanged）只分析变化的音轨，其余音轨的结果从缓存中取出后一起合并。
+ * 每次分析记录速度（实时倍数，见 realtimeFactor），以便按机器调整并发上限。
+ */
+class LoudnessScanner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LoudnessScanner(QObject *parent = nullptr);
+    ~LoudnessScanner();
+
+    // 并发上限（工作线程数）
+    void setMaxConcurrency(int count);
+    int maxConcurrency() const;
+
+    void setLoudnessCache(LoudnessCache *cache);
+
+    // 开始分析一张专辑，会取消上一次尚未完成的分析；priorityTrack 不为空时最先分析
+    void scanAlbum(const QStringList &tracks, const QString &priorityTrack = QString());
+    // 只分析专辑中新增或修改的音轨 tracks，完成后按 albumTracks（专辑现有的全部音轨）重新计算专辑响度
+    void scanChanged(const QStringList &tracks, const QStringList &albumTracks);
+    void cancel();
+
+    bool isRunning() const { return m_running; }
+
+    // 最近一次分析的速度（音频时长 / 实际耗时），只统计实际解码的音轨
+    double realtimeFactor() const { return m_realtimeFactor; }
+
+signals:
+    void trackScanned(const QString &url, const LoudnessInfo &info);
+    void progress(int done, int total);
+    void finished(int total, qint64 elapsedMs, double realtimeFactor);
+
+private:
+    void start(const QStringList &tracks, const QString &priorityTrack, const QStringList &albumTracks);
+    void onTaskFinished(quint64 generation, int index, const LoudnessInfo &info, bool analyzed);
+    void finishAlbum();
+
+private:
+    QThreadPool m_threadPool;
+    LoudnessCache *m_cache;
+
+    quint64 m_generation;                          // 当前任务代号，用于丢弃过期结果
+    std::shared_ptr<std::atomic_bool> m_canceled;  // 当前任务的取消标记
+
+    QStringList m_tracks;             // 本次分析的本地音轨 url
+    QVector<LoudnessInfo> m_results;  // 按音轨顺序存放的结果
+    QStringList m_albumTracks;        // 增量分析时专辑全部音轨的本地文件路径，完整分析时为空
+    int m_doneCount;
+    int m_analyzedCount;              // 实际解码的音轨数（其余来自缓存）
+    qint64 m_analyzedMs;              // 实际解码的音频时长
+
+    bool m_running;
+    double m_realtimeFactor;
+    QElapsedTimer m_timer;
+};
+
+#endif // LOUDNESSSCANNER_H
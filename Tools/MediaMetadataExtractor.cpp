@@ -1,4 +1,5 @@
 #include "MediaMetadataExtractor.h"
+#include "NativeTagReader.h"
 
 #include <QFileInfo>
 
@@ -14,6 +15,25 @@ QVariantMap MediaMetadataExtractor::extractMetadata(const QUrl &url, int timeout
         return metadata;
     }
 
+    // 优先使用内置解析器直接读取标签，无法识别的格式才回退到 QMediaPlayer
+    if (!NativeTagReader::read(url.toLocalFile(), metadata)) {
+        metadata = extractWithPlayer(url, timeout);
+        if (metadata.isEmpty()) {
+            return metadata;
+        }
+    }
+
+    applyFallbacks(url, metadata);
+
+    metadata.insert("Url", url);
+
+    return metadata;
+}
+
+QVariantMap MediaMetadataExtractor::extractWithPlayer(const QUrl &url, int timeout)
+{
+    QVariantMap metadata;
+
     QMediaPlayer player;
     QEventLoop eventLoop;
     QTimer timeoutTimer;
@@ -50,6 +70,15 @@ QVariantMap MediaMetadataExtractor::extractMetadata(const QUrl &url, int timeout
         }
     }
 
+    if (player.duration() > 0) {
+        metadata.insert("Duration", player.duration());
+    }
+
+    return metadata;
+}
+
+void MediaMetadataExtractor::applyFallbacks(const QUrl &url, QVariantMap &metadata)
+{
     if (metadata[metaDataKeyToString(QMediaMetaData::Title)].isNull())   // 当取标题失败的时候
     {
         // 从文件字符串中解析
@@ -80,7 +109,7 @@ QVariantMap MediaMetadataExtractor::extractMetadata(const QUrl &url, int timeout
 
         }
         // 从专辑作者中复制
-        else if (!mediaData.value(QMediaMetaData::AlbumArtist).isNull())
+        else if (!metadata[metaDataKeyToString(QMediaMetaData::AlbumArtist)].isNull())
         {
             metadata[metaDataKeyToString(QMediaMetaData::Author)] = metadata[metaDataKeyToString(QMediaMetaData::AlbumArtist)];
         }
@@ -105,14 +134,6 @@ QVariantMap MediaMetadataExtractor::extractMetadata(const QUrl &url, int timeout
             metadata[metaDataKeyToString(QMediaMetaData::Author)] = artist;
         }
     }
-
-    if (player.duration() > 0) {
-        metadata.insert("Duration", player.duration());
-    }
-
-    metadata.insert("Url", url);
-
-    return metadata;
 }
 
 bool MediaMetadataExtractor::validateUrl(const QUrl &url)
@@ -19,11 +19,17 @@ public:
 
     static QVariantMap extractMetadata(const QUrl &url, int timeout = 5000);
 
+    static QString metaDataKeyToString(QMediaMetaData::Key key);
+
 private:
     static bool validateUrl(const QUrl &url);
 
+    // 使用 QMediaPlayer 提取（内置解析器无法识别的格式）
+    static QVariantMap extractWithPlayer(const QUrl &url, int timeout);
+    // 标题、作者缺失时的补全
+    static void applyFallbacks(const QUrl &url, QVariantMap &metadata);
+
     static QList<QMediaMetaData::Key> getTargetMetadataKeys();
-    static QString metaDataKeyToString(QMediaMetaData::Key key);
 
 signals:
 };
@@ -0,0 +1,42 @@
+#include "MetadataCache.h"
+
+namespace {
+
+constexpr quint32 kCacheMagic = 0x4D444348;     // "MDCH"
+constexpr quint32 kCacheVersion = 1;
+
+// 图片体积大、序列化慢，不进入缓存
+void stripImages(QVariantMap &metadata)
+{
+    metadata.remove("ThumbnailImage");
+    metadata.remove("CoverArtImage");
+}
+
+} // namespace
+
+MetadataCache::MetadataCache(QObject *parent)
+    : QObject{parent}
+    , m_cache("metadata_cache.dat", kCacheMagic, kCacheVersion, "metadata")
+{
+}
+
+MetadataCache::~MetadataCache()
+{
+    saveToFile();
+}
+
+bool MetadataCache::lookup(const QString &filePath, QVariantMap &metadata)
+{
+    return m_cache.lookup(filePath, metadata);
+}
+
+void MetadataCache::insert(const QString &filePath, const QVariantMap &metadata)
+{
+    if (metadata.isEmpty()) {
+        return;
+    }
+
+    QVariantMap stripped = metadata;
+    stripImages(stripped);
+    m_cache.insert(filePath, stripped);
+}
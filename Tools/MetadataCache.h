@@ -0,0 +1,46 @@
+#ifndef METADATACACHE_H
+#define METADATACACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QVariantMap>
+
+#include "KeyedFileCache.h"
+
+class PersistenceService;
+
+/**
+ * @brief The MetadataCache class
+ * 持久化的元数据缓存
+ *
+ * 以（规范路径、文件大小、修改时间）为键缓存提取出的元数据，文件未变化时直接复用，不再重新提取。
+ * 键的校验、文件格式与持久化由 KeyedFileCache 完成，可在多个线程中同时查询和写入。
+ */
+class MetadataCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MetadataCache(QObject *parent = nullptr);
+    ~MetadataCache();
+
+    // 命中时写入 metadata 并返回 true
+    bool lookup(const QString &filePath, QVariantMap &metadata);
+    void insert(const QString &filePath, const QVariantMap &metadata);
+
+    quint64 hitCount() const { return m_cache.hitCount(); }
+    quint64 missCount() const { return m_cache.missCount(); }
+    void resetCounters() { m_cache.resetCounters(); }
+
+    int size() const { return m_cache.size(); }
+
+    // 保存经由 persistence 在后台写入；未设置（或已销毁）时在调用线程中同步写入
+    void setPersistence(PersistenceService *persistence) { m_cache.setPersistence(persistence); }
+
+    void loadFromFile() { m_cache.loadFromFile(); }
+    void saveToFile() { m_cache.saveToFile(); }
+
+private:
+    KeyedFileCache<QVariantMap> m_cache;
+};
+
+#endif // METADATACACHE_H
@@ -0,0 +1,224 @@
+#include "MetadataExtractPool.h"
+#include "MediaMetadataExtractor.h"
+#include "MetadataCache.h"
+
+#include <QDebug>
+#include <QThread>
+#include <QUrl>
+
+MetadataExtractPool::MetadataExtractPool(QObject *parent)
+    : QObject{parent}
+    , m_batchSize(32)
+    , m_cache(nullptr)
+    , m_cacheHitsAtStart(0)
+    , m_cacheMissesAtStart(0)
+    , m_generation(0)
+    , m_canceled(std::make_shared<std::atomic_bool>(false))
+    , m_nextIndex(0)
+    , m_priorityIndex(-1)
+    , m_doneCount(0)
+    , m_metadataBytes(0)
+    , m_recordBytes(0)
+    , m_running(false)
+    , m_throughput(0.0)
+{
+    m_threadPool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+MetadataExtractPool::~MetadataExtractPool()
+{
+    cancel();
+    m_threadPool.waitForDone();
+}
+
+void MetadataExtractPool::setMaxConcurrency(int count)
+{
+    m_threadPool.setMaxThreadCount(qMax(1, count));
+}
+
+int MetadataExtractPool::maxConcurrency() const
+{
+    return m_threadPool.maxThreadCount();
+}
+
+void MetadataExtractPool::setBatchSize(int size)
+{
+    m_batchSize = qMax(1, size);
+}
+
+int MetadataExtractPool::batchSize() const
+{
+    return m_batchSize;
+}
+
+void MetadataExtractPool::setMetadataCache(MetadataCache *cache)
+{
+    m_cache = cache;
+}
+
+void MetadataExtractPool::start(const QStringList &tracks, const QString &priorityTrack)
+{
+    cancel();
+
+    // 新一轮任务使用新的代号与取消标记，旧任务的结果回送时会被丢弃
+    ++m_generation;
+    m_canceled = std::make_shared<std::atomic_bool>(false);
+
+    m_results = QVector<TrackRecord>(tracks.size());
+    m_ready = QVector<bool>(tracks.size(), false);
+    m_nextIndex = 0;
+    m_priorityIndex = priorityTrack.isEmpty() ? -1 : tracks.indexOf(priorityTrack);
+    m_doneCount = 0;
+    m_metadataBytes = 0;
+    m_recordBytes = 0;
+    m_running = true;
+    m_timer.start();
+
+    if (m_cache) {
+        m_cacheHitsAtStart = m_cache->hitCount();
+        m_cacheMissesAtStart = m_cache->missCount();
+    }
+
+    if (tracks.isEmpty()) {
+        m_running = false;
+        m_throughput = 0.0;
+        emit finished(0, 0, 0.0);
+        return;
+    }
+
+    const quint64 generation = m_generation;
+    const auto canceled = m_canceled;
+    MetadataCache *cache = m_cache;
+
+    // 线程池按提交顺序执行，优先的音轨最先提交
+    QVector<int> order;
+    order.reserve(tracks.size());
+    if (m_priorityIndex >= 0) {
+        order.append(m_priorityIndex);
+    }
+    for (int i = 0; i < tracks.size(); ++i) {
+        if (i != m_priorityIndex) {
+            order.append(i);
+        }
+    }
+
+    for (const int i : std::as_const(order)) {
+        const QString track = tracks.at(i);
+        m_threadPool.start([this, generation, canceled, cache, i, track]() {
+            if (canceled->load()) {
+                return;
+            }
+
+            const QUrl url(track);
+            QVariantMap metadata;
+
+            // 文件未变化时直接使用缓存
+            if (!cache || !cache->lookup(url.toLocalFile(), metadata)) {
+                metadata = MediaMetadataExtractor::extractMetadata(url);
+                if (cache && !metadata.isEmpty()) {
+                    cache->insert(url.toLocalFile(), metadata);
+                }
+            }
+
+            if (canceled->load()) {
+                return;
+            }
+
+            // 转换为紧凑存储，原始的 QVariantMap（连同封面图像）在此释放
+            const TrackRecord track = TrackRecord::fromMetadata(metadata);
+            const qsizetype metadataBytes = TrackRecord::estimateMetadataMemory(metadata);
+
+            // 回到所属线程汇总结果
+            QMetaObject::invokeMethod(this, [this, generation, i, track, metadataBytes]() {
+                onTaskFinished(generation, i, track, metadataBytes);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void MetadataExtractPool::cancel()
+{
+    m_canceled->store(true);
+    m_threadPool.clear();   // 移除尚未开始的任务
+    m_running = false;
+}
+
+void MetadataExtractPool::onTaskFinished(quint64 generation, int index, const TrackRecord &track,
+                                         qsizetype metadataBytes)
+{
+    if (generation != m_generation || !m_running) {
+        return;
+    }
+
+    m_results[index] = track;
+    if (!track.isNull()) {
+        m_metadataBytes += metadataBytes;
+        m_recordBytes += track.memoryUsage();
+    }
+    m_ready[index] = true;
+    ++m_doneCount;
+
+    if (index == m_priorityIndex && !track.isNull()) {
+        emit priorityTrackReady(track);
+    }
+
+    const int total = m_results.size();
+    const bool allDone = (m_doneCount == total);
+
+    emit progress(m_doneCount, total);
+
+    flushReady(allDone);
+
+    if (allDone) {
+        m_running = false;
+
+        const qint64 elapsed = m_timer.elapsed();
+        m_throughput = elapsed > 0 ? total * 1000.0 / elapsed : total;
+
+        qDebug().nospace() << "Metadata extracted: " << total << " tracks in "
+                           << elapsed << " ms (" << m_throughput << " tracks/s, "
+                           << maxConcurrency() << " workers)";
+        if (m_cache) {
+            qDebug().nospace() << "Metadata cache: "
+                               << m_cache->hitCount() - m_cacheHitsAtStart << " hits, "
+                               << m_cache->missCount() - m_cacheMissesAtStart << " misses";
+        }
+        if (total > 0) {
+            qDebug().nospace() << "Track storage: " << m_recordBytes / total << " bytes/track (QVariantMap: "
+                               << m_metadataBytes / total << " bytes/track)";
+        }
+
+        emit finished(total, elapsed, m_throughput);
+    }
+}
+
+void MetadataExtractPool::flushReady(bool force)
+{
+    // 只回送从 m_nextIndex 开始连续完成的部分，保证播放列表顺序与专辑一致
+    int end = m_nextIndex;
+    while (end < m_ready.size() && m_ready[end]) {
+        ++end;
+    }
+
+    if (end == m_nextIndex) {
+        return;
+    }
+    if (!force && end - m_nextIndex < m_batchSize) {
+        return;
+    }
+
+    QVector<TrackRecord> batch;
+    batch.reserve(end - m_nextIndex);
+    for (int i = m_nextIndex; i < end; ++i) {
+        // 提取失败的音轨（空元数据）不进入播放列表
+        if (!m_results[i].isNull()) {
+            batch.append(m_results[i]);
+        }
+        m_results[i] = TrackRecord();
+    }
+    m_nextIndex = end;
+
+    if (!batch.isEmpty()) {
+        emit batchReady(batch);
+    }
+}
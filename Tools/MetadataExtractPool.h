@@ -0,0 +1,88 @@
+#ifndef METADATAEXTRACTPOOL_H
+#define METADATAEXTRACTPOOL_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+#include "TrackRecord.h"
+
+#include <atomic>
+#include <memory>
+
+class MetadataCache;
+
+/**
+ * @brief The MetadataExtractPool class
+ * 并行元数据提取池
+ *
+ * 将专辑内的音轨分发到有界的线程池中并行提取元数据，提取结果按音轨原有顺序分批回送到所属线程，
+ * 全部完成后报告吞吐量（音轨/秒），以便按机器调整并发上限。
+ * 元数据在工作线程中转换为紧凑的 TrackRecord，并统计转换前后每首音轨的内存占用。
+ */
+class MetadataExtractPool : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MetadataExtractPool(QObject *parent = nullptr);
+    ~MetadataExtractPool();
+
+    // 并发上限（工作线程数）
+    void setMaxConcurrency(int count);
+    int maxConcurrency() const;
+
+    // 每批回送的音轨数
+    void setBatchSize(int size);
+    int batchSize() const;
+
+    // 元数据缓存，命中时跳过提取
+    void setMetadataCache(MetadataCache *cache);
+
+    // 开始提取，会取消上一次尚未完成的任务
+    // priorityTrack 不为空时最先提取该音轨，完成后立即通过 priorityTrackReady 单独回送（仍会按顺序出现在批次中）
+    void start(const QStringList& tracks, const QString& priorityTrack = QString());
+    void cancel();
+
+    bool isRunning() const { return m_running; }
+
+    // 最近一次提取的吞吐量（音轨/秒）
+    double throughput() const { return m_throughput; }
+
+signals:
+    void batchReady(const QVector<TrackRecord>& batch);
+    void priorityTrackReady(const TrackRecord& track);
+    void progress(int done, int total);
+    void finished(int total, qint64 elapsedMs, double tracksPerSecond);
+
+private:
+    void onTaskFinished(quint64 generation, int index, const TrackRecord& track,
+                        qsizetype metadataBytes);
+    void flushReady(bool force);
+
+private:
+    QThreadPool m_threadPool;
+    int m_batchSize;
+    MetadataCache *m_cache;
+    quint64 m_cacheHitsAtStart;
+    quint64 m_cacheMissesAtStart;
+
+    quint64 m_generation;                          // 当前任务代号，用于丢弃过期结果
+    std::shared_ptr<std::atomic_bool> m_canceled;  // 当前任务的取消标记
+
+    QVector<TrackRecord> m_results;   // 按音轨顺序存放的结果
+    QVector<bool> m_ready;            // 对应位置是否已完成
+    int m_nextIndex;                  // 下一个待回送的位置
+    int m_priorityIndex;              // 优先提取的位置，-1 表示无
+    int m_doneCount;
+
+    qsizetype m_metadataBytes;        // 本轮 QVariantMap 形式的估算内存
+    qsizetype m_recordBytes;          // 本轮 TrackRecord 形式的估算内存
+
+    bool m_running;
+    double m_throughput;
+    QElapsedTimer m_timer;
+};
+
+#endif // METADATAEXTRACTPOOL_H
@@ -0,0 +1,1316 @@
+#include "NativeTagReader.h"
+#include "MediaMetadataExtractor.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QMediaFormat>
+#include <QStringDecoder>
+
+#include <functional>
+
+namespace {
+
+constexpr qint64 kMaxTagSize = 16 * 1024 * 1024;   // 单个标签块的读取上限（封面等图片不读取）
+constexpr qint64 kHeadScanSize = 64 * 1024;        // 查找首个音频帧时扫描的长度
+constexpr qint64 kTailScanSize = 64 * 1024;        // 从文件尾部查找最后一个 Ogg 页的长度
+
+// ---------------------------------------------------------------------------
+// 字节序读取
+// ---------------------------------------------------------------------------
+
+inline const uchar *bytes(const QByteArray &data)
+{
+    return reinterpret_cast<const uchar *>(data.constData());
+}
+
+inline quint32 be32(const uchar *p)
+{
+    return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+}
+
+inline quint64 be64(const uchar *p)
+{
+    return (quint64(be32(p)) << 32) | be32(p + 4);
+}
+
+inline quint16 le16(const uchar *p)
+{
+    return quint16(p[0] | (p[1] << 8));
+}
+
+inline quint32 le32(const uchar *p)
+{
+    return quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16) | (quint32(p[3]) << 24);
+}
+
+inline quint64 le64(const uchar *p)
+{
+    return quint64(le32(p)) | (quint64(le32(p + 4)) << 32);
+}
+
+inline quint32 syncSafe32(const uchar *p)
+{
+    return ((p[0] & 0x7F) << 21) | ((p[1] & 0x7F) << 14) | ((p[2] & 0x7F) << 7) | (p[3] & 0x7F);
+}
+
+constexpr quint32 fourcc(char a, char b, char c, char d)
+{
+    return (quint32(uchar(a)) << 24) | (quint32(uchar(b)) << 16) | (quint32(uchar(c)) << 8) | quint32(uchar(d));
+}
+
+// 读取 pos 处的 size 字节；标签中声明的长度不可信，最多读到文件末尾，分配的内存不超过文件实际的大小
+QByteArray readAt(QFile &file, qint64 pos, qint64 size)
+{
+    const qint64 available = file.size() - pos;
+    if (pos < 0 || size <= 0 || available <= 0 || !file.seek(pos)) {
+        return QByteArray();
+    }
+    return file.read(qMin(size, available));
+}
+
+// ---------------------------------------------------------------------------
+// 元数据写入
+// ---------------------------------------------------------------------------
+
+inline QString keyName(QMediaMetaData::Key key)
+{
+    return MediaMetadataExtractor::metaDataKeyToString(key);
+}
+
+// 仅在该键尚无值时写入（先解析到的标签优先）
+void setIfEmpty(QVariantMap &metadata, QMediaMetaData::Key key, const QVariant &value)
+{
+    if (value.isNull() || (value.typeId() == QMetaType::QString && value.toString().isEmpty())) {
+        return;
+    }
+    const QString name = keyName(key);
+    if (!metadata.contains(name)) {
+        metadata.insert(name, value);
+    }
+}
+
+// 多值字段以 "; " 连接
+void appendValue(QVariantMap &metadata, QMediaMetaData::Key key, const QString &value)
+{
+    if (value.isEmpty()) {
+        return;
+    }
+    const QString name = keyName(key);
+    const QString current = metadata.value(name).toString();
+    metadata.insert(name, current.isEmpty() ? value : current + "; " + value);
+}
+
+int parseTrackNumber(const QString &text)
+{
+    // "3" 或 "3/12"
+    return text.section('/', 0, 0).trimmed().toInt();
+}
+
+QVariant parseDate(const QString &text)
+{
+    const QString trimmed = text.trimmed();
+    if (trimmed.isEmpty()) {
+        return QVariant();
+    }
+
+    QDate date = QDate::fromString(trimmed.left(10), Qt::ISODate);
+    if (!date.isValid()) {
+        bool ok = false;
+        const int year = trimmed.left(4).toInt(&ok);
+        if (ok && year > 0) {
+            date = QDate(year, 1, 1);
+        }
+    }
+    return date.isValid() ? QVariant(date.startOfDay()) : QVariant(trimmed);
+}
+
+const char *const kId3v1Genres[] = {
+    "Blues", "Classic Rock", "Country", "Dance", "Disco", "Funk", "Grunge", "Hip-Hop",
+    "Jazz", "Metal", "New Age", "Oldies", "Other", "Pop", "R&B", "Rap",
+    "Reggae", "Rock", "Techno", "Industrial", "Alternative", "Ska", "Death Metal", "Pranks",
+    "Soundtrack", "Euro-Techno", "Ambient", "Trip-Hop", "Vocal", "Jazz+Funk", "Fusion", "Trance",
+    "Classical", "Instrumental", "Acid", "House", "Game", "Sound Clip", "Gospel", "Noise",
+    "AlternRock", "Bass", "Soul", "Punk", "Space", "Meditative", "Instrumental Pop", "Instrumental Rock",
+    "Ethnic", "Gothic", "Darkwave", "Techno-Industrial", "Electronic", "Pop-Folk", "Eurodance", "Dream",
+    "Southern Rock", "Comedy", "Cult", "Gangsta", "Top 40", "Christian Rap", "Pop/Funk", "Jungle",
+    "Native American", "Cabaret", "New Wave", "Psychadelic", "Rave", "Showtunes", "Trailer", "Lo-Fi",
+    "Tribal", "Acid Punk", "Acid Jazz", "Polka", "Retro", "Musical", "Rock & Roll", "Hard Rock",
+};
+
+QString genreName(int index)
+{
+    constexpr int count = int(sizeof(kId3v1Genres) / sizeof(kId3v1Genres[0]));
+    return (index >= 0 && index < count) ? QString::fromLatin1(kId3v1Genres[index]) : QString();
+}
+
+// ID3 的 TCON 可能是 "(17)"、"17" 或 "(17)Rock"
+QString normalizeGenre(const QString &text)
+{
+    QString genre = text.trimmed();
+    if (genre.startsWith('(')) {
+        const int close = genre.indexOf(')');
+        if (close > 0) {
+            const QString rest = genre.mid(close + 1).trimmed();
+            if (!rest.isEmpty()) {
+                return rest;
+            }
+            genre = genre.mid(1, close - 1);
+        }
+    }
+
+    bool ok = false;
+    const int index = genre.toInt(&ok);
+    if (ok) {
+        const QString name = genreName(index);
+        return name.isEmpty() ? genre : name;
+    }
+    return genre;
+}
+
+// ---------------------------------------------------------------------------
+// Vorbis 注释（FLAC、Ogg Vorbis、Opus）
+// ---------------------------------------------------------------------------
+
+void parseVorbisComment(const QByteArray &data, QVariantMap &metadata)
+{
+    const uchar *d = bytes(data);
+    const qint64 size = data.size();
+    if (size < 8) {
+        return;
+    }
+
+    qint64 pos = 4 + qint64(le32(d));   // 跳过 vendor 字符串
+    if (pos + 4 > size) {
+        return;
+    }
+    const quint32 count = le32(d + pos);
+    pos += 4;
+
+    for (quint32 i = 0; i < count && pos + 4 <= size; ++i) {
+        const qint64 length = le32(d + pos);
+        pos += 4;
+        if (length > size - pos) {
+            break;
+        }
+        const QByteArray entry = data.mid(pos, length);
+        pos += length;
+
+        const int eq = entry.indexOf('=');
+        if (eq <= 0) {
+            continue;
+        }
+        const QByteArray field = entry.left(eq).toUpper();
+        if (field == "METADATA_BLOCK_PICTURE") {
+            continue;   // 封面（base64），不解码
+        }
+        const QString value = QString::fromUtf8(entry.mid(eq + 1)).trimmed();
+
+        if (field == "TITLE") {
+            setIfEmpty(metadata, QMediaMetaData::Title, value);
+        } else if (field == "ARTIST") {
+            appendValue(metadata, QMediaMetaData::ContributingArtist, value);
+        } else if (field == "ALBUMARTIST" || field == "ALBUM ARTIST") {
+            setIfEmpty(metadata, QMediaMetaData::AlbumArtist, value);
+        } else if (field == "ALBUM") {
+            setIfEmpty(metadata, QMediaMetaData::AlbumTitle, value);
+        } else if (field == "GENRE") {
+            appendValue(metadata, QMediaMetaData::Genre, value);
+        } else if (field == "DATE" || field == "YEAR") {
+            setIfEmpty(metadata, QMediaMetaData::Date, parseDate(value));
+        } else if (field == "TRACKNUMBER") {
+            setIfEmpty(metadata, QMediaMetaData::TrackNumber, parseTrackNumber(value));
+        } else if (field == "COMPOSER") {
+            appendValue(metadata, QMediaMetaData::Composer, value);
+        } else if (field == "COMMENT") {
+            setIfEmpty(metadata, QMediaMetaData::Comment, value);
+        } else if (field == "DESCRIPTION") {
+            setIfEmpty(metadata, QMediaMetaData::Description, value);
+        } else if (field == "COPYRIGHT") {
+            setIfEmpty(metadata, QMediaMetaData::Copyright, value);
+        } else if (field == "ORGANIZATION" || field == "LABEL") {
+            setIfEmpty(metadata, QMediaMetaData::Publisher, value);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ID3v2 / ID3v1
+// ---------------------------------------------------------------------------
+
+QByteArray removeUnsync(const QByteArray &data)
+{
+    // 反同步：0xFF 0x00 -> 0xFF
+    QByteArray out;
+    out.reserve(data.size());
+    for (int i = 0; i < data.size(); ++i) {
+        out.append(data[i]);
+        if (uchar(data[i]) == 0xFF && i + 1 < data.size() && data[i + 1] == 0) {
+            ++i;
+        }
+    }
+    return out;
+}
+
+inline bool isWideEncoding(quint8 encoding)
+{
+    return encoding == 1 || encoding == 2;
+}
+
+// 查找以指定编码结尾的字符串终止符，返回终止符位置
+int findTerminator(const QByteArray &data, int from, quint8 encoding)
+{
+    if (isWideEncoding(encoding)) {
+        for (int i = from; i + 1 < data.size(); i += 2) {
+            if (data[i] == 0 && data[i + 1] == 0) {
+                return i;
+            }
+        }
+        return -1;
+    }
+    return data.indexOf('\0', from);
+}
+
+QString decodeId3String(quint8 encoding, const QByteArray &data)
+{
+    QString text;
+    switch (encoding) {
+    case 1: {
+        QStringDecoder decoder(QStringConverter::Utf16);
+        text = decoder(data);
+        break;
+    }
+    case 2: {
+        QStringDecoder decoder(QStringConverter::Utf16BE);
+        text = decoder(data);
+        break;
+    }
+    case 3:
+        text = QString::fromUtf8(data);
+        break;
+    default:
+        text = QString::fromLatin1(data);
+        break;
+    }
+
+    // ID3v2.4 的多值以 \0 分隔
+    QStringList parts = text.split(QChar(0), Qt::SkipEmptyParts);
+    for (auto &part : parts) {
+        part = part.trimmed();
+    }
+    parts.removeAll(QString());
+    return parts.join("; ");
+}
+
+QString decodeTextFrame(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return QString();
+    }
+    return decodeId3String(quint8(data[0]), data.mid(1));
+}
+
+QByteArray normalizeFrameId(const QByteArray &id)
+{
+    // ID3v2.2 的三字符帧映射到 v2.3 名称
+    if (id.size() != 3) {
+        return id;
+    }
+    static const QHash<QByteArray, QByteArray> mapping{
+        {"TT2", "TIT2"}, {"TP1", "TPE1"}, {"TP2", "TPE2"}, {"TAL", "TALB"},
+        {"TCO", "TCON"}, {"TRK", "TRCK"}, {"TYE", "TYER"}, {"COM", "COMM"},
+        {"TCM", "TCOM"}, {"TLE", "TLEN"}, {"TCR", "TCOP"}, {"TPB", "TPUB"},
+        {"PIC", "APIC"}, {"TXX", "TXXX"},
+    };
+    return mapping.value(id, id);
+}
+
+void handleId3Frame(const QByteArray &id, const QByteArray &data, QVariantMap &metadata)
+{
+    if (id == "COMM") {
+        // 编码(1) 语言(3) 简述(以编码终止) 正文
+        if (data.size() < 5) return;
+        const quint8 encoding = quint8(data[0]);
+        const int end = findTerminator(data, 4, encoding);
+        if (end < 0) return;
+        const QString desc = decodeId3String(encoding, data.mid(4, end - 4));
+        const int start = end + (isWideEncoding(encoding) ? 2 : 1);
+        if (desc.isEmpty()) {
+            setIfEmpty(metadata, QMediaMetaData::Comment, decodeId3String(encoding, data.mid(start)));
+        }
+        return;
+    }
+
+    if (!id.startsWith('T') || id == "TXXX") {
+        return;
+    }
+
+    const QString text = decodeTextFrame(data);
+    if (text.isEmpty()) {
+        return;
+    }
+
+    if (id == "TIT2") {
+        setIfEmpty(metadata, QMediaMetaData::Title, text);
+    } else if (id == "TPE1") {
+        setIfEmpty(metadata, QMediaMetaData::ContributingArtist, text);
+    } else if (id == "TPE2") {
+        setIfEmpty(metadata, QMediaMetaData::AlbumArtist, text);
+    } else if (id == "TALB") {
+        setIfEmpty(metadata, QMediaMetaData::AlbumTitle, text);
+    } else if (id == "TCON") {
+        setIfEmpty(metadata, QMediaMetaData::Genre, normalizeGenre(text));
+    } else if (id == "TRCK") {
+        setIfEmpty(metadata, QMediaMetaData::TrackNumber, parseTrackNumber(text));
+    } else if (id == "TYER" || id == "TDRC") {
+        setIfEmpty(metadata, QMediaMetaData::Date, parseDate(text));
+    } else if (id == "TCOM") {
+        setIfEmpty(metadata, QMediaMetaData::Composer, text);
+    } else if (id == "TCOP") {
+        setIfEmpty(metadata, QMediaMetaData::Copyright, text);
+    } else if (id == "TPUB") {
+        setIfEmpty(metadata, QMediaMetaData::Publisher, text);
+    } else if (id == "TLEN") {
+        // 标签中声明的时长只作参考，后续由音频帧计算的结果覆盖
+        const qint64 length = text.toLongLong();
+        if (length > 0) {
+            setIfEmpty(metadata, QMediaMetaData::Duration, length);
+        }
+    }
+}
+
+// 解析 file 中 offset 处的 ID3v2 标签，tagSize 为含标签头的总长度
+// 逐帧读取，图片帧（APIC）只读帧头后直接跳过：播放列表不使用封面，而它往往占了标签的绝大部分
+void parseId3v2(QFile &file, qint64 offset, qint64 tagSize, QVariantMap &metadata)
+{
+    const QByteArray header = readAt(file, offset, 10);
+    if (header.size() < 10 || !header.startsWith("ID3")) {
+        return;
+    }
+
+    const int major = uchar(header[3]);
+    const quint8 flags = uchar(header[5]);
+    if (major < 2 || major > 4) {
+        return;
+    }
+
+    // 标签体（标签头之后）中 pos 处的 size 字节
+    qint64 bodySize = qMin(tagSize, file.size() - offset) - 10;
+    std::function<QByteArray(qint64, qint64)> read = [&file, offset](qint64 pos, qint64 size) {
+        return readAt(file, offset + 10 + pos, size);
+    };
+
+    QByteArray body;
+    if ((flags & 0x80) && major < 4) {
+        // 整个标签反同步时帧在文件中的位置无法直接计算，只能整体读入（少见）
+        if (bodySize > kMaxTagSize) {
+            return;
+        }
+        body = removeUnsync(read(0, bodySize));
+        bodySize = body.size();
+        read = [&body](qint64 pos, qint64 size) {
+            return body.mid(pos, size);
+        };
+    }
+
+    qint64 pos = 0;
+    if ((flags & 0x40) && major >= 3) {
+        // 扩展头：v2.3 的长度不含自身 4 字节，v2.4 为同步安全整数且包含自身
+        const QByteArray extended = read(0, 4);
+        if (extended.size() == 4) {
+            pos = (major == 4) ? syncSafe32(bytes(extended)) : be32(bytes(extended)) + 4;
+        }
+    }
+
+    const int idLength = (major == 2) ? 3 : 4;
+    const int headerLength = (major == 2) ? 6 : 10;
+
+    while (pos + headerLength <= bodySize) {
+        const QByteArray frameHeader = read(pos, headerLength);
+        if (frameHeader.size() < headerLength) {
+            break;
+        }
+        const uchar *frame = bytes(frameHeader);
+        if (frame[0] == 0) {
+            break;  // 填充区
+        }
+
+        const QByteArray id = normalizeFrameId(frameHeader.left(idLength));
+        qint64 size = 0;
+        quint16 frameFlags = 0;
+        if (major == 2) {
+            size = (frame[3] << 16) | (frame[4] << 8) | frame[5];
+        } else if (major == 3) {
+            size = be32(frame + 4);
+        } else {
+            size = syncSafe32(frame + 4);
+        }
+        if (major >= 3) {
+            frameFlags = quint16((frame[8] << 8) | frame[9]);
+        }
+
+        pos += headerLength;
+        if (size <= 0 || pos + size > bodySize) {
+            break;
+        }
+        const qint64 dataPos = pos;
+        pos += size;
+
+        if (id == "APIC" || size > kMaxTagSize) {
+            continue;
+        }
+        QByteArray data = read(dataPos, size);
+        if (data.size() < size) {
+            break;
+        }
+
+        if (major == 3) {
+            if (frameFlags & 0x00C0) continue;              // 压缩或加密
+            if (frameFlags & 0x0020) data.remove(0, 1);     // 分组标识
+        } else if (major == 4) {
+            if (frameFlags & 0x000C) continue;              // 压缩或加密
+            if (frameFlags & 0x0040) data.remove(0, 1);     // 分组标识
+            if (frameFlags & 0x0001) data.remove(0, 4);     // 数据长度指示
+            if (frameFlags & 0x0002) data = removeUnsync(data);
+        }
+
+        handleId3Frame(id, data, metadata);
+    }
+}
+
+// 读取文件开头的 ID3v2 标签，返回标签总长度（无标签返回 0）
+qint64 readLeadingId3v2(QFile &file, qint64 offset, QVariantMap &metadata)
+{
+    const QByteArray header = readAt(file, offset, 10);
+    if (header.size() < 10 || !header.startsWith("ID3")) {
+        return 0;
+    }
+
+    qint64 tagSize = 10 + qint64(syncSafe32(bytes(header) + 6));
+    if (uchar(header[5]) & 0x10) {
+        tagSize += 10;  // 页脚
+    }
+
+    parseId3v2(file, offset, tagSize, metadata);
+    return tagSize;
+}
+
+// 读取文件末尾的 ID3v1 标签，返回是否存在
+bool readId3v1(QFile &file, QVariantMap &metadata)
+{
+    if (file.size() < 128) {
+        return false;
+    }
+
+    const QByteArray tag = readAt(file, file.size() - 128, 128);
+    if (tag.size() < 128 || !tag.startsWith("TAG")) {
+        return false;
+    }
+
+    auto field = [&](int pos, int length) {
+        QByteArray raw = tag.mid(pos, length);
+        const int end = raw.indexOf('\0');
+        if (end >= 0) raw.truncate(end);
+        return QString::fromLatin1(raw).trimmed();
+    };
+
+    setIfEmpty(metadata, QMediaMetaData::Title, field(3, 30));
+    setIfEmpty(metadata, QMediaMetaData::ContributingArtist, field(33, 30));
+    setIfEmpty(metadata, QMediaMetaData::AlbumTitle, field(63, 30));
+    setIfEmpty(metadata, QMediaMetaData::Date, parseDate(field(93, 4)));
+
+    // ID3v1.1：注释第 29 字节为 0 时第 30 字节是音轨号
+    if (tag[125] == 0 && tag[126] != 0) {
+        setIfEmpty(metadata, QMediaMetaData::Comment, field(97, 28));
+        setIfEmpty(metadata, QMediaMetaData::TrackNumber, int(uchar(tag[126])));
+    } else {
+        setIfEmpty(metadata, QMediaMetaData::Comment, field(97, 30));
+    }
+    setIfEmpty(metadata, QMediaMetaData::Genre, genreName(uchar(tag[127])));
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// MPEG 音频帧
+// ---------------------------------------------------------------------------
+
+struct MpegFrameHeader
+{
+    int version = 0;            // 1: MPEG-1, 2: MPEG-2, 25: MPEG-2.5
+    int layer = 0;
+    int bitrate = 0;            // kbps
+    int sampleRate = 0;
+    int channels = 0;
+    int samplesPerFrame = 0;
+    int frameLength = 0;        // 字节
+};
+
+bool parseMpegFrameHeader(const uchar *p, MpegFrameHeader &h)
+{
+    if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) {
+        return false;
+    }
+
+    const int versionBits = (p[1] >> 3) & 0x03;
+    const int layerBits = (p[1] >> 1) & 0x03;
+    const int bitrateIndex = p[2] >> 4;
+    const int rateIndex = (p[2] >> 2) & 0x03;
+    const int padding = (p[2] >> 1) & 0x01;
+    if (versionBits == 1 || layerBits == 0 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) {
+        return false;
+    }
+
+    static const int kBitrates[5][15] = {
+        {0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448},   // V1 L1
+        {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},      // V1 L2
+        {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},       // V1 L3
+        {0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256},      // V2 L1
+        {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},           // V2 L2/L3
+    };
+    static const int kSampleRates[3] = {44100, 48000, 32000};
+
+    h.version = (versionBits == 3) ? 1 : (versionBits == 2 ? 2 : 25);
+    h.layer = 4 - layerBits;
+
+    int table = 0;
+    if (h.version == 1) {
+        table = h.layer - 1;
+    } else {
+        table = (h.layer == 1) ? 3 : 4;
+    }
+    h.bitrate = kBitrates[table][bitrateIndex];
+
+    h.sampleRate = kSampleRates[rateIndex];
+    if (h.version == 2) h.sampleRate /= 2;
+    if (h.version == 25) h.sampleRate /= 4;
+
+    h.channels = ((p[3] >> 6) == 3) ? 1 : 2;
+
+    if (h.layer == 1) {
+        h.samplesPerFrame = 384;
+        h.frameLength = (12 * h.bitrate * 1000 / h.sampleRate + padding) * 4;
+    } else {
+        h.samplesPerFrame = (h.layer == 3 && h.version != 1) ? 576 : 1152;
+        h.frameLength = (h.samplesPerFrame / 8) * h.bitrate * 1000 / h.sampleRate + padding;
+    }
+    return h.frameLength > 4;
+}
+
+} // namespace
+
+bool NativeTagReader::read(const QString &filePath, QVariantMap &metadata)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QByteArray magic = file.read(12);
+    if (magic.size() < 4) {
+        return false;
+    }
+
+    QVariantMap result;
+    bool ok = false;
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+
+    if (magic.startsWith("fLaC")) {
+        ok = readFlac(file, result);
+    } else if (magic.startsWith("OggS")) {
+        ok = readOgg(file, result);
+    } else if (magic.startsWith("RIFF") && magic.mid(8, 4) == "WAVE") {
+        ok = readRiff(file, result);
+    } else if (magic.mid(4, 4) == "ftyp") {
+        ok = readMp4(file, result);
+    } else if (magic.startsWith("ID3")) {
+        // 带 ID3v2 头的 FLAC 较少见，按扩展名区分
+        ok = (suffix == "flac") ? readFlac(file, result) : readMpeg(file, result);
+    } else if (suffix == "mp3" || suffix == "mp2" || suffix == "mpga") {
+        ok = readMpeg(file, result);
+    }
+
+    if (ok) {
+        metadata.insert(result);
+    }
+    return ok;
+}
+
+bool NativeTagReader::readMpeg(QFile &file, QVariantMap &metadata)
+{
+    const qint64 fileSize = file.size();
+    const qint64 audioStart = readLeadingId3v2(file, 0, metadata);
+    const bool hasId3v1 = readId3v1(file, metadata);
+
+    // 在标签之后查找首个有效的音频帧（连续两帧都能解析才认为同步成功）
+    const QByteArray head = readAt(file, audioStart, kHeadScanSize);
+    const uchar *d = bytes(head);
+    MpegFrameHeader frame;
+    qint64 frameOffset = -1;
+    for (qint64 i = 0; i + 4 <= head.size(); ++i) {
+        if (!parseMpegFrameHeader(d + i, frame)) {
+            continue;
+        }
+        MpegFrameHeader next;
+        const qint64 nextOffset = i + frame.frameLength;
+        if (nextOffset + 4 > head.size() || parseMpegFrameHeader(d + nextOffset, next)) {
+            frameOffset = i;
+            break;
+        }
+    }
+    if (frameOffset < 0) {
+        return false;
+    }
+
+    const qint64 audioBytes = fileSize - (audioStart + frameOffset) - (hasId3v1 ? 128 : 0);
+
+    // VBR 文件的首帧中带有 Xing/Info 或 VBRI 头，记录了总帧数
+    quint32 totalFrames = 0;
+    const int sideInfo = (frame.version == 1) ? (frame.channels == 1 ? 17 : 32)
+                                              : (frame.channels == 1 ? 9 : 17);
+    const qint64 xingOffset = frameOffset + 4 + sideInfo;
+    const qint64 vbriOffset = frameOffset + 4 + 32;
+    if (xingOffset + 12 <= head.size()
+        && (head.mid(xingOffset, 4) == "Xing" || head.mid(xingOffset, 4) == "Info")) {
+        const quint32 flags = be32(d + xingOffset + 4);
+        if (flags & 0x01) {
+            totalFrames = be32(d + xingOffset + 8);
+        }
+    } else if (vbriOffset + 18 <= head.size() && head.mid(vbriOffset, 4) == "VBRI") {
+        totalFrames = be32(d + vbriOffset + 14);
+    }
+
+    qint64 durationMs = 0;
+    if (totalFrames > 0) {
+        durationMs = qint64(totalFrames) * frame.samplesPerFrame * 1000 / frame.sampleRate;
+    } else if (frame.bitrate > 0) {
+        durationMs = audioBytes * 8 / frame.bitrate;    // CBR：kbps 即 bit/ms
+    }
+
+    if (durationMs > 0) {
+        metadata.insert(keyName(QMediaMetaData::Duration), durationMs);
+        metadata.insert(keyName(QMediaMetaData::AudioBitRate), int(audioBytes * 8 * 1000 / durationMs));
+    }
+    metadata.insert(keyName(QMediaMetaData::FileFormat), QVariant::fromValue(QMediaFormat::MP3));
+    metadata.insert(keyName(QMediaMetaData::AudioCodec), QVariant::fromValue(QMediaFormat::AudioCodec::MP3));
+    return true;
+}
+
+bool NativeTagReader::readFlac(QFile &file, QVariantMap &metadata)
+{
+    const qint64 fileSize = file.size();
+    qint64 pos = readLeadingId3v2(file, 0, metadata);
+
+    if (readAt(file, pos, 4) != "fLaC") {
+        return false;
+    }
+    pos += 4;
+
+    qint64 durationMs = 0;
+    bool last = false;
+
+    // 逐个读取元数据块头，只读取需要的块内容（PICTURE 等其余的块直接跳过）
+    while (!last && pos + 4 <= fileSize) {
+        const QByteArray header = readAt(file, pos, 4);
+        if (header.size() < 4) {
+            break;
+        }
+        const uchar *h = bytes(header);
+        last = (h[0] & 0x80) != 0;
+        const int type = h[0] & 0x7F;
+        const qint64 length = (h[1] << 16) | (h[2] << 8) | h[3];
+        pos += 4;
+
+        if (type == 0 && length >= 34) {
+            // STREAMINFO
+            const QByteArray info = readAt(file, pos, 34);
+            if (info.size() == 34) {
+                const uchar *s = bytes(info);
+                const quint32 sampleRate = (quint32(s[10]) << 12) | (quint32(s[11]) << 4) | (s[12] >> 4);
+                const quint64 totalSamples = (quint64(s[13] & 0x0F) << 32) | be32(s + 14);
+                if (sampleRate > 0 && totalSamples > 0) {
+                    durationMs = qint64(totalSamples * 1000 / sampleRate);
+                }
+            }
+        } else if (type == 4 && length <= kMaxTagSize) {
+            // VORBIS_COMMENT
+            parseVorbisComment(readAt(file, pos, length), metadata);
+        }
+
+        pos += length;
+    }
+
+    if (durationMs > 0) {
+        metadata.insert(keyName(QMediaMetaData::Duration), durationMs);
+        metadata.insert(keyName(QMediaMetaData::AudioBitRate), int((fileSize - pos) * 8 * 1000 / durationMs));
+    }
+    metadata.insert(keyName(QMediaMetaData::FileFormat), QVariant::fromValue(QMediaFormat::FLAC));
+    metadata.insert(keyName(QMediaMetaData::AudioCodec), QVariant::fromValue(QMediaFormat::AudioCodec::FLAC));
+    return true;
+}
+
+bool NativeTagReader::readOgg(QFile &file, QVariantMap &metadata)
+{
+    const qint64 fileSize = file.size();
+
+    // 按页读取，重组首个逻辑流的前两个包（标识头、注释头）
+    QList<QByteArray> packets;
+    QByteArray packet;
+    quint32 serial = 0;
+    bool haveSerial = false;
+    qint64 pos = 0;
+    qint64 consumed = 0;
+
+    while (packets.size() < 2 && pos + 27 <= fileSize && consumed <= kMaxTagSize) {
+        const QByteArray header = readAt(file, pos, 27);
+        if (header.size() < 27 || !header.startsWith("OggS")) {
+            return false;
+        }
+        const uchar *h = bytes(header);
+        const quint32 pageSerial = le32(h + 14);
+        const int segmentCount = h[26];
+
+        const QByteArray lacing = readAt(file, pos + 27, segmentCount);
+        if (lacing.size() < segmentCount) {
+            return false;
+        }
+        qint64 bodySize = 0;
+        for (char value : lacing) {
+            bodySize += uchar(value);
+        }
+        const qint64 bodyOffset = pos + 27 + segmentCount;
+        pos = bodyOffset + bodySize;
+        consumed += 27 + segmentCount + bodySize;
+
+        if (!haveSerial) {
+            serial = pageSerial;
+            haveSerial = true;
+        } else if (pageSerial != serial) {
+            continue;
+        }
+
+        const QByteArray body = readAt(file, bodyOffset, bodySize);
+        qint64 offset = 0;
+        for (char value : lacing) {
+            const int length = uchar(value);
+            packet.append(body.mid(offset, length));
+            offset += length;
+            if (length < 255) {
+                packets.append(packet);
+                packet.clear();
+                if (packets.size() == 2) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (packets.isEmpty()) {
+        return false;
+    }
+
+    const QByteArray &ident = packets.at(0);
+    quint32 sampleRate = 0;
+    quint32 preSkip = 0;
+    int nominalBitrate = 0;
+    QMediaFormat::AudioCodec codec = QMediaFormat::AudioCodec::Unspecified;
+
+    if (ident.size() >= 30 && ident.startsWith("\x01vorbis")) {
+        sampleRate = le32(bytes(ident) + 12);
+        nominalBitrate = int(le32(bytes(ident) + 20));
+        codec = QMediaFormat::AudioCodec::Vorbis;
+        if (packets.size() > 1 && packets.at(1).startsWith("\x03vorbis")) {
+            parseVorbisComment(packets.at(1).mid(7), metadata);
+        }
+    } else if (ident.size() >= 19 && ident.startsWith("OpusHead")) {
+        sampleRate = 48000;     // Opus 的 granule 始终以 48kHz 计
+        preSkip = le16(bytes(ident) + 10);
+        codec = QMediaFormat::AudioCodec::Opus;
+        if (packets.size() > 1 && packets.at(1).startsWith("OpusTags")) {
+            parseVorbisComment(packets.at(1).mid(8), metadata);
+        }
+    } else {
+        return false;
+    }
+
+    // 时长取自最后一页的 granule position
+    const qint64 tailSize = qMin(fileSize, kTailScanSize);
+    const QByteArray tail = readAt(file, fileSize - tailSize, tailSize);
+    qint64 lastGranule = -1;
+    for (qint64 i = tail.size() - 27; i >= 0; --i) {
+        if (tail.at(i) != 'O' || tail.mid(i, 4) != "OggS") {
+            continue;
+        }
+        const uchar *page = bytes(tail) + i;
+        const qint64 granule = qint64(le64(page + 6));
+        if (le32(page + 14) == serial && granule >= 0) {
+            lastGranule = granule;
+            break;
+        }
+    }
+
+    if (sampleRate > 0 && lastGranule > qint64(preSkip)) {
+        const qint64 durationMs = (lastGranule - preSkip) * 1000 / sampleRate;
+        metadata.insert(keyName(QMediaMetaData::Duration), durationMs);
+        const int bitrate = durationMs > 0 ? int(fileSize * 8 * 1000 / durationMs) : nominalBitrate;
+        metadata.insert(keyName(QMediaMetaData::AudioBitRate), bitrate);
+    } else if (nominalBitrate > 0) {
+        metadata.insert(keyName(QMediaMetaData::AudioBitRate), nominalBitrate);
+    }
+    metadata.insert(keyName(QMediaMetaData::FileFormat), QVariant::fromValue(QMediaFormat::Ogg));
+    metadata.insert(keyName(QMediaMetaData::AudioCodec), QVariant::fromValue(codec));
+    return true;
+}
+
+namespace {
+
+struct Mp4Atom
+{
+    quint32 type = 0;
+    qint64 offset = 0;      // 负载起始位置
+    qint64 size = 0;        // 负载长度
+};
+
+// 列出 [begin, end) 范围内的子 atom，只读取头部
+QList<Mp4Atom> listAtoms(QFile &file, qint64 begin, qint64 end)
+{
+    QList<Mp4Atom> atoms;
+    qint64 pos = begin;
+    while (pos + 8 <= end) {
+        const QByteArray header = readAt(file, pos, 16);
+        if (header.size() < 8) {
+            break;
+        }
+        const uchar *h = bytes(header);
+        quint64 size = be32(h);
+        qint64 headerSize = 8;
+        if (size == 1) {
+            if (header.size() < 16) break;
+            size = be64(h + 8);
+            headerSize = 16;
+        } else if (size == 0) {
+            size = quint64(end - pos);
+        }
+        // 64 位长度可能超出 qint64，先与剩余长度比较
+        if (size < quint64(headerSize) || size > quint64(end - pos)) {
+            break;
+        }
+
+        atoms.append({be32(h + 4), pos + headerSize, qint64(size) - headerSize});
+        pos += qint64(size);
+    }
+    return atoms;
+}
+
+const Mp4Atom *findAtom(const QList<Mp4Atom> &atoms, quint32 type)
+{
+    for (const auto &atom : atoms) {
+        if (atom.type == type) {
+            return &atom;
+        }
+    }
+    return nullptr;
+}
+
+// 解析 ilst 中的一个条目，item 为条目的负载
+void parseIlstItem(quint32 itemType, const QByteArray &item, QVariantMap &metadata)
+{
+    // 条目内的 data atom：长度(4) "data"(4) 类型(4) 区域(4) 值
+    const uchar *d = bytes(item);
+    qint64 inner = 0;
+    while (inner + 16 <= item.size()) {
+        const qint64 size = be32(d + inner);
+        if (size < 8 || inner + size > item.size()) {
+            break;
+        }
+        if (be32(d + inner + 4) == fourcc('d', 'a', 't', 'a') && size >= 16) {
+            const quint32 dataType = be32(d + inner + 8) & 0x00FFFFFF;
+            const QByteArray value = item.mid(inner + 16, size - 16);
+            const QString text = (dataType == 1) ? QString::fromUtf8(value).trimmed() : QString();
+
+            switch (itemType) {
+            case fourcc('\xA9', 'n', 'a', 'm'): setIfEmpty(metadata, QMediaMetaData::Title, text); break;
+            case fourcc('\xA9', 'A', 'R', 'T'): setIfEmpty(metadata, QMediaMetaData::ContributingArtist, text); break;
+            case fourcc('a', 'A', 'R', 'T'):    setIfEmpty(metadata, QMediaMetaData::AlbumArtist, text); break;
+            case fourcc('\xA9', 'a', 'l', 'b'): setIfEmpty(metadata, QMediaMetaData::AlbumTitle, text); break;
+            case fourcc('\xA9', 'g', 'e', 'n'): setIfEmpty(metadata, QMediaMetaData::Genre, text); break;
+            case fourcc('\xA9', 'd', 'a', 'y'): setIfEmpty(metadata, QMediaMetaData::Date, parseDate(text)); break;
+            case fourcc('\xA9', 'w', 'r', 't'): setIfEmpty(metadata, QMediaMetaData::Composer, text); break;
+            case fourcc('\xA9', 'c', 'm', 't'): setIfEmpty(metadata, QMediaMetaData::Comment, text); break;
+            case fourcc('d', 'e', 's', 'c'):    setIfEmpty(metadata, QMediaMetaData::Description, text); break;
+            case fourcc('c', 'p', 'r', 't'):    setIfEmpty(metadata, QMediaMetaData::Copyright, text); break;
+            case fourcc('g', 'n', 'r', 'e'):
+                if (value.size() >= 2) {
+                    setIfEmpty(metadata, QMediaMetaData::Genre, genreName(((uchar(value[0]) << 8) | uchar(value[1])) - 1));
+                }
+                break;
+            case fourcc('t', 'r', 'k', 'n'):
+                if (value.size() >= 4) {
+                    setIfEmpty(metadata, QMediaMetaData::TrackNumber, (uchar(value[2]) << 8) | uchar(value[3]));
+                }
+                break;
+            default:
+                break;
+            }
+            return;     // 每个条目只取第一个 data
+        }
+        inner += size;
+    }
+}
+
+// 逐个读取 ilst 中的条目，封面（covr）只读条目头后跳过
+void parseIlst(QFile &file, const Mp4Atom &ilst, QVariantMap &metadata)
+{
+    for (const Mp4Atom &item : listAtoms(file, ilst.offset, ilst.offset + ilst.size)) {
+        if (item.type == fourcc('c', 'o', 'v', 'r') || item.size > kMaxTagSize) {
+            continue;
+        }
+        parseIlstItem(item.type, readAt(file, item.offset, item.size), metadata);
+    }
+}
+
+} // namespace
+
+bool NativeTagReader::readMp4(QFile &file, QVariantMap &metadata)
+{
+    const qint64 fileSize = file.size();
+    const QList<Mp4Atom> top = listAtoms(file, 0, fileSize);
+    if (top.isEmpty() || top.first().type != fourcc('f', 't', 'y', 'p')) {
+        return false;
+    }
+
+    // moov 可能位于文件尾部，按 atom 头跳转而不是顺序读取
+    const Mp4Atom *moov = findAtom(top, fourcc('m', 'o', 'o', 'v'));
+    if (!moov) {
+        return false;
+    }
+    const QList<Mp4Atom> moovChildren = listAtoms(file, moov->offset, moov->offset + moov->size);
+
+    qint64 durationMs = 0;
+    if (const Mp4Atom *mvhd = findAtom(moovChildren, fourcc('m', 'v', 'h', 'd'))) {
+        const QByteArray data = readAt(file, mvhd->offset, qMin<qint64>(mvhd->size, 32));
+        const uchar *d = bytes(data);
+        if (data.size() >= 32 && d[0] == 1) {
+            const quint32 timescale = be32(d + 20);
+            if (timescale > 0) durationMs = qint64(be64(d + 24) * 1000 / timescale);
+        } else if (data.size() >= 20) {
+            const quint32 timescale = be32(d + 12);
+            if (timescale > 0) durationMs = qint64(quint64(be32(d + 16)) * 1000 / timescale);
+        }
+    }
+
+    // moov/udta/meta/ilst
+    if (const Mp4Atom *udta = findAtom(moovChildren, fourcc('u', 'd', 't', 'a'))) {
+        const QList<Mp4Atom> udtaChildren = listAtoms(file, udta->offset, udta->offset + udta->size);
+        if (const Mp4Atom *meta = findAtom(udtaChildren, fourcc('m', 'e', 't', 'a'))) {
+            // meta 通常是 full box（4 字节版本与标志），QuickTime 写出的则没有
+            qint64 metaBegin = meta->offset;
+            if (readAt(file, meta->offset + 4, 4) != "hdlr") {
+                metaBegin += 4;
+            }
+            const QList<Mp4Atom> metaChildren = listAtoms(file, metaBegin, meta->offset + meta->size);
+            const Mp4Atom *ilst = findAtom(metaChildren, fourcc('i', 'l', 's', 't'));
+            if (ilst) {
+                parseIlst(file, *ilst, metadata);
+            }
+        }
+    }
+
+    // moov/trak/mdia/minf/stbl/stsd 的首个条目即编码类型
+    QMediaFormat::AudioCodec codec = QMediaFormat::AudioCodec::Unspecified;
+    for (const auto &trak : moovChildren) {
+        if (trak.type != fourcc('t', 'r', 'a', 'k')) {
+            continue;
+        }
+        const Mp4Atom *atom = &trak;
+        QList<Mp4Atom> children;
+        for (quint32 type : {fourcc('m', 'd', 'i', 'a'), fourcc('m', 'i', 'n', 'f'), fourcc('s', 't', 'b', 'l'), fourcc('s', 't', 's', 'd')}) {
+            children = listAtoms(file, atom->offset, atom->offset + atom->size);
+            atom = findAtom(children, type);
+            if (!atom) break;
+        }
+        if (!atom) {
+            continue;
+        }
+
+        const QByteArray stsd = readAt(file, atom->offset, 16);
+        if (stsd.size() < 16) {
+            continue;
+        }
+        switch (be32(bytes(stsd) + 12)) {
+        case fourcc('m', 'p', '4', 'a'): codec = QMediaFormat::AudioCodec::AAC; break;
+        case fourcc('a', 'l', 'a', 'c'): codec = QMediaFormat::AudioCodec::ALAC; break;
+        case fourcc('f', 'L', 'a', 'C'): codec = QMediaFormat::AudioCodec::FLAC; break;
+        case fourcc('O', 'p', 'u', 's'): codec = QMediaFormat::AudioCodec::Opus; break;
+        case fourcc('a', 'c', '-', '3'): codec = QMediaFormat::AudioCodec::AC3; break;
+        case fourcc('e', 'c', '-', '3'): codec = QMediaFormat::AudioCodec::EAC3; break;
+        case fourcc('.', 'm', 'p', '3'): codec = QMediaFormat::AudioCodec::MP3; break;
+        default: break;
+        }
+        if (codec != QMediaFormat::AudioCodec::Unspecified) {
+            break;
+        }
+    }
+
+    if (durationMs > 0) {
+        metadata.insert(keyName(QMediaMetaData::Duration), durationMs);
+        if (const Mp4Atom *mdat = findAtom(top, fourcc('m', 'd', 'a', 't'))) {
+            metadata.insert(keyName(QMediaMetaData::AudioBitRate), int(mdat->size * 8 * 1000 / durationMs));
+        }
+    }
+    metadata.insert(keyName(QMediaMetaData::FileFormat), QVariant::fromValue(QMediaFormat::Mpeg4Audio));
+    metadata.insert(keyName(QMediaMetaData::AudioCodec), QVariant::fromValue(codec));
+    return true;
+}
+
+bool NativeTagReader::readRiff(QFile &file, QVariantMap &metadata)
+{
+    const qint64 fileSize = file.size();
+    qint64 pos = 12;
+    quint32 byteRate = 0;
+    qint64 dataSize = 0;
+
+    // 逐个跳过块，只读取 fmt、LIST/INFO 与内嵌的 ID3 块
+    while (pos + 8 <= fileSize) {
+        const QByteArray header = readAt(file, pos, 8);
+        if (header.size() < 8) {
+            break;
+        }
+        const QByteArray id = header.left(4);
+        const qint64 size = le32(bytes(header) + 4);
+        const qint64 payload = pos + 8;
+
+        if (id == "fmt " && size >= 16) {
+            const QByteArray fmt = readAt(file, payload, 16);
+            if (fmt.size() == 16) {
+                byteRate = le32(bytes(fmt) + 8);
+            }
+        } else if (id == "data") {
+            dataSize = qMin(size, fileSize - payload);
+        } else if (id == "LIST" && size >= 4 && size <= kMaxTagSize) {
+            const QByteArray list = readAt(file, payload, size);
+            if (list.startsWith("INFO")) {
+                const uchar *d = bytes(list);
+                qint64 inner = 4;
+                while (inner + 8 <= list.size()) {
+                    const QByteArray subId = list.mid(inner, 4);
+                    const qint64 subSize = le32(d + inner + 4);
+                    if (inner + 8 + subSize > list.size()) {
+                        break;
+                    }
+                    QByteArray raw = list.mid(inner + 8, subSize);
+                    const int end = raw.indexOf('\0');
+                    if (end >= 0) raw.truncate(end);
+                    const QString text = QString::fromUtf8(raw).trimmed();
+
+                    if (subId == "INAM") setIfEmpty(metadata, QMediaMetaData::Title, text);
+                    else if (subId == "IART") setIfEmpty(metadata, QMediaMetaData::ContributingArtist, text);
+                    else if (subId == "IPRD") setIfEmpty(metadata, QMediaMetaData::AlbumTitle, text);
+                    else if (subId == "IGNR") setIfEmpty(metadata, QMediaMetaData::Genre, text);
+                    else if (subId == "ICRD") setIfEmpty(metadata, QMediaMetaData::Date, parseDate(text));
+                    else if (subId == "ICMT") setIfEmpty(metadata, QMediaMetaData::Comment, text);
+                    else if (subId == "ICOP") setIfEmpty(metadata, QMediaMetaData::Copyright, text);
+                    else if (subId == "ITRK" || subId == "IPRT") setIfEmpty(metadata, QMediaMetaData::TrackNumber, parseTrackNumber(text));
+
+                    inner += 8 + subSize + (subSize & 1);
+                }
+            }
+        } else if (id == "id3 " || id == "ID3 ") {
+            parseId3v2(file, payload, size, metadata);
+        }
+
+        pos = payload + size + (size & 1);  // 块按偶数字节对齐
+    }
+
+    if (byteRate > 0 && dataSize > 0) {
+        metadata.insert(keyName(QMediaMetaData::Duration), dataSize * 1000 / byteRate);
+        metadata.insert(keyName(QMediaMetaData::AudioBitRate), int(byteRate * 8));
+    }
+    metadata.insert(keyName(QMediaMetaData::FileFormat), QVariant::fromValue(QMediaFormat::Wave));
+    metadata.insert(keyName(QMediaMetaData::AudioCodec), QVariant::fromValue(QMediaFormat::AudioCodec::Wave));
+    return byteRate > 0;
+}
+
+// ---------------------------------------------------------------------------
+// 无缝播放信息
+// ---------------------------------------------------------------------------
+
+bool NativeTagReader::readGapless(const QString &filePath, GaplessInfo &info)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QByteArray magic = file.read(12);
+    if (magic.size() < 4) {
+        return false;
+    }
+
+    GaplessInfo result;
+    bool ok = false;
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+
+    if (magic.mid(4, 4) == "ftyp") {
+        ok = readMp4Gapless(file, result);
+    } else if (magic.startsWith("ID3") || suffix == "mp3") {
+        ok = readMpegGapless(file, result);
+    }
+
+    if (ok && result.isValid()) {
+        info = result;
+        return true;
+    }
+    return false;
+}
+
+bool NativeTagReader::readMpegGapless(QFile &file, GaplessInfo &info)
+{
+    // LAME 标签中记录的是编码器延迟，解码器（mpg123/FFmpeg 等）还会额外引入 529 帧延迟
+    constexpr qint64 kDecoderDelay = 529;
+
+    QVariantMap ignored;
+    const qint64 audioStart = readLeadingId3v2(file, 0, ignored);
+
+    const QByteArray head = readAt(file, audioStart, kHeadScanSize);
+    const uchar *d = bytes(head);
+    MpegFrameHeader frame;
+    qint64 frameOffset = -1;
+    for (qint64 i = 0; i + 4 <= head.size(); ++i) {
+        if (parseMpegFrameHeader(d + i, frame)) {
+            frameOffset = i;
+            break;
+        }
+    }
+    if (frameOffset < 0 || frame.layer != 3) {
+        return false;
+    }
+
+    // Xing/Info 头：标识(4) 标志(4) [帧数(4)] [字节数(4)] [TOC(100)] [质量(4)]，之后是 LAME 扩展
+    const int sideInfo = (frame.version == 1) ? (frame.channels == 1 ? 17 : 32)
+                                              : (frame.channels == 1 ? 9 : 17);
+    const qint64 xingOffset = frameOffset + 4 + sideInfo;
+    if (xingOffset + 8 > head.size()
+        || (head.mid(xingOffset, 4) != "Xing" && head.mid(xingOffset, 4) != "Info")) {
+        return false;
+    }
+
+    const quint32 flags = be32(d + xingOffset + 4);
+    qint64 pos = xingOffset + 8;
+    quint32 totalFrames = 0;
+    if (flags & 0x01) {
+        if (pos + 4 > head.size()) return false;
+        totalFrames = be32(d + pos);
+        pos += 4;
+    }
+    if (flags & 0x02) pos += 4;
+    if (flags & 0x04) pos += 100;
+    if (flags & 0x08) pos += 4;
+
+    // LAME 扩展：版本字符串(9) 修订(1) 低通(1) 回放增益(8) 编码标志(1) 码率(1) 延迟与填充(各 12 位)
+    if (pos + 24 > head.size()) {
+        return false;
+    }
+    const QByteArray encoder = head.mid(pos, 4);
+    if (encoder != "LAME" && encoder != "Lavf" && encoder != "Lavc") {
+        return false;
+    }
+    const uchar *p = d + pos + 21;
+    const qint64 delay = (qint64(p[0]) << 4) | (p[1] >> 4);
+    const qint64 padding = (qint64(p[1] & 0x0F) << 8) | p[2];
+
+    info.sampleRate = frame.sampleRate;
+    info.encoderDelay = delay + kDecoderDelay;
+    info.padding = qMax<qint64>(0, padding - kDecoderDelay);
+    if (totalFrames > 0) {
+        info.validFrames = qMax<qint64>(0, qint64(totalFrames) * frame.samplesPerFrame - delay - padding);
+    }
+    return true;
+}
+
+bool NativeTagReader::readMp4Gapless(QFile &file, GaplessInfo &info)
+{
+    const QList<Mp4Atom> top = listAtoms(file, 0, file.size());
+    const Mp4Atom *moov = findAtom(top, fourcc('m', 'o', 'o', 'v'));
+    if (!moov) {
+        return false;
+    }
+    const QList<Mp4Atom> moovChildren = listAtoms(file, moov->offset, moov->offset + moov->size);
+
+    // 采样率取自 moov/trak/mdia/minf/stbl/stsd 首个条目（16.16 定点数）
+    for (const auto &trak : moovChildren) {
+        if (trak.type != fourcc('t', 'r', 'a', 'k')) {
+            continue;
+        }
+        const Mp4Atom *atom = &trak;
+        QList<Mp4Atom> children;
+        for (quint32 type : {fourcc('m', 'd', 'i', 'a'), fourcc('m', 'i', 'n', 'f'),
+                             fourcc('s', 't', 'b', 'l'), fourcc('s', 't', 's', 'd')}) {
+            children = listAtoms(file, atom->offset, atom->offset + atom->size);
+            atom = findAtom(children, type);
+            if (!atom) break;
+        }
+        if (!atom) {
+            continue;
+        }
+        const QByteArray stsd = readAt(file, atom->offset, 44);
+        if (stsd.size() >= 44) {
+            info.sampleRate = int(be32(bytes(stsd) + 40) >> 16);
+            break;
+        }
+    }
+
+    // moov/udta/meta/ilst/----，name 为 iTunSMPB 的条目
+    const Mp4Atom *udta = findAtom(moovChildren, fourcc('u', 'd', 't', 'a'));
+    if (!udta) {
+        return false;
+    }
+    const QList<Mp4Atom> udtaChildren = listAtoms(file, udta->offset, udta->offset + udta->size);
+    const Mp4Atom *meta = findAtom(udtaChildren, fourcc('m', 'e', 't', 'a'));
+    if (!meta) {
+        return false;
+    }
+    qint64 metaBegin = meta->offset;
+    if (readAt(file, meta->offset + 4, 4) != "hdlr") {
+        metaBegin += 4;
+    }
+    const QList<Mp4Atom> metaChildren = listAtoms(file, metaBegin, meta->offset + meta->size);
+    const Mp4Atom *ilst = findAtom(metaChildren, fourcc('i', 'l', 's', 't'));
+    if (!ilst) {
+        return false;
+    }
+
+    for (const auto &item : listAtoms(file, ilst->offset, ilst->offset + ilst->size)) {
+        if (item.type != fourcc('-', '-', '-', '-')) {
+            continue;
+        }
+
+        QString name;
+        QByteArray value;
+        for (const auto &child : listAtoms(file, item.offset, item.offset + item.size)) {
+            // name 与 data 都带有 4 字节版本与标志，data 另有 4 字节区域
+            if (child.type == fourcc('n', 'a', 'm', 'e') && child.size > 4) {
+                name = QString::fromLatin1(readAt(file, child.offset + 4, child.size - 4));
+            } else if (child.type == fourcc('d', 'a', 't', 'a') && child.size > 8) {
+                value = readAt(file, child.offset + 8, child.size - 8);
+            }
+        }
+        if (name != "iTunSMPB") {
+            continue;
+        }
+
+        // " 00000000 00000840 000001CA 00000000003F31F6 ..."：保留、延迟、填充、原始帧数（十六进制）
+        const QList<QByteArray> fields = value.simplified().split(' ');
+        if (fields.size() < 4) {
+            return false;
+        }
+        bool delayOk = false, paddingOk = false, lengthOk = false;
+        info.encoderDelay = fields[1].toLongLong(&delayOk, 16);
+        info.padding = fields[2].toLongLong(&paddingOk, 16);
+        info.validFrames = fields[3].toLongLong(&lengthOk, 16);
+        if (!lengthOk || info.validFrames <= 0) {
+            info.validFrames = -1;
+        }
+        return delayOk && paddingOk;
+    }
+    return false;
+}
@@ -0,0 +1,38 @@
+#ifndef NATIVETAGREADER_H
+#define NATIVETAGREADER_H
+
+#include <QFile>
+#include <QString>
+#include <QVariantMap>
+
+#include "GaplessInfo.h"
+
+/**
+ * @brief The NativeTagReader class
+ * 内置的音频标签解析器
+ *
+ * 直接解析文件头尾的标签结构（ID3v1/ID3v2、FLAC/Ogg 的 Vorbis 注释、MP4/M4A 的 atom、RIFF INFO 块），
+ * 不需要为每个文件创建 QMediaPlayer 解码管线。输出的键与 MediaMetadataExtractor::metaDataKeyToString 一致。
+ * 无法识别的格式返回 false，由调用者回退到 QMediaPlayer。
+ */
+class NativeTagReader
+{
+public:
+    // 解析成功（格式可识别）时返回 true，并将结果写入 metadata
+    static bool read(const QString &filePath, QVariantMap &metadata);
+
+    // 读取 MP3 的 LAME/Xing 头或 MP4 的 iTunSMPB 标签中的编码器延迟与填充，没有相关信息时返回 false
+    static bool readGapless(const QString &filePath, GaplessInfo &info);
+
+private:
+    static bool readMpeg(QFile &file, QVariantMap &metadata);
+    static bool readFlac(QFile &file, QVariantMap &metadata);
+    static bool readOgg(QFile &file, QVariantMap &metadata);
+    static bool readMp4(QFile &file, QVariantMap &metadata);
+    static bool readRiff(QFile &file, QVariantMap &metadata);
+
+    static bool readMpegGapless(QFile &file, GaplessInfo &info);
+    static bool readMp4Gapless(QFile &file, GaplessInfo &info);
+};
+
+#endif // NATIVETAGREADER_H
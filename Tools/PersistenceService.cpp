@@ -0,0 +1,154 @@
+#include "PersistenceService.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+#include <QTimer>
+
+PersistenceService::PersistenceService(QObject *parent)
+    : QObject{parent}
+    , m_thread(new QThread(this))
+    , m_worker(new QObject)
+    , m_timer(new QTimer(m_worker))
+    , m_timerArmed(false)
+    , m_coalesceDelay(500)
+{
+    m_thread->setObjectName("PersistenceService");
+
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, m_worker, [this]() {
+        writePending();
+    });
+
+    // 定时器作为子对象随工作对象一起移动到工作线程
+    m_worker->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_thread->start(QThread::LowPriority);
+}
+
+PersistenceService::~PersistenceService()
+{
+    flush();
+    m_thread->quit();
+    m_thread->wait();
+
+    const Metrics m = metrics();
+    qDebug().nospace() << "Persistence: " << m.writes << " writes (" << m.coalesced << " coalesced, "
+                       << m.failures << " failed), " << m.bytesWritten << " bytes, "
+                       << m.writeTimeNs / 1000000.0 << " ms total, "
+                       << m.maxWriteTimeNs / 1000000.0 << " ms max";
+}
+
+void PersistenceService::setCoalesceDelay(int ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_coalesceDelay = qMax(0, ms);
+}
+
+int PersistenceService::coalesceDelay() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_coalesceDelay;
+}
+
+void PersistenceService::schedule(const QString &path, Serializer serializer)
+{
+    QMutexLocker locker(&m_mutex);
+
+    ++m_metrics.requests;
+    if (m_pending.contains(path)) {
+        ++m_metrics.coalesced;
+    }
+    m_pending.insert(path, std::move(serializer));
+
+    if (!m_timerArmed) {
+        // 窗口从第一次提交开始，之后的提交不再推迟写入
+        m_timerArmed = true;
+        const int delay = m_coalesceDelay;
+        QMetaObject::invokeMethod(m_worker, [this, delay]() {
+            m_timer->start(delay);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void PersistenceService::flush()
+{
+    if (QThread::currentThread() == m_thread) {
+        writePending();
+        return;
+    }
+    if (!m_thread->isRunning()) {
+        return;
+    }
+
+    QMetaObject::invokeMethod(m_worker, [this]() {
+        m_timer->stop();
+        writePending();
+    }, Qt::BlockingQueuedConnection);
+}
+
+PersistenceService::Metrics PersistenceService::metrics() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_metrics;
+}
+
+void PersistenceService::writePending()
+{
+    QHash<QString, Serializer> pending;
+    {
+        QMutexLocker locker(&m_mutex);
+        pending.swap(m_pending);
+        m_timerArmed = false;
+    }
+
+    for (auto it = pending.begin(); it != pending.end(); ++it) {
+        QElapsedTimer timer;
+        timer.start();
+
+        const QByteArray data = it.value()();
+        const bool ok = writeFile(it.key(), data);
+        const qint64 elapsed = timer.nsecsElapsed();
+
+        {
+            QMutexLocker locker(&m_mutex);
+            if (ok) {
+                ++m_metrics.writes;
+                m_metrics.bytesWritten += data.size();
+            } else {
+                ++m_metrics.failures;
+            }
+            m_metrics.writeTimeNs += elapsed;
+            m_metrics.maxWriteTimeNs = qMax(m_metrics.maxWriteTimeNs, elapsed);
+        }
+
+        emit written(it.key(), ok, data.size(), elapsed);
+    }
+}
+
+bool PersistenceService::writeFile(const QString &path, const QByteArray &data)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    // QSaveFile 写入同目录下的临时文件，commit 时同步到磁盘后重命名替换原文件
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open file for writing:" << path << file.errorString();
+        return false;
+    }
+
+    if (file.write(data) != data.size()) {
+        qWarning() << "Failed to write file:" << path << file.errorString();
+        file.cancelWriting();   // 放弃临时文件，原文件保持不变
+        return false;
+    }
+
+    if (!file.commit()) {
+        qWarning() << "Failed to commit file:" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
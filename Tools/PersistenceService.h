@@ -0,0 +1,77 @@
+#ifndef PERSISTENCESERVICE_H
+#define PERSISTENCESERVICE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+
+#include <functional>
+
+class QThread;
+class QTimer;
+
+/**
+ * @brief The PersistenceService class
+ * 后台文件持久化服务
+ *
+ * 调用方只需在状态变化时提交 “路径 + 序列化函数”，同一路径在合并窗口内的多次提交只保留最后一次，
+ * 窗口结束后在工作线程中执行序列化并写入。写入使用 QSaveFile：先写临时文件，提交时同步到磁盘再重命名替换，
+ * 写入过程中崩溃不会损坏原文件。序列化函数在工作线程中执行，应按值捕获状态的快照。
+ */
+class PersistenceService : public QObject
+{
+    Q_OBJECT
+public:
+    using Serializer = std::function<QByteArray()>;
+
+    struct Metrics
+    {
+        qint64 requests = 0;        // 提交次数
+        qint64 coalesced = 0;       // 被后续提交合并掉的次数
+        qint64 writes = 0;          // 实际写入次数
+        qint64 failures = 0;
+        qint64 bytesWritten = 0;
+        qint64 writeTimeNs = 0;     // 序列化与写入的总耗时（工作线程）
+        qint64 maxWriteTimeNs = 0;
+    };
+
+    explicit PersistenceService(QObject *parent = nullptr);
+    ~PersistenceService();
+
+    // 合并窗口（毫秒），从第一次提交开始计时
+    void setCoalesceDelay(int ms);
+    int coalesceDelay() const;
+
+    // 标记 path 需要写入，窗口结束后以 serializer 的结果替换文件内容
+    void schedule(const QString &path, Serializer serializer);
+
+    // 立即写入所有待写的文件，完成后返回
+    void flush();
+
+    Metrics metrics() const;
+
+    // 在当前线程中以 QSaveFile 写入 path（没有服务实例可用时的同步写入）
+    static bool writeFile(const QString &path, const QByteArray &data);
+
+signals:
+    // 在工作线程中发出
+    void written(const QString &path, bool ok, qint64 bytes, qint64 elapsedNs);
+
+private:
+    void writePending();    // 工作线程
+
+private:
+    QThread *m_thread;
+    QObject *m_worker;      // 工作线程中的上下文对象
+    QTimer *m_timer;        // 合并窗口定时器（属于工作线程）
+
+    mutable QMutex m_mutex;
+    QHash<QString, Serializer> m_pending;
+    bool m_timerArmed;
+    int m_coalesceDelay;
+    Metrics m_metrics;
+};
+
+#endif // PERSISTENCESERVICE_H
@@ -1,13 +1,22 @@
 #include "QMediaPlayList.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
 #include <QDir>
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QJsonObject>
+#include <QSet>
 #include <QStandardPaths>
-#include <random>
+
+namespace {
+
+constexpr quint32 kShuffleMagic = 0x53485546;      // "SHUF"
+constexpr quint32 kShuffleVersion = 1;
+
+} // namespace
 
 QMediaPlayList::QMediaPlayList(QObject *parent)
     : QObject{parent}
+    , m_currentIndex(-1)
+    , m_playbackMode(EPlayMode::List)
 {
     // 初始化历史记录存储路径
     QString appDataPath = "./";
@@ -16,8 +25,25 @@ QMediaPlayList::QMediaPlayList(QObject *parent)
         dir.mkpath(".");
     }
     m_historySavePath = dir.filePath("play_history.json");
+    m_historyJournal = new HistoryJournal(dir.filePath("play_history.journal"), this);
 
-    loadHistoryFromFile();
+    // 随机顺序属于应用数据，与其他缓存放在一起
+    QDir appDataDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    if (!appDataDir.exists()) {
+        appDataDir.mkpath(".");
+    }
+    m_shuffleSavePath = appDataDir.filePath("shuffle_order.dat");
+
+    m_shuffleSaveTimer.setSingleShot(true);
+    m_shuffleSaveTimer.setInterval(1000);
+    connect(&m_shuffleSaveTimer, &QTimer::timeout, this, &QMediaPlayList::saveShuffleToFile);
+}
+
+QMediaPlayList::~QMediaPlayList()
+{
+    if (m_shuffleSaveTimer.isActive()) {
+        saveShuffleToFile();
+    }
 }
 
 QMediaPlayList::EPlayMode QMediaPlayList::getPlaybackMode() const
@@ -30,152 +56,338 @@ void QMediaPlayList::setPlaybackMode(EPlayMode mode)
     m_playbackMode = mode;
     if (m_playbackMode == EPlayMode::Rand)
     {
-        // 如果主动设置随机模式，生成随机播放列表
-        shuffleIterators();
+        // 已有完整的随机顺序时沿用，只在不一致时重新生成，并从当前音频开始
+        if (m_shuffleOrder.size() != m_metadataList.size())
+        {
+            m_shuffleOrder.reset(m_metadataList.size(), m_currentIndex);
+            scheduleShuffleSave();
+        }
+        m_shuffleOrder.setCurrent(m_currentIndex);
     }
 }
 
-void QMediaPlayList::append(const QVariantMap& metadata)
+void QMediaPlayList::append(const TrackRecord& track)
 {
-    append(QVector<QVariantMap>({metadata}));
+    append(QVector<TrackRecord>({track}));
 }
 
-void QMediaPlayList::append(const QVector<QVariantMap> &metadataList)
+void QMediaPlayList::append(const QVector<TrackRecord> &tracks)
 {
-    m_metadataList.append(metadataList);
+    if (tracks.isEmpty())
+    {
+        return;
+    }
+
+    const int first = m_metadataList.size();
+    const int last = first + tracks.size() - 1;
+
+    emit mediaAboutToBeInserted(first, last);
+    insertTracks(tracks);
+    emit mediaInserted(first, last);
 
     // 更新当前播放的媒体
     updateCurrentMedia();
-    if (m_playbackMode == EPlayMode::Rand)
+}
+
+void QMediaPlayList::setPlayList(const QVector<TrackRecord> &tracks)
+{
+    emit metadataListAboutToBeReset();
+
+    m_metadataList.clear();
+    m_urlIndex.clear();
+    m_shuffleOrder.clear();
+    m_currentIndex = -1;
+
+    insertTracks(tracks);
+
+    emit metadataListChanged();
+
+    updateCurrentMedia();
+}
+
+void QMediaPlayList::insertTracks(const QVector<TrackRecord> &tracks)
+{
+    const int firstIndex = m_metadataList.size();
+
+    // 上次保存过位置的音轨回到原来的名次，其余随机插入到尚未播放的部分
+    QVector<double> shuffleKeys;
+    shuffleKeys.reserve(tracks.size());
+
+    m_urlIndex.reserve(m_metadataList.size() + tracks.size());
+    for (const auto &track : tracks)
     {
-        // 当播放模式为随机且载入了元数据时，生成随机播放列表
-        shuffleIterators();
+        if (!m_urlIndex.contains(track.url))
+        {
+            m_urlIndex.insert(track.url, int(m_metadataList.size()));
+        }
+        m_metadataList.append(track);
+
+        double shuffleKey = -1.0;
+        auto saved = m_savedShuffleRanks.find(track.url);
+        if (saved != m_savedShuffleRanks.end())
+        {
+            shuffleKey = saved.value();
+            m_savedShuffleRanks.erase(saved);
+        }
+        shuffleKeys.append(shuffleKey);
     }
+    m_shuffleOrder.append(firstIndex, shuffleKeys);
+    scheduleShuffleSave();
 }
 
-void QMediaPlayList::setPlayList(const QVector<QVariantMap> &metadataList)
+void QMediaPlayList::removeMedia(const QStringList &urls)
 {
-    m_metadataList.clear();
+    if (urls.isEmpty() || m_metadataList.isEmpty())
+    {
+        return;
+    }
 
-    append(metadataList);
+    const QSet<QString> targets(urls.begin(), urls.end());
+
+    QVector<int> newIndexOf(m_metadataList.size(), -1);
+    int keptCount = 0;
+    int removedBefore = 0;
+    bool currentRemoved = false;
+    for (int i = 0; i < m_metadataList.size(); i++)
+    {
+        if (!targets.contains(m_metadataList.at(i).url))
+        {
+            newIndexOf[i] = keptCount++;
+            continue;
+        }
+
+        if (i < m_currentIndex)
+        {
+            removedBefore++;
+        }
+        else if (i == m_currentIndex)
+        {
+            currentRemoved = true;
+        }
+    }
+
+    if (keptCount == m_metadataList.size())
+    {
+        return;
+    }
+
+    // 从后往前按连续区间移除，前面区间的下标保持不变
+    int last = m_metadataList.size() - 1;
+    while (last >= 0)
+    {
+        if (newIndexOf[last] >= 0)
+        {
+            last--;
+            continue;
+        }
+
+        int first = last;
+        while (first > 0 && newIndexOf[first - 1] < 0)
+        {
+            first--;
+        }
+
+        emit mediaAboutToBeRemoved(first, last);
+        m_metadataList.remove(first, last - first + 1);
+        emit mediaRemoved(first, last);
+
+        last = first - 1;
+    }
+
+    rebuildUrlIndex();
+    m_shuffleOrder.remap(newIndexOf);
+    scheduleShuffleSave();
+
+    if (m_currentIndex >= 0)
+    {
+        m_currentIndex -= removedBefore;
+        if (currentRemoved)
+        {
+            // 当前音频被移除，顺延到原位置上的下一首
+            setCurrentIndex(qMin(m_currentIndex, int(m_metadataList.size()) - 1));
+        }
+    }
 }
 
-QVariantMap QMediaPlayList::getCurrentMediaValue()
+void QMediaPlayList::updateMedia(const TrackRecord &track)
 {
-    QVariantMap metadata = *m_currentMedia;
-    return metadata;
+    const int index = indexOfUrl(track.url);
+    if (index < 0)
+    {
+        return;
+    }
+
+    m_metadataList[index] = track;
+    emit mediaChanged(index, index);
 }
 
-void QMediaPlayList::setMediaByUrl(const QString &url)
+void QMediaPlayList::moveMedia(int from, int to)
 {
-    // 如果列表中有对应 url 的音乐，就进行设置，否则不设置
-    for (auto it = m_metadataList.begin(); it < m_metadataList.end(); it ++)
+    const int count = m_metadataList.size();
+    if (from < 0 || from >= count || to < 0 || to >= count || from == to)
+    {
+        return;
+    }
+
+    // 与 QAbstractItemModel::beginMoveRows 一致，destination 为移动前坐标中插入位置之后的行
+    const int destination = (to > from) ? to + 1 : to;
+
+    emit mediaAboutToBeMoved(from, from, destination);
+
+    m_metadataList.move(from, to);
+
+    QVector<int> newIndexOf(count);
+    for (int i = 0; i < count; i++)
     {
-        QVariantMap metadata = *it;
-        if (metadata["Url"].toString() == url)
+        if (i == from)
+        {
+            newIndexOf[i] = to;
+        }
+        else if (from < to && i > from && i <= to)
+        {
+            newIndexOf[i] = i - 1;
+        }
+        else if (to < from && i >= to && i < from)
+        {
+            newIndexOf[i] = i + 1;
+        }
+        else
         {
-            setCurrentMedia(it);
+            newIndexOf[i] = i;
         }
     }
 
+    rebuildUrlIndex();
+    m_shuffleOrder.remap(newIndexOf);
+    if (m_currentIndex >= 0)
+    {
+        m_currentIndex = newIndexOf[m_currentIndex];
+        m_shuffleOrder.setCurrent(m_currentIndex);
+    }
+
+    emit mediaMoved(from, from, destination);
+}
+
+TrackRecord QMediaPlayList::getCurrentMediaValue()
+{
+    if (m_currentIndex < 0 || m_currentIndex >= m_metadataList.size())
+    {
+        return TrackRecord();
+    }
+    return m_metadataList.at(m_currentIndex);
+}
+
+void QMediaPlayList::setMediaByUrl(const QString &url)
+{
+    // 如果列表中有对应 url 的音乐，就进行设置，否则不设置
+    const int index = indexOfUrl(url);
+    if (index >= 0)
+    {
+        setCurrentIndex(index);
+    }
 }
 
-QVector<QVariantMap>::ConstIterator QMediaPlayList::getCurrentMediaIterator()
+int QMediaPlayList::indexOfUrl(const QString &url) const
 {
-    return m_currentMedia;
+    return m_urlIndex.value(url, -1);
 }
 
-const QVector<QVariantMap> &QMediaPlayList::getMetadataList() const
+QVector<TrackRecord>::ConstIterator QMediaPlayList::getCurrentMediaIterator()
+{
+    if (m_currentIndex < 0 || m_currentIndex >= m_metadataList.size())
+    {
+        return m_metadataList.cend();
+    }
+    return m_metadataList.cbegin() + m_currentIndex;
+}
+
+const QVector<TrackRecord> &QMediaPlayList::getMetadataList() const
 {
     return m_metadataList;
 }
 
-void QMediaPlayList::setCurrentMedia(QVector<QVariantMap>::ConstIterator it)
+void QMediaPlayList::setCurrentMedia(QVector<TrackRecord>::ConstIterator it)
 {
-    if (!it->isEmpty())
+    setCurrentIndex(it - m_metadataList.cbegin());
+}
+
+void QMediaPlayList::setCurrentIndex(int index)
+{
+    // 记录下标而不是迭代器，列表追加导致重新分配时不会失效
+    if (index < 0 || index >= m_metadataList.size())
+    {
+        m_currentIndex = -1;
+    }
+    else if (!m_metadataList.at(index).isNull())
     {
-        m_currentMedia = it;
+        m_currentIndex = index;
     }
+    m_shuffleOrder.setCurrent(m_currentIndex);
 
     emit currentMediaChanged();
 }
 
 void QMediaPlayList::setNextMedia()
 {
-    if (getCurrentMediaIterator() == nullptr) { return ; }
+    if (m_currentIndex < 0) { return ; }
 
     if (m_playbackMode == EPlayMode::Rand)
     {
-        // 如果是处于随机模式下，使用随机列表中的顺序
-
-        // 找到当前歌曲在随机列表中的位置，然后进行加减。
-        int i = 0;
-        for (; i < m_randomMediaList.size(); i++)
-        {
-            auto it = m_randomMediaList[i];
-            if (getCurrentMediaIterator() == it)
-            {
-                break;
-            }
-        }
-        if (getCurrentMediaIterator() != *(m_randomMediaList.end() - 1))
-        {
-            setCurrentMedia(m_randomMediaList[i + 1]);
-        }
-        else
-        {
-            setCurrentMedia(*m_randomMediaList.begin());
-        }
+        // 如果是处于随机模式下，使用随机顺序中游标的后一首
+        setCurrentIndex(m_shuffleOrder.nextIndex());
     }
     else
     {
-        if (getCurrentMediaIterator() != getMetadataList().end() - 1)
+        if (m_currentIndex != m_metadataList.size() - 1)
         {
-            setCurrentMedia(getCurrentMediaIterator() + 1);
+            setCurrentIndex(m_currentIndex + 1);
         }
         else
         {
-            setCurrentMedia(getMetadataList().begin());
+            setCurrentIndex(0);
         }
     }
 }
 
+TrackRecord QMediaPlayList::peekNextMedia() const
+{
+    if (m_currentIndex < 0 || m_currentIndex >= m_metadataList.size()) { return TrackRecord(); }
+
+    int index = m_currentIndex;
+    switch (m_playbackMode)
+    {
+    case EPlayMode::Loops:
+        break;
+    case EPlayMode::Rand:
+        index = m_shuffleOrder.nextIndex();
+        break;
+    default:
+        index = (m_currentIndex + 1) % m_metadataList.size();
+        break;
+    }
+
+    if (index < 0 || index >= m_metadataList.size()) { return TrackRecord(); }
+    return m_metadataList.at(index);
+}
+
 void QMediaPlayList::setPreviousMedia()
 {
+    if (m_currentIndex < 0) { return ; }
+
     if (m_playbackMode == EPlayMode::Rand)
     {
-        // 如果是处于随机模式下，使用随机列表中的顺序
-
-        // 找到当前歌曲在随机列表中的位置，然后进行加减。
-        int i = 0;
-        for (; i < m_randomMediaList.size(); i++)
-        {
-            auto it = m_randomMediaList[i];
-            if (getCurrentMediaIterator() == it)
-            {
-                break;
-            }
-        }
-        if (getCurrentMediaIterator() != *m_randomMediaList.begin())
-        {
-            setCurrentMedia(m_randomMediaList[i - 1]);
-        }
-        else
-        {
-            setCurrentMedia(*(m_randomMediaList.end()-1));
-        }
+        // 如果是处于随机模式下，使用随机顺序中游标的前一首
+        setCurrentIndex(m_shuffleOrder.previousIndex());
     }
     else
     {
-        if (getCurrentMediaIterator() == nullptr) { return ; }
-
-        if (getCurrentMediaIterator() != getMetadataList().begin())
+        if (m_currentIndex != 0)
         {
-            setCurrentMedia(getCurrentMediaIterator() - 1);
+            setCurrentIndex(m_currentIndex - 1);
         }
         else
         {
-            setCurrentMedia(getMetadataList().end() - 1);
+            setCurrentIndex(m_metadataList.size() - 1);
         }
     }
 }
@@ -185,16 +397,16 @@ void QMediaPlayList::updateCurrentMedia()
     // 如果播放列表没有音频信息，重置空
     if (m_metadataList.isEmpty())
     {
-        setCurrentMedia(m_metadataList.end());
+        setCurrentIndex(-1);
         return;
     }
 
     // 当播放列表中有值
 
     // 如果当前播放信息为空，设置当前播放信息为首个
-    if (m_currentMedia == nullptr || m_currentMedia == m_metadataList.end())
+    if (m_currentIndex < 0 || m_currentIndex >= m_metadataList.size())
     {
-        setCurrentMedia(m_metadataList.begin());
+        setCurrentIndex(0);
     }
 
     // 如果当前播放信息不为空
@@ -211,79 +423,101 @@ void QMediaPlayList::updateCurrentMedia()
     //     m_pcurrentMedia = &m_vmediaInfo.front();
     // }
 
-    QVariantMap currentMediaMetadata = *m_currentMedia;
-    // 更新历史记录
-    m_historyMedia[currentMediaMetadata["Url"].toString()] = currentMediaMetadata;
-    m_mediaUpdate[currentMediaMetadata["Url"].toString()] = QDateTime::currentSecsSinceEpoch();
-
-    saveHistoryFromFile();
-
-    emit metadataListChanged();
+    // 每批追加都会走到这里，只有当前音频确实换了才记一次播放；更新历史记录只追加一条记录而不重写整个文件
+    const TrackRecord currentMedia = getCurrentMediaValue();
+    if (currentMedia.isNull() || currentMedia.url == m_recordedUrl)
+    {
+        return;
+    }
+    m_recordedUrl = currentMedia.url;
+    m_historyJournal->recordPlayed(currentMedia, QDateTime::currentSecsSinceEpoch());
 }
 
-void QMediaPlayList::shuffleIterators()
+void QMediaPlayList::rebuildUrlIndex()
 {
-    m_randomMediaList.clear();
-
-    // 步骤1：填充原始迭代器
-    for (auto it = m_metadataList.begin(); it != m_metadataList.end(); ++it) {
-        m_randomMediaList.append(it);
-    }
-
-    // 步骤2：Fisher-Yates Shuffle
-    std::random_device rd;
-    std::mt19937 gen(rd());
-
-    for (int i = m_randomMediaList.size() - 1; i > 0; --i) {
-        std::uniform_int_distribution<> distrib(0, i);
-        int j = distrib(gen);
-        qSwap(m_randomMediaList[i], m_randomMediaList[j]);
+    m_urlIndex.clear();
+    m_urlIndex.reserve(m_metadataList.size());
+    for (int i = 0; i < m_metadataList.size(); ++i)
+    {
+        if (!m_urlIndex.contains(m_metadataList.at(i).url))
+        {
+            m_urlIndex.insert(m_metadataList.at(i).url, i);
+        }
     }
 }
 
 void QMediaPlayList::loadHistoryFromFile()
 {
-    QFile file(m_historySavePath);
+    // 日志不存在时导入旧版 JSON 历史记录
+    m_historyJournal->load(m_historySavePath);
+}
+
+void QMediaPlayList::loadShuffleFromFile()
+{
+    QFile file(m_shuffleSavePath);
     if (!file.open(QIODevice::ReadOnly)) {
         return;
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    if (doc.isObject()) {
-        QJsonObject root = doc.object();
-        QJsonArray historyArray = root["history"].toArray();
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
 
-        for (const QJsonValue& val : historyArray) {
-            QJsonObject obj = val.toObject();
-            QString url = obj["url"].toString();
-            QVariantMap data = obj["data"].toObject().toVariantMap();
-            int timestamp = obj["timestamp"].toInt();
-            m_historyMedia[url] = data;
-            m_mediaUpdate[url] = timestamp;
-        }
+    quint32 magic = 0, version = 0;
+    QStringList urls;
+    in >> magic >> version >> urls;
+    if (magic != kShuffleMagic || version != kShuffleVersion || in.status() != QDataStream::Ok) {
+        qWarning() << "Ignoring invalid shuffle order file:" << m_shuffleSavePath;
+        return;
+    }
+
+    m_savedShuffleRanks.reserve(urls.size());
+    for (int i = 0; i < urls.size(); ++i) {
+        m_savedShuffleRanks.insert(urls.at(i), i);
     }
 }
 
-void QMediaPlayList::saveHistoryFromFile()
+void QMediaPlayList::saveShuffleToFile()
 {
-    QJsonArray historyArray;
-
-    for (auto it = m_historyMedia.begin(); it != m_historyMedia.end(); ++it) {
-        QJsonObject obj;
-        obj["url"] = it.key();
-        obj["data"] = QJsonObject::fromVariantMap(it.value());
-        obj["timestamp"] = m_mediaUpdate.value(it.key());
-        historyArray.append(obj);
+    m_shuffleSaveTimer.stop();
+    if (m_shuffleOrder.isEmpty() || !m_savedShuffleRanks.isEmpty()) {
+        return;     // 保留上次的顺序
     }
 
-    QJsonObject root;
-    root["history"] = historyArray;
-    QJsonDocument doc(root);
+    QStringList urls;
+    urls.reserve(m_shuffleOrder.size());
+    for (int index : m_shuffleOrder.order()) {
+        urls.append(m_metadataList.at(index).url);
+    }
 
-    QFile file(m_historySavePath);
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(doc.toJson());
+    auto serialize = [urls]() {
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << kShuffleMagic << kShuffleVersion << urls;
+        return data;
+    };
+
+    if (m_persistence) {
+        m_persistence->schedule(m_shuffleSavePath, serialize);
+    } else {
+        PersistenceService::writeFile(m_shuffleSavePath, serialize());
     }
 }
 
+void QMediaPlayList::finishShuffleRestore()
+{
+    if (m_savedShuffleRanks.isEmpty()) {
+        return;
+    }
+    m_savedShuffleRanks.clear();
+    m_savedShuffleRanks.squeeze();
+    scheduleShuffleSave();
+}
 
+void QMediaPlayList::scheduleShuffleSave()
+{
+    if (!m_savedShuffleRanks.isEmpty()) {
+        return;     // 仍在恢复上次的顺序
+    }
+    m_shuffleSaveTimer.start();
+}
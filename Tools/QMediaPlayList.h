@@ -3,9 +3,17 @@
 
 #include <QObject>
 #include <QUrl>
+#include <QHash>
 #include <QMap>
+#include <QPointer>
+#include <QTimer>
 #include <QVariant>
 
+#include "HistoryJournal.h"
+#include "PersistenceService.h"
+#include "ShuffleOrder.h"
+#include "TrackRecord.h"
+
 class QMediaPlayList : public QObject
 {
     Q_OBJECT
@@ -20,49 +28,92 @@ public:
 
 public:
     explicit QMediaPlayList(QObject *parent = nullptr);
+    ~QMediaPlayList();
 
     EPlayMode getPlaybackMode() const;
     void setPlaybackMode(EPlayMode mode);
 
-    void append(const QVariantMap& metadata);
-    void append(const QVector<QVariantMap>& metadataList);
+    void append(const TrackRecord& track);
+    void append(const QVector<TrackRecord>& tracks);
+
+    void setPlayList(const QVector<TrackRecord>& tracks);
 
-    void setPlayList(const QVector<QVariantMap>& metadataList);
+    // 按 url 移除音频
+    void removeMedia(const QStringList& urls);
+    // 用新的元数据替换列表中相同 url 的音频
+    void updateMedia(const TrackRecord& track);
+    // 将下标 from 的音频移动到下标 to
+    void moveMedia(int from, int to);
 
-    QVariantMap getCurrentMediaValue();
+    TrackRecord getCurrentMediaValue();
     void setMediaByUrl(const QString& url);
-    QVector<QVariantMap>::ConstIterator getCurrentMediaIterator();
-    const QVector<QVariantMap>& getMetadataList() const;
+    // url 对应的列表下标，不存在时返回 -1
+    int indexOfUrl(const QString& url) const;
+    QVector<TrackRecord>::ConstIterator getCurrentMediaIterator();
+    const QVector<TrackRecord>& getMetadataList() const;
 
-    void setCurrentMedia(QVector<QVariantMap>::ConstIterator it);
+    void setCurrentMedia(QVector<TrackRecord>::ConstIterator it);
+    void setCurrentIndex(int index);
 
     // 设置音频，不一定会播放
     void setNextMedia();
     void setPreviousMedia();
 
+    // 当前音频自然播放结束后接着播放的音频（单曲循环为当前音频），不改变当前音频
+    TrackRecord peekNextMedia() const;
+
 private:
-    QVector<QVariantMap> m_metadataList;
+    QVector<TrackRecord> m_metadataList;
+    QHash<QString, int> m_urlIndex;  // url -> 列表下标（重复的 url 指向第一个）
 
-    QVector<QVariantMap>::ConstIterator m_currentMedia;
-    QVector<QVector<QVariantMap>::iterator> m_randomMediaList;
+    int m_currentIndex;              // 当前音频在列表中的下标，-1 表示无
+    ShuffleOrder m_shuffleOrder;     // 随机播放顺序，任何模式下都随列表维护
+    QHash<QString, double> m_savedShuffleRanks;  // 上次保存的随机顺序（url -> 名次），恢复完成后清空
+    QString m_shuffleSavePath;                   // 随机顺序保存路径
+    QTimer m_shuffleSaveTimer;                   // 顺序变化后延迟保存，合并连续的变化
+    QPointer<PersistenceService> m_persistence;
 
     EPlayMode m_playbackMode;
 
-    QMap<QString, QVariantMap> m_historyMedia;   // 历史音频（URL -> 专辑数据）
-    QMap<QString, int> m_mediaUpdate;            // 更新历史 (URL -> 最后一次载入时间戳)
-    QString m_historySavePath;                   // 历史记录保存路径
+    HistoryJournal *m_historyJournal;            // 播放历史（追加式日志）
+    QString m_historySavePath;                   // 旧版 JSON 历史记录路径，仅用于首次导入
+    QString m_recordedUrl;                       // 最近一次记入历史的音频，同一音频不重复记录
 
 private:
     void updateCurrentMedia();
-    void shuffleIterators();
+    void insertTracks(const QVector<TrackRecord>& tracks);
+    void rebuildUrlIndex();
+    // 随机顺序变化，延迟保存
+    void scheduleShuffleSave();
 
 signals:
+    // 整个列表被替换（与 QAbstractItemModel 的重置对应）
+    void metadataListAboutToBeReset();
     void metadataListChanged();
+
+    // 列表局部变化，区间为闭区间 [first, last]，语义与 QAbstractItemModel 的行变化一致
+    void mediaAboutToBeInserted(int first, int last);
+    void mediaInserted(int first, int last);
+    void mediaAboutToBeRemoved(int first, int last);
+    void mediaRemoved(int first, int last);
+    void mediaChanged(int first, int last);
+    void mediaAboutToBeMoved(int first, int last, int destination);
+    void mediaMoved(int first, int last, int destination);
+
     void currentMediaChanged();
 
 public:
+    // 历史日志与随机顺序不在构造时读取，由所属窗口在显示后载入（须在添加音轨之前）
     void loadHistoryFromFile();
-    void saveHistoryFromFile();
+    const HistoryJournal *historyJournal() const { return m_historyJournal; }
+
+    // 随机播放顺序按 url 保存，重启后分批载入的音轨会回到原来的位置
+    // 顺序变化后延迟提交给 persistence 在后台写入，恢复完成（finishShuffleRestore）之前不保存，以免覆盖尚未载入的音轨
+    void setPersistence(PersistenceService *persistence) { m_persistence = persistence; }
+    void loadShuffleFromFile();
+    void saveShuffleToFile();
+    // 上次的音轨已全部载入，丢弃未能恢复的名次
+    void finishShuffleRestore();
 };
 
 #endif // QMEDIAPLAYLIST_H
@@ -0,0 +1,279 @@
+#include "Resampler.h"
+
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVarLengthArray>
+
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <tuple>
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+
+// 抽头数上限（极端的降采样比例下）
+constexpr int MaxTaps = 4096;
+
+struct QualitySpec
+{
+    double attenuationDb;   // 阻带衰减
+    double passband;        // 通带边缘占奈奎斯特频率的比例
+};
+
+constexpr QualitySpec Specs[] = {
+    { 60.0, 0.80 },
+    { 96.0, 0.90 },
+    { 120.0, 0.95 },
+};
+
+const QualitySpec &spec(Resampler::Quality quality)
+{
+    return Specs[qBound(0, int(quality), 2)];
+}
+
+// 第一类零阶修正贝塞尔函数（级数展开）
+double besselI0(double x)
+{
+    const double q = x * x / 4.0;
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 100; ++k) {
+        term *= q / (double(k) * k);
+        sum += term;
+        if (term < sum * 1e-17) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// Kaiser 窗的 beta 与阻带衰减的经验关系
+double kaiserBeta(double attenuationDb)
+{
+    if (attenuationDb > 50.0) {
+        return 0.1102 * (attenuationDb - 8.7);
+    }
+    if (attenuationDb >= 21.0) {
+        return 0.5842 * std::pow(attenuationDb - 21.0, 0.4) + 0.07886 * (attenuationDb - 21.0);
+    }
+    return 0.0;
+}
+
+} // namespace
+
+// 一个转换比与质量下的全部相位的系数
+struct Resampler::FilterBank
+{
+    int up = 1;
+    int down = 1;
+    int phases = 1;
+    int taps = 8;               // 8 的倍数
+    double passband = 0.0;      // 通带边缘，以输入采样率为 1
+    QVector<float> coeffs;      // phases * taps，第 p 个相位对应输出位于两个输入采样之间 p / phases 处
+};
+
+Resampler::Resampler(int inRate, int outRate, int channels, Quality quality, const DspKernels &kernels)
+    : m_inRate(qMax(1, inRate))
+    , m_outRate(qMax(1, outRate))
+    , m_channels(qMax(1, channels))
+    , m_quality(quality)
+    , m_dsp(kernels)
+    , m_bank(filterBank(m_inRate, m_outRate, quality))
+    , m_history(m_channels)
+    , m_length(0)
+    , m_pos(0)
+    , m_phase(0)
+    , m_inputFrames(0)
+    , m_outputFrames(0)
+{
+    reset();
+}
+
+Resampler::~Resampler() = default;
+
+int Resampler::taps() const
+{
+    return m_bank->taps;
+}
+
+void Resampler::reset()
+{
+    // 历史开头放 taps / 2 - 1 个 0，使第 0 个输出帧的滤波中心对齐第 0 个输入帧
+    m_length = m_bank->taps / 2 - 1;
+    for (QVector<float> &plane : m_history) {
+        plane.fill(0.0f, m_length);
+    }
+    m_pos = 0;
+    m_phase = 0;
+    m_inputFrames = 0;
+    m_outputFrames = 0;
+}
+
+qint64 Resampler::process(const float *data, qint64 frames, QVector<float> &out)
+{
+    if (frames <= 0) {
+        return 0;
+    }
+    append(data, frames);
+    m_inputFrames += frames;
+    return produce(out, -1);
+}
+
+qint64 Resampler::flush(QVector<float> &out)
+{
+    // 补 taps / 2 个 0，使最后一个输入帧之前的输出帧都能算出，再截到应有的总帧数
+    const qint64 zeros = m_bank->taps / 2;
+    for (QVector<float> &plane : m_history) {
+        plane.resize(m_length + zeros);
+        std::fill(plane.begin() + m_length, plane.end(), 0.0f);
+    }
+    m_length += zeros;
+
+    const qint64 total = (m_inputFrames * m_bank->up + m_bank->down - 1) / m_bank->down;
+    return produce(out, qMax<qint64>(0, total - m_outputFrames));
+}
+
+void Resampler::append(const float *data, qint64 frames)
+{
+    QVarLengthArray<float *, 8> planes(m_channels);
+    for (int c = 0; c < m_channels; ++c) {
+        QVector<float> &plane = m_history[c];
+        if (plane.size() < m_length + frames) {
+            plane.resize(m_length + frames);
+        }
+        planes[c] = plane.data() + m_length;
+    }
+    m_dsp.deinterleave(data, planes.data(), m_channels, frames);
+    m_length += frames;
+}
+
+qint64 Resampler::produce(QVector<float> &out, qint64 maxFrames)
+{
+    const FilterBank &bank = *m_bank;
+
+    // 第 j 个输出帧的第一个抽头在 m_pos + (m_phase + j * down) / up，最后一个抽头不能超出历史
+    const qint64 positions = m_length - bank.taps + 1 - m_pos;
+    qint64 frames = positions > 0 ? (positions * bank.up - m_phase + bank.down - 1) / bank.down : 0;
+    if (maxFrames >= 0) {
+        frames = qMin(frames, maxFrames);
+    }
+
+    if (frames > 0) {
+        const qint64 offset = out.size();
+        out.resize(offset + frames * m_channels);
+        float *dst = out.data() + offset;
+        for (qint64 j = 0; j < frames; ++j) {
+            const float *h = bank.coeffs.constData() + (m_phase * bank.phases / bank.up) * bank.taps;
+            for (int c = 0; c < m_channels; ++c) {
+                dst[c] = m_dsp.dotProduct(m_history[c].constData() + m_pos, h, bank.taps);
+            }
+            dst += m_channels;
+
+            m_phase += bank.down;
+            m_pos += m_phase / bank.up;
+            m_phase %= bank.up;
+        }
+        m_outputFrames += frames;
+    }
+
+    // 丢弃之后不再用到的历史
+    const qint64 discard = qMin(m_pos, m_length);
+    if (discard > 0) {
+        for (QVector<float> &plane : m_history) {
+            std::memmove(plane.data(), plane.constData() + discard, size_t(m_length - discard) * sizeof(float));
+        }
+        m_length -= discard;
+        m_pos -= discard;
+    }
+
+    return qMax<qint64>(0, frames);
+}
+
+const char *Resampler::qualityName(Quality quality)
+{
+    switch (quality) {
+    case Fast:
+        return "fast";
+    case Standard:
+        return "standard";
+    default:
+        return "high";
+    }
+}
+
+std::shared_ptr<const Resampler::FilterBank> Resampler::filterBank(int inRate, int outRate, Quality quality)
+{
+    static QMutex mutex;
+    static QMap<std::tuple<int, int, int>, std::shared_ptr<const FilterBank>> cache;
+
+    const std::tuple<int, int, int> key(inRate, outRate, int(quality));
+    {
+        QMutexLocker locker(&mutex);
+        auto it = cache.constFind(key);
+        if (it != cache.constEnd()) {
+            return it.value();
+        }
+    }
+
+    // 在锁外设计，新的采样率组合不会阻塞其他转换的查找；两个线程同时设计同一组时沿用先放入缓存的
+    std::shared_ptr<const FilterBank> bank = design(inRate, outRate, quality);
+
+    QMutexLocker locker(&mutex);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.insert(key, bank);
+    }
+    return it.value();
+}
+
+std::shared_ptr<const Resampler::FilterBank> Resampler::design(int inRate, int outRate, Quality quality)
+{
+    auto bank = std::make_shared<FilterBank>();
+    const int g = std::gcd(inRate, outRate);
+    bank->up = outRate / g;
+    bank->down = inRate / g;
+    bank->phases = qMin(bank->up, MaxPhases);
+
+    // 以输入采样率为 1：阻带从较低一方的奈奎斯特频率开始，截止频率在过渡带中点
+    const QualitySpec &s = spec(quality);
+    const double stop = 0.5 * qMin(1.0, double(outRate) / inRate);
+    const double pass = stop * s.passband;
+    const double cutoff = 0.5 * (pass + stop);
+    bank->passband = pass;
+
+    // Kaiser 窗的长度估计：N = (A - 7.95) / (14.36 * 过渡带宽度)，取 8 的倍数便于向量化
+    const int taps = int(std::ceil((s.attenuationDb - 7.95) / (14.36 * (stop - pass))));
+    bank->taps = qBound(8, (taps + 7) / 8 * 8, MaxTaps);
+
+    const int n = bank->taps;
+    const double half = n / 2.0;
+    const double beta = kaiserBeta(s.attenuationDb);
+    const double i0Beta = besselI0(beta);
+
+    bank->coeffs.resize(qint64(bank->phases) * n);
+    QVector<double> h(n);
+    for (int p = 0; p < bank->phases; ++p) {
+        const double frac = double(p) / bank->phases;
+        double sum = 0.0;
+        for (int k = 0; k < n; ++k) {
+            // 第 k 个抽头的输入采样到输出位置的距离
+            const double t = (half - 1 - k) + frac;
+            const double x = t / half;
+            const double window = std::fabs(x) < 1.0 ? besselI0(beta * std::sqrt(1.0 - x * x)) / i0Beta : 0.0;
+            const double arg = 2.0 * cutoff * t;
+            const double sinc = arg == 0.0 ? 1.0 : std::sin(Pi * arg) / (Pi * arg);
+            h[k] = 2.0 * cutoff * sinc * window;
+            sum += h[k];
+        }
+
+        // 每个相位的直流增益都归一化为 1
+        float *dst = bank->coeffs.data() + qint64(p) * n;
+        for (int k = 0; k < n; ++k) {
+            dst[k] = float(h[k] / sum);
+        }
+    }
+    return bank;
+}
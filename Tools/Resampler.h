@@ -0,0 +1,81 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <QVector>
+
+#include <memory>
+
+#include "DspKernels.h"
+
+/**
+ * @brief The Resampler class
+ * 多相加窗 sinc 采样率转换
+ *
+ * 转换比约分为 up / down，输出第 j 帧位于输入的 j * down / up 处，由 up 个相位中对应的一组 FIR 系数与
+ * 附近的输入采样做内积（DspKernels::dotProduct）得到。滤波器为 Kaiser 窗 sinc，截止频率在较低一方的奈奎斯特频率以下，
+ * 过渡带以奈奎斯特频率为止，降采样时混叠只落在过渡带内。各档质量的阻带衰减、通带宽度不同，抽头数由它们决定。
+ * 系数组（滤波器组）按（输入采样率，输出采样率，质量）缓存，同一转换的所有实例共用，只在第一次使用时计算。
+ * up 超过 MaxPhases 时（不常见的采样率组合）位置仍按精确的比例推进，系数取最接近的较低相位，误差约 -80 dB。
+ *
+ * 滤波器的延迟已在内部补偿：输出的第 0 帧对齐输入的第 0 帧，输入结束后调用 flush，
+ * 输出总帧数为 ceil(输入帧数 * outRate / inRate)。
+ */
+class Resampler
+{
+public:
+    enum Quality {
+        Fast,       // 60 dB，通带到奈奎斯特频率的 80%
+        Standard,   // 96 dB，90%
+        High,       // 120 dB，95%
+    };
+
+    static constexpr int MaxPhases = 1024;
+
+    Resampler(int inRate, int outRate, int channels, Quality quality = High,
+              const DspKernels &kernels = DspKernels::instance());
+    ~Resampler();
+
+    int inputRate() const { return m_inRate; }
+    int outputRate() const { return m_outRate; }
+    int channels() const { return m_channels; }
+    Quality quality() const { return m_quality; }
+    // 每个相位的抽头数
+    int taps() const;
+
+    // 转换交错的 frames 帧，结果追加到 out，返回追加的帧数
+    qint64 process(const float *data, qint64 frames, QVector<float> &out);
+    // 输入结束，输出剩余的帧
+    qint64 flush(QVector<float> &out);
+    // 清空历史，重新开始
+    void reset();
+
+    static const char *qualityName(Quality quality);
+
+private:
+    struct FilterBank;
+
+    // 计算（或从缓存取得）滤波器组
+    static std::shared_ptr<const FilterBank> filterBank(int inRate, int outRate, Quality quality);
+    static std::shared_ptr<const FilterBank> design(int inRate, int outRate, Quality quality);
+
+    // 用历史中已有的采样计算至多 maxFrames 帧
+    qint64 produce(QVector<float> &out, qint64 maxFrames);
+    void append(const float *data, qint64 frames);
+
+private:
+    int m_inRate;
+    int m_outRate;
+    int m_channels;
+    Quality m_quality;
+    DspKernels m_dsp;
+    std::shared_ptr<const FilterBank> m_bank;
+
+    QVector<QVector<float>> m_history;  // 每个声道一个，不交错
+    qint64 m_length;                    // 历史中的帧数
+    qint64 m_pos;                       // 下一个输出帧的第一个抽头在历史中的位置
+    qint64 m_phase;                     // 下一个输出帧的相位 [0, up)
+    qint64 m_inputFrames;               // 自开始以来输入的帧数
+    qint64 m_outputFrames;              // 自开始以来输出的帧数
+};
+
+#endif // RESAMPLER_H
@@ -0,0 +1,94 @@
+#include "SettingsStore.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+
+SettingsStore::SettingsStore(const QString &fileName, QSettings::Format format, QObject *parent)
+    : QObject{parent}
+    , m_settings(fileName, format)
+    , m_changeCount(0)
+    , m_flushCount(0)
+{
+    const QStringList keys = m_settings.allKeys();
+    m_values.reserve(keys.size());
+    for (const auto &key : keys) {
+        m_values.insert(key, m_settings.value(key));
+    }
+
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(1000);
+    m_maxTimer.setSingleShot(true);
+    m_maxTimer.setInterval(5000);
+
+    connect(&m_idleTimer, &QTimer::timeout, this, &SettingsStore::flush);
+    connect(&m_maxTimer, &QTimer::timeout, this, &SettingsStore::flush);
+
+    // 退出时事件循环已停止，定时器不会再触发
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &SettingsStore::flush);
+    }
+}
+
+SettingsStore::~SettingsStore()
+{
+    flush();
+    qDebug() << "Settings:" << m_changeCount << "changes written in" << m_flushCount << "flushes";
+}
+
+QVariant SettingsStore::value(const QString &key, const QVariant &defaultValue) const
+{
+    return m_values.value(key, defaultValue);
+}
+
+void SettingsStore::setValue(const QString &key, const QVariant &value)
+{
+    auto it = m_values.find(key);
+    if (it != m_values.end() && *it == value) {
+        return;
+    }
+
+    m_values.insert(key, value);
+    m_dirtyKeys.insert(key);
+    ++m_changeCount;
+
+    scheduleFlush();
+}
+
+void SettingsStore::setIdleDelay(int ms)
+{
+    m_idleTimer.setInterval(qMax(0, ms));
+}
+
+void SettingsStore::setMaxDelay(int ms)
+{
+    m_maxTimer.setInterval(qMax(0, ms));
+}
+
+void SettingsStore::flush()
+{
+    m_idleTimer.stop();
+    m_maxTimer.stop();
+
+    if (m_dirtyKeys.isEmpty()) {
+        return;
+    }
+
+    for (const auto &key : std::as_const(m_dirtyKeys)) {
+        m_settings.setValue(key, m_values.value(key));
+    }
+    m_dirtyKeys.clear();
+
+    m_settings.sync();
+    if (m_settings.status() != QSettings::NoError) {
+        qWarning() << "Failed to write settings:" << m_settings.fileName();
+    }
+    ++m_flushCount;
+}
+
+void SettingsStore::scheduleFlush()
+{
+    m_idleTimer.start();
+    if (!m_maxTimer.isActive()) {
+        m_maxTimer.start();
+    }
+}
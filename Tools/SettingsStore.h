@@ -0,0 +1,74 @@
+#ifndef SETTINGSSTORE_H
+#define SETTINGSSTORE_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QSettings>
+#include <QTimer>
+#include <QVariant>
+
+/**
+ * @brief The SettingsStore class
+ * 配置的内存缓存层
+ *
+ * 构造时一次性读入配置文件，读取只访问内存；修改先记在内存中并标记为脏，
+ * 空闲一段时间（没有新的修改）或距第一次未写入的修改超过上限时批量写回 QSettings 并同步到文件，
+ * 程序退出时也会写回。拖动音量条等连续修改只产生一次文件写入。
+ */
+class SettingsStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SettingsStore(const QString &fileName, QSettings::Format format = QSettings::IniFormat,
+                           QObject *parent = nullptr);
+    ~SettingsStore();
+
+    QVariant value(const QString &key, const QVariant &defaultValue = QVariant()) const;
+
+    // 不存在或无法转换为 T（例如 INI 中的 "abc" 读取为 int）时返回 defaultValue
+    template<typename T>
+    T value(const QString &key, const T &defaultValue) const
+    {
+        const auto it = m_values.constFind(key);
+        if (it == m_values.constEnd()) {
+            return defaultValue;
+        }
+        // canConvert 只比较类型，实际转换失败时 convert 返回 false
+        QVariant converted = *it;
+        if (!converted.convert(QMetaType::fromType<T>())) {
+            return defaultValue;
+        }
+        return converted.value<T>();
+    }
+
+    void setValue(const QString &key, const QVariant &value);
+
+    bool contains(const QString &key) const { return m_values.contains(key); }
+
+    // 空闲多久后写回（毫秒），以及第一次修改到写回的最长间隔
+    void setIdleDelay(int ms);
+    void setMaxDelay(int ms);
+
+    // 立即写回所有修改
+    void flush();
+
+    qint64 changeCount() const { return m_changeCount; }    // 实际改变了值的 setValue 次数
+    qint64 flushCount() const { return m_flushCount; }      // 写回文件的次数
+
+private:
+    void scheduleFlush();
+
+private:
+    QSettings m_settings;
+    QHash<QString, QVariant> m_values;
+    QSet<QString> m_dirtyKeys;
+
+    QTimer m_idleTimer;     // 每次修改重新计时
+    QTimer m_maxTimer;      // 第一次修改时开始，不再推迟
+
+    qint64 m_changeCount;
+    qint64 m_flushCount;
+};
+
+#endif // SETTINGSSTORE_H
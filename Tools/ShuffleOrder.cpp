@@ -0,0 +1,198 @@
+#include "ShuffleOrder.h"
+
+#include <algorithm>
+#include <cmath>
+
+ShuffleOrder::ShuffleOrder()
+    : m_cursor(-1)
+    , m_random(std::random_device{}())
+{
+}
+
+void ShuffleOrder::reset(int count, int first)
+{
+    m_order.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_order[i] = i;
+    }
+
+    // Fisher-Yates Shuffle
+    for (int i = count - 1; i > 0; --i) {
+        std::uniform_int_distribution<int> distrib(0, i);
+        qSwap(m_order[i], m_order[distrib(m_random)]);
+    }
+
+    m_keys.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_keys[i] = i;
+    }
+
+    m_position.resize(count);
+    rebuildPositions(0);
+
+    m_cursor = -1;
+    if (first >= 0 && first < count) {
+        // 当前音轨放在最前，从它开始播放整轮
+        const int pos = m_position[first];
+        qSwap(m_order[0], m_order[pos]);
+        m_position[m_order[0]] = 0;
+        m_position[m_order[pos]] = pos;
+        m_cursor = 0;
+    }
+}
+
+void ShuffleOrder::clear()
+{
+    m_order.clear();
+    m_position.clear();
+    m_keys.clear();
+    m_cursor = -1;
+}
+
+void ShuffleOrder::append(int firstIndex, const QVector<double> &keys)
+{
+    if (keys.isEmpty()) {
+        return;
+    }
+
+    struct Item {
+        double key;
+        int index;
+    };
+
+    QVector<Item> items;
+    items.reserve(keys.size());
+
+    for (int i = 0; i < keys.size(); ++i) {
+        double key = keys.at(i);
+
+        if (key < 0) {
+            // 在游标之后的 n - cursor 个间隙中均匀地选择一个，取相邻两个键之间的随机值
+            const int n = m_order.size();
+            std::uniform_int_distribution<int> slotDistrib(m_cursor + 1, n);
+            const int slot = slotDistrib(m_random);
+
+            const double lo = (slot > 0) ? m_keys[slot - 1] : (n > 0 ? m_keys[0] - 1.0 : 0.0);
+            const double hi = (slot < n) ? m_keys[slot] : lo + 1.0;
+            if (!(std::nextafter(lo, hi) < hi)) {
+                // 间隙已无法再细分，重新编号后重试
+                normalizeKeys();
+                --i;
+                continue;
+            }
+
+            std::uniform_real_distribution<double> keyDistrib(lo, hi);
+            key = keyDistrib(m_random);
+            if (key <= lo || key >= hi) {
+                key = lo + (hi - lo) / 2;
+            }
+        }
+
+        items.append({ key, firstIndex + i });
+    }
+
+    std::stable_sort(items.begin(), items.end(), [](const Item &a, const Item &b) {
+        return a.key < b.key;
+    });
+
+    // 归并到原有顺序中，键相同时原有的在前
+    const int n = m_order.size();
+    QVector<int> order;
+    QVector<double> orderKeys;
+    order.reserve(n + items.size());
+    orderKeys.reserve(n + items.size());
+
+    int firstChanged = -1;
+    int newCursor = m_cursor;
+    int a = 0;
+    int b = 0;
+    while (a < n || b < items.size()) {
+        if (b >= items.size() || (a < n && m_keys[a] <= items[b].key)) {
+            if (a == m_cursor) {
+                newCursor = order.size();
+            }
+            order.append(m_order[a]);
+            orderKeys.append(m_keys[a]);
+            ++a;
+        } else {
+            if (firstChanged < 0) {
+                firstChanged = order.size();
+            }
+            order.append(items[b].index);
+            orderKeys.append(items[b].key);
+            ++b;
+        }
+    }
+
+    m_order = order;
+    m_keys = orderKeys;
+    m_cursor = newCursor;
+
+    m_position.resize(qMax(int(m_position.size()), firstIndex + int(keys.size())));
+    rebuildPositions(qMax(0, firstChanged));
+}
+
+void ShuffleOrder::remap(const QVector<int> &newIndexOf)
+{
+    QVector<int> order;
+    QVector<double> keys;
+    order.reserve(m_order.size());
+    keys.reserve(m_keys.size());
+
+    int newCursor = -1;
+    for (int pos = 0; pos < m_order.size(); ++pos) {
+        const int oldIndex = m_order[pos];
+        const int newIndex = (oldIndex < newIndexOf.size()) ? newIndexOf[oldIndex] : -1;
+        if (newIndex >= 0) {
+            order.append(newIndex);
+            keys.append(m_keys[pos]);
+        }
+        if (pos == m_cursor) {
+            // 当前音轨被删除时停在它前一个位置，下一首即为原来的后继
+            newCursor = order.size() - 1;
+        }
+    }
+
+    m_order = order;
+    m_keys = keys;
+    m_cursor = newCursor;
+
+    m_position.resize(m_order.size());
+    rebuildPositions(0);
+}
+
+void ShuffleOrder::setCurrent(int index)
+{
+    m_cursor = (index >= 0 && index < m_position.size()) ? m_position[index] : -1;
+}
+
+int ShuffleOrder::nextIndex() const
+{
+    if (m_order.isEmpty()) {
+        return -1;
+    }
+    const int pos = m_cursor + 1;
+    return m_order[pos < m_order.size() ? pos : 0];
+}
+
+int ShuffleOrder::previousIndex() const
+{
+    if (m_order.isEmpty()) {
+        return -1;
+    }
+    return m_order[m_cursor > 0 ? m_cursor - 1 : m_order.size() - 1];
+}
+
+void ShuffleOrder::rebuildPositions(int from)
+{
+    for (int pos = from; pos < m_order.size(); ++pos) {
+        m_position[m_order[pos]] = pos;
+    }
+}
+
+void ShuffleOrder::normalizeKeys()
+{
+    for (int pos = 0; pos < m_keys.size(); ++pos) {
+        m_keys[pos] = pos;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef SHUFFLEORDER_H
+#define SHUFFLEORDER_H
+
+#include <QVector>
+
+#include <random>
+
+/**
+ * @brief The ShuffleOrder class
+ * 随机播放顺序
+ *
+ * 保存播放顺序（位置 -> 列表下标）与其逆排列（列表下标 -> 位置），以及当前所在位置的游标，
+ * 上一首/下一首与按下标定位都是 O(1)。
+ * 每个位置带有一个递增的排序键：新追加的音轨在游标之后的剩余部分中随机选择插入位置，已播放的部分与原有的相对顺序都不变；
+ * 也可以为音轨指定固定的排序键（如上次保存的名次），使分批追加的音轨最终回到保存时的顺序。
+ */
+class ShuffleOrder
+{
+public:
+    ShuffleOrder();
+
+    // 为 count 首音轨生成新的随机顺序，first 有效时放在最前
+    void reset(int count, int first = -1);
+    void clear();
+
+    int size() const { return m_order.size(); }
+    bool isEmpty() const { return m_order.isEmpty(); }
+
+    // 追加列表下标 [firstIndex, firstIndex + keys.size())；keys 中小于 0 的项随机插入到游标之后，其余按给定的键插入
+    void append(int firstIndex, const QVector<double> &keys);
+
+    // 列表删除音轨后重新映射下标，newIndexOf[旧下标] 为新下标或 -1（已删除）
+    void remap(const QVector<int> &newIndexOf);
+
+    // 游标移动到列表下标 index 所在的位置
+    void setCurrent(int index);
+
+    // 游标前后的列表下标（首尾循环），顺序为空时返回 -1
+    int nextIndex() const;
+    int previousIndex() const;
+
+    // 按播放顺序排列的列表下标
+    const QVector<int> &order() const { return m_order; }
+
+private:
+    void rebuildPositions(int from);
+    void normalizeKeys();
+
+private:
+    QVector<int> m_order;        // 位置 -> 列表下标
+    QVector<int> m_position;     // 列表下标 -> 位置
+    QVector<double> m_keys;      // 位置 -> 排序键（严格递增）
+    int m_cursor;                // 当前音轨的位置，-1 表示尚未开始
+
+    std::mt19937 m_random;
+};
+
+#endif // SHUFFLEORDER_H
@@ -0,0 +1,82 @@
+#include "SpectrumAnalyzer.h"
+#include "AudioEngine.h"
+#include "SpectrumWorker.h"
+
+#include <QThread>
+
+SpectrumAnalyzer::SpectrumAnalyzer(QObject *parent)
+    : QObject{parent}
+    , m_thread(new QThread(this))
+    , m_worker(new SpectrumWorker(&m_tap, &m_frames))
+    , m_active(false)
+{
+    m_worker->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+
+    // 只用于显示，不与解码、界面争抢
+    m_thread->start(QThread::LowPriority);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    setActive(false);
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void SpectrumAnalyzer::attach(AudioEngine *engine)
+{
+    const bool active = m_active;
+    setActive(false);
+    m_engine = engine;
+    setActive(active);
+}
+
+void SpectrumAnalyzer::setActive(bool active)
+{
+    if (active == m_active || (active && !m_engine)) {
+        return;
+    }
+    m_active = active;
+
+    SpectrumWorker *worker = m_worker;
+    if (active) {
+        // 抽头此时没有读写两端，可以重置；容量约 0.5 秒，分析线程偶尔被推迟时也不丢数据
+        const QAudioFormat format = m_engine->format();
+        m_tap.reset(qsizetype(format.sampleRate()) * format.channelCount() / 2);
+
+        const int sampleRate = format.sampleRate();
+        const int channels = format.channelCount();
+        QMetaObject::invokeMethod(worker, [worker, sampleRate, channels]() {
+            worker->start(sampleRate, channels);
+        }, Qt::QueuedConnection);
+        m_engine->setAnalysisTap(&m_tap);
+    } else {
+        // 先断开写端，再等待读端停止，之后抽头可以安全地重置或释放
+        if (m_engine) {
+            m_engine->setAnalysisTap(nullptr);
+        }
+        QMetaObject::invokeMethod(worker, [worker]() {
+            worker->stop();
+        }, Qt::BlockingQueuedConnection);
+    }
+}
+
+double SpectrumAnalyzer::cpuLoad() const
+{
+    return m_worker->load();
+}
+
+double SpectrumAnalyzer::analysisMicroseconds() const
+{
+    return m_worker->analysisMicroseconds();
+}
+
+bool SpectrumAnalyzer::latest(SpectrumFrame &frame)
+{
+    if (!m_frames.update()) {
+        return false;
+    }
+    frame = m_frames.front();
+    return true;
+}
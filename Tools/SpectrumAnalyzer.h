@@ -0,0 +1,67 @@
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include <QObject>
+#include <QPointer>
+
+#include "SpscRingBuffer.h"
+#include "TripleBuffer.h"
+
+class QThread;
+class AudioEngine;
+class SpectrumWorker;
+
+// 一帧频谱与电平，数值都是 dBFS（满幅正弦为 0），低于 FloorDb 的记为 FloorDb
+struct SpectrumFrame
+{
+    static constexpr int BandCount = 48;
+    static constexpr int MaxChannels = 2;
+    static constexpr float FloorDb = -120.0f;
+
+    float bands[BandCount];         // 从低频到高频按对数等分的各频带
+    float peak[MaxChannels];        // 自上一帧以来各声道的峰值（单声道时两者相同）
+    float rms[MaxChannels];
+    quint64 serial;                 // 分析线程发布的序号，没有声音时为 0
+};
+
+/**
+ * @brief The SpectrumAnalyzer class
+ * 播放输出的实时频谱与电平
+ *
+ * 启用时在 AudioEngine 的输出上接一个分析抽头（无锁环形缓冲区），输出回调把送往设备的采样写入其中，写不下时直接丢弃。
+ * 独立的低优先级分析线程（SpectrumWorker）按显示帧率读取抽头，加窗后做 FFT，把结果通过无锁三缓冲交给界面线程，
+ * 界面线程用 latest() 取最新的一帧。输出回调、分析线程与界面线程之间都不会互相等待。
+ * 停用时断开抽头；分析线程的 CPU 开销由 cpuLoad() 与 analysisMicroseconds() 给出，抽头丢弃的帧数见 AudioEngine::tapDroppedFrames()。
+ */
+class SpectrumAnalyzer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SpectrumAnalyzer(QObject *parent = nullptr);
+    ~SpectrumAnalyzer();
+
+    // 分析 engine 的输出（格式取 engine->format()）
+    void attach(AudioEngine *engine);
+
+    // 界面不可见时停用，不再占用输出回调与分析线程
+    void setActive(bool active);
+    bool isActive() const { return m_active; }
+
+    // 界面线程调用：有新的一帧时复制到 frame 并返回 true
+    bool latest(SpectrumFrame &frame);
+
+    // 本次（停用后为最近一次）启用期间分析线程占用单个核心的比例（0 ~ 1），以及每次分析的平均耗时（微秒）
+    double cpuLoad() const;
+    double analysisMicroseconds() const;
+
+private:
+    QPointer<AudioEngine> m_engine;
+    QThread *m_thread;
+    SpectrumWorker *m_worker;           // 属于分析线程
+
+    SpscRingBuffer<float> m_tap;
+    TripleBuffer<SpectrumFrame> m_frames;
+    bool m_active;
+};
+
+#endif // SPECTRUMANALYZER_H
@@ -0,0 +1,222 @@
+#include "SpectrumWorker.h"
+#include "DspKernels.h"
+
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+
+// 频带覆盖的范围（高端不超过奈奎斯特频率的 0.9 倍）
+constexpr double LowestBandHz = 30.0;
+constexpr double HighestBandHz = 16000.0;
+
+float toDb(double value)
+{
+    return value > 1e-6 ? float(20.0 * std::log10(value)) : SpectrumFrame::FloorDb;
+}
+
+} // namespace
+
+SpectrumWorker::SpectrumWorker(SpscRingBuffer<float> *tap, TripleBuffer<SpectrumFrame> *frames, QObject *parent)
+    : QObject{parent}
+    , m_tap(tap)
+    , m_frames(frames)
+    , m_timer(new QTimer(this))
+    , m_fft(FftSize)
+    , m_dsp(&DspKernels::instance())
+    , m_sampleRate(0)
+    , m_channels(0)
+    , m_window(FftSize)
+    , m_amplitudeScale(1.0f)
+    , m_bandEdges(SpectrumFrame::BandCount + 1)
+    , m_history(FftSize, 0.0f)
+    , m_historyPos(0)
+    , m_re(FftSize)
+    , m_im(FftSize)
+    , m_magnitude(FftSize / 2 + 1)
+    , m_peak{}
+    , m_sumSquares{}
+    , m_levelFrames(0)
+    , m_silent(false)
+    , m_serial(0)
+    , m_busyNs(0)
+    , m_analyses(0)
+    , m_load(0.0f)
+    , m_analysisUs(0.0f)
+{
+    double windowSum = 0.0;
+    for (int i = 0; i < FftSize; ++i) {
+        const double w = 0.5 - 0.5 * std::cos(2.0 * Pi * i / FftSize);
+        m_window[i] = float(w);
+        windowSum += w;
+    }
+    // 频点中心上幅度为 A 的正弦，变换后的模为 A * sum(w) / 2
+    m_amplitudeScale = float(2.0 / windowSum);
+
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(FrameInterval);
+    connect(m_timer, &QTimer::timeout, this, &SpectrumWorker::process);
+}
+
+void SpectrumWorker::start(int sampleRate, int channels)
+{
+    m_sampleRate = qMax(1, sampleRate);
+    m_channels = qMax(1, channels);
+    m_chunk.resize(FftSize * m_channels);
+
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+    m_historyPos = 0;
+    std::fill(std::begin(m_peak), std::end(m_peak), 0.0f);
+    std::fill(std::begin(m_sumSquares), std::end(m_sumSquares), 0.0);
+    m_levelFrames = 0;
+    m_silent = false;
+
+    // 对数等分的频带边界，换算为频点
+    const double highest = qMin(HighestBandHz, m_sampleRate * 0.45);
+    const double ratio = highest / LowestBandHz;
+    for (int b = 0; b <= SpectrumFrame::BandCount; ++b) {
+        const double hz = LowestBandHz * std::pow(ratio, double(b) / SpectrumFrame::BandCount);
+        m_bandEdges[b] = float(hz * FftSize / m_sampleRate);
+    }
+
+    m_busyNs = 0;
+    m_analyses = 0;
+    m_load.store(0.0f, std::memory_order_relaxed);
+    m_analysisUs.store(0.0f, std::memory_order_relaxed);
+    m_activeTimer.start();
+    m_timer->start();
+}
+
+void SpectrumWorker::stop()
+{
+    if (!m_timer->isActive()) {
+        return;
+    }
+    m_timer->stop();
+}
+
+void SpectrumWorker::process()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // 抽头中总是整帧，按整帧读出
+    const qint64 chunkFrames = m_chunk.size() / m_channels;
+    qint64 total = 0;
+    for (;;) {
+        const qint64 frames = m_tap->read(m_chunk.data(), chunkFrames * m_channels) / m_channels;
+        if (frames <= 0) {
+            break;
+        }
+        consume(m_chunk.constData(), frames);
+        total += frames;
+    }
+
+    if (total > 0) {
+        m_silent = false;
+        SpectrumFrame &frame = m_frames->back();
+        analyze(frame);
+        frame.serial = ++m_serial;
+        m_frames->publish();
+        ++m_analyses;
+    } else if (!m_silent) {
+        // 暂停或停止后发布一帧无声，界面据此让频谱回落
+        m_silent = true;
+        publishSilence();
+    }
+
+    m_busyNs += timer.nsecsElapsed();
+    const qint64 activeNs = qMax<qint64>(1, m_activeTimer.nsecsElapsed());
+    m_load.store(float(double(m_busyNs) / activeNs), std::memory_order_relaxed);
+    if (m_analyses > 0) {
+        m_analysisUs.store(float(m_busyNs / 1000.0 / m_analyses), std::memory_order_relaxed);
+    }
+}
+
+void SpectrumWorker::consume(const float *data, qint64 frames)
+{
+    const int channels = m_channels;
+    const int metered = qMin(channels, int(SpectrumFrame::MaxChannels));
+    const float mix = 1.0f / channels;
+
+    for (qint64 i = 0; i < frames; ++i) {
+        const float *frame = data + i * channels;
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            sum += frame[c];
+        }
+        m_history[m_historyPos] = sum * mix;
+        m_historyPos = (m_historyPos + 1) & (FftSize - 1);
+
+        for (int c = 0; c < metered; ++c) {
+            const float v = std::fabs(frame[c]);
+            m_peak[c] = qMax(m_peak[c], v);
+            m_sumSquares[c] += double(v) * v;
+        }
+    }
+    m_levelFrames += frames;
+}
+
+void SpectrumWorker::analyze(SpectrumFrame &frame)
+{
+    // 按时间顺序展开历史，加窗
+    float *re = m_re.data();
+    float *im = m_im.data();
+    const int tail = FftSize - m_historyPos;
+    std::memcpy(re, m_history.constData() + m_historyPos, size_t(tail) * sizeof(float));
+    std::memcpy(re + tail, m_history.constData(), size_t(m_historyPos) * sizeof(float));
+    m_dsp->multiply(re, re, m_window.constData(), FftSize);
+    std::fill(m_im.begin(), m_im.end(), 0.0f);
+
+    m_fft.transform(re, im);
+    m_dsp->magnitude(re, im, m_magnitude.data(), m_magnitude.size());
+
+    const float *magnitude = m_magnitude.constData();
+    for (int b = 0; b < SpectrumFrame::BandCount; ++b) {
+        const float lo = m_bandEdges[b];
+        const float hi = m_bandEdges[b + 1];
+        const int first = int(std::ceil(lo));
+        const int last = int(std::floor(hi));
+
+        float value = 0.0f;
+        if (first <= last) {
+            value = *std::max_element(magnitude + first, magnitude + last + 1);
+        } else {
+            // 低频的频带比频点间隔还窄，在中心频率处插值
+            const float center = (lo + hi) * 0.5f;
+            const int i = int(center);
+            const float frac = center - i;
+            value = magnitude[i] * (1.0f - frac) + magnitude[i + 1] * frac;
+        }
+        frame.bands[b] = toDb(value * m_amplitudeScale);
+    }
+
+    // 单声道时两个电平相同
+    const int metered = qMin(m_channels, int(SpectrumFrame::MaxChannels));
+    for (int c = 0; c < SpectrumFrame::MaxChannels; ++c) {
+        const int source = qMin(c, metered - 1);
+        frame.peak[c] = toDb(m_peak[source]);
+        frame.rms[c] = toDb(m_levelFrames > 0 ? std::sqrt(m_sumSquares[source] / m_levelFrames) : 0.0);
+    }
+    std::fill(std::begin(m_peak), std::end(m_peak), 0.0f);
+    std::fill(std::begin(m_sumSquares), std::end(m_sumSquares), 0.0);
+    m_levelFrames = 0;
+}
+
+void SpectrumWorker::publishSilence()
+{
+    SpectrumFrame &frame = m_frames->back();
+    std::fill(std::begin(frame.bands), std::end(frame.bands), SpectrumFrame::FloorDb);
+    std::fill(std::begin(frame.peak), std::end(frame.peak), SpectrumFrame::FloorDb);
+    std::fill(std::begin(frame.rms), std::end(frame.rms), SpectrumFrame::FloorDb);
+    frame.serial = 0;
+    m_frames->publish();
+
+    // 之后重新开始时不混入暂停前的采样
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+}
@@ -0,0 +1,85 @@
+#ifndef SPECTRUMWORKER_H
+#define SPECTRUMWORKER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVector>
+
+#include <atomic>
+
+#include "Fft.h"
+#include "SpectrumAnalyzer.h"
+
+class QTimer;
+struct DspKernels;
+
+/**
+ * @brief The SpectrumWorker class
+ * 分析线程中的工作对象（由 SpectrumAnalyzer 创建并移入分析线程）
+ *
+ * 定时读出抽头中的全部采样，混合为单声道后放入最近 FftSize 帧的历史中，并累计各声道的峰值与均方；
+ * 每次有新采样时对历史加 Hann 窗做一次 FFT，按对数频带取幅度的最大值，写入三缓冲后发布。
+ * 抽头是环形缓冲区的唯一读端，三缓冲的唯一写端。
+ */
+class SpectrumWorker : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr int FftSize = 2048;
+    static constexpr int FrameInterval = 16;    // 毫秒，约 60 帧/秒
+
+    SpectrumWorker(SpscRingBuffer<float> *tap, TripleBuffer<SpectrumFrame> *frames, QObject *parent = nullptr);
+
+    // 以下函数只在分析线程中调用
+
+    // 开始分析，调用前抽头应已清空
+    void start(int sampleRate, int channels);
+    // 停止分析
+    void stop();
+
+    // 任意线程调用：本次（停用后为最近一次）启用期间分析线程占用单个核心的比例，以及每次分析的平均耗时（微秒）
+    double load() const { return m_load.load(std::memory_order_relaxed); }
+    double analysisMicroseconds() const { return m_analysisUs.load(std::memory_order_relaxed); }
+
+private:
+    void process();
+    void consume(const float *data, qint64 frames);
+    void analyze(SpectrumFrame &frame);
+    void publishSilence();
+
+private:
+    SpscRingBuffer<float> *m_tap;
+    TripleBuffer<SpectrumFrame> *m_frames;
+    QTimer *m_timer;
+    Fft m_fft;
+    const DspKernels *m_dsp;
+
+    int m_sampleRate;
+    int m_channels;
+
+    QVector<float> m_window;
+    float m_amplitudeScale;             // 把窗函数的增益折算回正弦的幅度
+    QVector<float> m_bandEdges;         // 各频带边界对应的（小数）频点
+    QVector<float> m_history;           // 最近 FftSize 帧的单声道采样（环形）
+    int m_historyPos;
+    QVector<float> m_chunk;
+    QVector<float> m_re;
+    QVector<float> m_im;
+    QVector<float> m_magnitude;
+
+    float m_peak[SpectrumFrame::MaxChannels];
+    double m_sumSquares[SpectrumFrame::MaxChannels];
+    qint64 m_levelFrames;
+
+    bool m_silent;                      // 已发布过无声的一帧
+    quint64 m_serial;
+
+    // 开销统计
+    QElapsedTimer m_activeTimer;
+    qint64 m_busyNs;
+    qint64 m_analyses;
+    std::atomic<float> m_load;
+    std::atomic<float> m_analysisUs;
+};
+
+#endif // SPECTRUMWORKER_H
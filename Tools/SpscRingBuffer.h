@@ -0,0 +1,119 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+/**
+ * @brief The SpscRingBuffer class
+ * 单生产者单消费者的无锁环形缓冲区
+ *
+ * 读写位置各自只由一端修改，另一端以 acquire 读取，写入的数据在写位置发布之后才对读端可见，
+ * 因此读写两端不需要加锁，读端（输出设备回调）不会因为写端（解码线程）而阻塞。
+ * 容量向上取 2 的幂，位置单调递增，取下标时按掩码回绕。
+ * reset 与 clear 会同时修改读写位置，只能在两端都不访问时调用。
+ */
+template <typename T>
+class SpscRingBuffer
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SpscRingBuffer requires a trivially copyable type");
+
+public:
+    explicit SpscRingBuffer(qsizetype capacity = 0)
+    {
+        reset(capacity);
+    }
+
+    SpscRingBuffer(const SpscRingBuffer &) = delete;
+    SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+    // 重新分配容量并清空
+    void reset(qsizetype capacity)
+    {
+        size_t size = 1;
+        while (size < size_t(qMax<qsizetype>(1, capacity))) {
+            size <<= 1;
+        }
+        if (size != m_capacity) {
+            m_buffer.reset(new T[size]);
+            m_capacity = size;
+        }
+        clear();
+    }
+
+    void clear()
+    {
+        m_read.store(0, std::memory_order_relaxed);
+        m_write.store(0, std::memory_order_release);
+    }
+
+    qsizetype capacity() const { return qsizetype(m_capacity); }
+
+    // 读端调用：可读取的元素数
+    qsizetype readAvailable() const
+    {
+        return qsizetype(m_write.load(std::memory_order_acquire) - m_read.load(std::memory_order_relaxed));
+    }
+
+    // 写端调用：可写入的元素数
+    qsizetype writeAvailable() const
+    {
+        return qsizetype(m_capacity - (m_write.load(std::memory_order_relaxed) - m_read.load(std::memory_order_acquire)));
+    }
+
+    // 写端调用：写入至多 count 个元素，返回实际写入的个数
+    qsizetype write(const T *data, qsizetype count)
+    {
+        const size_t write = m_write.load(std::memory_order_relaxed);
+        const size_t read = m_read.load(std::memory_order_acquire);
+        const size_t n = std::min(size_t(qMax<qsizetype>(0, count)), m_capacity - (write - read));
+
+        copyIn(write, data, n);
+        m_write.store(write + n, std::memory_order_release);
+        return qsizetype(n);
+    }
+
+    // 读端调用：读取至多 count 个元素，返回实际读取的个数
+    qsizetype read(T *data, qsizetype count)
+    {
+        const size_t read = m_read.load(std::memory_order_relaxed);
+        const size_t write = m_write.load(std::memory_order_acquire);
+        const size_t n = std::min(size_t(qMax<qsizetype>(0, count)), write - read);
+
+        copyOut(read, data, n);
+        m_read.store(read + n, std::memory_order_release);
+        return qsizetype(n);
+    }
+
+private:
+    void copyIn(size_t pos, const T *data, size_t n)
+    {
+        const size_t offset = pos & (m_capacity - 1);
+        const size_t first = std::min(n, m_capacity - offset);
+        std::memcpy(m_buffer.get() + offset, data, first * sizeof(T));
+        std::memcpy(m_buffer.get(), data + first, (n - first) * sizeof(T));
+    }
+
+    void copyOut(size_t pos, T *data, size_t n) const
+    {
+        const size_t offset = pos & (m_capacity - 1);
+        const size_t first = std::min(n, m_capacity - offset);
+        std::memcpy(data, m_buffer.get() + offset, first * sizeof(T));
+        std::memcpy(data + first, m_buffer.get(), (n - first) * sizeof(T));
+    }
+
+private:
+    std::unique_ptr<T[]> m_buffer;
+    size_t m_capacity = 0;
+
+    // 读写位置放在不同的缓存行，避免两端互相干扰
+    alignas(64) std::atomic<size_t> m_write{0};
+    alignas(64) std::atomic<size_t> m_read{0};
+};
+
+#endif // SPSCRINGBUFFER_H
@@ -0,0 +1,58 @@
+#include "StartupProfiler.h"
+
+#include <QDebug>
+#include <QStringList>
+
+StartupProfiler &StartupProfiler::instance()
+{
+    static StartupProfiler profiler;
+    return profiler;
+}
+
+StartupProfiler::StartupProfiler()
+    : m_lastMark(0)
+    , m_finished(false)
+{
+}
+
+void StartupProfiler::start()
+{
+    m_timer.start();
+    m_lastMark = 0;
+    m_phases.clear();
+    m_finished = false;
+}
+
+void StartupProfiler::mark(const QString &phase)
+{
+    if (m_finished || !m_timer.isValid()) {
+        return;
+    }
+    for (const auto &recorded : std::as_const(m_phases)) {
+        if (recorded.first == phase) {
+            return;
+        }
+    }
+
+    const qint64 now = m_timer.elapsed();
+    qDebug().nospace() << "Startup: " << phase << " +" << now - m_lastMark << " ms (" << now << " ms)";
+
+    m_phases.append(qMakePair(phase, now));
+    m_lastMark = now;
+}
+
+void StartupProfiler::finish()
+{
+    if (m_finished || !m_timer.isValid()) {
+        return;
+    }
+    m_finished = true;
+
+    QStringList parts;
+    qint64 previous = 0;
+    for (const auto &phase : std::as_const(m_phases)) {
+        parts.append(QString("%1 %2 ms").arg(phase.first).arg(phase.second - previous));
+        previous = phase.second;
+    }
+    qDebug().noquote() << "Startup finished in" << m_timer.elapsed() << "ms:" << parts.join(", ");
+}
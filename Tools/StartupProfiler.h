@@ -0,0 +1,37 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QElapsedTimer>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The StartupProfiler class
+ * 启动阶段计时
+ *
+ * 从 main 开始计时，各阶段完成时调用 mark 记录距上一阶段与距启动的耗时，finish 时输出汇总。
+ * 每个阶段只记录第一次（如第一帧、第一次载入专辑），finish 之后的调用全部忽略。
+ */
+class StartupProfiler
+{
+public:
+    static StartupProfiler &instance();
+
+    void start();
+    void mark(const QString &phase);
+    void finish();
+
+    bool isFinished() const { return m_finished; }
+
+private:
+    StartupProfiler();
+
+private:
+    QElapsedTimer m_timer;
+    qint64 m_lastMark;
+    QVector<QPair<QString, qint64>> m_phases;   // 阶段名 -> 距启动的毫秒数
+    bool m_finished;
+};
+
+#endif // STARTUPPROFILER_H
@@ -0,0 +1,52 @@
+#include "StringPool.h"
+
+StringPool &StringPool::instance()
+{
+    static StringPool pool;
+    return pool;
+}
+
+StringPool::StringPool()
+{
+    m_strings.append(QString());
+    m_ids.insert(QString(), 0);
+}
+
+quint32 StringPool::intern(const QString &str)
+{
+    if (str.isEmpty()) {
+        return 0;
+    }
+
+    {
+        QReadLocker locker(&m_lock);
+        auto it = m_ids.constFind(str);
+        if (it != m_ids.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QWriteLocker locker(&m_lock);
+    // 获取写锁期间可能已被其他线程插入
+    auto it = m_ids.constFind(str);
+    if (it != m_ids.constEnd()) {
+        return it.value();
+    }
+
+    const quint32 id = quint32(m_strings.size());
+    m_strings.append(str);
+    m_ids.insert(str, id);
+    return id;
+}
+
+QString StringPool::string(quint32 id) const
+{
+    QReadLocker locker(&m_lock);
+    return id < quint32(m_strings.size()) ? m_strings.at(id) : QString();
+}
+
+int StringPool::size() const
+{
+    QReadLocker locker(&m_lock);
+    return m_strings.size();
+}
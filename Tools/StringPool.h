@@ -0,0 +1,57 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The StringPool class
+ * 全局字符串驻留表
+ *
+ * 艺术家、专辑、流派等在整个曲库中大量重复的字符串只保存一份，以递增的整数 ID 表示，ID 0 固定为空串。
+ * ID 与字符串的双向查找都是 O(1)，驻留后的比较只需要比较整数。字符串一经驻留不会释放。
+ * 可在元数据提取的工作线程中并发使用。
+ */
+class StringPool
+{
+public:
+    static StringPool &instance();
+
+    quint32 intern(const QString &str);
+    QString string(quint32 id) const;
+
+    int size() const;
+
+private:
+    StringPool();
+
+    mutable QReadWriteLock m_lock;
+    QVector<QString> m_strings;          // ID -> 字符串
+    QHash<QString, quint32> m_ids;       // 字符串 -> ID
+};
+
+/**
+ * @brief The PooledString class
+ * 驻留在 StringPool 中的字符串，只占用 4 字节
+ */
+class PooledString
+{
+public:
+    PooledString() = default;
+    PooledString(const QString &str) : m_id(StringPool::instance().intern(str)) {}
+
+    quint32 id() const { return m_id; }
+    bool isEmpty() const { return m_id == 0; }
+    QString toString() const { return StringPool::instance().string(m_id); }
+
+    friend bool operator==(PooledString a, PooledString b) { return a.m_id == b.m_id; }
+    friend bool operator!=(PooledString a, PooledString b) { return a.m_id != b.m_id; }
+    friend size_t qHash(PooledString s, size_t seed = 0) { return qHash(s.m_id, seed); }
+
+private:
+    quint32 m_id = 0;
+};
+
+#endif // STRINGPOOL_H
@@ -0,0 +1,330 @@
+#include "TrackDecoder.h"
+#include "DspKernels.h"
+#include "NativeTagReader.h"
+
+#include <QAudioBuffer>
+#include <QAudioDecoder>
+#include <QDebug>
+
+#include <cmath>
+#include <cstring>
+
+TrackDecoder::TrackDecoder(QObject *parent)
+    : QObject{parent}
+    , m_decoder(new QAudioDecoder(this))
+    , m_channels(2)
+    , m_gain(1.0f)
+    , m_resampleQuality(Resampler::High)
+    , m_delayFrames(0)
+    , m_delayRemaining(0)
+    , m_startFrame(0)
+    , m_frameLimit(-1)
+    , m_decodedFrames(0)
+    , m_durationFrames(-1)
+    , m_firstBuffer(true)
+    , m_chunkOffset(0)
+    , m_bufferedFrames(0)
+    , m_highWater(0)
+    , m_finished(false)
+    , m_error(false)
+{
+    connect(m_decoder, &QAudioDecoder::bufferReady, this, &TrackDecoder::onBufferReady);
+    connect(m_decoder, &QAudioDecoder::finished, this, &TrackDecoder::onFinished);
+    connect(m_decoder, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), this, &TrackDecoder::onError);
+    connect(m_decoder, &QAudioDecoder::durationChanged, this, [this](qint64 ms) {
+        // 没有无缝播放信息时使用解码器估计的时长
+        if (m_frameLimit < 0 && !m_finished && ms > 0) {
+            m_durationFrames = ms * m_format.sampleRate() / 1000;
+            emit durationChanged(m_durationFrames);
+        }
+    });
+}
+
+TrackDecoder::~TrackDecoder()
+{
+    m_decoder->stop();
+}
+
+void TrackDecoder::start(const QUrl &url, const QAudioFormat &format, qint64 startFrame)
+{
+    stop();
+
+    m_source = url;
+    m_format = format;
+    m_channels = qMax(1, format.channelCount());
+
+    m_gapless = GaplessInfo();
+    if (url.isLocalFile()) {
+        NativeTagReader::readGapless(url.toLocalFile(), m_gapless);
+    }
+
+    // 无缝播放信息以文件采样率计，换算到输出采样率
+    const double scale = m_gapless.sampleRate > 0 ? double(format.sampleRate()) / m_gapless.sampleRate : 1.0;
+    m_delayFrames = std::llround(m_gapless.encoderDelay * scale);
+    m_delayRemaining = m_delayFrames;
+    m_startFrame = qMax<qint64>(0, startFrame);
+    m_frameLimit = m_gapless.validFrames >= 0 ? std::llround(m_gapless.validFrames * scale) : -1;
+    m_decodedFrames = 0;
+    m_durationFrames = m_frameLimit;
+    m_firstBuffer = true;
+    m_resampler.reset();
+    m_finished = false;
+    m_error = false;
+
+    if (m_durationFrames >= 0) {
+        emit durationChanged(m_durationFrames);
+    }
+
+    // 不指定解码格式，后端按文件的原始格式输出：声道与采样格式由 convert 转换，采样率由 resample 转换
+    m_decoder->setAudioFormat(QAudioFormat());
+    m_decoder->setSource(url);
+    m_decoder->start();
+}
+
+void TrackDecoder::stop()
+{
+    m_decoder->stop();
+    m_chunks.clear();
+    m_chunkOffset = 0;
+    m_bufferedFrames = 0;
+}
+
+qint64 TrackDecoder::read(float *data, qint64 frames)
+{
+    qint64 done = 0;
+    while (done < frames && !m_chunks.isEmpty()) {
+        const QVector<float> &chunk = m_chunks.head();
+        const qint64 chunkFrames = chunk.size() / m_channels;
+        const qint64 n = qMin(frames - done, chunkFrames - m_chunkOffset);
+
+        std::memcpy(data + done * m_channels, chunk.constData() + m_chunkOffset * m_channels,
+                    size_t(n * m_channels) * sizeof(float));
+        done += n;
+        m_chunkOffset += n;
+
+        if (m_chunkOffset == chunkFrames) {
+            m_chunks.dequeue();
+            m_chunkOffset = 0;
+        }
+    }
+
+    m_bufferedFrames -= done;
+
+    // 降到低水位以下，取走暂停时留在解码器中的缓冲区，解码随之继续
+    if (done > 0 && m_bufferedFrames < m_highWater / 2) {
+        pull();
+    }
+    return done;
+}
+
+qint64 TrackDecoder::remainingFrames() const
+{
+    if (m_durationFrames < 0) {
+        return -1;
+    }
+    return qMax<qint64>(0, m_durationFrames - m_decodedFrames) + m_bufferedFrames;
+}
+
+void TrackDecoder::onBufferReady()
+{
+    pull();
+}
+
+void TrackDecoder::pull()
+{
+    // 达到高水位时不取走缓冲区，解码器在它被读取之前不会继续解码
+    while (m_decoder->bufferAvailable() && (m_highWater <= 0 || m_bufferedFrames < m_highWater)) {
+        decodeBuffer(m_decoder->read());
+    }
+}
+
+void TrackDecoder::decodeBuffer(const QAudioBuffer &buffer)
+{
+    if (!buffer.isValid()) {
+        return;
+    }
+
+    if (m_firstBuffer) {
+        m_firstBuffer = false;
+
+        // 后端已经按容器中的信息裁掉了开头的延迟（首个缓冲区不从 0 开始），不再重复裁剪
+        const qint64 startFrames = buffer.startTime() * m_format.sampleRate() / 1000000;
+        if (m_delayFrames > 0 && startFrames >= m_delayFrames / 2) {
+            m_delayRemaining = 0;
+        }
+    }
+
+    const int rate = buffer.format().sampleRate();
+
+    // 跳转时起始位置之前的整个缓冲区直接计数丢弃，不转换采样（需要转换采样率时仍要经过转换器，保持其状态连续）
+    if (!m_resampler && (rate <= 0 || rate == m_format.sampleRate())) {
+        const qint64 frames = buffer.frameCount();
+        const qint64 delay = qMin(frames, m_delayRemaining);
+        if (frames > 0 && m_decodedFrames + frames - delay <= m_startFrame) {
+            qint64 first = 0;
+            qint64 last = 0;
+            advance(frames, first, last);
+            return;
+        }
+    }
+
+    QVector<float> samples;
+    qint64 frames = convert(buffer, samples);
+    if (frames > 0 && rate > 0 && rate != m_format.sampleRate()) {
+        frames = resample(rate, samples);
+    }
+    if (frames > 0) {
+        push(std::move(samples), frames);
+    }
+}
+
+void TrackDecoder::onFinished()
+{
+    // 输出采样率转换器中剩余的帧
+    if (m_resampler) {
+        QVector<float> samples;
+        const qint64 frames = m_resampler->flush(samples);
+        if (frames > 0) {
+            push(std::move(samples), frames);
+        }
+        m_resampler.reset();
+    }
+
+    m_finished = true;
+    m_durationFrames = m_decodedFrames;
+    emit durationChanged(m_durationFrames);
+    emit decodingFinished();
+}
+
+void TrackDecoder::onError()
+{
+    qWarning() << "Failed to decode" << m_source.toString() << ":" << m_decoder->errorString();
+
+    m_error = true;
+    m_finished = true;
+    emit errorOccurred(m_decoder->errorString());
+    emit decodingFinished();
+}
+
+qint64 TrackDecoder::convert(const QAudioBuffer &buffer, QVector<float> &out) const
+{
+    const QAudioFormat format = buffer.format();
+    const int inChannels = format.channelCount();
+    const qint64 frames = buffer.frameCount();
+    if (inChannels <= 0 || frames <= 0) {
+        return 0;
+    }
+
+    out.resize(frames * m_channels);
+    float *dst = out.data();
+
+    // 声道少于输出时复制最后一个声道（单声道复制到双声道），多于输出时只取前面的声道
+    auto convertWith = [&](auto sampleAt) {
+        for (qint64 f = 0; f < frames; ++f) {
+            for (int c = 0; c < m_channels; ++c) {
+                dst[f * m_channels + c] = sampleAt(f * inChannels + qMin(c, inChannels - 1));
+            }
+        }
+    };
+
+    // 声道数相同时整块转换
+    if (inChannels == m_channels) {
+        const DspKernels &dsp = DspKernels::instance();
+        const qint64 samples = frames * m_channels;
+        switch (format.sampleFormat()) {
+        case QAudioFormat::Float:
+            std::memcpy(dst, buffer.constData<float>(), size_t(samples) * sizeof(float));
+            return frames;
+        case QAudioFormat::Int16:
+            dsp.int16ToFloat(buffer.constData<qint16>(), dst, samples);
+            return frames;
+        case QAudioFormat::Int32:
+            dsp.int32ToFloat(buffer.constData<qint32>(), dst, samples);
+            return frames;
+        default:
+            break;
+        }
+    }
+
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Float: {
+        const float *src = buffer.constData<float>();
+        convertWith([src](qint64 i) { return src[i]; });
+        break;
+    }
+    case QAudioFormat::Int16: {
+        const qint16 *src = buffer.constData<qint16>();
+        convertWith([src](qint64 i) { return src[i] * (1.0f / 32768.0f); });
+        break;
+    }
+    case QAudioFormat::Int32: {
+        const qint32 *src = buffer.constData<qint32>();
+        convertWith([src](qint64 i) { return float(src[i] * (1.0 / 2147483648.0)); });
+        break;
+    }
+    case QAudioFormat::UInt8: {
+        const quint8 *src = buffer.constData<quint8>();
+        convertWith([src](qint64 i) { return (int(src[i]) - 128) * (1.0f / 128.0f); });
+        break;
+    }
+    default:
+        return 0;
+    }
+
+    return frames;
+}
+
+qint64 TrackDecoder::resample(int inRate, QVector<float> &samples)
+{
+    // 采样率在中途改变时（极少见）从新的转换器开始
+    if (!m_resampler || m_resampler->inputRate() != inRate) {
+        m_resampler = std::make_unique<Resampler>(inRate, m_format.sampleRate(), m_channels, m_resampleQuality);
+    }
+
+    QVector<float> out;
+    const qint64 frames = m_resampler->process(samples.constData(), samples.size() / m_channels, out);
+    samples = std::move(out);
+    return frames;
+}
+
+void TrackDecoder::advance(qint64 frames, qint64 &first, qint64 &last)
+{
+    // 丢弃编码器延迟
+    qint64 begin = 0;
+    if (m_delayRemaining > 0) {
+        begin = qMin(frames, m_delayRemaining);
+        m_delayRemaining -= begin;
+    }
+
+    // 超出原始长度的部分即末尾填充
+    qint64 count = frames - begin;
+    if (m_frameLimit >= 0) {
+        count = qMin(count, qMax<qint64>(0, m_frameLimit - m_decodedFrames));
+    }
+
+    // 起始位置之前的帧
+    const qint64 skip = qBound<qint64>(0, m_startFrame - m_decodedFrames, count);
+    m_decodedFrames += count;
+
+    first = begin + skip;
+    last = begin + count;
+}
+
+void TrackDecoder::push(QVector<float> &&samples, qint64 frames)
+{
+    qint64 first = 0;
+    qint64 last = 0;
+    advance(frames, first, last);
+    if (first >= last) {
+        return;
+    }
+
+    if (first > 0 || last < frames) {
+        samples = samples.mid(first * m_channels, (last - first) * m_channels);
+    }
+    if (m_gain != 1.0f) {
+        DspKernels::instance().applyGain(samples.data(), (last - first) * m_channels, m_gain);
+    }
+    m_chunks.enqueue(std::move(samples));
+    m_bufferedFrames += last - first;
+}
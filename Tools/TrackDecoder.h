@@ -0,0 +1,112 @@
+#ifndef TRACKDECODER_H
+#define TRACKDECODER_H
+
+#include <QAudioFormat>
+#include <QObject>
+#include <QQueue>
+#include <QUrl>
+#include <QVector>
+
+#include <memory>
+
+#include "GaplessInfo.h"
+#include "Resampler.h"
+
+class QAudioBuffer;
+class QAudioDecoder;
+
+/**
+ * @brief The TrackDecoder class
+ * 单个音轨的解码器
+ *
+ * 用 QAudioDecoder 将音轨解码为指定声道数的交错 float 采样，按编码器延迟与填充裁掉首尾多余的帧。
+ * 解码器按文件的原始采样率输出，与输出采样率不同时由 Resampler 转换，相同时不做任何处理。
+ * 解码器后端已经裁掉开头延迟时（首个缓冲区的时间戳不为 0）不再重复裁剪；
+ * 原始帧数已知时输出总帧数不超过它，因此后端是否裁掉末尾填充都能得到相同的长度。
+ * 从指定位置开始时丢弃之前的帧（QAudioDecoder 不支持跳转，解码远快于实时播放），因此跳转的耗时随目标位置线性增长；
+ * 不需要转换采样率时起始位置之前的缓冲区整块丢弃，不做采样转换，只剩解码本身的开销。
+ *
+ * 解码结果不会无限堆积：缓冲的帧数达到上限后暂不取走解码器中就绪的缓冲区，QAudioDecoder 在上一个缓冲区被 read 之前
+ * 不会继续解码，解码因此暂停；read 使缓冲降到上限的一半以下后再取走，解码随之恢复。
+ */
+class TrackDecoder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TrackDecoder(QObject *parent = nullptr);
+    ~TrackDecoder();
+
+    // 开始解码，format 为输出格式（只使用其中的采样率与声道数，采样始终为 float），startFrame 为起始帧
+    void start(const QUrl &url, const QAudioFormat &format, qint64 startFrame = 0);
+    // 解码结果乘以的线性增益（回放增益），在 start 之前设置
+    void setGain(float gain) { m_gain = gain; }
+    // 采样率转换的质量，在 start 之前设置
+    void setResampleQuality(Resampler::Quality quality) { m_resampleQuality = quality; }
+    // 缓冲帧数的上限（高水位），0 表示不限；低于其一半（低水位）时恢复解码
+    void setBufferLimit(qint64 frames) { m_highWater = qMax<qint64>(0, frames); }
+    void stop();
+
+    QUrl source() const { return m_source; }
+
+    // 读取至多 frames 帧到 data（交错），返回实际读取的帧数
+    qint64 read(float *data, qint64 frames);
+
+    qint64 bufferedFrames() const { return m_bufferedFrames; }
+    bool isDecodingFinished() const { return m_finished; }
+    bool atEnd() const { return m_finished && m_bufferedFrames == 0; }
+    bool hasError() const { return m_error; }
+
+    // 音轨总长度（输出采样率下的帧数），未知时为 -1
+    qint64 durationFrames() const { return m_durationFrames; }
+    // 尚未被 read 取走的帧数（包括还没解码的部分），总长度未知时为 -1
+    qint64 remainingFrames() const;
+
+signals:
+    void durationChanged(qint64 frames);
+    void decodingFinished();
+    void errorOccurred(const QString &message);
+
+private:
+    void onBufferReady();
+    // 在高水位以下时取走解码器中就绪的缓冲区
+    void pull();
+    void decodeBuffer(const QAudioBuffer &buffer);
+    void onFinished();
+    void onError();
+
+    // 转换为输出声道数的 float 采样，返回帧数
+    qint64 convert(const QAudioBuffer &buffer, QVector<float> &out) const;
+    // 把 inRate 采样率的 samples 转换为输出采样率，返回转换后的帧数
+    qint64 resample(int inRate, QVector<float> &samples);
+    // 按编码器延迟、原始长度与起始位置计算 frames 帧中保留的范围 [first, last)，并计入已解码的帧数
+    void advance(qint64 frames, qint64 &first, qint64 &last);
+    void push(QVector<float> &&samples, qint64 frames);
+
+private:
+    QAudioDecoder *m_decoder;
+    QUrl m_source;
+    QAudioFormat m_format;
+    int m_channels;
+    float m_gain;
+    Resampler::Quality m_resampleQuality;
+    std::unique_ptr<Resampler> m_resampler;     // 解码输出的采样率与输出采样率相同时为空
+
+    GaplessInfo m_gapless;
+    qint64 m_delayFrames;       // 编码器延迟（输出采样率下的帧数）
+    qint64 m_delayRemaining;    // 开头还需丢弃的延迟帧数
+    qint64 m_startFrame;        // 起始位置，之前的帧解码后丢弃
+    qint64 m_frameLimit;        // 裁剪延迟后音轨的总帧数上限，-1 表示不限
+    qint64 m_decodedFrames;     // 裁剪延迟后已解码的帧数（包括起始位置之前被丢弃的）
+    qint64 m_durationFrames;
+    bool m_firstBuffer;
+
+    QQueue<QVector<float>> m_chunks;
+    qint64 m_chunkOffset;       // 队首块中已读取的帧数
+    qint64 m_bufferedFrames;
+    qint64 m_highWater;         // 缓冲帧数达到它时暂停取走解码结果，0 表示不限
+
+    bool m_finished;
+    bool m_error;
+};
+
+#endif // TRACKDECODER_H
@@ -0,0 +1,189 @@
+#include "TrackRecord.h"
+
+#include <QImage>
+#include <QUrl>
+
+namespace {
+
+// 附加表字段与元数据键名的对应
+struct ExtraKey
+{
+    TrackRecord::Field field;
+    const char *name;
+};
+
+constexpr ExtraKey kExtraKeys[] = {
+    { TrackRecord::Field::Comment,            "Comment" },
+    { TrackRecord::Field::Description,        "Description" },
+    { TrackRecord::Field::Date,               "Date" },
+    { TrackRecord::Field::Language,           "Language" },
+    { TrackRecord::Field::Publisher,          "Publisher" },
+    { TrackRecord::Field::Copyright,          "Copyright" },
+    { TrackRecord::Field::Composer,           "Composer" },
+    { TrackRecord::Field::LeadPerformer,      "LeadPerformer" },
+    { TrackRecord::Field::ContributingArtist, "ContributingArtist" },
+    { TrackRecord::Field::MediaType,          "MediaType" },
+    { TrackRecord::Field::VideoBitRate,       "VideoBitRate" },
+    { TrackRecord::Field::VideoCodec,         "VideoCodec" },
+    { TrackRecord::Field::VideoFrameRate,     "VideoFrameRate" },
+    { TrackRecord::Field::Orientation,        "Orientation" },
+    { TrackRecord::Field::Resolution,         "Resolution" },
+};
+
+// 以下估算基于 64 位平台：每次堆分配另计 16 字节的分配器开销
+constexpr qsizetype kAllocOverhead = 16;
+constexpr qsizetype kArrayHeader = 16;      // QArrayData 头
+constexpr qsizetype kMapNode = 32;          // std::map 红黑树节点头
+
+qsizetype stringMemory(const QString &str)
+{
+    // 隐式共享的数据也按独占计算，即估算各自单独存放时的开销
+    if (str.isEmpty()) {
+        return 0;
+    }
+    return kAllocOverhead + kArrayHeader + (str.capacity() + 1) * qsizetype(sizeof(QChar));
+}
+
+qsizetype variantMemory(const QVariant &value)
+{
+    switch (value.typeId()) {
+    case QMetaType::QString:
+        return stringMemory(value.toString());
+    case QMetaType::QByteArray:
+        return kAllocOverhead + kArrayHeader + value.toByteArray().capacity() + 1;
+    case QMetaType::QStringList: {
+        const QStringList list = value.toStringList();
+        qsizetype bytes = kAllocOverhead + kArrayHeader + list.size() * qsizetype(sizeof(QString));
+        for (const QString &str : list) {
+            bytes += stringMemory(str);
+        }
+        return bytes;
+    }
+    case QMetaType::QUrl:
+        // QUrlPrivate 约 100 字节，外加各组成部分的字符串
+        return kAllocOverhead + 100 + stringMemory(value.toUrl().toString());
+    case QMetaType::QImage:
+        return kAllocOverhead + 200 + value.value<QImage>().sizeInBytes();
+    default:
+        break;
+    }
+
+    // 超过 QVariant 内部存储的类型需要额外的堆分配
+    const qsizetype size = value.metaType().sizeOf();
+    return size > qsizetype(3 * sizeof(void *)) ? kAllocOverhead + kArrayHeader + size : 0;
+}
+
+} // namespace
+
+QVariant TrackRecord::extra(Field field) const
+{
+    for (const auto &entry : extras) {
+        if (entry.first == field) {
+            return entry.second;
+        }
+    }
+    return QVariant();
+}
+
+void TrackRecord::setExtra(Field field, const QVariant &value)
+{
+    for (auto &entry : extras) {
+        if (entry.first == field) {
+            entry.second = value;
+            return;
+        }
+    }
+    extras.append(qMakePair(field, value));
+}
+
+TrackRecord TrackRecord::fromMetadata(const QVariantMap &metadata)
+{
+    TrackRecord record;
+
+    const QVariant url = metadata.value("Url");
+    record.url = (url.typeId() == QMetaType::QUrl) ? url.toUrl().toString() : url.toString();
+
+    record.title = metadata.value("Title").toString();
+    record.author = metadata.value("Author").toString();
+    record.albumTitle = metadata.value("AlbumTitle").toString();
+    record.albumArtist = metadata.value("AlbumArtist").toString();
+    record.genre = metadata.value("Genre").toString();
+    record.duration = metadata.value("Duration").toLongLong();
+    record.audioBitRate = metadata.value("AudioBitRate").toInt();
+    record.trackNumber = qint16(metadata.value("TrackNumber").toInt());
+
+    auto it = metadata.constFind("FileFormat");
+    if (it != metadata.constEnd()) {
+        record.fileFormat = qint16(it->toInt());
+    }
+    it = metadata.constFind("AudioCodec");
+    if (it != metadata.constEnd()) {
+        record.audioCodec = qint16(it->toInt());
+    }
+
+    for (const ExtraKey &key : kExtraKeys) {
+        it = metadata.constFind(QLatin1StringView(key.name));
+        if (it != metadata.constEnd() && !it->isNull()) {
+            record.extras.append(qMakePair(key.field, *it));
+        }
+    }
+    record.extras.squeeze();
+
+    return record;
+}
+
+QVariantMap TrackRecord::toMetadata() const
+{
+    QVariantMap metadata;
+    if (isNull()) {
+        return metadata;
+    }
+
+    metadata.insert("Url", url);
+    metadata.insert("Title", title);
+    metadata.insert("Author", author.toString());
+    if (!albumTitle.isEmpty()) metadata.insert("AlbumTitle", albumTitle.toString());
+    if (!albumArtist.isEmpty()) metadata.insert("AlbumArtist", albumArtist.toString());
+    if (!genre.isEmpty()) metadata.insert("Genre", genre.toString());
+    if (duration > 0) metadata.insert("Duration", duration);
+    if (audioBitRate > 0) metadata.insert("AudioBitRate", audioBitRate);
+    if (trackNumber > 0) metadata.insert("TrackNumber", int(trackNumber));
+    if (fileFormat >= 0) metadata.insert("FileFormat", int(fileFormat));
+    if (audioCodec >= 0) metadata.insert("AudioCodec", int(audioCodec));
+
+    for (const auto &entry : extras) {
+        for (const ExtraKey &key : kExtraKeys) {
+            if (key.field == entry.first) {
+                metadata.insert(QString::fromLatin1(key.name), entry.second);
+                break;
+            }
+        }
+    }
+
+    return metadata;
+}
+
+qsizetype TrackRecord::memoryUsage() const
+{
+    qsizetype bytes = sizeof(TrackRecord);
+    bytes += stringMemory(url) + stringMemory(title);
+
+    if (!extras.isEmpty()) {
+        bytes += kAllocOverhead + kArrayHeader + extras.capacity() * qsizetype(sizeof(extras.first()));
+        for (const auto &entry : extras) {
+            bytes += variantMemory(entry.second);
+        }
+    }
+    return bytes;
+}
+
+qsizetype TrackRecord::estimateMetadataMemory(const QVariantMap &metadata)
+{
+    // QVariantMap 本身（共享数据头 + std::map）与每个键值对的树节点
+    qsizetype bytes = sizeof(QVariantMap) + kAllocOverhead + 56;
+    for (auto it = metadata.constBegin(); it != metadata.constEnd(); ++it) {
+        bytes += kAllocOverhead + kMapNode + qsizetype(sizeof(QString) + sizeof(QVariant));
+        bytes += stringMemory(it.key()) + variantMemory(it.value());
+    }
+    return bytes;
+}
@@ -0,0 +1,72 @@
+#ifndef TRACKRECORD_H
+#define TRACKRECORD_H
+
+#include <QMetaType>
+#include <QPair>
+#include <QString>
+#include <QVariant>
+#include <QVariantMap>
+#include <QVector>
+
+#include "StringPool.h"
+
+/**
+ * @brief The TrackRecord struct
+ * 播放列表中一首音轨的紧凑存储
+ *
+ * 常用字段直接以成员保存，不再为每个字段分配 QString 键与 QVariant 节点；
+ * 不常用的字段存放在以枚举为键的附加表中，只在存在时占用空间。封面等图像不进入播放列表。
+ * 艺术家、专辑、流派在曲库中大量重复，驻留在 StringPool 中，分组与筛选时直接比较 ID。
+ */
+struct TrackRecord
+{
+    // 附加表中的字段
+    enum class Field : quint8 {
+        Comment,
+        Description,
+        Date,
+        Language,
+        Publisher,
+        Copyright,
+        Composer,
+        LeadPerformer,
+        ContributingArtist,
+        MediaType,
+        VideoBitRate,
+        VideoCodec,
+        VideoFrameRate,
+        Orientation,
+        Resolution,
+    };
+
+    QString url;
+    QString title;
+    PooledString author;
+    PooledString albumTitle;
+    PooledString albumArtist;
+    PooledString genre;
+    qint64 duration = 0;        // 毫秒
+    qint32 audioBitRate = 0;
+    qint16 trackNumber = 0;
+    qint16 fileFormat = -1;     // QMediaFormat::FileFormat
+    qint16 audioCodec = -1;     // QMediaFormat::AudioCodec
+
+    QVector<QPair<Field, QVariant>> extras;
+
+    bool isNull() const { return url.isEmpty(); }
+
+    QVariant extra(Field field) const;
+    void setExtra(Field field, const QVariant &value);
+
+    // 与元数据提取器产生的 QVariantMap 互相转换（键名与 MediaMetadataExtractor 一致）
+    static TrackRecord fromMetadata(const QVariantMap &metadata);
+    QVariantMap toMetadata() const;
+
+    // 估算占用的内存（字节），用于比较两种存储方式；驻留的字符串由所有音轨分摊，不计入
+    qsizetype memoryUsage() const;
+    static qsizetype estimateMetadataMemory(const QVariantMap &metadata);
+};
+
+Q_DECLARE_METATYPE(TrackRecord)
+
+#endif // TRACKRECORD_H
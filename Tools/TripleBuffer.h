@@ -0,0 +1,59 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+/**
+ * @brief The TripleBuffer class
+ * 单写单读的无锁三缓冲，用于把最新的一帧结果从工作线程交给界面
+ *
+ * 写端与读端各自独占一个槽，第三个槽用于交换：写端写完 back() 后 publish()，把它与中间槽交换；
+ * 读端 update() 时若中间槽有新数据，把它与自己的槽交换。两端都不会等待对方，
+ * 读端来不及读取的旧帧直接被新帧覆盖，读端总是拿到最新完成的一帧。
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // 写端调用：正在写的槽
+    T &back() { return m_slots[m_back]; }
+
+    // 写端调用：发布 back() 中的数据
+    void publish()
+    {
+        // 交换后拿到的是读端已放弃的槽或者未被读取的旧帧，都可以直接覆盖
+        const int previous = m_middle.exchange(m_back | DirtyBit, std::memory_order_acq_rel);
+        m_back = previous & IndexMask;
+    }
+
+    // 读端调用：有新发布的数据时切换到它，返回是否切换
+    bool update()
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & DirtyBit)) {
+            return false;
+        }
+        const int previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & IndexMask;
+        return true;
+    }
+
+    // 读端调用：最近一次 update() 取得的数据
+    const T &front() const { return m_slots[m_front]; }
+
+private:
+    static constexpr int DirtyBit = 4;
+    static constexpr int IndexMask = 3;
+
+    T m_slots[3]{};
+
+    // 槽下标：写端与读端各自的放在不同缓存行，中间槽带有是否有新数据的标记
+    alignas(64) int m_back = 0;
+    alignas(64) std::atomic<int> m_middle{1};
+    alignas(64) int m_front = 2;
+};
+
+#endif // TRIPLEBUFFER_H
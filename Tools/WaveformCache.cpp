@@ -0,0 +1,140 @@
+#include "WaveformCache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+
+constexpr quint32 kCacheMagic = 0x57465043;     // "WFPC"
+constexpr quint32 kCacheVersion = 1;
+
+} // namespace
+
+WaveformCache::WaveformCache()
+{
+    QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir dir(appDataPath);
+    if (!dir.exists("waveforms")) {
+        dir.mkpath("waveforms");
+    }
+    m_cacheDir = dir.filePath("waveforms");
+}
+
+QString WaveformCache::entryPath(const QString &canonicalPath) const
+{
+    const QByteArray hash = QCryptographicHash::hash(canonicalPath.toUtf8(), QCryptographicHash::Sha1);
+    return QDir(m_cacheDir).filePath(QString::fromLatin1(hash.toHex()) + ".wfp");
+}
+
+bool WaveformCache::lookup(const QString &filePath, WaveformPeaks &peaks) const
+{
+    const QFileInfo fileInfo(filePath);
+    const QString key = fileInfo.canonicalFilePath();
+    if (key.isEmpty()) {
+        return false;
+    }
+
+    const QString path = entryPath(key);
+    QFile file(path);
+    // 以读写方式打开以便更新时间，不存在时不能让 open 创建空文件
+    if (!file.exists() || !file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0, version = 0;
+    QString storedKey;
+    qint64 size = 0, mtime = 0, frames = 0;
+    qint32 sampleRate = 0;
+    QByteArray packed;
+    in >> magic >> version >> storedKey >> size >> mtime >> sampleRate >> frames >> packed;
+
+    const bool valid = in.status() == QDataStream::Ok && magic == kCacheMagic && version == kCacheVersion
+                       && storedKey == key && size == fileInfo.size()
+                       && mtime == fileInfo.lastModified().toMSecsSinceEpoch();
+    const QByteArray raw = valid ? qUncompress(packed) : QByteArray();
+    if (raw.isEmpty() || raw.size() % 3 != 0) {
+        // 音轨已被修改或缓存文件损坏
+        file.close();
+        file.remove();
+        return false;
+    }
+
+    // 记录最后使用时间，供 trim 淘汰
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    QVector<WaveformPeaks::Bin> base(raw.size() / 3);
+    const char *src = raw.constData();
+    for (qsizetype i = 0; i < base.size(); ++i) {
+        base[i].min = qint8(src[i * 3]);
+        base[i].max = qint8(src[i * 3 + 1]);
+        base[i].rms = quint8(src[i * 3 + 2]);
+    }
+
+    peaks = WaveformPeaks::fromBase(base, sampleRate, frames);
+    return true;
+}
+
+void WaveformCache::insert(const QString &filePath, const WaveformPeaks &peaks) const
+{
+    const QFileInfo fileInfo(filePath);
+    const QString key = fileInfo.canonicalFilePath();
+    if (key.isEmpty() || peaks.isNull()) {
+        return;
+    }
+
+    const QVector<WaveformPeaks::Bin> &base = peaks.levels.first();
+    QByteArray raw(base.size() * 3, Qt::Uninitialized);
+    char *dst = raw.data();
+    for (qsizetype i = 0; i < base.size(); ++i) {
+        dst[i * 3] = char(base[i].min);
+        dst[i * 3 + 1] = char(base[i].max);
+        dst[i * 3 + 2] = char(base[i].rms);
+    }
+
+    // 先写入临时文件再替换，读取时不会看到写了一半的文件
+    QSaveFile file(entryPath(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write waveform cache:" << file.fileName();
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kCacheMagic << kCacheVersion << key << fileInfo.size()
+        << fileInfo.lastModified().toMSecsSinceEpoch() << qint32(peaks.sampleRate) << peaks.frames
+        << qCompress(raw, 1);
+
+    if (!file.commit()) {
+        qWarning() << "Failed to write waveform cache:" << file.fileName();
+    }
+}
+
+void WaveformCache::trim(qint64 maxBytes) const
+{
+    QFileInfoList entries = QDir(m_cacheDir).entryInfoList({ "*.wfp" }, QDir::Files, QDir::Time | QDir::Reversed);
+
+    qint64 total = 0;
+    for (const QFileInfo &entry : std::as_const(entries)) {
+        total += entry.size();
+    }
+
+    // 从最久未使用的开始删除
+    for (const QFileInfo &entry : std::as_const(entries)) {
+        if (total <= maxBytes) {
+            break;
+        }
+        if (QFile::remove(entry.filePath())) {
+            total -= entry.size();
+        }
+    }
+}
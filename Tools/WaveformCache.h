@@ -0,0 +1,35 @@
+#ifndef WAVEFORMCACHE_H
+#define WAVEFORMCACHE_H
+
+#include <QString>
+
+#include "WaveformPeaks.h"
+
+/**
+ * @brief The WaveformCache class
+ * 波形概览的磁盘缓存
+ *
+ * 每首音轨一个文件（以规范路径的哈希命名），保存文件大小、修改时间与压缩后的第 0 层，
+ * 文件大小或修改时间不一致即视为过期并删除。不同音轨的读写互不影响，可在多个线程中同时使用。
+ * 缓存目录的总大小超过上限时按最后使用时间删除最旧的文件。
+ */
+class WaveformCache
+{
+public:
+    WaveformCache();
+
+    // 命中时写入 peaks 并返回 true
+    bool lookup(const QString &filePath, WaveformPeaks &peaks) const;
+    void insert(const QString &filePath, const WaveformPeaks &peaks) const;
+
+    // 删除最旧的缓存文件，直到总大小不超过 maxBytes
+    void trim(qint64 maxBytes) const;
+
+private:
+    QString entryPath(const QString &canonicalPath) const;
+
+private:
+    QString m_cacheDir;
+};
+
+#endif // WAVEFORMCACHE_H
@@ -0,0 +1,133 @@
+#include "WaveformGenerator.h"
+#include "BlockingDecoder.h"
+
+#include <QThread>
+#include <QUrl>
+
+namespace {
+
+// 在工作线程中解码整首音轨并构建波形
+bool buildWaveform(const QString &filePath, const std::atomic_bool &canceled, WaveformPeaks &peaks)
+{
+    std::unique_ptr<WaveformBuilder> builder;
+    const bool ok = BlockingDecoder::decode(filePath, canceled,
+                                            [&builder](const QAudioFormat &format, const float *data, qint64 frames) {
+        if (!builder) {
+            builder = std::make_unique<WaveformBuilder>(format.sampleRate(), format.channelCount());
+        } else if (format.sampleRate() != builder->sampleRate() || format.channelCount() != builder->channelCount()) {
+            return;     // 中途改变格式的流只取第一段
+        }
+        builder->process(data, frames);
+    });
+
+    if (!ok || !builder) {
+        return false;
+    }
+
+    peaks = builder->result();
+    return !peaks.isNull();
+}
+
+} // namespace
+
+WaveformGenerator::WaveformGenerator(QObject *parent)
+    : QObject{parent}
+    , m_recent(8)
+    , m_cacheLimit(64 * 1024 * 1024)
+    , m_generation(0)
+    , m_canceled(std::make_shared<std::atomic_bool>(false))
+{
+    // 一次只生成一首，不与播放、界面争抢
+    m_threadPool.setMaxThreadCount(1);
+    m_threadPool.setThreadPriority(QThread::LowPriority);
+
+    // 遍历缓存目录较慢，同样在后台低优先级执行，一次一个
+    m_trimPool.setMaxThreadCount(1);
+    m_trimPool.setThreadPriority(QThread::LowPriority);
+}
+
+WaveformGenerator::~WaveformGenerator()
+{
+    cancel();
+    m_threadPool.waitForDone();
+    m_trimPool.waitForDone();
+}
+
+void WaveformGenerator::request(const QString &url)
+{
+    cancel();
+
+    ++m_generation;
+    m_canceled = std::make_shared<std::atomic_bool>(false);
+
+    if (const WaveformPeaks *peaks = m_recent.object(url)) {
+        emit peaksReady(url, *peaks);
+        return;
+    }
+
+    const QUrl source(url);
+    if (!source.isLocalFile()) {
+        return;
+    }
+
+    const quint64 generation = m_generation;
+    const auto canceled = m_canceled;
+    const QString filePath = source.toLocalFile();
+    const WaveformCache *cache = &m_cache;
+
+    m_threadPool.start([this, generation, canceled, cache, url, filePath]() {
+        if (canceled->load()) {
+            return;
+        }
+
+        WaveformPeaks peaks;
+        bool decoded = false;
+        if (!cache->lookup(filePath, peaks)) {
+            if (!buildWaveform(filePath, *canceled, peaks)) {
+                return;
+            }
+            decoded = true;
+            cache->insert(filePath, peaks);
+        }
+
+        QMetaObject::invokeMethod(this, [this, generation, url, peaks, decoded]() {
+            onTaskFinished(generation, url, peaks, decoded);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void WaveformGenerator::cancel()
+{
+    m_canceled->store(true);
+    m_threadPool.clear();   // 移除尚未开始的任务
+}
+
+void WaveformGenerator::setCacheLimit(qint64 bytes)
+{
+    m_cacheLimit = qMax<qint64>(0, bytes);
+    scheduleTrim();
+}
+
+void WaveformGenerator::scheduleTrim()
+{
+    // 尚未开始的淘汰与这一次等价，只保留一个
+    m_trimPool.clear();
+    m_trimPool.start([cache = m_cache, limit = m_cacheLimit]() {
+        cache.trim(limit);
+    });
+}
+
+void WaveformGenerator::onTaskFinished(quint64 generation, const QString &url, const WaveformPeaks &peaks,
+                                       bool decoded)
+{
+    m_recent.insert(url, new WaveformPeaks(peaks));
+
+    if (decoded) {
+        // 新写入的缓存文件可能使总大小超过上限
+        scheduleTrim();
+    }
+
+    if (generation == m_generation) {
+        emit peaksReady(url, peaks);
+    }
+}
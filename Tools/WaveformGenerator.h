@@ -0,0 +1,56 @@
+#ifndef WAVEFORMGENERATOR_H
+#define WAVEFORMGENERATOR_H
+
+#include <QObject>
+#include <QCache>
+#include <QString>
+#include <QThreadPool>
+
+#include "WaveformCache.h"
+#include "WaveformPeaks.h"
+
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief The WaveformGenerator class
+ * 波形概览的生成
+ *
+ * 请求的音轨依次查找内存中最近使用的几首、磁盘缓存，都没有时在低优先级的后台线程中完整解码一次，
+ * 构建峰值金字塔并写入磁盘缓存。新的请求会取消尚未完成的旧请求（只需要当前音轨的波形）。
+ * 每次写入新的波形后在独立的后台线程中按大小上限淘汰最久未使用的缓存文件。
+ */
+class WaveformGenerator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WaveformGenerator(QObject *parent = nullptr);
+    ~WaveformGenerator();
+
+    // 请求 url（本地文件）的波形概览，结果通过 peaksReady 发出（内存命中时在返回前发出）
+    void request(const QString &url);
+    void cancel();
+
+    // 磁盘缓存的总大小上限（字节），设置后以及每次写入新的波形后在后台删除最久未使用的缓存文件直到不超过上限
+    void setCacheLimit(qint64 bytes);
+    qint64 cacheLimit() const { return m_cacheLimit; }
+
+signals:
+    void peaksReady(const QString &url, const WaveformPeaks &peaks);
+
+private:
+    void onTaskFinished(quint64 generation, const QString &url, const WaveformPeaks &peaks, bool decoded);
+    void scheduleTrim();
+
+private:
+    QThreadPool m_threadPool;
+    QThreadPool m_trimPool;                        // 淘汰缓存文件，不受请求取消的影响
+    WaveformCache m_cache;
+    QCache<QString, WaveformPeaks> m_recent;       // 最近使用的几首（url -> 波形）
+    qint64 m_cacheLimit;
+
+    quint64 m_generation;                          // 当前请求代号，用于丢弃过期结果
+    std::shared_ptr<std::atomic_bool> m_canceled;  // 当前请求的取消标记
+};
+
+#endif // WAVEFORMGENERATOR_H
@@ -0,0 +1,156 @@
+#include "WaveformPeaks.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+inline qint8 quantizeSample(float v)
+{
+    return qint8(std::lround(std::clamp(v, -1.0f, 1.0f) * 127.0f));
+}
+
+inline quint8 quantizeRms(double v)
+{
+    return quint8(std::lround(std::clamp(v, 0.0, 1.0) * 255.0));
+}
+
+inline double rmsValue(quint8 q)
+{
+    return q / 255.0;
+}
+
+} // namespace
+
+WaveformPeaks WaveformPeaks::fromBase(const QVector<Bin> &base, int sampleRate, qint64 frames)
+{
+    WaveformPeaks peaks;
+    peaks.sampleRate = sampleRate;
+    peaks.frames = frames;
+    if (base.isEmpty()) {
+        return peaks;
+    }
+
+    peaks.levels.append(base);
+    while (peaks.levels.last().size() > MinLevelBins) {
+        const QVector<Bin> &fine = peaks.levels.last();
+        QVector<Bin> coarse((fine.size() + 1) / 2);
+        for (qsizetype i = 0; i < coarse.size(); ++i) {
+            const qsizetype first = i * 2;
+            coarse[i] = merge(fine.constData() + first, int(qMin<qsizetype>(2, fine.size() - first)));
+        }
+        peaks.levels.append(coarse);
+    }
+    return peaks;
+}
+
+QVector<WaveformPeaks::Bin> WaveformPeaks::columns(int width) const
+{
+    QVector<Bin> result;
+    if (isNull() || width <= 0) {
+        return result;
+    }
+
+    // 格数不少于像素数的最粗一层，没有时用最细一层
+    int level = 0;
+    for (int i = levels.size() - 1; i >= 0; --i) {
+        if (levels[i].size() >= width) {
+            level = i;
+            break;
+        }
+    }
+
+    const QVector<Bin> &bins = levels[level];
+    const qint64 count = bins.size();
+    result.resize(width);
+    for (int x = 0; x < width; ++x) {
+        const qint64 begin = x * count / width;
+        const qint64 end = qMax(begin + 1, (x + 1) * count / width);
+        result[x] = merge(bins.constData() + begin, int(end - begin));
+    }
+    return result;
+}
+
+WaveformPeaks::Bin WaveformPeaks::merge(const Bin *bins, int count)
+{
+    Bin bin;
+    if (count <= 0) {
+        return bin;
+    }
+
+    bin.min = bins[0].min;
+    bin.max = bins[0].max;
+    double energy = 0.0;
+    for (int i = 0; i < count; ++i) {
+        bin.min = std::min(bin.min, bins[i].min);
+        bin.max = std::max(bin.max, bins[i].max);
+        const double rms = rmsValue(bins[i].rms);
+        energy += rms * rms;
+    }
+    bin.rms = quantizeRms(std::sqrt(energy / count));
+    return bin;
+}
+
+WaveformBuilder::WaveformBuilder(int sampleRate, int channels)
+    : m_sampleRate(qMax(1, sampleRate))
+    , m_channels(qMax(1, channels))
+    , m_frames(0)
+    , m_binFill(0)
+    , m_min(0.0f)
+    , m_max(0.0f)
+    , m_sumSquares(0.0)
+{
+}
+
+void WaveformBuilder::process(const float *data, qint64 frames)
+{
+    while (frames > 0) {
+        // 每次最多处理到当前格结束
+        const qint64 n = qMin<qint64>(frames, WaveformPeaks::BaseFrames - m_binFill);
+        const qint64 count = n * m_channels;
+
+        float lo = m_binFill > 0 ? m_min : data[0];
+        float hi = m_binFill > 0 ? m_max : data[0];
+        double sum = 0.0;
+        for (qint64 i = 0; i < count; ++i) {
+            const float v = data[i];
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+            sum += double(v) * v;
+        }
+        m_min = lo;
+        m_max = hi;
+        m_sumSquares += sum;
+
+        data += count;
+        frames -= n;
+        m_frames += n;
+        m_binFill += n;
+        if (m_binFill == WaveformPeaks::BaseFrames) {
+            finishBin();
+        }
+    }
+}
+
+void WaveformBuilder::finishBin()
+{
+    WaveformPeaks::Bin bin;
+    bin.min = quantizeSample(m_min);
+    bin.max = quantizeSample(m_max);
+    bin.rms = quantizeRms(std::sqrt(m_sumSquares / (m_binFill * m_channels)));
+    m_bins.append(bin);
+
+    m_binFill = 0;
+    m_sumSquares = 0.0;
+}
+
+WaveformPeaks WaveformBuilder::result() const
+{
+    // 末尾不满一格的部分也算一格
+    if (m_binFill > 0) {
+        WaveformBuilder tail(*this);
+        tail.finishBin();
+        return WaveformPeaks::fromBase(tail.m_bins, m_sampleRate, m_frames);
+    }
+    return WaveformPeaks::fromBase(m_bins, m_sampleRate, m_frames);
+}
@@ -0,0 +1,78 @@
+#ifndef WAVEFORMPEAKS_H
+#define WAVEFORMPEAKS_H
+
+#include <QMetaType>
+#include <QVector>
+
+/**
+ * @brief The WaveformPeaks struct
+ * 音轨波形概览的多分辨率峰值金字塔
+ *
+ * 第 0 层每 BaseFrames 帧一格，记录所有声道中的最小值、最大值与均方根，各量化为 8 位；
+ * 之后每层把上一层相邻的两格合并为一格，直到不超过 MinLevelBins 格。
+ * 绘制任意宽度时选择格数不少于像素数的最粗一层再按像素合并，代价与音轨长度无关。
+ * 磁盘上只保存第 0 层，其余各层载入时重建。数据隐式共享，复制的代价很小。
+ */
+struct WaveformPeaks
+{
+    struct Bin
+    {
+        qint8 min = 0;          // [-127, 127] 对应 [-1, 1]
+        qint8 max = 0;
+        quint8 rms = 0;         // [0, 255] 对应 [0, 1]
+    };
+
+    static constexpr int BaseFrames = 1024;
+    static constexpr int MinLevelBins = 16;
+
+    int sampleRate = 0;
+    qint64 frames = 0;
+    QVector<QVector<Bin>> levels;   // levels[0] 最细
+
+    bool isNull() const { return levels.isEmpty() || levels.first().isEmpty(); }
+    qint64 durationMs() const { return sampleRate > 0 ? frames * 1000 / sampleRate : 0; }
+
+    // 由第 0 层构建金字塔
+    static WaveformPeaks fromBase(const QVector<Bin> &base, int sampleRate, qint64 frames);
+
+    // 把整首音轨按 width 个像素列合并，每列一格
+    QVector<Bin> columns(int width) const;
+
+    // 合并若干格：最小值取最小，最大值取最大，均方根按能量平均
+    static Bin merge(const Bin *bins, int count);
+};
+
+Q_DECLARE_METATYPE(WaveformPeaks)
+
+/**
+ * @brief The WaveformBuilder class
+ * 从交错的 float 采样逐块累计出 WaveformPeaks 的第 0 层
+ */
+class WaveformBuilder
+{
+public:
+    WaveformBuilder(int sampleRate, int channels);
+
+    int sampleRate() const { return m_sampleRate; }
+    int channelCount() const { return m_channels; }
+
+    void process(const float *data, qint64 frames);
+    WaveformPeaks result() const;
+
+private:
+    void finishBin();
+
+private:
+    int m_sampleRate;
+    int m_channels;
+    qint64 m_frames;
+
+    qint64 m_binFill;
+    float m_min;
+    float m_max;
+    double m_sumSquares;
+
+    QVector<WaveformPeaks::Bin> m_bins;
+};
+
+#endif // WAVEFORMPEAKS_H
@@ -0,0 +1,139 @@
+#include "EqualizerDialog.h"
+
+#include <QCheckBox>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QSignalBlocker>
+#include <QSlider>
+#include <QVBoxLayout>
+
+namespace {
+
+// 滑块以 0.5 dB 为一格
+constexpr int StepsPerDb = 2;
+constexpr int MaxGainDb = 12;
+
+QString gainText(double gainDb)
+{
+    return QString::number(gainDb, 'f', 1);
+}
+
+QString frequencyText(double frequency)
+{
+    if (frequency >= 1000.0) {
+        return QString::number(frequency / 1000.0, 'g', 3) + "k";
+    }
+    return QString::number(qRound(frequency));
+}
+
+} // namespace
+
+EqualizerDialog::EqualizerDialog(QWidget *parent)
+    : QDialog{parent}
+    , m_preset(EqPreset::graphic10())
+    , m_sliderLayout(new QGridLayout)
+    , m_albumCheck(new QCheckBox("仅用于当前专辑", this))
+{
+    setWindowTitle("均衡器");
+
+    QPushButton *resetButton = new QPushButton("重置", this);
+    connect(resetButton, &QPushButton::clicked, this, &EqualizerDialog::onResetClicked);
+    connect(m_albumCheck, &QCheckBox::toggled, this, [this]() {
+        emit presetChanged(m_preset, m_albumCheck->isChecked());
+    });
+
+    QHBoxLayout *bottomLayout = new QHBoxLayout;
+    bottomLayout->addWidget(m_albumCheck);
+    bottomLayout->addStretch();
+    bottomLayout->addWidget(resetButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(m_sliderLayout);
+    layout->addLayout(bottomLayout);
+
+    rebuildSliders();
+}
+
+void EqualizerDialog::setPreset(const EqPreset &preset, bool albumPreset)
+{
+    m_preset = preset;
+    {
+        const QSignalBlocker blocker(m_albumCheck);
+        m_albumCheck->setChecked(albumPreset);
+    }
+    rebuildSliders();
+}
+
+void EqualizerDialog::rebuildSliders()
+{
+    while (QLayoutItem *item = m_sliderLayout->takeAt(0)) {
+        delete item->widget();
+        delete item;
+    }
+    m_sliders.clear();
+    m_valueLabels.clear();
+
+    QLabel *valueLabel = nullptr;
+    m_sliders.append(addSlider(0, "前置", m_preset.preampDb, &valueLabel));
+    m_valueLabels.append(valueLabel);
+
+    for (qsizetype i = 0; i < m_preset.bands.size(); ++i) {
+        const EqBand &band = m_preset.bands[i];
+        m_sliders.append(addSlider(int(i) + 1, frequencyText(band.frequency), band.gainDb, &valueLabel));
+        m_valueLabels.append(valueLabel);
+    }
+
+    for (qsizetype i = 0; i < m_sliders.size(); ++i) {
+        connect(m_sliders[i], &QSlider::valueChanged, this, [this, i](int value) {
+            onSliderChanged(int(i), value);
+        });
+    }
+}
+
+QSlider *EqualizerDialog::addSlider(int column, const QString &title, double gainDb, QLabel **valueLabel)
+{
+    QLabel *value = new QLabel(gainText(gainDb), this);
+    value->setAlignment(Qt::AlignCenter);
+
+    QSlider *slider = new QSlider(Qt::Vertical, this);
+    slider->setRange(-MaxGainDb * StepsPerDb, MaxGainDb * StepsPerDb);
+    slider->setPageStep(StepsPerDb);
+    slider->setValue(qRound(gainDb * StepsPerDb));
+    slider->setMinimumHeight(120);
+
+    QLabel *label = new QLabel(title, this);
+    label->setAlignment(Qt::AlignCenter);
+
+    m_sliderLayout->addWidget(value, 0, column, Qt::AlignHCenter);
+    m_sliderLayout->addWidget(slider, 1, column, Qt::AlignHCenter);
+    m_sliderLayout->addWidget(label, 2, column, Qt::AlignHCenter);
+
+    *valueLabel = value;
+    return slider;
+}
+
+void EqualizerDialog::onSliderChanged(int index, int value)
+{
+    const double gainDb = double(value) / StepsPerDb;
+    if (index == 0) {
+        m_preset.preampDb = gainDb;
+    } else {
+        m_preset.bands[index - 1].gainDb = gainDb;
+    }
+    m_valueLabels[index]->setText(gainText(gainDb));
+
+    emit presetChanged(m_preset, m_albumCheck->isChecked());
+}
+
+void EqualizerDialog::onResetClicked()
+{
+    m_preset.preampDb = 0.0;
+    for (EqBand &band : m_preset.bands) {
+        band.gainDb = 0.0;
+    }
+    rebuildSliders();
+
+    emit presetChanged(m_preset, m_albumCheck->isChecked());
+}
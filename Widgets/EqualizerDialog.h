@@ -0,0 +1,50 @@
+#ifndef EQUALIZERDIALOG_H
+#define EQUALIZERDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+
+#include "../Tools/Equalizer.h"
+
+class QCheckBox;
+class QGridLayout;
+class QLabel;
+class QSlider;
+
+/**
+ * @brief The EqualizerDialog class
+ * 均衡器的调节窗口
+ *
+ * 前置增益与每个频段各一个竖直滑块（±12 dB，步长 0.5 dB），拖动时立即发出 presetChanged，
+ * 由播放引擎平滑过渡到新的设置。勾选“仅用于当前专辑”时设置保存为当前专辑的设置，否则保存为默认设置。
+ */
+class EqualizerDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit EqualizerDialog(QWidget *parent = nullptr);
+
+    // 显示 preset（不发出 presetChanged），albumPreset 表示它是当前专辑自己的设置
+    void setPreset(const EqPreset &preset, bool albumPreset);
+    EqPreset preset() const { return m_preset; }
+
+signals:
+    void presetChanged(const EqPreset &preset, bool albumPreset);
+
+private:
+    // 按 m_preset 重新建立滑块
+    void rebuildSliders();
+    QSlider *addSlider(int column, const QString &title, double gainDb, QLabel **valueLabel);
+    void onSliderChanged(int index, int value);
+    void onResetClicked();
+
+private:
+    EqPreset m_preset;
+
+    QGridLayout *m_sliderLayout;
+    QVector<QSlider *> m_sliders;       // 第一个是前置增益，其后依次为各频段
+    QVector<QLabel *> m_valueLabels;
+    QCheckBox *m_albumCheck;
+};
+
+#endif // EQUALIZERDIALOG_H
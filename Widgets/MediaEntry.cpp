@@ -15,7 +15,7 @@ void MediaEntry::mousePressEvent(QMouseEvent *event)
 
 void MediaEntry::mouseReleaseEvent(QMouseEvent *event)
 {
-    emit clicked(m_metadata);
+    emit clicked(m_track);
 
     QWidget::mouseReleaseEvent(event);
 }
@@ -32,16 +32,16 @@ void MediaEntry::leaveEvent(QEvent *event)
     QWidget::leaveEvent(event);
 }
 
-void MediaEntry::setEntry(const QVariantMap &metadata)
+void MediaEntry::setEntry(const TrackRecord &track)
 {
-    m_metadata = metadata;
+    m_track = track;
 
     update();
 }
 
 void MediaEntry::update()
 {
-    ui->label_mediaName->setText(m_metadata["Title"].toString());
-    ui->label_author->setText(m_metadata["Author"].toString());
-    ui->label_time->setText(m_metadata["Duration"].toString());
+    ui->label_mediaName->setText(m_track.title);
+    ui->label_author->setText(m_track.author.toString());
+    ui->label_time->setText(QString::number(m_track.duration));
 }
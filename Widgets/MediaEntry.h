@@ -3,6 +3,8 @@
 
 #include <QWidget>
 
+#include "../Tools/TrackRecord.h"
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class MediaEntry;
@@ -23,17 +25,17 @@ public:
     virtual void leaveEvent(QEvent *event) override;
 
 public:
-    void setEntry(const QVariantMap& metadata);
+    void setEntry(const TrackRecord& track);
 
     void update();
 
 private:
     Ui::MediaEntry *ui;
 
-    QVariantMap m_metadata;
+    TrackRecord m_track;
 
 signals:
-    void clicked(const QVariantMap&);
+    void clicked(const TrackRecord&);
 };
 
 #endif // MEDIAENTRY_H
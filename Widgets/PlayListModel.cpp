@@ -0,0 +1,77 @@
+#include "PlayListModel.h"
+#include "../Tools/QMediaPlayList.h"
+
+PlayListModel::PlayListModel(QObject *parent)
+    : QAbstractListModel{parent}
+    , m_playList(nullptr)
+{
+}
+
+void PlayListModel::setMediaPlayList(QMediaPlayList *playList)
+{
+    beginResetModel();
+    if (m_playList) {
+        disconnect(m_playList, nullptr, this, nullptr);
+    }
+    m_playList = playList;
+    if (m_playList) {
+        // 播放列表的变化通知逐一转为行级更新，视图只处理变化的行
+        connect(m_playList, &QMediaPlayList::metadataListAboutToBeReset, this, [this]() {
+            beginResetModel();
+        });
+        connect(m_playList, &QMediaPlayList::metadataListChanged, this, [this]() {
+            endResetModel();
+        });
+        connect(m_playList, &QMediaPlayList::mediaAboutToBeInserted, this, [this](int first, int last) {
+            beginInsertRows(QModelIndex(), first, last);
+        });
+        connect(m_playList, &QMediaPlayList::mediaInserted, this, [this]() {
+            endInsertRows();
+        });
+        connect(m_playList, &QMediaPlayList::mediaAboutToBeRemoved, this, [this](int first, int last) {
+            beginRemoveRows(QModelIndex(), first, last);
+        });
+        connect(m_playList, &QMediaPlayList::mediaRemoved, this, [this]() {
+            endRemoveRows();
+        });
+        connect(m_playList, &QMediaPlayList::mediaAboutToBeMoved, this, [this](int first, int last, int destination) {
+            beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
+        });
+        connect(m_playList, &QMediaPlayList::mediaMoved, this, [this]() {
+            endMoveRows();
+        });
+        connect(m_playList, &QMediaPlayList::mediaChanged, this, [this](int first, int last) {
+            emit dataChanged(index(first), index(last));
+        });
+    }
+    endResetModel();
+}
+
+int PlayListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !m_playList) {
+        return 0;
+    }
+    return m_playList->getMetadataList().size();
+}
+
+QVariant PlayListModel::data(const QModelIndex &index, int role) const
+{
+    if (!m_playList || !index.isValid() || index.row() >= m_playList->getMetadataList().size()) {
+        return QVariant();
+    }
+
+    const TrackRecord &track = m_playList->getMetadataList().at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return QString("%1 - %2").arg(track.title, track.author.toString());
+    case Qt::ToolTipRole:
+        return track.url;
+    case TrackRole:
+        return QVariant::fromValue(track);
+    case UrlRole:
+        return track.url;
+    default:
+        return QVariant();
+    }
+}
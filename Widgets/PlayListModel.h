@@ -0,0 +1,37 @@
+#ifndef PLAYLISTMODEL_H
+#define PLAYLISTMODEL_H
+
+#include <QAbstractListModel>
+
+#include "../Tools/TrackRecord.h"
+
+class QMediaPlayList;
+
+/**
+ * @brief The PlayListModel class
+ * 直接读取 QMediaPlayList 的列表模型
+ *
+ * 不复制任何行数据，行数与内容都来自播放列表本身，显示文本只在视图请求（即绘制可见行）时才格式化。
+ * 播放列表的插入、删除、修改、移动通知直接转为对应的行级更新。
+ */
+class PlayListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum Roles {
+        TrackRole = Qt::UserRole,   // TrackRecord
+        UrlRole,                    // QString
+    };
+
+    explicit PlayListModel(QObject *parent = nullptr);
+
+    void setMediaPlayList(QMediaPlayList *playList);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    QMediaPlayList *m_playList;
+};
+
+#endif // PLAYLISTMODEL_H
@@ -1,10 +1,6 @@
 #include "PlayListWidget.h"
 #include "ui_PlayListWidget.h"
 
-#include <QPainter>
-#include <QTime>
-#include <QTimer>
-
 PlayListWidget::PlayListWidget(QWidget *parent)
     : QWidget{parent}
     , ui(new Ui::PlayListWidget)
@@ -13,14 +9,10 @@ PlayListWidget::PlayListWidget(QWidget *parent)
 
     QListView *listView = ui->listView;
     listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    // 行高一致时视图无需逐行计算尺寸，大列表可以立即完成布局
+    listView->setUniformItemSizes(true);
 
-    m_model = new QStandardItemModel(listView);
-
-    // for(int i = 0; i < 100; i++)
-    // {
-    //     QStandardItem* item = new QStandardItem(QString("Item %1").arg(i));
-    //     m_model->appendRow(item);
-    // }
+    m_model = new PlayListModel(listView);
 
     listView->setModel(m_model);
 
@@ -32,33 +24,16 @@ PlayListWidget::~PlayListWidget()
     delete ui;
 }
 
-void PlayListWidget::addMediaEntry(const QVariantMap &metadata)
-{
-    QString mediaString = QString("%1 - %2").arg(metadata["Title"].toString(), metadata["Author"].toString());
-    QStandardItem* item = new QStandardItem(mediaString);
-
-    item->setData(metadata, Qt::UserRole);
-    m_model->appendRow(item);
-}
-
-void PlayListWidget::addMediaEntries(const QVector<QVariantMap> &metadataList)
-{
-    for (const auto &metadata : metadataList) {
-        addMediaEntry(metadata);
-    }
-}
-
-void PlayListWidget::clearEntries()
+void PlayListWidget::setMediaPlayList(QMediaPlayList *playList)
 {
-    m_model->clear();
+    m_model->setMediaPlayList(playList);
 }
 
 void PlayListWidget::onItemDoubleClicked(const QModelIndex &index)
 {
     if (index.isValid()) {
-        // QString text = m_model->itemFromIndex(index)->text();
-        QVariantMap metadata = m_model->itemFromIndex(index)->data(Qt::UserRole).toMap();
+        TrackRecord track = index.data(PlayListModel::TrackRole).value<TrackRecord>();
 
-        emit entryClicked(metadata);
+        emit entryClicked(track);
     }
 }
@@ -2,7 +2,8 @@
 #define PLAYLISTWIDGET_H
 
 #include <QWidget>
-#include <QStandardItemModel>
+
+#include "PlayListModel.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -17,18 +18,16 @@ public:
     explicit PlayListWidget(QWidget *parent = nullptr);
     virtual ~PlayListWidget();
 
-    void addMediaEntry(const QVariantMap& metadata);
-    void addMediaEntries(const QVector<QVariantMap>& metadataList);
-
-    void clearEntries();
+    // 视图直接显示该播放列表的内容
+    void setMediaPlayList(QMediaPlayList* playList);
 signals:
     void closeRequested();
-    void entryClicked(const QVariantMap&);
+    void entryClicked(const TrackRecord&);
 
 private:
     Ui::PlayListWidget* ui;
 
-    QStandardItemModel* m_model;
+    PlayListModel* m_model;
 
 private slots:
     void onItemDoubleClicked(const QModelIndex &index);
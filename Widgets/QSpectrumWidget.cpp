@@ -0,0 +1,178 @@
+#include "QSpectrumWidget.h"
+
+#include <QPainter>
+
+#include <algorithm>
+
+namespace {
+
+// 显示的动态范围（dBFS）
+constexpr float RangeDb = 72.0f;
+// 每秒回落的高度（占满高的比例）
+constexpr float FalloffPerSecond = 1.5f;
+
+float toHeight(float db)
+{
+    return qBound(0.0f, (db + RangeDb) / RangeDb, 1.0f);
+}
+
+} // namespace
+
+QSpectrumWidget::QSpectrumWidget(QWidget *parent)
+    : QWidget{parent}
+{
+    reset();
+
+    m_frameTimer.setTimerType(Qt::PreciseTimer);
+    m_frameTimer.setInterval(16);
+    connect(&m_frameTimer, &QTimer::timeout, this, &QSpectrumWidget::onFrameTimer);
+}
+
+QSpectrumWidget::~QSpectrumWidget()
+{
+    if (m_analyzer) {
+        m_analyzer->setActive(false);
+    }
+}
+
+void QSpectrumWidget::setAnalyzer(SpectrumAnalyzer *analyzer)
+{
+    if (m_analyzer) {
+        m_analyzer->setActive(false);
+    }
+    m_analyzer = analyzer;
+    reset();
+
+    if (m_analyzer && isVisible()) {
+        m_analyzer->setActive(true);
+        m_elapsed.start();
+        m_frameTimer.start();
+    }
+    update();
+}
+
+QSize QSpectrumWidget::sizeHint() const
+{
+    return QSize(320, 48);
+}
+
+QSize QSpectrumWidget::minimumSizeHint() const
+{
+    return QSize(SpectrumFrame::BandCount * 2, 24);
+}
+
+void QSpectrumWidget::showEvent(QShowEvent *event)
+{
+    if (m_analyzer) {
+        m_analyzer->setActive(true);
+        m_elapsed.start();
+        m_frameTimer.start();
+    }
+    QWidget::showEvent(event);
+}
+
+void QSpectrumWidget::hideEvent(QHideEvent *event)
+{
+    m_frameTimer.stop();
+    if (m_analyzer) {
+        m_analyzer->setActive(false);
+    }
+    reset();
+    QWidget::hideEvent(event);
+}
+
+void QSpectrumWidget::reset()
+{
+    std::fill(std::begin(m_targetBands), std::end(m_targetBands), 0.0f);
+    std::fill(std::begin(m_bands), std::end(m_bands), 0.0f);
+    std::fill(std::begin(m_targetPeak), std::end(m_targetPeak), 0.0f);
+    std::fill(std::begin(m_targetRms), std::end(m_targetRms), 0.0f);
+    std::fill(std::begin(m_peak), std::end(m_peak), 0.0f);
+    std::fill(std::begin(m_rms), std::end(m_rms), 0.0f);
+}
+
+void QSpectrumWidget::onFrameTimer()
+{
+    if (!m_analyzer) {
+        return;
+    }
+
+    SpectrumFrame frame;
+    if (m_analyzer->latest(frame)) {
+        for (int b = 0; b < SpectrumFrame::BandCount; ++b) {
+            m_targetBands[b] = toHeight(frame.bands[b]);
+        }
+        for (int c = 0; c < SpectrumFrame::MaxChannels; ++c) {
+            m_targetPeak[c] = toHeight(frame.peak[c]);
+            m_targetRms[c] = toHeight(frame.rms[c]);
+        }
+    }
+
+    const float falloff = qMin(m_elapsed.restart(), qint64(100)) / 1000.0f * FalloffPerSecond;
+    bool changed = false;
+    auto follow = [&changed, falloff](float &shown, float target) {
+        const float next = qMax(target, shown - falloff);
+        if (next != shown) {
+            shown = qMax(next, 0.0f);
+            changed = true;
+        }
+    };
+
+    for (int b = 0; b < SpectrumFrame::BandCount; ++b) {
+        follow(m_bands[b], m_targetBands[b]);
+    }
+    for (int c = 0; c < SpectrumFrame::MaxChannels; ++c) {
+        follow(m_peak[c], m_targetPeak[c]);
+        follow(m_rms[c], m_targetRms[c]);
+    }
+
+    // 没有变化（静音且已回落到底）时不重绘
+    if (changed) {
+        update();
+    }
+}
+
+void QSpectrumWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    const int h = height();
+    const int meterWidth = 4;
+    const int meterGap = 2;
+    const int metersWidth = SpectrumFrame::MaxChannels * (meterWidth + meterGap) + 4;
+    const double barsWidth = qMax(0, width() - metersWidth);
+    const double barPitch = barsWidth / SpectrumFrame::BandCount;
+    const double barWidth = qMax(1.0, barPitch - 1.0);
+
+    const QColor highlight = palette().color(isEnabled() ? QPalette::Active : QPalette::Disabled, QPalette::Highlight);
+    QColor bar = highlight;
+    bar.setAlpha(170);
+
+    QPainter painter(this);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(bar);
+    for (int b = 0; b < SpectrumFrame::BandCount; ++b) {
+        const double barHeight = m_bands[b] * h;
+        if (barHeight >= 0.5) {
+            painter.drawRect(QRectF(b * barPitch, h - barHeight, barWidth, barHeight));
+        }
+    }
+
+    // 电平表：均方根为实心，峰值为一条横线
+    const QColor peakColor = palette().color(QPalette::WindowText);
+    for (int c = 0; c < SpectrumFrame::MaxChannels; ++c) {
+        const double x = width() - metersWidth + 4 + c * (meterWidth + meterGap);
+        painter.setBrush(palette().color(QPalette::Mid));
+        painter.drawRect(QRectF(x, 0, meterWidth, h));
+
+        const double rmsHeight = m_rms[c] * h;
+        painter.setBrush(highlight);
+        painter.drawRect(QRectF(x, h - rmsHeight, meterWidth, rmsHeight));
+
+        if (m_peak[c] > 0.0f) {
+            const double y = qMax(0.0, h - m_peak[c] * h);
+            painter.setBrush(peakColor);
+            painter.drawRect(QRectF(x, y, meterWidth, 1.0));
+        }
+    }
+}
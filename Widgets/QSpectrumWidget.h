@@ -0,0 +1,53 @@
+#ifndef QSPECTRUMWIDGET_H
+#define QSPECTRUMWIDGET_H
+
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QTimer>
+#include <QWidget>
+
+#include "../Tools/SpectrumAnalyzer.h"
+
+/**
+ * @brief The QSpectrumWidget class
+ * 播放输出的频谱柱与左右声道电平表
+ *
+ * 可见时启用 SpectrumAnalyzer 并按显示帧率取最新的一帧，隐藏（包括窗口最小化）时停用。
+ * 柱高立即升到新值、按固定速度回落；电平表显示均方根，并以竖线标出峰值。
+ */
+class QSpectrumWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit QSpectrumWidget(QWidget *parent = nullptr);
+    ~QSpectrumWidget();
+
+    void setAnalyzer(SpectrumAnalyzer *analyzer);
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void onFrameTimer();
+    void reset();
+
+private:
+    QPointer<SpectrumAnalyzer> m_analyzer;
+    QTimer m_frameTimer;
+    QElapsedTimer m_elapsed;
+
+    // 以下均为 [0, 1] 的显示高度
+    float m_targetBands[SpectrumFrame::BandCount];
+    float m_bands[SpectrumFrame::BandCount];
+    float m_targetPeak[SpectrumFrame::MaxChannels];
+    float m_targetRms[SpectrumFrame::MaxChannels];
+    float m_peak[SpectrumFrame::MaxChannels];
+    float m_rms[SpectrumFrame::MaxChannels];
+};
+
+#endif // QSPECTRUMWIDGET_H
@@ -0,0 +1,146 @@
+#include "QWaveformSlider.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStyle>
+
+QWaveformSlider::QWaveformSlider(QWidget *parent)
+    : QSlider{Qt::Horizontal, parent}
+{
+}
+
+void QWaveformSlider::setPeaks(const WaveformPeaks &peaks)
+{
+    m_peaks = peaks;
+    m_columns.clear();
+    update();
+}
+
+void QWaveformSlider::clearPeaks()
+{
+    setPeaks(WaveformPeaks());
+}
+
+QSize QWaveformSlider::sizeHint() const
+{
+    QSize size = QSlider::sizeHint();
+    size.setHeight(qMax(size.height(), 32));
+    return size;
+}
+
+QSize QWaveformSlider::minimumSizeHint() const
+{
+    QSize size = QSlider::minimumSizeHint();
+    size.setHeight(qMax(size.height(), 24));
+    return size;
+}
+
+void QWaveformSlider::paintEvent(QPaintEvent *event)
+{
+    if (m_peaks.isNull()) {
+        QSlider::paintEvent(event);
+        return;
+    }
+
+    const int w = width();
+    const int h = height();
+    if (m_columns.size() != w) {
+        m_columns = m_peaks.columns(w);
+    }
+
+    const int playedX = QStyle::sliderPositionFromValue(minimum(), maximum(), value(), w);
+    const double center = h / 2.0;
+    const double scale = (h / 2.0 - 1.0) / 127.0;
+
+    // 按颜色分组后批量绘制
+    QVector<QLineF> peakLines[2];
+    QVector<QLineF> rmsLines[2];
+    peakLines[0].reserve(w);
+    peakLines[1].reserve(w);
+    rmsLines[0].reserve(w);
+    rmsLines[1].reserve(w);
+
+    for (int x = 0; x < m_columns.size(); ++x) {
+        const WaveformPeaks::Bin &bin = m_columns[x];
+        const int played = x < playedX ? 1 : 0;
+        const double px = x + 0.5;
+
+        // 至少画出一个像素，静音处也能看到基线
+        const double top = center - qMax(bin.max * scale, 0.5);
+        const double bottom = center - qMin(bin.min * scale, -0.5);
+        peakLines[played].append(QLineF(px, top, px, bottom));
+
+        const double rms = bin.rms * 127.0 / 255.0 * scale;
+        if (rms >= 0.5) {
+            rmsLines[played].append(QLineF(px, center - rms, px, center + rms));
+        }
+    }
+
+    const QColor highlight = palette().color(isEnabled() ? QPalette::Active : QPalette::Disabled, QPalette::Highlight);
+    QColor base = palette().color(QPalette::Mid);
+    QColor playedPeak = highlight;
+    playedPeak.setAlpha(140);
+    QColor unplayedPeak = base;
+    unplayedPeak.setAlpha(140);
+
+    QPainter painter(this);
+    painter.setPen(QPen(unplayedPeak, 1.0));
+    painter.drawLines(peakLines[0]);
+    painter.setPen(QPen(base.darker(130), 1.0));
+    painter.drawLines(rmsLines[0]);
+    painter.setPen(QPen(playedPeak, 1.0));
+    painter.drawLines(peakLines[1]);
+    painter.setPen(QPen(highlight, 1.0));
+    painter.drawLines(rmsLines[1]);
+
+    // 当前位置
+    painter.setPen(QPen(palette().color(QPalette::WindowText), 1.0));
+    painter.drawLine(QLineF(playedX + 0.5, 0, playedX + 0.5, h));
+}
+
+void QWaveformSlider::resizeEvent(QResizeEvent *event)
+{
+    m_columns.clear();
+    QSlider::resizeEvent(event);
+}
+
+void QWaveformSlider::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || maximum() <= minimum()) {
+        QSlider::mousePressEvent(event);
+        return;
+    }
+
+    // 直接跳到点击处并开始拖动（发出 sliderPressed 与 sliderMoved）
+    setSliderDown(true);
+    setSliderPosition(valueAt(event->position().toPoint().x()));
+    event->accept();
+}
+
+void QWaveformSlider::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!isSliderDown()) {
+        QSlider::mouseMoveEvent(event);
+        return;
+    }
+
+    setSliderPosition(valueAt(event->position().toPoint().x()));
+    event->accept();
+}
+
+void QWaveformSlider::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || !isSliderDown()) {
+        QSlider::mouseReleaseEvent(event);
+        return;
+    }
+
+    setSliderPosition(valueAt(event->position().toPoint().x()));
+    setSliderDown(false);
+    event->accept();
+}
+
+int QWaveformSlider::valueAt(int x) const
+{
+    return QStyle::sliderValueFromPosition(minimum(), maximum(), qBound(0, x, width()), width());
+}
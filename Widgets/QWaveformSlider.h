@@ -0,0 +1,44 @@
+#ifndef QWAVEFORMSLIDER_H
+#define QWAVEFORMSLIDER_H
+
+#include <QSlider>
+
+#include "../Tools/WaveformPeaks.h"
+
+/**
+ * @brief The QWaveformSlider class
+ * 以波形概览作为背景的播放进度条
+ *
+ * 设置了波形时绘制每个像素列的峰值范围与均方根，已播放的部分使用高亮色，并以竖线标出当前位置；
+ * 没有波形时按普通 QSlider 绘制。像素列只在波形或宽度变化时重新计算。
+ * 点击任意位置直接跳到该处，按下、拖动、松开时发出的信号与 QSlider 相同。
+ */
+class QWaveformSlider : public QSlider
+{
+    Q_OBJECT
+public:
+    explicit QWaveformSlider(QWidget *parent = nullptr);
+
+    void setPeaks(const WaveformPeaks &peaks);
+    void clearPeaks();
+    bool hasPeaks() const { return !m_peaks.isNull(); }
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+
+private:
+    int valueAt(int x) const;
+
+private:
+    WaveformPeaks m_peaks;
+    QVector<WaveformPeaks::Bin> m_columns;     // 每个像素列一格，宽度变化后重新计算
+};
+
+#endif // QWAVEFORMSLIDER_H
@@ -1,11 +1,16 @@
 #include "MainWindow.h"
+#include "Tools/StartupProfiler.h"
 
 #include <QApplication>
 
 
 int main(int argc, char *argv[])
 {
+    StartupProfiler::instance().start();
+
     QApplication a(argc, argv);
+    StartupProfiler::instance().mark("Qt init");
+
     MainWindow w;
     w.show();
     return a.exec();
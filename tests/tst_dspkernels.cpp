@@ -0,0 +1,317 @@
+#include <QtTest>
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+#include "Tools/DspKernels.h"
+
+namespace {
+
+// 奇数长度，覆盖向量主体与尾部
+constexpr qint64 Count = 4099;
+
+// 确定的伪随机测试数据
+QVector<float> testSignal(qint64 count)
+{
+    QVector<float> data(count);
+    quint32 state = 0x12345678u;
+    for (qint64 i = 0; i < count; ++i) {
+        state = state * 1664525u + 1013904223u;
+        data[i] = (float(state >> 8) / float(1 << 24)) * 2.5f - 1.25f;
+    }
+    // 边界值：满幅、越界、舍入的中点与 NaN
+    const float specials[] = { 1.0f, -1.0f, 0.999985f, -0.999985f, 2.0f, -2.0f, 0.5f / 32768.0f,
+                               1.5f / 32768.0f, std::numeric_limits<float>::quiet_NaN() };
+    for (qint64 i = 0; i < qint64(sizeof(specials) / sizeof(specials[0])) && i < count; ++i) {
+        data[i * 7 % count] = specials[i];
+    }
+    return data;
+}
+
+template <typename T>
+bool sameBits(const QVector<T> &a, const QVector<T> &b)
+{
+    return a.size() == b.size() && std::memcmp(a.constData(), b.constData(), size_t(a.size()) * sizeof(T)) == 0;
+}
+
+} // namespace
+
+/**
+ * @brief The TestDspKernels class
+ * 向量实现与标量实现逐位一致，以及各运算在各级别下的吞吐量
+ */
+class TestDspKernels : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void gainAndMix_data() { addLevels(); }
+    void gainAndMix();
+    void fft_data() { addLevels(); }
+    void fft();
+    void dotProduct_data() { addLevels(); }
+    void dotProduct();
+    void biquadCascade_data() { addLevels(); }
+    void biquadCascade();
+    void sampleConversion_data() { addLevels(); }
+    void sampleConversion();
+    void interleave_data() { addLevels(); }
+    void interleave();
+
+    void benchmark_data();
+    void benchmark();
+
+private:
+    // 向量级别（CPU 不支持的跳过），标量实现作为基准
+    void addLevels();
+
+    DspKernels m_reference;
+    QVector<float> m_a;
+    QVector<float> m_b;
+    QVector<float> m_gainA;
+    QVector<float> m_gainB;
+};
+
+void TestDspKernels::initTestCase()
+{
+    qInfo() << "Supported level:" << DspKernels::levelName(DspKernels::supportedLevel());
+
+    m_reference = DspKernels::forLevel(DspKernels::Scalar);
+    m_a = testSignal(Count);
+    m_b = testSignal(Count + 3).mid(3);
+    m_gainA.resize(Count);
+    m_gainB.resize(Count);
+    for (qint64 i = 0; i < Count; ++i) {
+        m_gainA[i] = std::cos(float(i) / Count);
+        m_gainB[i] = std::sin(float(i) / Count);
+    }
+}
+
+void TestDspKernels::addLevels()
+{
+    QTest::addColumn<int>("level");
+    QTest::newRow("SSE2") << int(DspKernels::Sse2);
+    QTest::newRow("AVX2") << int(DspKernels::Avx2);
+}
+
+void TestDspKernels::gainAndMix()
+{
+    QFETCH(int, level);
+    const DspKernels kernels = DspKernels::forLevel(DspKernels::Level(level));
+    if (kernels.level != level) {
+        QSKIP("Not supported by this CPU");
+    }
+
+    QVector<float> x = m_a;
+    QVector<float> y = m_a;
+    kernels.applyGain(x.data(), Count, 0.7071f);
+    m_reference.applyGain(y.data(), Count, 0.7071f);
+    QVERIFY(sameBits(x, y));
+
+    kernels.mixWeighted(x.data(), m_a.constData(), m_b.constData(), m_gainA.constData(), m_gainB.constData(), Count);
+    m_reference.mixWeighted(y.data(), m_a.constData(), m_b.constData(), m_gainA.constData(), m_gainB.constData(), Count);
+    QVERIFY(sameBits(x, y));
+
+    kernels.multiply(x.data(), m_a.constData(), m_gainA.constData(), Count);
+    m_reference.multiply(y.data(), m_a.constData(), m_gainA.constData(), Count);
+    QVERIFY(sameBits(x, y));
+}
+
+void TestDspKernels::fft()
+{
+    QFETCH(int, level);
+    const DspKernels kernels = DspKernels::forLevel(DspKernels::Level(level));
+    if (kernels.level != level) {
+        QSKIP("Not supported by this CPU");
+    }
+
+    // a、b 分别作为两组输入的实部，gainA、gainB 作为旋转因子
+    QVector<float> re0 = m_a, im0 = m_b, re1 = m_b, im1 = m_a;
+    QVector<float> re2 = m_a, im2 = m_b, re3 = m_b, im3 = m_a;
+    kernels.fftButterfly(re0.data(), im0.data(), re1.data(), im1.data(), m_gainA.constData(), m_gainB.constData(), Count);
+    m_reference.fftButterfly(re2.data(), im2.data(), re3.data(), im3.data(), m_gainA.constData(), m_gainB.constData(), Count);
+    QVERIFY(sameBits(re0, re2));
+    QVERIFY(sameBits(im0, im2));
+    QVERIFY(sameBits(re1, re3));
+    QVERIFY(sameBits(im1, im3));
+
+    QVector<float> x(Count);
+    QVector<float> y(Count);
+    kernels.magnitude(re0.constData(), im0.constData(), x.data(), Count);
+    m_reference.magnitude(re2.constData(), im2.constData(), y.data(), Count);
+    QVERIFY(sameBits(x, y));
+}
+
+void TestDspKernels::dotProduct()
+{
+    QFETCH(int, level);
+    const DspKernels kernels = DspKernels::forLevel(DspKernels::Level(level));
+    if (kernels.level != level) {
+        QSKIP("Not supported by this CPU");
+    }
+
+    // 不同长度覆盖整组与尾部
+    for (qint64 n : { qint64(7), qint64(64), qint64(317), Count }) {
+        const float x = kernels.dotProduct(m_a.constData(), m_b.constData(), n);
+        const float y = m_reference.dotProduct(m_a.constData(), m_b.constData(), n);
+        QVERIFY2(std::memcmp(&x, &y, sizeof(float)) == 0, qPrintable(QStringLiteral("length %1").arg(n)));
+    }
+}
+
+void TestDspKernels::biquadCascade()
+{
+    QFETCH(int, level);
+    const DspKernels kernels = DspKernels::forLevel(DspKernels::Level(level));
+    if (kernels.level != level) {
+        QSKIP("Not supported by this CPU");
+    }
+
+    // 稳定的高 Q 峰值滤波，覆盖各种声道数（向量的整组、部分通道与多组）
+    const float coeffs[] = { 1.0212f, -1.9561f, 0.9408f, -1.9561f, 0.9620f,
+                             0.8817f, -1.6203f, 0.7716f, -1.6203f, 0.6533f };
+    for (int channels : { 1, 2, 3, 4, 6, 8, 11 }) {
+        const qint64 frames = Count / channels;
+        QVector<float> x = m_a.mid(0, frames * channels);
+        QVector<float> y = x;
+        QVector<float> sx(2 * 2 * channels, 0.25f);
+        QVector<float> sy = sx;
+        kernels.biquadCascade(x.data(), channels, frames, coeffs, sx.data(), 2);
+        m_reference.biquadCascade(y.data(), channels, frames, coeffs, sy.data(), 2);
+        QVERIFY2(sameBits(x, y) && sameBits(sx, sy), qPrintable(QStringLiteral("%1 channels").arg(channels)));
+    }
+}
+
+void TestDspKernels::sampleConversion()
+{
+    QFETCH(int, level);
+    const DspKernels kernels = DspKernels::forLevel(DspKernels::Level(level));
+    if (kernels.level != level) {
+        QSKIP("Not supported by this CPU");
+    }
+
+    QVector<qint16> pcm16(Count);
+    {
+        QVector<qint16> y(Count);
+        kernels.floatToInt16(m_a.constData(), pcm16.data(), Count);
+        m_reference.floatToInt16(m_a.constData(), y.data(), Count);
+        QVERIFY(sameBits(pcm16, y));
+    }
+
+    QVector<float> x(Count);
+    QVector<float> y(Count);
+    kernels.int16ToFloat(pcm16.constData(), x.data(), Count);
+    m_reference.int16ToFloat(pcm16.constData(), y.data(), Count);
+    QVERIFY(sameBits(x, y));
+
+    QVector<uchar> pcm24(Count * 3);
+    for (qint64 i = 0; i < pcm24.size(); ++i) {
+        pcm24[i] = uchar(quint32(i) * 2654435761u >> 24);
+    }
+    kernels.int24ToFloat(pcm24.constData(), x.data(), Count);
+    m_reference.int24ToFloat(pcm24.constData(), y.data(), Count);
+    QVERIFY(sameBits(x, y));
+
+    QVector<qint32> pcm32(Count);
+    for (qint64 i = 0; i < Count; ++i) {
+        pcm32[i] = qint32(quint32(i) * 2654435761u);
+    }
+    kernels.int32ToFloat(pcm32.constData(), x.data(), Count);
+    m_reference.int32ToFloat(pcm32.constData(), y.data(), Count);
+    QVERIFY(sameBits(x, y));
+}
+
+void TestDspKernels::interleave()
+{
+    QFETCH(int, level);
+    const DspKernels kernels = DspKernels::forLevel(DspKernels::Level(level));
+    if (kernels.level != level) {
+        QSKIP("Not supported by this CPU");
+    }
+
+    const qint64 frames = Count / 2;
+    QVector<float> l1(frames), r1(frames), l2(frames), r2(frames);
+    kernels.deinterleaveStereo(m_a.constData(), l1.data(), r1.data(), frames);
+    m_reference.deinterleaveStereo(m_a.constData(), l2.data(), r2.data(), frames);
+    QVERIFY(sameBits(l1, l2));
+    QVERIFY(sameBits(r1, r2));
+
+    QVector<float> x(frames * 2);
+    QVector<float> y(frames * 2);
+    kernels.interleaveStereo(l1.constData(), r1.constData(), x.data(), frames);
+    m_reference.interleaveStereo(l2.constData(), r2.constData(), y.data(), frames);
+    QVERIFY(sameBits(x, y));
+}
+
+void TestDspKernels::benchmark_data()
+{
+    QTest::addColumn<int>("level");
+    QTest::addColumn<QString>("kernel");
+
+    const char *kernels[] = { "applyGain", "mixWeighted", "multiply", "fftButterfly", "magnitude", "dotProduct",
+                              "biquad10x2", "floatToInt16", "int16ToFloat", "int24ToFloat", "int32ToFloat",
+                              "deinterleave", "interleave" };
+    for (DspKernels::Level level : { DspKernels::Scalar, DspKernels::Sse2, DspKernels::Avx2 }) {
+        for (const char *kernel : kernels) {
+            QTest::addRow("%s/%s", DspKernels::levelName(level), kernel) << int(level) << QString::fromLatin1(kernel);
+        }
+    }
+}
+
+void TestDspKernels::benchmark()
+{
+    QFETCH(int, level);
+    QFETCH(QString, kernel);
+
+    const DspKernels kernels = DspKernels::forLevel(DspKernels::Level(level));
+    if (kernels.level != level) {
+        QSKIP("Not supported by this CPU");
+    }
+
+    const qint64 count = 1 << 16;
+    QVector<float> a = testSignal(count);
+    QVector<float> b = testSignal(count);
+    QVector<float> gain(count, 0.5f);
+    QVector<float> out(count);
+    QVector<qint16> pcm16(count);
+    QVector<uchar> pcm24(count * 3, 0);
+    QVector<qint32> pcm32(count, 0);
+    QVector<float> left(count / 2);
+    QVector<float> right(count / 2);
+
+    // 10 节双声道（均衡器的典型负载），静态的状态与系数，结果不影响计时
+    QVector<float> coeffs;
+    for (int s = 0; s < 10; ++s) {
+        coeffs << 1.0212f << -1.9561f << 0.9408f << -1.9561f << 0.9620f;
+    }
+    QVector<float> state(10 * 2 * 2, 0.0f);
+
+    const QHash<QString, std::function<void()>> runs = {
+        { "applyGain", [&] { kernels.applyGain(a.data(), count, 1.0f); } },
+        { "mixWeighted", [&] { kernels.mixWeighted(out.data(), a.constData(), b.constData(), gain.constData(), gain.constData(), count); } },
+        { "multiply", [&] { kernels.multiply(out.data(), a.constData(), gain.constData(), count); } },
+        { "fftButterfly", [&] { kernels.fftButterfly(a.data(), b.data(), out.data(), gain.data(), left.constData(), right.constData(), count / 2); } },
+        { "magnitude", [&] { kernels.magnitude(a.constData(), b.constData(), out.data(), count); } },
+        { "dotProduct", [&] { out[0] += kernels.dotProduct(a.constData(), b.constData(), count); } },
+        { "biquad10x2", [&] { kernels.biquadCascade(out.data(), 2, count / 2, coeffs.constData(), state.data(), 10); } },
+        { "floatToInt16", [&] { kernels.floatToInt16(a.constData(), pcm16.data(), count); } },
+        { "int16ToFloat", [&] { kernels.int16ToFloat(pcm16.constData(), out.data(), count); } },
+        { "int24ToFloat", [&] { kernels.int24ToFloat(pcm24.constData(), out.data(), count); } },
+        { "int32ToFloat", [&] { kernels.int32ToFloat(pcm32.constData(), out.data(), count); } },
+        { "deinterleave", [&] { kernels.deinterleaveStereo(a.constData(), left.data(), right.data(), count / 2); } },
+        { "interleave", [&] { kernels.interleaveStereo(left.constData(), right.constData(), out.data(), count / 2); } },
+    };
+    const std::function<void()> run = runs.value(kernel);
+    QVERIFY(run);
+
+    QBENCHMARK {
+        run();
+    }
+}
+
+QTEST_APPLESS_MAIN(TestDspKernels)
+
+#include "tst_dspkernels.moc"
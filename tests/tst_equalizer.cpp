@@ -0,0 +1,251 @@
+#include <QtTest>
+
+#include <cmath>
+#include <cstring>
+
+#include "Tools/Equalizer.h"
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+
+QVector<float> noise(qint64 count)
+{
+    QVector<float> data(count);
+    quint32 seed = 0x9e3779b9u;
+    for (float &v : data) {
+        seed = seed * 1664525u + 1013904223u;
+        v = (float(seed >> 8) / float(1 << 24)) - 0.5f;
+    }
+    return data;
+}
+
+// 每段都有增益，全部参与计算
+EqPreset alternatingPreset()
+{
+    EqPreset preset = EqPreset::graphic10();
+    for (int b = 0; b < preset.bands.size(); ++b) {
+        preset.bands[b].gainDb = (b % 2 == 0) ? 3.0 : -3.0;
+    }
+    return preset;
+}
+
+// 各声道相同的正弦
+QVector<float> sine(int sampleRate, int channels, qint64 frames, double frequency, double amplitude)
+{
+    QVector<float> data(frames * channels);
+    for (qint64 i = 0; i < frames; ++i) {
+        const float v = float(amplitude * std::sin(2.0 * Pi * frequency * i / sampleRate));
+        for (int c = 0; c < channels; ++c) {
+            data[i * channels + c] = v;
+        }
+    }
+    return data;
+}
+
+double rms(const float *data, qint64 count)
+{
+    double sum = 0.0;
+    for (qint64 i = 0; i < count; ++i) {
+        sum += double(data[i]) * data[i];
+    }
+    return std::sqrt(sum / qMax<qint64>(1, count));
+}
+
+// 第一个声道相邻采样之差的最大值，from/to 为帧号
+float maxStep(const QVector<float> &data, int channels, qint64 from, qint64 to)
+{
+    float step = 0.0f;
+    for (qint64 i = qMax<qint64>(1, from); i < to; ++i) {
+        step = std::max(step, std::fabs(data[i * channels] - data[(i - 1) * channels]));
+    }
+    return step;
+}
+
+EqPreset singleBand(EqBand::Type type, double frequency, double gainDb, double q, double preampDb = 0.0)
+{
+    EqBand band;
+    band.type = type;
+    band.frequency = frequency;
+    band.gainDb = gainDb;
+    band.q = q;
+
+    EqPreset preset;
+    preset.preampDb = preampDb;
+    preset.bands.append(band);
+    return preset;
+}
+
+bool sameBits(const QVector<float> &a, const QVector<float> &b)
+{
+    return a.size() == b.size() && std::memcmp(a.constData(), b.constData(), size_t(a.size()) * sizeof(float)) == 0;
+}
+
+} // namespace
+
+/**
+ * @brief The TestEqualizer class
+ * 平直设置下的直通，峰值与搁架滤波的增益，切换设置时的平滑过渡，以及 10 段均衡在各实现下每个采样的耗时
+ */
+class TestEqualizer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void flatIsBypassed();
+    void returnsToBypass();
+    void bandGain_data();
+    void bandGain();
+    void rampIsContinuous();
+
+    void benchmark_data();
+    void benchmark();
+};
+
+void TestEqualizer::flatIsBypassed()
+{
+    Equalizer equalizer(48000, 2);
+    const QVector<float> signal = noise(48000 * 2);
+
+    QVector<float> data = signal;
+    equalizer.process(data.data(), 48000);
+    QVERIFY(sameBits(data, signal));
+
+    equalizer.setPreset(EqPreset::graphic10());
+    data = signal;
+    equalizer.process(data.data(), 48000);
+    QVERIFY(sameBits(data, signal));
+}
+
+void TestEqualizer::returnsToBypass()
+{
+    Equalizer equalizer(48000, 2);
+    const QVector<float> signal = noise(48000 * 2);
+
+    equalizer.setPreset(alternatingPreset());
+    QVector<float> data = signal;
+    equalizer.process(data.data(), 48000);
+    QVERIFY(!sameBits(data, signal));
+
+    // 过渡完成后恢复直通，不留滤波器的余响
+    equalizer.setPreset(EqPreset::graphic10());
+    data = signal;
+    equalizer.process(data.data(), 48000);
+    data = signal;
+    equalizer.process(data.data(), 48000);
+    QVERIFY(sameBits(data, signal));
+}
+
+void TestEqualizer::bandGain_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::addColumn<double>("frequency");
+    QTest::addColumn<double>("q");
+    QTest::addColumn<double>("probe");
+    QTest::addColumn<double>("expectedDb");
+
+    // +6 dB 的频段：峰值滤波在中心频率处，搁架滤波在搁架一侧远离转折频率处达到设定增益，另一侧不受影响
+    QTest::newRow("peaking centre") << int(EqBand::Peaking) << 1000.0 << 1.41 << 1000.0 << 6.0;
+    QTest::newRow("peaking far") << int(EqBand::Peaking) << 1000.0 << 1.41 << 100.0 << 0.0;
+    QTest::newRow("low shelf below") << int(EqBand::LowShelf) << 100.0 << 0.7071 << 20.0 << 6.0;
+    QTest::newRow("low shelf above") << int(EqBand::LowShelf) << 100.0 << 0.7071 << 5000.0 << 0.0;
+    QTest::newRow("high shelf above") << int(EqBand::HighShelf) << 5000.0 << 0.7071 << 20000.0 << 6.0;
+    QTest::newRow("high shelf below") << int(EqBand::HighShelf) << 5000.0 << 0.7071 << 100.0 << 0.0;
+}
+
+void TestEqualizer::bandGain()
+{
+    QFETCH(int, type);
+    QFETCH(double, frequency);
+    QFETCH(double, q);
+    QFETCH(double, probe);
+    QFETCH(double, expectedDb);
+
+    const int sampleRate = 48000;
+    const int channels = 2;
+    const QVector<float> signal = sine(sampleRate, channels, sampleRate, probe, 0.25);
+
+    Equalizer equalizer(sampleRate, channels);
+    equalizer.setPreset(singleBand(EqBand::Type(type), frequency, 6.0, q));
+    QVector<float> data = signal;
+    equalizer.process(data.data(), sampleRate);
+
+    // 只比较后半秒，过渡与滤波器的起振都已结束
+    const qint64 offset = qint64(sampleRate / 2) * channels;
+    const qint64 count = data.size() - offset;
+    const double db = 20.0 * std::log10(rms(data.constData() + offset, count) / rms(signal.constData() + offset, count));
+    QVERIFY2(std::fabs(db - expectedDb) <= 0.1, qPrintable(QStringLiteral("%1 dB").arg(db)));
+}
+
+void TestEqualizer::rampIsContinuous()
+{
+    // 正弦播放中途两次切换设置（中心频率处 +12 dB，再到 -12 dB），切换发生在波形的任意相位
+    const int sampleRate = 48000;
+    const int channels = 2;
+    const int block = 512;
+    const double frequency = 997.0;
+    QVector<float> data = sine(sampleRate, channels, qint64(sampleRate) * 2, frequency, 0.2);
+
+    Equalizer equalizer(sampleRate, channels);
+    const int blocks = int(data.size() / channels / block);
+    for (int b = 0; b < blocks; ++b) {
+        if (b == 10) {
+            equalizer.setPreset(singleBand(EqBand::Peaking, frequency, 6.0, 1.41, 6.0));
+        } else if (b == 40) {
+            equalizer.setPreset(singleBand(EqBand::Peaking, frequency, -6.0, 1.41, -6.0));
+        }
+        equalizer.process(data.data() + qint64(b) * block * channels, block);
+    }
+
+    // 直接换用新系数时，采样之间的跳变远大于 +12 dB 稳定后的正弦；过渡中不应超出后者太多
+    const float steady = maxStep(data, channels, 20 * block, 39 * block);
+    const float rise = maxStep(data, channels, 9 * block, 13 * block);
+    const float fall = maxStep(data, channels, 39 * block, 43 * block);
+    QVERIFY2(rise <= 1.5f * steady, qPrintable(QStringLiteral("%1 / %2").arg(rise).arg(steady)));
+    QVERIFY2(fall <= 1.5f * steady, qPrintable(QStringLiteral("%1 / %2").arg(fall).arg(steady)));
+}
+
+void TestEqualizer::benchmark_data()
+{
+    QTest::addColumn<int>("level");
+    for (DspKernels::Level level : { DspKernels::Scalar, DspKernels::Sse2, DspKernels::Avx2 }) {
+        QTest::newRow(DspKernels::levelName(level)) << int(level);
+    }
+}
+
+void TestEqualizer::benchmark()
+{
+    QFETCH(int, level);
+    const DspKernels kernels = DspKernels::forLevel(DspKernels::Level(level));
+    if (kernels.level != level) {
+        QSKIP("Not supported by this CPU");
+    }
+
+    // 10 段均衡，192 kHz 双声道一秒
+    const int sampleRate = 192000;
+    const int channels = 2;
+    const QVector<float> signal = noise(qint64(sampleRate) * channels);
+
+    Equalizer equalizer(sampleRate, channels, kernels);
+    equalizer.setPreset(alternatingPreset());
+
+    // 先完成系数过渡，只计时稳定状态
+    QVector<float> data = signal;
+    equalizer.process(data.data(), sampleRate);
+
+    // 每次恢复输入不计入耗时，结果以每个采样（每声道）的纳秒数报告
+    constexpr int Iterations = 20;
+    QElapsedTimer timer;
+    qint64 elapsed = 0;
+    for (int i = 0; i < Iterations; ++i) {
+        data = signal;
+        timer.start();
+        equalizer.process(data.data(), sampleRate);
+        elapsed += timer.nsecsElapsed();
+    }
+    QTest::setBenchmarkResult(double(elapsed) / (double(Iterations) * signal.size()), QTest::WalltimeNanoseconds);
+}
+
+QTEST_APPLESS_MAIN(TestEqualizer)
+
+#include "tst_equalizer.moc"
@@ -0,0 +1,128 @@
+#include <QtTest>
+
+#include <cmath>
+#include <complex>
+
+#include "Tools/Fft.h"
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+
+QVector<float> noise(qint64 count, quint32 seed)
+{
+    QVector<float> data(count);
+    for (float &v : data) {
+        seed = seed * 1664525u + 1013904223u;
+        v = (float(seed >> 8) / float(1 << 24)) - 0.5f;
+    }
+    return data;
+}
+
+// 按定义以双精度计算的 DFT，旋转因子按 n * k mod size 查表，避免大角度的误差
+QVector<std::complex<double>> naiveDft(const QVector<float> &re, const QVector<float> &im)
+{
+    const int size = re.size();
+    QVector<std::complex<double>> twiddle(size);
+    for (int i = 0; i < size; ++i) {
+        twiddle[i] = std::polar(1.0, -2.0 * Pi * i / size);
+    }
+
+    QVector<std::complex<double>> out(size);
+    for (int k = 0; k < size; ++k) {
+        std::complex<double> sum;
+        for (int n = 0; n < size; ++n) {
+            sum += std::complex<double>(re[n], im[n]) * twiddle[int((qint64(n) * k) % size)];
+        }
+        out[k] = sum;
+    }
+    return out;
+}
+
+} // namespace
+
+/**
+ * @brief The TestFft class
+ * 各长度下与直接计算的 DFT 比较，以及单一频点的余弦只落在对应的两个频点上
+ */
+class TestFft : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void matchesDft_data();
+    void matchesDft();
+    void singleBin_data();
+    void singleBin();
+};
+
+void TestFft::matchesDft_data()
+{
+    QTest::addColumn<int>("size");
+    for (int size : { 4, 8, 16, 64, 256, 1024, 2048, 4096 }) {
+        QTest::addRow("%d", size) << size;
+    }
+}
+
+void TestFft::matchesDft()
+{
+    QFETCH(int, size);
+
+    QVector<float> re = noise(size, 0x9e3779b9u);
+    QVector<float> im = noise(size, 0x7f4a7c15u);
+    const QVector<std::complex<double>> expected = naiveDft(re, im);
+
+    Fft fft(size);
+    QCOMPARE(fft.size(), size);
+    fft.transform(re.data(), im.data());
+
+    // 单精度的误差随级数缓慢增长，按整体的相对误差（二范数）比较
+    double error = 0.0;
+    double norm = 0.0;
+    for (int k = 0; k < size; ++k) {
+        error += std::norm(std::complex<double>(re[k], im[k]) - expected[k]);
+        norm += std::norm(expected[k]);
+    }
+    const double relative = std::sqrt(error / norm);
+    QVERIFY2(relative <= 1e-5, qPrintable(QStringLiteral("relative error %1").arg(relative)));
+}
+
+void TestFft::singleBin_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("bin");
+
+    QTest::newRow("4 / 1") << 4 << 1;
+    QTest::newRow("64 / 3") << 64 << 3;
+    QTest::newRow("1024 / 1") << 1024 << 1;
+    QTest::newRow("1024 / 100") << 1024 << 100;
+    QTest::newRow("2048 / 511") << 2048 << 511;
+    QTest::newRow("4096 / 2047") << 4096 << 2047;
+}
+
+void TestFft::singleBin()
+{
+    QFETCH(int, size);
+    QFETCH(int, bin);
+
+    // cos(2 pi bin n / size) 的变换在 bin 与 size - bin 处为实数 size / 2，其余频点为 0
+    QVector<float> re(size);
+    QVector<float> im(size, 0.0f);
+    for (int n = 0; n < size; ++n) {
+        re[n] = float(std::cos(2.0 * Pi * double((qint64(n) * bin) % size) / size));
+    }
+
+    Fft fft(size);
+    fft.transform(re.data(), im.data());
+
+    const double tolerance = size * 1e-5;
+    for (int k = 0; k < size; ++k) {
+        const double expected = (k == bin || k == size - bin) ? size / 2.0 : 0.0;
+        QVERIFY2(std::fabs(re[k] - expected) <= tolerance && std::fabs(im[k]) <= tolerance,
+                 qPrintable(QStringLiteral("bin %1: %2 %3i").arg(k).arg(re[k]).arg(im[k])));
+    }
+}
+
+QTEST_APPLESS_MAIN(TestFft)
+
+#include "tst_fft.moc"
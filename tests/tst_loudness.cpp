@@ -0,0 +1,191 @@
+#include <QtTest>
+
+#include <cmath>
+#include <optional>
+
+#include "Tools/LoudnessMeter.h"
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+constexpr int Channels = 2;
+
+// 峰值为 dbfs 的正弦追加到 data，各声道相同；dbfs 为空时追加静音
+void appendSine(QVector<float> &data, int sampleRate, double seconds, std::optional<double> dbfs,
+                double frequency = 1000.0, double phase = 0.0)
+{
+    const qint64 frames = std::llround(seconds * sampleRate);
+    const double amplitude = dbfs ? std::pow(10.0, *dbfs / 20.0) : 0.0;
+    const qint64 offset = data.size();
+    data.resize(offset + frames * Channels);
+    for (qint64 i = 0; i < frames; ++i) {
+        const float v = float(amplitude * std::sin(2.0 * Pi * frequency * i / sampleRate + phase));
+        for (int c = 0; c < Channels; ++c) {
+            data[offset + i * Channels + c] = v;
+        }
+    }
+}
+
+// 与解码时一样分块送入，块长不规则
+LoudnessInfo measure(int sampleRate, const QVector<float> &data)
+{
+    LoudnessMeter meter(sampleRate, Channels);
+    const qint64 frames = data.size() / Channels;
+    quint32 seed = 12345u;
+    for (qint64 offset = 0; offset < frames;) {
+        seed = seed * 1664525u + 1013904223u;
+        const qint64 n = qMin<qint64>(frames - offset, 1 + (seed >> 8) % 8192);
+        meter.process(data.constData() + offset * Channels, n);
+        offset += n;
+    }
+    return meter.result();
+}
+
+} // namespace
+
+/**
+ * @brief The TestLoudness class
+ * BS.1770 响度计按 EBU Tech 3341 的方式校验：正弦的积分响度、绝对与相对门限、4 倍过采样的真峰值，
+ * 以及直方图合并得到的专辑响度；另测量响度计的处理速度
+ */
+class TestLoudness : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sineLevel_data();
+    void sineLevel();
+    void gating_data();
+    void gating();
+    void truePeak_data();
+    void truePeak();
+    void albumMerge();
+
+    void benchmark();
+};
+
+void TestLoudness::sineLevel_data()
+{
+    QTest::addColumn<int>("sampleRate");
+    QTest::newRow("44100") << 44100;
+    QTest::newRow("48000") << 48000;
+}
+
+void TestLoudness::sineLevel()
+{
+    QFETCH(int, sampleRate);
+
+    // 1 kHz、-23 dBFS 的立体声正弦为 -23 LUFS
+    QVector<float> data;
+    appendSine(data, sampleRate, 20.0, -23.0);
+    const LoudnessInfo info = measure(sampleRate, data);
+
+    QVERIFY(info.isValid());
+    QVERIFY2(std::fabs(info.integrated + 23.0) <= 0.1, qPrintable(QString::number(info.integrated)));
+    QCOMPARE(info.durationMs, qint64(20000));
+}
+
+void TestLoudness::gating_data()
+{
+    QTest::addColumn<QVector<float>>("data");
+
+    // 低于相对门限的段落不计入
+    QVector<float> relative;
+    appendSine(relative, 48000, 10.0, -36.0);
+    appendSine(relative, 48000, 60.0, -23.0);
+    appendSine(relative, 48000, 10.0, -36.0);
+    QTest::newRow("relative") << relative;
+
+    // 静音与低于绝对门限的段落不计入
+    QVector<float> absolute;
+    appendSine(absolute, 48000, 10.0, std::nullopt);
+    appendSine(absolute, 48000, 20.0, -23.0);
+    appendSine(absolute, 48000, 10.0, -80.0);
+    appendSine(absolute, 48000, 5.0, std::nullopt);
+    QTest::newRow("absolute") << absolute;
+
+    // 高低交替，积分响度由相对门限之上的部分共同决定
+    QVector<float> mixed;
+    appendSine(mixed, 48000, 20.0, -26.0);
+    appendSine(mixed, 48000, 20.1, -20.0);
+    appendSine(mixed, 48000, 20.0, -26.0);
+    QTest::newRow("mixed") << mixed;
+}
+
+void TestLoudness::gating()
+{
+    QFETCH(QVector<float>, data);
+
+    const LoudnessInfo info = measure(48000, data);
+    QVERIFY2(std::fabs(info.integrated + 23.0) <= 0.1, qPrintable(QString::number(info.integrated)));
+}
+
+void TestLoudness::truePeak_data()
+{
+    QTest::addColumn<int>("sampleRate");
+    QTest::newRow("44100") << 44100;
+    QTest::newRow("48000") << 48000;
+}
+
+void TestLoudness::truePeak()
+{
+    QFETCH(int, sampleRate);
+
+    // 四分之一采样率、相位 45° 的满幅正弦：采样峰值只有 -3 dB，样点之间的真峰值为 0 dBTP
+    QVector<float> data;
+    appendSine(data, sampleRate, 5.0, 0.0, sampleRate / 4.0, Pi / 4.0);
+
+    float samplePeak = 0.0f;
+    for (float v : std::as_const(data)) {
+        samplePeak = std::max(samplePeak, std::fabs(v));
+    }
+    QVERIFY(20.0 * std::log10(samplePeak) < -2.9);
+
+    // Tech 3341 对 4 倍过采样允许 +0.2 / -0.4 dB
+    const LoudnessInfo info = measure(sampleRate, data);
+    const double db = 20.0 * std::log10(info.truePeak);
+    QVERIFY2(db > -0.4 && db < 0.2, qPrintable(QStringLiteral("%1 dBTP").arg(db)));
+}
+
+void TestLoudness::albumMerge()
+{
+    QVector<float> first;
+    appendSine(first, 48000, 30.0, -20.0);
+    QVector<float> second;
+    appendSine(second, 48000, 30.0, -26.0, 440.0);
+
+    const LoudnessInfo a = measure(48000, first);
+    const LoudnessInfo b = measure(48000, second);
+    double merged = 0.0;
+    QVERIFY(LoudnessInfo::combinedLoudness({ &a, &b }, merged));
+
+    // 与两首连在一起测量的结果一致，误差来自直方图的分辨率与交界处跨越两首的门限块
+    const LoudnessInfo whole = measure(48000, first + second);
+    QVERIFY2(std::fabs(merged - whole.integrated) <= 0.05,
+             qPrintable(QStringLiteral("%1 / %2").arg(merged).arg(whole.integrated)));
+
+    // 没有有效门限块时不给出结果
+    const LoudnessInfo silent;
+    QVERIFY(!LoudnessInfo::combinedLoudness({ &silent }, merged));
+}
+
+void TestLoudness::benchmark()
+{
+    // 48 kHz 双声道十秒（K 计权、门限块与真峰值）
+    QVector<float> data(48000 * 10 * Channels);
+    quint32 seed = 0x9e3779b9u;
+    for (float &v : data) {
+        seed = seed * 1664525u + 1013904223u;
+        v = (float(seed >> 8) / float(1 << 24)) - 0.5f;
+    }
+
+    QBENCHMARK {
+        LoudnessMeter meter(48000, Channels);
+        meter.process(data.constData(), data.size() / Channels);
+        QVERIFY(meter.result().isValid());
+    }
+}
+
+QTEST_APPLESS_MAIN(TestLoudness)
+
+#include "tst_loudness.moc"
@@ -0,0 +1,570 @@
+#include <QtTest>
+
+#include <QMediaMetaData>
+#include <QTemporaryDir>
+
+#include "Tools/MediaMetadataExtractor.h"
+#include "Tools/NativeTagReader.h"
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// 字节序写入
+// ---------------------------------------------------------------------------
+
+QByteArray be16(quint16 v)
+{
+    return QByteArray({ char(v >> 8), char(v) });
+}
+
+QByteArray be32(quint32 v)
+{
+    return QByteArray({ char(v >> 24), char(v >> 16), char(v >> 8), char(v) });
+}
+
+QByteArray be64(quint64 v)
+{
+    return be32(quint32(v >> 32)) + be32(quint32(v));
+}
+
+QByteArray le16(quint16 v)
+{
+    return QByteArray({ char(v), char(v >> 8) });
+}
+
+QByteArray le32(quint32 v)
+{
+    return QByteArray({ char(v), char(v >> 8), char(v >> 16), char(v >> 24) });
+}
+
+QByteArray le64(quint64 v)
+{
+    return le32(quint32(v)) + le32(quint32(v >> 32));
+}
+
+QByteArray syncSafe(quint32 v)
+{
+    return QByteArray({ char((v >> 21) & 0x7F), char((v >> 14) & 0x7F), char((v >> 7) & 0x7F), char(v & 0x7F) });
+}
+
+// ---------------------------------------------------------------------------
+// MPEG：MPEG-1 Layer III、128 kbps、44.1 kHz 立体声，每帧 417 字节
+// ---------------------------------------------------------------------------
+
+constexpr int kMpegFrameLength = 417;
+
+QByteArray mpegFrame(const QByteArray &payload = QByteArray())
+{
+    QByteArray frame("\xFF\xFB\x90\x00", 4);
+    frame += payload;
+    frame.resize(kMpegFrameLength, '\0');
+    return frame;
+}
+
+QByteArray mpegFrames(int count)
+{
+    QByteArray data;
+    for (int i = 0; i < count; ++i) {
+        data += mpegFrame();
+    }
+    return data;
+}
+
+// 首帧中的 Xing/Info 头与 LAME 扩展：总帧数、编码器延迟与填充
+QByteArray lameFrame(quint32 totalFrames, int delay, int padding)
+{
+    QByteArray payload(32, '\0');               // 立体声 MPEG-1 的边信息
+    payload += "Info";
+    payload += be32(0x01);
+    payload += be32(totalFrames);
+    payload += "LAME3.100";
+    payload += QByteArray(12, '\0');            // 修订、低通、回放增益、编码标志、码率
+    payload += char(delay >> 4);
+    payload += char(((delay & 0x0F) << 4) | (padding >> 8));
+    payload += char(padding & 0xFF);
+    return mpegFrame(payload);
+}
+
+// Fraunhofer 编码器的 VBRI 头：固定位于帧头后 32 字节，总帧数在其后 14 字节处
+QByteArray vbriFrame(quint32 totalFrames)
+{
+    QByteArray payload(32, '\0');
+    payload += "VBRI";
+    payload += be16(1) + be16(0) + be16(75) + be32(0) + be32(totalFrames);
+    return mpegFrame(payload);
+}
+
+QByteArray id3Frame(int major, const QByteArray &id, const QByteArray &text)
+{
+    const QByteArray data = '\x03' + text;      // UTF-8
+    if (major == 2) {
+        return id + be32(quint32(data.size())).mid(1) + data;
+    }
+    const QByteArray size = (major == 4) ? syncSafe(quint32(data.size())) : be32(quint32(data.size()));
+    return id + size + QByteArray(2, '\0') + data;
+}
+
+QByteArray id3Tag(int major, const QByteArray &frames, quint32 declaredSize = 0)
+{
+    QByteArray tag("ID3");
+    tag += char(major);
+    tag += '\0';
+    tag += '\0';
+    tag += syncSafe(declaredSize ? declaredSize : quint32(frames.size()));
+    return tag + frames;
+}
+
+QByteArray id3v2Frames(int major)
+{
+    if (major == 2) {
+        return id3Frame(2, "TT2", "Title") + id3Frame(2, "TP1", "Artist") + id3Frame(2, "TAL", "Album")
+               + id3Frame(2, "TRK", "3/12") + id3Frame(2, "TCO", "(17)");
+    }
+    return id3Frame(major, "TIT2", "Title") + id3Frame(major, "TPE1", "Artist") + id3Frame(major, "TALB", "Album")
+           + id3Frame(major, "TRCK", "3/12") + id3Frame(major, "TCON", "(17)");
+}
+
+QByteArray id3v1Tag()
+{
+    auto field = [](const QByteArray &text, int length) {
+        QByteArray raw = text;
+        raw.resize(length, '\0');
+        return raw;
+    };
+    return "TAG" + field("Title", 30) + field("Artist", 30) + field("Album", 30) + "2001"
+           + field("Comment", 28) + '\0' + char(3) + char(17);
+}
+
+// ---------------------------------------------------------------------------
+// FLAC、Ogg
+// ---------------------------------------------------------------------------
+
+QByteArray vorbisComment(const QList<QByteArray> &entries)
+{
+    const QByteArray vendor("test");
+    QByteArray data = le32(quint32(vendor.size())) + vendor + le32(quint32(entries.size()));
+    for (const QByteArray &entry : entries) {
+        data += le32(quint32(entry.size())) + entry;
+    }
+    return data;
+}
+
+const QList<QByteArray> kComments = { "TITLE=Title", "ARTIST=Artist", "ALBUM=Album", "TRACKNUMBER=3" };
+
+QByteArray flacBlock(int type, const QByteArray &payload, bool last, quint32 declaredLength = 0)
+{
+    const quint32 length = declaredLength ? declaredLength : quint32(payload.size());
+    QByteArray header;
+    header += char((last ? 0x80 : 0) | type);
+    header += be32(length).mid(1);
+    return header + payload;
+}
+
+// 44.1 kHz 立体声 16 位，441000 帧（10 秒）
+QByteArray flacStreamInfo()
+{
+    const quint32 rate = 44100;
+    const quint64 total = 441000;
+    QByteArray info(10, '\0');
+    info += char(rate >> 12);
+    info += char(rate >> 4);
+    info += char(((rate & 0x0F) << 4) | (1 << 1) | (15 >> 4));
+    info += char(((15 & 0x0F) << 4) | int((total >> 32) & 0x0F));
+    info += be32(quint32(total));
+    info += QByteArray(16, '\0');               // MD5
+    return info;
+}
+
+QByteArray flacFile(quint32 commentLength = 0)
+{
+    return "fLaC" + flacBlock(0, flacStreamInfo(), false) + flacBlock(6, QByteArray(64, '\x55'), false)
+           + flacBlock(4, vorbisComment(kComments), true, commentLength) + QByteArray(256, '\0');
+}
+
+// 一页只放一个包
+QByteArray oggPage(quint8 headerType, quint64 granule, quint32 sequence, const QByteArray &packet)
+{
+    QByteArray lacing;
+    qsizetype remaining = packet.size();
+    while (remaining >= 255) {
+        lacing += char(255);
+        remaining -= 255;
+    }
+    lacing += char(remaining);
+
+    QByteArray page("OggS");
+    page += '\0';
+    page += char(headerType);
+    page += le64(granule);
+    page += le32(1234);
+    page += le32(sequence);
+    page += le32(0);                            // 校验和不参与解析
+    page += char(lacing.size());
+    return page + lacing + packet;
+}
+
+QByteArray oggVorbisFile()
+{
+    QByteArray ident("\x01vorbis");
+    ident += le32(0) + char(2) + le32(44100) + le32(0) + le32(128000) + le32(0) + char(0xB8) + char(1);
+    const QByteArray comment = "\x03vorbis" + vorbisComment(kComments) + char(1);
+    return oggPage(0x02, 0, 0, ident) + oggPage(0x00, 0, 1, comment)
+           + oggPage(0x04, 441000, 2, QByteArray(300, '\0'));
+}
+
+QByteArray oggOpusFile()
+{
+    QByteArray ident("OpusHead");
+    ident += char(1);                           // 版本
+    ident += char(2);                           // 声道数
+    ident += le16(312) + le32(48000) + le16(0) + char(0);
+    const QByteArray comment = "OpusTags" + vorbisComment(kComments);
+    return oggPage(0x02, 0, 0, ident) + oggPage(0x00, 0, 1, comment)
+           + oggPage(0x04, 480312, 2, QByteArray(300, '\0'));
+}
+
+// ---------------------------------------------------------------------------
+// MP4
+// ---------------------------------------------------------------------------
+
+QByteArray atom(const QByteArray &type, const QByteArray &payload)
+{
+    return be32(quint32(8 + payload.size())) + type + payload;
+}
+
+QByteArray mp4File(const QByteArray &trailer = QByteArray())
+{
+    const QByteArray ftyp = atom("ftyp", "M4A " + be32(0) + "M4A mp42isom");
+
+    QByteArray mvhdPayload = be32(0) + be32(0) + be32(0) + be32(1000) + be32(10000);
+    mvhdPayload.resize(100, '\0');
+
+    // stsd：版本与标志、条目数，之后的首个条目到采样率（16.16 定点数）为止
+    QByteArray entry = "mp4a" + QByteArray(6, '\0') + be16(1) + QByteArray(8, '\0')
+                       + be16(2) + be16(16) + be16(0) + be16(0) + be32(44100u << 16);
+    const QByteArray stsd = atom("stsd", be32(0) + be32(1) + be32(quint32(4 + entry.size())) + entry);
+    const QByteArray trak = atom("trak", atom("mdia", atom("minf", atom("stbl", stsd))));
+
+    auto dataAtom = [](quint32 type, const QByteArray &value) {
+        return atom("data", be32(type) + be32(0) + value);
+    };
+    const QByteArray ilst = atom("ilst",
+        atom("\xA9nam", dataAtom(1, "Title"))
+        + atom("\xA9" "ART", dataAtom(1, "Artist"))
+        + atom("\xA9" "alb", dataAtom(1, "Album"))
+        + atom("trkn", dataAtom(0, QByteArray("\0\0\0\x05\0\x0C\0\0", 8)))
+        + atom("covr", dataAtom(13, QByteArray(128, '\x55')))
+        + atom("----", atom("mean", be32(0) + "com.apple.iTunes") + atom("name", be32(0) + "iTunSMPB")
+                       + dataAtom(1, " 00000000 00000840 000001CA 00000000003F31F6 00000000 00000000")));
+    const QByteArray hdlr = atom("hdlr", be32(0) + be32(0) + "mdir" + "appl" + QByteArray(9, '\0'));
+    const QByteArray udta = atom("udta", atom("meta", be32(0) + hdlr + ilst));
+
+    const QByteArray moov = atom("moov", atom("mvhd", mvhdPayload) + trak + udta);
+    return ftyp + moov + trailer + atom("mdat", QByteArray(1000, '\0'));
+}
+
+// ---------------------------------------------------------------------------
+// RIFF
+// ---------------------------------------------------------------------------
+
+QByteArray riffFmt()
+{
+    const QByteArray fmt = le16(1) + le16(2) + le32(44100) + le32(176400) + le16(4) + le16(16);
+    return "fmt " + le32(quint32(fmt.size())) + fmt;
+}
+
+QByteArray riff(const QByteArray &chunks)
+{
+    return "RIFF" + le32(quint32(4 + chunks.size())) + "WAVE" + chunks;
+}
+
+QByteArray riffFile(quint32 listSize = 0)
+{
+    const QByteArray info = "INFO" + QByteArray("INAM") + le32(6) + QByteArray("Title\0", 6)
+                            + "IART" + le32(7) + QByteArray("Artist\0", 7) + '\0';
+    const QByteArray list = "LIST" + le32(listSize ? listSize : quint32(info.size())) + info;
+    return riff(riffFmt() + "data" + le32(17640) + QByteArray(17640, '\0') + list);
+}
+
+// ---------------------------------------------------------------------------
+
+QVariant value(const QVariantMap &metadata, QMediaMetaData::Key key)
+{
+    return metadata.value(MediaMetadataExtractor::metaDataKeyToString(key));
+}
+
+} // namespace
+
+/**
+ * @brief The TestNativeTagReader class
+ * 以生成的小文件校验各容器的标签、时长与无缝播放信息，以及截断、零长度与声明长度过大的文件
+ */
+class TestNativeTagReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void tags_data();
+    void tags();
+    void mpegDuration();
+    void id3v1();
+    void mpegGapless();
+    void mp4Gapless();
+
+    void truncated_data();
+    void truncated();
+    void empty_data();
+    void empty();
+    void oversizedLengths_data();
+    void oversizedLengths();
+
+private:
+    QString writeFile(const QString &name, const QByteArray &data);
+
+    QTemporaryDir m_dir;
+};
+
+void TestNativeTagReader::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+}
+
+QString TestNativeTagReader::writeFile(const QString &name, const QByteArray &data)
+{
+    const QString path = m_dir.filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(data) != data.size()) {
+        return QString();
+    }
+    return path;
+}
+
+void TestNativeTagReader::tags_data()
+{
+    QTest::addColumn<QString>("name");
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<qint64>("durationMs");
+
+    QTest::newRow("id3v2.2") << "v22.mp3" << (id3Tag(2, id3v2Frames(2)) + mpegFrames(4)) << qint64(-1);
+    QTest::newRow("id3v2.3") << "v23.mp3" << (id3Tag(3, id3v2Frames(3)) + mpegFrames(4)) << qint64(-1);
+    QTest::newRow("id3v2.4") << "v24.mp3" << (id3Tag(4, id3v2Frames(4)) + mpegFrames(4)) << qint64(-1);
+    QTest::newRow("flac") << "a.flac" << flacFile() << qint64(10000);
+    QTest::newRow("vorbis") << "a.ogg" << oggVorbisFile() << qint64(10000);
+    QTest::newRow("opus") << "a.opus" << oggOpusFile() << qint64(10000);
+    QTest::newRow("mp4") << "a.m4a" << mp4File() << qint64(10000);
+    QTest::newRow("riff") << "a.wav" << riffFile() << qint64(100);
+}
+
+void TestNativeTagReader::tags()
+{
+    QFETCH(QString, name);
+    QFETCH(QByteArray, data);
+    QFETCH(qint64, durationMs);
+
+    const QString path = writeFile(name, data);
+    QVERIFY(!path.isEmpty());
+
+    QVariantMap metadata;
+    QVERIFY(NativeTagReader::read(path, metadata));
+    QCOMPARE(value(metadata, QMediaMetaData::Title).toString(), QStringLiteral("Title"));
+    QCOMPARE(value(metadata, QMediaMetaData::ContributingArtist).toString(), QStringLiteral("Artist"));
+    if (!name.endsWith(".wav")) {
+        QCOMPARE(value(metadata, QMediaMetaData::AlbumTitle).toString(), QStringLiteral("Album"));
+        QCOMPARE(value(metadata, QMediaMetaData::TrackNumber).toInt(), name.endsWith(".m4a") ? 5 : 3);
+    }
+    if (name.endsWith(".mp3")) {
+        QCOMPARE(value(metadata, QMediaMetaData::Genre).toString(), QStringLiteral("Rock"));
+    }
+    if (durationMs >= 0) {
+        QCOMPARE(value(metadata, QMediaMetaData::Duration).toLongLong(), durationMs);
+    }
+}
+
+void TestNativeTagReader::mpegDuration()
+{
+    // CBR：时长由音频字节数与码率得出；VBR：由 Xing 或 VBRI 头中的总帧数得出
+    const QByteArray tag = id3Tag(3, id3v2Frames(3));
+    QVariantMap metadata;
+    QVERIFY(NativeTagReader::read(writeFile("cbr.mp3", tag + mpegFrames(100)), metadata));
+    QCOMPARE(value(metadata, QMediaMetaData::Duration).toLongLong(), qint64(100) * kMpegFrameLength * 8 / 128);
+
+    metadata.clear();
+    QVERIFY(NativeTagReader::read(writeFile("vbr.mp3", tag + lameFrame(1000, 576, 1000) + mpegFrames(4)), metadata));
+    QCOMPARE(value(metadata, QMediaMetaData::Duration).toLongLong(), qint64(1000) * 1152 * 1000 / 44100);
+
+    metadata.clear();
+    QVERIFY(NativeTagReader::read(writeFile("vbri.mp3", tag + vbriFrame(2000) + mpegFrames(4)), metadata));
+    QCOMPARE(value(metadata, QMediaMetaData::Duration).toLongLong(), qint64(2000) * 1152 * 1000 / 44100);
+}
+
+void TestNativeTagReader::id3v1()
+{
+    QVariantMap metadata;
+    QVERIFY(NativeTagReader::read(writeFile("v1.mp3", mpegFrames(4) + id3v1Tag()), metadata));
+    QCOMPARE(value(metadata, QMediaMetaData::Title).toString(), QStringLiteral("Title"));
+    QCOMPARE(value(metadata, QMediaMetaData::AlbumTitle).toString(), QStringLiteral("Album"));
+    QCOMPARE(value(metadata, QMediaMetaData::TrackNumber).toInt(), 3);
+    QCOMPARE(value(metadata, QMediaMetaData::Genre).toString(), QStringLiteral("Rock"));
+    QCOMPARE(value(metadata, QMediaMetaData::Comment).toString(), QStringLiteral("Comment"));
+
+    // ID3v2 优先于文件末尾的 ID3v1
+    metadata.clear();
+    const QByteArray v2 = id3Tag(3, id3Frame(3, "TIT2", "Newer"));
+    QVERIFY(NativeTagReader::read(writeFile("v1v2.mp3", v2 + mpegFrames(4) + id3v1Tag()), metadata));
+    QCOMPARE(value(metadata, QMediaMetaData::Title).toString(), QStringLiteral("Newer"));
+}
+
+void TestNativeTagReader::mpegGapless()
+{
+    // LAME 头中的延迟加上解码器的 529 帧，填充减去同样的 529 帧
+    const QString path = writeFile("gapless.mp3", id3Tag(3, id3v2Frames(3)) + lameFrame(1000, 576, 1000) + mpegFrames(4));
+    GaplessInfo info;
+    QVERIFY(NativeTagReader::readGapless(path, info));
+    QCOMPARE(info.sampleRate, 44100);
+    QCOMPARE(info.encoderDelay, qint64(576 + 529));
+    QCOMPARE(info.padding, qint64(1000 - 529));
+    QCOMPARE(info.validFrames, qint64(1000) * 1152 - 576 - 1000);
+
+    // 没有 LAME 扩展时没有无缝播放信息
+    QVERIFY(!NativeTagReader::readGapless(writeFile("plain.mp3", mpegFrames(4)), info));
+}
+
+void TestNativeTagReader::mp4Gapless()
+{
+    GaplessInfo info;
+    QVERIFY(NativeTagReader::readGapless(writeFile("gapless.m4a", mp4File()), info));
+    QCOMPARE(info.sampleRate, 44100);
+    QCOMPARE(info.encoderDelay, qint64(0x840));
+    QCOMPARE(info.padding, qint64(0x1CA));
+    QCOMPARE(info.validFrames, qint64(0x3F31F6));
+}
+
+void TestNativeTagReader::truncated_data()
+{
+    QTest::addColumn<QString>("name");
+    QTest::addColumn<QByteArray>("data");
+
+    QTest::newRow("mp3") << "t.mp3" << (id3Tag(4, id3v2Frames(4)) + lameFrame(1000, 576, 1000) + mpegFrames(2) + id3v1Tag());
+    QTest::newRow("flac") << "t.flac" << flacFile();
+    QTest::newRow("vorbis") << "t.ogg" << oggVorbisFile();
+    QTest::newRow("opus") << "t.opus" << oggOpusFile();
+    QTest::newRow("mp4") << "t.m4a" << mp4File();
+    QTest::newRow("riff") << "t.wav" << riffFile();
+}
+
+void TestNativeTagReader::truncated()
+{
+    QFETCH(QString, name);
+    QFETCH(QByteArray, data);
+
+    // 开头逐字节截断，之后均匀取样：只要求不越界、不挂起，能解析出的部分照常返回
+    QList<qsizetype> lengths;
+    for (qsizetype n = 0; n < qMin<qsizetype>(data.size(), 96); ++n) {
+        lengths.append(n);
+    }
+    for (int i = 1; i < 64; ++i) {
+        lengths.append(96 + (data.size() - 96) * i / 64);
+    }
+
+    for (qsizetype length : std::as_const(lengths)) {
+        const QString path = writeFile(name, data.left(length));
+        QVERIFY(!path.isEmpty());
+
+        QVariantMap metadata;
+        GaplessInfo info;
+        NativeTagReader::read(path, metadata);
+        NativeTagReader::readGapless(path, info);
+
+        // 截断处的字段整个丢弃，不会读出半截的值
+        const QVariant title = value(metadata, QMediaMetaData::Title);
+        QVERIFY2(title.isNull() || title.toString() == QStringLiteral("Title"),
+                 qPrintable(QStringLiteral("%1 bytes: %2").arg(length).arg(title.toString())));
+    }
+}
+
+void TestNativeTagReader::empty_data()
+{
+    QTest::addColumn<QString>("name");
+    for (const char *name : { "e.mp3", "e.flac", "e.ogg", "e.m4a", "e.wav" }) {
+        QTest::newRow(name) << QString::fromLatin1(name);
+    }
+}
+
+void TestNativeTagReader::empty()
+{
+    QFETCH(QString, name);
+
+    const QString path = writeFile(name, QByteArray());
+    QVariantMap metadata;
+    GaplessInfo info;
+    QVERIFY(!NativeTagReader::read(path, metadata));
+    QVERIFY(!NativeTagReader::readGapless(path, info));
+    QVERIFY(metadata.isEmpty());
+}
+
+void TestNativeTagReader::oversizedLengths_data()
+{
+    QTest::addColumn<QString>("name");
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<bool>("hasTitle");
+
+    // 标签声明 256 MB，实际只有几十字节：其后找不到音频帧，不识别为 MPEG
+    QTest::newRow("id3 tag") << "big.mp3" << (id3Tag(4, id3v2Frames(4), 0x0FFFFFFF) + mpegFrames(4)) << false;
+
+    // RIFF 中的 id3 块声明接近 4 GB，标签按文件中实际存在的部分解析
+    QTest::newRow("riff id3") << "id3.wav" << riff(riffFmt() + "id3 " + le32(0xFFFFFFF0) + id3Tag(3, id3v2Frames(3))) << true;
+
+    // 帧长度远超标签，帧被丢弃
+    QByteArray frame = id3Frame(3, "TIT2", "Title");
+    frame.replace(4, 4, be32(0xFFFFFFF0));
+    QTest::newRow("id3 frame") << "frame.mp3" << (id3Tag(3, frame) + mpegFrames(4)) << false;
+
+    // 零长度的帧结束解析
+    QTest::newRow("id3 zero frame") << "zero.mp3"
+        << (id3Tag(3, QByteArray("TIT2") + be32(0) + QByteArray(2, '\0') + id3Frame(3, "TPE1", "Artist")) + mpegFrames(4))
+        << false;
+
+    // 注释块声明接近 16 MB，只读到文件末尾
+    QTest::newRow("flac comment") << "big.flac"
+        << ("fLaC" + flacBlock(0, flacStreamInfo(), false) + flacBlock(4, vorbisComment(kComments), true, 0xFFFFFF))
+        << true;
+
+    // Vorbis 注释的条目数与条目长度都不可信
+    QByteArray comment = le32(4) + "test" + le32(0xFFFFFFFF) + le32(11) + "TITLE=Title" + le32(0xFFFFFFF0) + "X";
+    QTest::newRow("vorbis entries") << "entries.flac"
+        << ("fLaC" + flacBlock(0, flacStreamInfo(), false) + flacBlock(4, comment, true)) << true;
+
+    // moov 之后的 64 位 atom 长度接近 2^64
+    QTest::newRow("mp4 64-bit atom") << "big.m4a" << mp4File(be32(1) + "free" + be64(0xFFFFFFFFFFFFFFF0ull)) << true;
+
+    // 32 位 atom 长度超过文件
+    QTest::newRow("mp4 atom") << "atom.m4a" << mp4File(be32(0xFFFFFFF0) + "free") << true;
+
+    // LIST 块声明接近 4 GB
+    QTest::newRow("riff list") << "big.wav" << riffFile(0xFFFFFFF0) << false;
+
+    // 页的分段表声明的包体超过文件
+    QByteArray page = oggVorbisFile().left(27);
+    page[26] = char(255);
+    QTest::newRow("ogg lacing") << "big.ogg" << (page + QByteArray(255, char(255))) << false;
+}
+
+void TestNativeTagReader::oversizedLengths()
+{
+    QFETCH(QString, name);
+    QFETCH(QByteArray, data);
+    QFETCH(bool, hasTitle);
+
+    const QString path = writeFile(name, data);
+    QVariantMap metadata;
+    GaplessInfo info;
+    NativeTagReader::read(path, metadata);
+    NativeTagReader::readGapless(path, info);
+    QCOMPARE(value(metadata, QMediaMetaData::Title).toString() == QStringLiteral("Title"), hasTitle);
+}
+
+QTEST_APPLESS_MAIN(TestNativeTagReader)
+
+#include "tst_nativetagreader.moc"
@@ -0,0 +1,243 @@
+#include <QtTest>
+
+#include <algorithm>
+
+#include "Tools/QMediaPlayList.h"
+
+namespace {
+
+QString trackUrl(int i)
+{
+    return QStringLiteral("file:///music/Artist %1/Album %2/%3 - Track.flac").arg(i % 97).arg(i % 13).arg(i);
+}
+
+QVector<TrackRecord> makeTracks(int count)
+{
+    QVector<TrackRecord> tracks(count);
+    for (int i = 0; i < count; ++i) {
+        tracks[i].url = trackUrl(i);
+        tracks[i].title = QStringLiteral("Track %1").arg(i);
+    }
+    return tracks;
+}
+
+// 建立索引之前的查找方式：逐项比较 url
+int linearIndexOf(const QVector<TrackRecord> &tracks, const QString &url)
+{
+    for (int i = 0; i < tracks.size(); ++i) {
+        if (tracks[i].url == url) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 均匀分布在列表各处的待查 url，另有一个不存在的
+QStringList probeUrls(int count)
+{
+    QStringList urls;
+    for (int i = 0; i < 64; ++i) {
+        urls.append(trackUrl(int(qint64(i) * count / 64)));
+    }
+    urls.append(QStringLiteral("file:///music/missing.flac"));
+    return urls;
+}
+
+QString shuffleSavePath()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).filePath("shuffle_order.dat");
+}
+
+// 随机顺序文件中保存的 url，文件不存在或无效时为空
+QStringList savedShuffleUrls()
+{
+    QFile file(shuffleSavePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QStringList();
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0, version = 0;
+    QStringList urls;
+    in >> magic >> version >> urls;
+    return in.status() == QDataStream::Ok ? urls : QStringList();
+}
+
+void addSizes()
+{
+    QTest::addColumn<int>("count");
+    for (int count : { 100, 10000, 100000 }) {
+        QTest::addRow("%d", count) << count;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief The TestPlayList class
+ * 播放列表按 url 查找下标：索引与逐项比较的结果一致，以及两者的耗时；分批载入时播放历史只记一次；随机顺序的恢复与保存
+ */
+class TestPlayList : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void indexOfUrl();
+    void duplicateUrls();
+    void historyRecordedOnce();
+    void shuffleSavedAfterAbandonedRestore();
+
+    void benchmarkIndex_data() { addSizes(); }
+    void benchmarkIndex();
+    void benchmarkLinear_data() { addSizes(); }
+    void benchmarkLinear();
+};
+
+void TestPlayList::initTestCase()
+{
+    // 随机顺序保存在应用数据目录中，不写入真实的用户数据
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestPlayList::indexOfUrl()
+{
+    QMediaPlayList playList;
+    playList.setPlayList(makeTracks(500));
+    playList.append(makeTracks(600).mid(500));
+
+    const QVector<TrackRecord> &tracks = playList.getMetadataList();
+    QCOMPARE(tracks.size(), 600);
+    for (int i = 0; i < tracks.size(); ++i) {
+        QCOMPARE(playList.indexOfUrl(tracks[i].url), i);
+    }
+    QCOMPARE(playList.indexOfUrl(QStringLiteral("file:///music/missing.flac")), -1);
+
+    // 移除后下标前移
+    playList.removeMedia({ trackUrl(0), trackUrl(250) });
+    for (int i = 0; i < tracks.size(); ++i) {
+        QCOMPARE(playList.indexOfUrl(tracks[i].url), linearIndexOf(tracks, tracks[i].url));
+    }
+    QCOMPARE(playList.indexOfUrl(trackUrl(250)), -1);
+}
+
+void TestPlayList::duplicateUrls()
+{
+    QVector<TrackRecord> tracks = makeTracks(10);
+    tracks.append(tracks[3]);
+
+    QMediaPlayList playList;
+    playList.setPlayList(tracks);
+
+    // 重复的 url 指向第一个
+    QCOMPARE(playList.indexOfUrl(trackUrl(3)), 3);
+}
+
+void TestPlayList::historyRecordedOnce()
+{
+    QMediaPlayList playList;
+    const HistoryJournal *journal = playList.historyJournal();
+
+    playList.setPlayList(makeTracks(100));
+    QCOMPARE(journal->entries().size(), 1);
+    const qint64 written = journal->bytesWritten();
+    QVERIFY(written > 0);
+
+    // 分批追加不改变当前音频，不再记录
+    const QVector<TrackRecord> tracks = makeTracks(400);
+    for (int first = 100; first < tracks.size(); first += 100) {
+        playList.append(tracks.mid(first, 100));
+    }
+    QCOMPARE(journal->bytesWritten(), written);
+
+    // 换成另一个列表后当前音频变了，记录一次
+    QVector<TrackRecord> other = makeTracks(10);
+    std::reverse(other.begin(), other.end());
+    playList.setPlayList(other);
+    QCOMPARE(journal->entries().size(), 2);
+    QVERIFY(journal->bytesWritten() > written);
+}
+
+void TestPlayList::shuffleSavedAfterAbandonedRestore()
+{
+    QFile::remove(shuffleSavePath());
+
+    // 上次会话保存的随机顺序
+    {
+        QMediaPlayList playList;
+        playList.setPlayList(makeTracks(20));
+        playList.setPlaybackMode(QMediaPlayList::Rand);
+        playList.saveShuffleToFile();
+    }
+    const QStringList previous = savedShuffleUrls();
+    QCOMPARE(previous.size(), 20);
+
+    // 本次载入的是另一张专辑，上次的音轨始终没有出现
+    QVector<TrackRecord> tracks(8);
+    for (int i = 0; i < tracks.size(); ++i) {
+        tracks[i].url = QStringLiteral("file:///other/%1.flac").arg(i);
+    }
+
+    QMediaPlayList playList;
+    playList.loadShuffleFromFile();
+    playList.setPlayList(tracks);
+    playList.setPlaybackMode(QMediaPlayList::Rand);
+
+    // 恢复结束之前不覆盖上次的顺序
+    playList.saveShuffleToFile();
+    QCOMPARE(savedShuffleUrls(), previous);
+
+    // 结束恢复后重新打乱的顺序照常保存
+    playList.finishShuffleRestore();
+    playList.setPlayList(tracks);
+    playList.saveShuffleToFile();
+
+    QStringList saved = savedShuffleUrls();
+    QCOMPARE(saved.size(), tracks.size());
+    saved.sort();
+    QStringList expected;
+    for (const TrackRecord &track : std::as_const(tracks)) {
+        expected.append(track.url);
+    }
+    expected.sort();
+    QCOMPARE(saved, expected);
+}
+
+void TestPlayList::benchmarkIndex()
+{
+    QFETCH(int, count);
+
+    QMediaPlayList playList;
+    playList.setPlayList(makeTracks(count));
+    const QStringList urls = probeUrls(count);
+
+    int found = 0;
+    QBENCHMARK {
+        for (const QString &url : urls) {
+            found += playList.indexOfUrl(url) >= 0;
+        }
+    }
+    QVERIFY(found > 0);
+}
+
+void TestPlayList::benchmarkLinear()
+{
+    QFETCH(int, count);
+
+    const QVector<TrackRecord> tracks = makeTracks(count);
+    const QStringList urls = probeUrls(count);
+
+    int found = 0;
+    QBENCHMARK {
+        for (const QString &url : urls) {
+            found += linearIndexOf(tracks, url) >= 0;
+        }
+    }
+    QVERIFY(found > 0);
+}
+
+QTEST_GUILESS_MAIN(TestPlayList)
+
+#include "tst_playlist.moc"
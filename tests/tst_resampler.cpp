@@ -0,0 +1,340 @@
+#include <QtTest>
+
+#include <cmath>
+
+#include "Tools/Resampler.h"
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+constexpr int Channels = 2;
+
+// 各档质量的设计阻带衰减（dB），测量值留 3 dB 余量
+double attenuationDb(Resampler::Quality quality)
+{
+    switch (quality) {
+    case Resampler::Fast:
+        return 60.0;
+    case Resampler::Standard:
+        return 96.0;
+    default:
+        return 120.0;
+    }
+}
+
+// 各档质量的通带宽度，占较低一方奈奎斯特频率的比例
+double passband(Resampler::Quality quality)
+{
+    switch (quality) {
+    case Resampler::Fast:
+        return 0.80;
+    case Resampler::Standard:
+        return 0.90;
+    default:
+        return 0.95;
+    }
+}
+
+// 通带纹波（峰峰值，dB）的上限：约为 Kaiser 窗设计纹波 20 * log10(1 + 10^(-A/20)) 两侧之和的两倍
+double rippleDb(Resampler::Quality quality)
+{
+    switch (quality) {
+    case Resampler::Fast:
+        return 0.05;
+    case Resampler::Standard:
+        return 0.001;
+    default:
+        return 0.0001;
+    }
+}
+
+// 幅度 0.5 的正弦，各声道相同
+QVector<float> sine(double frequency, int rate, qint64 frames)
+{
+    QVector<float> data(frames * Channels);
+    for (qint64 i = 0; i < frames; ++i) {
+        const float v = float(0.5 * std::sin(2.0 * Pi * frequency * i / rate));
+        for (int c = 0; c < Channels; ++c) {
+            data[i * Channels + c] = v;
+        }
+    }
+    return data;
+}
+
+// 与解码时一样分块送入，块长不规则
+QVector<float> resampleAll(Resampler &resampler, const QVector<float> &input)
+{
+    QVector<float> out;
+    const qint64 frames = input.size() / Channels;
+    quint32 seed = 12345u;
+    for (qint64 offset = 0; offset < frames;) {
+        seed = seed * 1664525u + 1013904223u;
+        const qint64 n = qMin<qint64>(frames - offset, 1 + (seed >> 8) % 4096);
+        resampler.process(input.constData() + offset * Channels, n, out);
+        offset += n;
+    }
+    resampler.flush(out);
+    return out;
+}
+
+struct SineFit
+{
+    double amplitude = 0.0;
+    double phase = 0.0;         // 相对 sin(wn) 的相位（弧度）
+    double residualDb = 0.0;    // 残差与拟合正弦的能量比（THD+N）
+};
+
+// 以最小二乘拟合第一个声道的 [begin, end) 为 a * sin(wn) + b * cos(wn)
+SineFit fitSine(const QVector<float> &data, qint64 begin, qint64 end, double w)
+{
+    double ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0;
+    for (qint64 n = begin; n < end; ++n) {
+        const double s = std::sin(w * n);
+        const double c = std::cos(w * n);
+        const double y = data[n * Channels];
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        ys += y * s;
+        yc += y * c;
+    }
+    const double det = ss * cc - sc * sc;
+    const double a = (ys * cc - yc * sc) / det;
+    const double b = (yc * ss - ys * sc) / det;
+
+    double signal = 0.0;
+    double residual = 0.0;
+    for (qint64 n = begin; n < end; ++n) {
+        const double fit = a * std::sin(w * n) + b * std::cos(w * n);
+        const double e = data[n * Channels] - fit;
+        signal += fit * fit;
+        residual += e * e;
+    }
+
+    SineFit result;
+    result.amplitude = std::sqrt(a * a + b * b);
+    result.phase = std::atan2(b, a);
+    result.residualDb = 10.0 * std::log10(qMax(residual, 1e-30) / signal);
+    return result;
+}
+
+void addConversions()
+{
+    QTest::addColumn<int>("inRate");
+    QTest::addColumn<int>("outRate");
+    QTest::addColumn<int>("quality");
+
+    const int rates[][2] = {
+        { 44100, 48000 }, { 48000, 44100 },
+        { 44100, 96000 }, { 96000, 44100 }, { 44100, 192000 }, { 192000, 44100 },
+        { 48000, 96000 }, { 96000, 48000 }, { 48000, 192000 }, { 192000, 48000 },
+    };
+    for (const auto &rate : rates) {
+        for (Resampler::Quality quality : { Resampler::Fast, Resampler::Standard, Resampler::High }) {
+            QTest::addRow("%d-%d/%s", rate[0], rate[1], Resampler::qualityName(quality))
+                << rate[0] << rate[1] << int(quality);
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief The TestResampler class
+ * 44.1 kHz、48 kHz 之间以及与 96 kHz、192 kHz 互相转换时，各档质量的输出帧数、延迟补偿、通带纹波与阻带衰减，以及转换速度
+ */
+class TestResampler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void frameCount_data() { addConversions(); }
+    void frameCount();
+    void delayAlignment_data() { addConversions(); }
+    void delayAlignment();
+    void passbandRipple_data() { addConversions(); }
+    void passbandRipple();
+    void stopband_data() { addConversions(); }
+    void stopband();
+
+    void benchmark_data() { addConversions(); }
+    void benchmark();
+};
+
+void TestResampler::frameCount()
+{
+    QFETCH(int, inRate);
+    QFETCH(int, outRate);
+    QFETCH(int, quality);
+
+    Resampler resampler(inRate, outRate, Channels, Resampler::Quality(quality));
+    const qint64 frames = inRate / 2 + 17;
+    const QVector<float> input = sine(1000.0, inRate, frames);
+
+    // 每次返回的帧数与追加的数据一致，任何时候都不超过已输入部分应有的帧数
+    QVector<float> out;
+    qint64 produced = 0;
+    for (qint64 offset = 0; offset < frames; offset += 1000) {
+        const qint64 n = qMin<qint64>(1000, frames - offset);
+        const qint64 got = resampler.process(input.constData() + offset * Channels, n, out);
+        produced += got;
+        QCOMPARE(out.size(), produced * Channels);
+        QVERIFY(produced <= ((offset + n) * outRate + inRate - 1) / inRate);
+    }
+    produced += resampler.flush(out);
+    QCOMPARE(out.size(), produced * Channels);
+
+    // 总帧数为 ceil(输入帧数 * outRate / inRate)
+    QCOMPARE(produced, (frames * outRate + inRate - 1) / inRate);
+
+    // flush 之后不再有输出
+    QCOMPARE(resampler.flush(out), qint64(0));
+}
+
+void TestResampler::delayAlignment()
+{
+    QFETCH(int, inRate);
+    QFETCH(int, outRate);
+    QFETCH(int, quality);
+
+    // 冲激的输出峰值落在对应的时刻
+    {
+        Resampler resampler(inRate, outRate, Channels, Resampler::Quality(quality));
+        const qint64 at = 1470;
+        QVector<float> input(4000 * Channels, 0.0f);
+        for (int c = 0; c < Channels; ++c) {
+            input[at * Channels + c] = 1.0f;
+        }
+        const QVector<float> out = resampleAll(resampler, input);
+
+        qint64 peak = 0;
+        for (qint64 n = 1; n < out.size() / Channels; ++n) {
+            if (out[n * Channels] > out[peak * Channels]) {
+                peak = n;
+            }
+        }
+        QVERIFY2(std::fabs(peak - double(at) * outRate / inRate) < 1.0, qPrintable(QString::number(peak)));
+    }
+
+    // 通带内的正弦没有相移（输出第 0 帧对齐输入第 0 帧），幅度不变
+    {
+        Resampler resampler(inRate, outRate, Channels, Resampler::Quality(quality));
+        const double frequency = 1000.0;
+        const QVector<float> out = resampleAll(resampler, sine(frequency, inRate, inRate / 2));
+
+        const qint64 skip = resampler.taps();
+        const SineFit fit = fitSine(out, skip, out.size() / Channels - skip, 2.0 * Pi * frequency / outRate);
+        QVERIFY2(std::fabs(fit.phase) < 1e-5, qPrintable(QString::number(fit.phase)));
+        QVERIFY2(std::fabs(20.0 * std::log10(fit.amplitude / 0.5)) < 0.05, qPrintable(QString::number(fit.amplitude)));
+    }
+}
+
+void TestResampler::passbandRipple()
+{
+    QFETCH(int, inRate);
+    QFETCH(int, outRate);
+    QFETCH(int, quality);
+
+    // 100 Hz 到通带边缘按对数间隔取正弦，拟合出的幅度的最大值与最小值之差即通带纹波
+    const double edge = passband(Resampler::Quality(quality)) * 0.5 * qMin(inRate, outRate);
+    constexpr int Tones = 16;
+    double lowest = 0.0;
+    double highest = 0.0;
+    for (int i = 0; i < Tones; ++i) {
+        const double frequency = 100.0 * std::pow(edge / 100.0, double(i) / (Tones - 1));
+        Resampler resampler(inRate, outRate, Channels, Resampler::Quality(quality));
+        const QVector<float> out = resampleAll(resampler, sine(frequency, inRate, inRate / 4));
+
+        const qint64 skip = resampler.taps();
+        const SineFit fit = fitSine(out, skip, out.size() / Channels - skip, 2.0 * Pi * frequency / outRate);
+        const double db = 20.0 * std::log10(fit.amplitude / 0.5);
+        lowest = (i == 0) ? db : qMin(lowest, db);
+        highest = (i == 0) ? db : qMax(highest, db);
+    }
+
+    QVERIFY2(highest - lowest <= rippleDb(Resampler::Quality(quality)),
+             qPrintable(QStringLiteral("%1 .. %2 dB").arg(lowest).arg(highest)));
+}
+
+void TestResampler::stopband()
+{
+    QFETCH(int, inRate);
+    QFETCH(int, outRate);
+    QFETCH(int, quality);
+
+    Resampler resampler(inRate, outRate, Channels, Resampler::Quality(quality));
+    const double limitDb = -(attenuationDb(Resampler::Quality(quality)) - 3.0);
+    const qint64 skip = resampler.taps();
+
+    if (outRate > inRate) {
+        // 升采样：通带内的正弦在输入采样率附近产生的镜像应被滤除，拟合正弦后的残差即镜像
+        const double frequency = 0.75 * 0.5 * inRate;
+        const QVector<float> out = resampleAll(resampler, sine(frequency, inRate, inRate / 2));
+        const SineFit fit = fitSine(out, skip, out.size() / Channels - skip, 2.0 * Pi * frequency / outRate);
+        QVERIFY2(fit.residualDb < limitDb, qPrintable(QStringLiteral("%1 dB").arg(fit.residualDb)));
+    } else {
+        // 降采样：输出奈奎斯特频率以上的正弦应被滤除，不混叠到输出中
+        const double frequency = 0.25 * (outRate + inRate);
+        const QVector<float> out = resampleAll(resampler, sine(frequency, inRate, inRate / 2));
+        double energy = 0.0;
+        const qint64 end = out.size() / Channels - skip;
+        for (qint64 n = skip; n < end; ++n) {
+            energy += double(out[n * Channels]) * out[n * Channels];
+        }
+        // 各档质量的通带宽度，占较低一方奈奎斯特频率的比例
+double passband(Resampler::Quality quality)
+{
+    switch (quality) {
+    case Resampler::Fast:
+        return 0.80;
+    case Resampler::Standard:
+        return 0.90;
+    default:
+        return 0.95;
+    }
+}
+
+// 通带纹波（峰峰值，dB）的上限：约为 Kaiser 窗设计纹波 20 * log10(1 + 10^(-A/20)) 两侧之和的两倍
+double rippleDb(Resampler::Quality quality)
+{
+    switch (quality) {
+    case Resampler::Fast:
+        return 0.05;
+    case Resampler::Standard:
+        return 0.001;
+    default:
+        return 0.0001;
+    }
+}
+
+// 幅度 0.5 的正弦能量为 0.125
+        const double db = 10.0 * std::log10(qMax(energy / (end - skip), 1e-30) / 0.125);
+        QVERIFY2(db < limitDb, qPrintable(QStringLiteral("%1 dB").arg(db)));
+    }
+}
+
+void TestResampler::benchmark()
+{
+    QFETCH(int, inRate);
+    QFETCH(int, outRate);
+    QFETCH(int, quality);
+
+    // 一秒双声道，滤波器组在计时前设计好
+    const QVector<float> input = sine(1000.0, inRate, inRate);
+    Resampler resampler(inRate, outRate, Channels, Resampler::Quality(quality));
+    QVector<float> out;
+    out.reserve((qint64(outRate) + resampler.taps()) * Channels);
+
+    QBENCHMARK {
+        resampler.reset();
+        out.clear();
+        for (qint64 offset = 0; offset < inRate; offset += 4096) {
+            resampler.process(input.constData() + offset * Channels, qMin<qint64>(4096, inRate - offset), out);
+        }
+        resampler.flush(out);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestResampler)
+
+#include "tst_resampler.moc"
@@ -0,0 +1,354 @@
+#include <QtTest>
+
+#include <cmath>
+
+#include "Tools/WaveformCache.h"
+#include "Tools/WaveformPeaks.h"
+
+namespace {
+
+constexpr int Channels = 2;
+constexpr int SampleRate = 48000;
+constexpr int Bins = 100;
+constexpr qint64 TailFrames = 300;
+
+using Bin = WaveformPeaks::Bin;
+
+// 第 i 格的幅度，逐格增大；末尾不满一格的部分为 0.25
+float amplitude(int bin)
+{
+    return bin < Bins ? float(0.05 + 0.9 * bin / (Bins - 1)) : 0.25f;
+}
+
+// 每格内正负交替的方波，第二个声道反相：各格的最小值、最大值与均方根都由幅度决定
+QVector<float> squareWave()
+{
+    const qint64 frames = qint64(Bins) * WaveformPeaks::BaseFrames + TailFrames;
+    QVector<float> data(frames * Channels);
+    for (qint64 i = 0; i < frames; ++i) {
+        const float a = amplitude(int(i / WaveformPeaks::BaseFrames));
+        const float v = (i % 2 == 0) ? a : -a;
+        data[i * Channels] = v;
+        data[i * Channels + 1] = -v;
+    }
+    return data;
+}
+
+// 与解码时一样分块送入，块长不规则；chunked 为 false 时一次送入
+WaveformPeaks build(const QVector<float> &data, bool chunked = true)
+{
+    WaveformBuilder builder(SampleRate, Channels);
+    const qint64 frames = data.size() / Channels;
+    quint32 seed = 12345u;
+    for (qint64 offset = 0; offset < frames;) {
+        seed = seed * 1664525u + 1013904223u;
+        const qint64 n = chunked ? qMin<qint64>(frames - offset, 1 + (seed >> 8) % 4096) : frames;
+        builder.process(data.constData() + offset * Channels, n);
+        offset += n;
+    }
+    return builder.result();
+}
+
+bool sameBins(const QVector<Bin> &a, const QVector<Bin> &b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (qsizetype i = 0; i < a.size(); ++i) {
+        if (a[i].min != b[i].min || a[i].max != b[i].max || a[i].rms != b[i].rms) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QString cacheDir()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).filePath("waveforms");
+}
+
+QStringList cacheEntries()
+{
+    QStringList paths;
+    const QFileInfoList entries = QDir(cacheDir()).entryInfoList({ "*.wfp" }, QDir::Files);
+    for (const QFileInfo &entry : entries) {
+        paths.append(entry.filePath());
+    }
+    return paths;
+}
+
+bool setModified(const QString &path, const QDateTime &time)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadWrite) && file.setFileTime(time, QFileDevice::FileModificationTime);
+}
+
+} // namespace
+
+/**
+ * @brief The TestWaveform class
+ * 峰值金字塔各层的最小值、最大值与均方根，按像素列合并，以及磁盘缓存的读写、过期与按最后使用时间淘汰
+ */
+class TestWaveform : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+
+    void pyramid();
+    void columns_data();
+    void columns();
+
+    void cacheRoundTrip();
+    void cacheInvalidation_data();
+    void cacheInvalidation();
+    void trimOrder();
+
+private:
+    QString writeTrack(const QString &name);
+
+    QTemporaryDir m_dir;
+};
+
+void TestWaveform::initTestCase()
+{
+    // 缓存写在应用数据目录中，不写入真实的用户数据
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_dir.isValid());
+}
+
+void TestWaveform::init()
+{
+    WaveformCache().trim(0);
+}
+
+QString TestWaveform::writeTrack(const QString &name)
+{
+    // 缓存只比较文件的大小与修改时间，内容无关
+    const QString path = m_dir.filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(QByteArray(1000, '\0')) != 1000) {
+        return QString();
+    }
+    return path;
+}
+
+void TestWaveform::pyramid()
+{
+    const QVector<float> data = squareWave();
+    const WaveformPeaks peaks = build(data);
+    QCOMPARE(peaks.sampleRate, SampleRate);
+    QCOMPARE(peaks.frames, qint64(Bins) * WaveformPeaks::BaseFrames + TailFrames);
+
+    // 第 0 层：每格的最小值、最大值与均方根，末尾不满一格的部分也是一格
+    const QVector<Bin> &base = peaks.levels.first();
+    QCOMPARE(base.size(), Bins + 1);
+    for (int i = 0; i < base.size(); ++i) {
+        const float a = amplitude(i);
+        QCOMPARE(base[i].min, qint8(std::lround(-a * 127.0f)));
+        QCOMPARE(base[i].max, qint8(std::lround(a * 127.0f)));
+        QCOMPARE(base[i].rms, quint8(std::lround(double(a) * 255.0)));
+    }
+
+    // 分块方式不影响结果
+    QVERIFY(sameBins(build(data, false).levels.first(), base));
+
+    // 之后每层把相邻两格合并为一格，直到不超过 MinLevelBins 格
+    for (int level = 1; level < peaks.levels.size(); ++level) {
+        const QVector<Bin> &fine = peaks.levels[level - 1];
+        const QVector<Bin> &coarse = peaks.levels[level];
+        QVERIFY(fine.size() > WaveformPeaks::MinLevelBins);
+        QCOMPARE(coarse.size(), (fine.size() + 1) / 2);
+
+        for (int j = 0; j < coarse.size(); ++j) {
+            const int count = int(qMin<qsizetype>(2, fine.size() - 2 * j));
+            qint8 lo = fine[2 * j].min;
+            qint8 hi = fine[2 * j].max;
+            double energy = 0.0;
+            for (int k = 0; k < count; ++k) {
+                lo = qMin(lo, fine[2 * j + k].min);
+                hi = qMax(hi, fine[2 * j + k].max);
+                energy += std::pow(fine[2 * j + k].rms / 255.0, 2.0);
+            }
+            QCOMPARE(coarse[j].min, lo);
+            QCOMPARE(coarse[j].max, hi);
+            // 均方根按能量平均
+            QVERIFY(qAbs(int(coarse[j].rms) - int(std::lround(std::sqrt(energy / count) * 255.0))) <= 1);
+        }
+    }
+    QVERIFY(peaks.levels.last().size() <= WaveformPeaks::MinLevelBins);
+}
+
+void TestWaveform::columns_data()
+{
+    QTest::addColumn<int>("width");
+    for (int width : { 1, 7, 13, 50, 101, 250 }) {
+        QTest::addRow("%d", width) << width;
+    }
+}
+
+void TestWaveform::columns()
+{
+    QFETCH(int, width);
+
+    const WaveformPeaks peaks = build(squareWave());
+    const QVector<Bin> &base = peaks.levels.first();
+    const QVector<Bin> columns = peaks.columns(width);
+    QCOMPARE(columns.size(), width);
+
+    // 取格数不少于像素数的最粗一层，第 level 层的一格对应第 0 层的 2^level 格
+    int level = 0;
+    for (int i = peaks.levels.size() - 1; i >= 0; --i) {
+        if (peaks.levels[i].size() >= width) {
+            level = i;
+            break;
+        }
+    }
+    const qint64 count = peaks.levels[level].size();
+
+    // 每列的最小值与最大值等于它覆盖的第 0 层各格中的最值，均方根在其间
+    for (int x = 0; x < width; ++x) {
+        const qint64 begin = x * count / width;
+        const qint64 end = qMax(begin + 1, (x + 1) * count / width);
+        const qint64 first = begin << level;
+        const qint64 last = qMin<qint64>(end << level, base.size());
+
+        qint8 lo = base[first].min;
+        qint8 hi = base[first].max;
+        quint8 rmsLo = base[first].rms;
+        quint8 rmsHi = base[first].rms;
+        for (qint64 i = first; i < last; ++i) {
+            lo = qMin(lo, base[i].min);
+            hi = qMax(hi, base[i].max);
+            rmsLo = qMin(rmsLo, base[i].rms);
+            rmsHi = qMax(rmsHi, base[i].rms);
+        }
+        QCOMPARE(columns[x].min, lo);
+        QCOMPARE(columns[x].max, hi);
+        QVERIFY2(columns[x].rms >= rmsLo && columns[x].rms <= rmsHi,
+                 qPrintable(QStringLiteral("column %1: %2").arg(x).arg(columns[x].rms)));
+    }
+
+    QVERIFY(peaks.columns(0).isEmpty());
+    QVERIFY(WaveformPeaks().columns(width).isEmpty());
+}
+
+void TestWaveform::cacheRoundTrip()
+{
+    const QString track = writeTrack("a.flac");
+    QVERIFY(!track.isEmpty());
+    const WaveformPeaks peaks = build(squareWave());
+
+    WaveformCache cache;
+    WaveformPeaks loaded;
+    QVERIFY(!cache.lookup(track, loaded));
+    cache.insert(track, peaks);
+    QCOMPARE(cacheEntries().size(), 1);
+
+    // 磁盘上只有第 0 层，其余各层载入时重建
+    QVERIFY(cache.lookup(track, loaded));
+    QCOMPARE(loaded.sampleRate, peaks.sampleRate);
+    QCOMPARE(loaded.frames, peaks.frames);
+    QCOMPARE(loaded.levels.size(), peaks.levels.size());
+    for (int level = 0; level < peaks.levels.size(); ++level) {
+        QVERIFY(sameBins(loaded.levels[level], peaks.levels[level]));
+    }
+
+    // 下次启动时的新实例同样命中
+    WaveformPeaks reloaded;
+    QVERIFY(WaveformCache().lookup(track, reloaded));
+    QVERIFY(sameBins(reloaded.levels.first(), peaks.levels.first()));
+}
+
+void TestWaveform::cacheInvalidation_data()
+{
+    QTest::addColumn<bool>("changeSize");
+    QTest::newRow("size") << true;
+    QTest::newRow("mtime") << false;
+}
+
+void TestWaveform::cacheInvalidation()
+{
+    QFETCH(bool, changeSize);
+
+    const QString track = writeTrack("b.flac");
+    QVERIFY(!track.isEmpty());
+    WaveformCache cache;
+    cache.insert(track, build(squareWave()));
+    QCOMPARE(cacheEntries().size(), 1);
+
+    // 只改变其中一项，另一项保持不变
+    const QDateTime modified = QFileInfo(track).lastModified();
+    QFile file(track);
+    QVERIFY(file.open(QIODevice::ReadWrite | QIODevice::Append));
+    if (changeSize) {
+        QCOMPARE(file.write("x"), qint64(1));
+        QVERIFY(file.flush());
+        QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+    } else {
+        QVERIFY(file.setFileTime(modified.addSecs(2), QFileDevice::FileModificationTime));
+    }
+    file.close();
+
+    // 过期的缓存文件随即删除
+    WaveformPeaks loaded;
+    QVERIFY(!cache.lookup(track, loaded));
+    QVERIFY(cacheEntries().isEmpty());
+}
+
+void TestWaveform::trimOrder()
+{
+    const WaveformPeaks peaks = build(squareWave());
+    WaveformCache cache;
+
+    // 依次写入三首，记下各自的缓存文件
+    QStringList tracks;
+    QStringList entries;
+    for (const char *name : { "c.flac", "d.flac", "e.flac" }) {
+        const QString track = writeTrack(QString::fromLatin1(name));
+        QVERIFY(!track.isEmpty());
+        const QStringList before = cacheEntries();
+        cache.insert(track, peaks);
+        QStringList after = cacheEntries();
+        for (const QString &entry : before) {
+            after.removeAll(entry);
+        }
+        QCOMPARE(after.size(), 1);
+        tracks.append(track);
+        entries.append(after.first());
+    }
+
+    // 写入时间依次相隔一分钟，之后再查找第一首：最久未使用的变为第二首，其次是第三首
+    const QDateTime now = QDateTime::currentDateTime();
+    for (int i = 0; i < entries.size(); ++i) {
+        QVERIFY(setModified(entries[i], now.addSecs(-180 + 60 * i)));
+    }
+    WaveformPeaks loaded;
+    QVERIFY(cache.lookup(tracks[0], loaded));
+
+    qint64 total = 0;
+    for (const QString &entry : std::as_const(entries)) {
+        total += QFileInfo(entry).size();
+    }
+
+    // 只超出一个字节，删除最久未使用的一个
+    cache.trim(total - 1);
+    QVERIFY(QFile::exists(entries[0]));
+    QVERIFY(!QFile::exists(entries[1]));
+    QVERIFY(QFile::exists(entries[2]));
+
+    // 再超出一个字节，删除剩下两个中较旧的第三首
+    cache.trim(QFileInfo(entries[0]).size() + QFileInfo(entries[2]).size() - 1);
+    QVERIFY(QFile::exists(entries[0]));
+    QVERIFY(!QFile::exists(entries[2]));
+
+    // 不超过上限时不删除
+    cache.trim(QFileInfo(entries[0]).size());
+    QVERIFY(QFile::exists(entries[0]));
+}
+
+QTEST_GUILESS_MAIN(TestWaveform)
+
+#include "tst_waveform.moc"